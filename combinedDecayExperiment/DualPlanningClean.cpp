@@ -17,6 +17,48 @@
 /* V1.3  JNI 22/Nov/2016 - Cleaning up code with HRS.                         */
 /*                                                                            */
 /* V1.4  HRS 11/May/2017 - Added options for passive wait trials.             */
+/*                                                                            */
+/* V1.5  HRS 17/Oct/2026 - Allocation-free VEC3/MAT3 in forces function.      */
+/*                                                                            */
+/* V1.6  HRS 17/Oct/2026 - Force-field compiled per trial (no per-tick trig). */
+/*                                                                            */
+/* V1.7  HRS 17/Oct/2026 - Force-field policy kernels selected per trial.     */
+/*                                                                            */
+/* V1.8  HRS 17/Oct/2026 - Robot state snapshot for the graphics thread.      */
+/*                                                                            */
+/* V1.9  HRS 17/Oct/2026 - Deferred logging (LOOPLOG) for robot loop messages.*/
+/*                                                                            */
+/* V1.10 HRS 17/Oct/2026 - Simulated robot (ROBOT_SIMULATE) for Linux.        */
+/*                                                                            */
+/* V1.11 HRS 17/Oct/2026 - Per-state loop timing histograms (LOOPHIST).       */
+/*                                                                            */
+/* V1.12 HRS 17/Oct/2026 - FrameData sized from worst-case trial duration.    */
+/*                                                                            */
+/* V1.13 HRS 17/Oct/2026 - Slow frame variables saved as streams (FRAMEREC).  */
+/*                                                                            */
+/* V1.14 HRS 17/Oct/2026 - Trials saved by a background thread (TRIALWRITER). */
+/*                                                                            */
+/* V1.15 HRS 17/Oct/2026 - Columnar session file (COLFILE).                   */
+/*                                                                            */
+/* V1.16 HRS 17/Oct/2026 - Compressed columns in session file (COLCODEC).     */
+/*                                                                            */
+/* V1.17 HRS 17/Oct/2026 - Session journal and /resume (JOURNAL).             */
+/*                                                                            */
+/* V1.18 HRS 17/Oct/2026 - Online force-compensation index for channel trials.*/
+/*                                                                            */
+/* V1.19 HRS 17/Oct/2026 - Random-access trial index next to the data file.   */
+/*                                                                            */
+/* V1.20 HRS 17/Oct/2026 - Configuration and trial list cache (CFGCACHE).     */
+/*                                                                            */
+/* V1.21 HRS 17/Oct/2026 - Trial list made in a typed array (TRIALPLAN).      */
+/*                                                                            */
+/* V1.22 HRS 17/Oct/2026 - Idle function sleeps until its next deadline.      */
+/*                                                                            */
+/* V1.23 HRS 17/Oct/2026 - Cursor predicted to the time it is on the screen.  */
+/*                                                                            */
+/* V1.24 HRS 17/Oct/2026 - Cached geometry for circles, rings and text.       */
+/*                                                                            */
+/* V1.25 HRS 17/Oct/2026 - Stereo scene compiled once, drawn for each eye.    */
 /******************************************************************************/
 
 #define MODULE_NAME "DualPlanningClean"
@@ -24,6 +66,24 @@
 /******************************************************************************/
 
 #include <motor.h>
+#include <atomic>
+#include "../common/vec3.h"
+#include "../common/snapshot.h"
+#include "../common/looplog.h"
+#include "../common/loophist.h"
+#include "../common/framerec.h"
+#include "../common/trialwriter.h"
+#include "../common/colfile.h"
+#include "../common/journal.h"
+#include "../common/trialindex.h"
+#include "../common/cfgcache.h"
+#include "../common/idlesched.h"
+#include "../common/glcache.h"
+#include "DualPlanningScene.h"
+
+#ifdef ROBOT_SIMULATE
+#include "../common/robotsim.h"
+#endif
 
 /******************************************************************************/
 
@@ -152,9 +212,19 @@ int     CursorColor=RED;
 STRING  CursorColorText="RED";
 double  CursorRadius=0.5;
 
-matrix  ForceFieldForces(3,1);
+// The cursor can be drawn where the hand is expected to be when the frame is
+// on the screen (CursorPredicted), extrapolated from the loop-rate kinematics.
+BOOL    CursorPredictFlag=FALSE;
+double  CursorPredictTime=0.0;             // Vertical retrace (or drawing) to photons (sec).
+BOOL    CursorPredictAcceleration=FALSE;   // Include acceleration as well as velocity.
+double  CursorAccelerationTime=0.01;       // Time constant (sec) of acceleration filter.
+matrix  CursorPredicted(3,1);
+VEC3    CursorAcceleration;
+VEC3    CursorVelocityLast;
+
+VEC3    ForceFieldForces;
 BOOL    ForceFieldStarted=FALSE;
-matrix  ForceFieldPosition(3,1);
+VEC3    ForceFieldPosition;
 double  ForceFieldAngle=0.0;
 RAMPER  ForceFieldRamp;
 double  ForceFieldRampValue=0.0;
@@ -192,14 +262,12 @@ matrix  ViaEntryPosition(3,1);
 double  ViaEntryLineLength=0.6;
 double  ViaEntryLineWidth=2.0;
 
-#define VIA_CIRCLE    0
-#define VIA_RECTANGLE 1
 int     ViaType=VIA_CIRCLE;
 
 TIMER_Interval  RobotForcesFunctionLatency("ForcesFunction");
 double          ForcesFunctionLatency;
 TIMER_Frequency RobotForcesFunctionFrequency("ForcesFunction");
-double          ForcesFunctionPeriod;
+double          ForcesFunctionPeriod;           // msec (TIMER_Frequency::Loop()).
 
 TIMER_Frequency GraphicsDisplayFrequency("DisplayFrequency");
 TIMER_Frequency GraphicsIdleFrequency("IdleFrequency");
@@ -210,6 +278,9 @@ TIMER_Interval  GraphicsClearMonoLatency("ClearMonoLatency");
 
 double  GraphicsVerticalRetraceSyncTime=0.01;   // Time (sec) before vertical retrace to draw graphics frame
 double  GraphicsVerticalRetraceCatchTime=0.05;  // Time (msec) to devote to catching vertical retrace
+double  GraphicsIdlePeriod=0.001;               // Longest sleep (sec) of idle function (0 for Sleep(0) loop)
+double  GraphicsIdleSpinTime=0.001;             // Time (sec) to spin before a vertical retrace deadline
+BOOL    GraphicsSceneListFlag=TRUE;             // Stereo scene compiled once and drawn for each eye
 TIMER   GraphicsTargetTimer("GraphicsTarget");
 
 int     GraphicsMode=GRAPHICS_DISPLAY_2D;
@@ -228,9 +299,21 @@ struct WAVELIST WaveList[] =
 
 TIMER_Interval WaveListPlayInterval("WaveListPlay");
 
-#define FRAMEDATA_ROWS 10000
+#define FRAMEDATA_ROWS   10000         // Minimum rows.
+#define FRAMEDATA_CHUNK  1000          // Rows are added in chunks of this size.
+#define FRAMEDATA_MARGIN 1.0           // Extra time (sec) on top of worst-case trial.
 MATDAT FrameData("FrameData");
+COLTABLE FrameColumns("FrameData");
+COLTABLE FrameShadow("FrameData");     // Copies of the frame variables, which FrameData samples.
+MATDAT FrameGraphics("FrameGraphics"); // GRAPHICS frame variables for each row.
 BOOL   FrameRecord=FALSE;
+int    FrameDataRows=0;
+int    FrameDataExtraChunks=0;
+BOOL   FrameDataTruncated=FALSE;       // FrameData filled and recording stopped early (TrialData).
+
+// Slowly-changing frame variables, each with its own sample rate and time.
+#define FRAMESTREAM_RATE 100.0         // Hz
+FRAMEREC FrameStreams("FrameStreams");
 
 TIMER  TrialTimer("Trial");
 TIMER  InterTrialDelayTimer("InterTrialDelay");
@@ -239,27 +322,8 @@ double TrialDuration=0.0;
 int    Trial;
 BOOL   TrialRunning=FALSE;
 
-// Field types.
-#define FIELD_NONE       0
-#define FIELD_VISCOUS    1
-#define FIELD_CHANNEL    2
-#define FIELD_PMOVE      3
-#define FIELD_2DSPRING   4
-#define FIELD_SAMEASLAST 5
-#define FIELD_MAX        6 
-
-// Target context types.
-#define TARGET_STATIC_ON	0
-#define TARGET_APPEAR		1
-#define TARGET_STOP		2
-#define TARGET_CENTRAL_ONLY	3
-#define TARGET_VISUAL_ONLY	4
-#define TARGET_DUAL_OFF	        5
-#define DUAL_PLANNING           6
-#define TARGET_STATIC_GO	7
-#define DUAL_PLANNING_GO        8
-#define PASSIVE_WAIT		9
-#define PASSIVE_MOVE		10
+// Field types, target context types, movement order types and states are
+// in DualPlanningScene.h.
 
 BOOL PassiveWaitFirstFlag=FALSE;
 BOOL PassiveWaitLastFlag=FALSE;
@@ -301,6 +365,42 @@ PERMUTELIST TargetPermute;
 
 MATDAT TrialData("TrialData");
 
+// The trial list is made in TrialPlan (one for each row of TrialData) and then
+// saved to TrialData once it is finished. A trial's other TrialData variables
+// are those of its configuration file, sampled into TrialPlanConfig before its
+// trials are made (configuration 0 is an empty row).
+struct TRIALPLAN
+{
+    BOOL   Made;                        // Saved to TrialData.
+    int    Config;                      // Row of TrialPlanConfig.
+    int    PhaseIndex;
+    int    TrialPhase;
+    int    FieldIndex;
+    int    FieldType;
+    double FieldAngle;
+    double FieldConstants[FIELD_CONSTANTS];
+    int    ContextType;
+    double ContextConstants[FIELD_CONSTANTS];
+    double TargetAngle;
+    double SymmetryAxisAngle;
+    double TargetResolveDistance;
+    int    MovementOrderType;
+    int    ChannelOrderType;
+    double MovementSecondDistance;
+    int    MovementDirection;
+    double TrialDelay;
+    BOOL   PassiveWaitFirstFlag;
+    BOOL   PassiveWaitLastFlag;
+    VEC3   StartPosition;
+    VEC3   TargetPosition;
+    VEC3   FinishPosition;
+};
+
+std::vector<TRIALPLAN> TrialPlan;
+std::vector<double> TrialPlanConfig;
+COLTABLE TrialColumns("TrialData");
+BOOL     ColumnCompress=TRUE;  // Compress columns in session file (COLCODEC).
+
 // Trial data variables.
 int    FieldIndex;
 int    FieldType;
@@ -310,8 +410,6 @@ double FieldLastConstants[FIELD_CONSTANTS];
 double FieldLastAngle;
 double FieldAngle;
 int    ContextType;
-int    ContextTypeLast;
-int    ContextTypeNext;
 
 double ContextConstants[FIELD_CONSTANTS];
 // 0 - Target Angle
@@ -327,13 +425,8 @@ double  SymmetryAxisAngle;
 double  TargetResolveDistance;
 BOOL    TargetResolveFlag=FALSE;
 int     MovementOrderType;
-#define ORDER_FOLLOW_THROUGH  0
-#define ORDER_LEAD_IN         1
-#define ORDER_SINGLE_MOVEMENT 2
 
 int     ChannelOrderType;
-#define CHANNEL_FIRST  0
-#define CHANNEL_SECOND 1
 
 double TargetAngle;
 double MovementReactionTime=0.0;
@@ -348,13 +441,46 @@ int     MissTrialsTotal=0;
 int     MissTrialsTypeTotal[MISS_TRIAL_TYPES];
 double  MissTrialsPercent=0.0;
 
+// Session journal (to resume an interrupted session with /resume).
+#define RECORD_SESSION  1       // Trial list.
+#define RECORD_TRIAL    2       // Trial written to data file.
+#define RECORD_RESUME   3       // Session resumed.
+#define RECORD_TIMES    64
+
+struct JOURNALTRIAL
+{
+    int    Trial;
+    int    MissTrialsTotal;
+    int    MissTrialsTypeTotal[MISS_TRIAL_TYPES];
+    int    MovementTimes;
+    double MovementTime[RECORD_TIMES];  // Added to ContextFullMovementTimeData.
+};
+
+STRING  JournalFile="";
+BOOL    JournalResumeFlag=FALSE;
+BOOL    JournalSessionFlag=FALSE;
+int     JournalResumeCount=0;
+int     JournalTrialLast=0;
+int     JournalTimeCount=0;
+double  JournalTime[RECORD_TIMES];
+JOURNALTRIAL JournalTrial;
+
+// Trial index (DataFile.index) to go straight to a trial in the data file.
+int     TrialIndexMissTotal=0;
+BOOL    TrialIndexMissTrial=FALSE;
+
+// Cache of the configuration and trial list (DataFile.cfgcache), which is used
+// instead of loading the configuration files again if they haven't changed.
+CFGCACHE ConfigCache;
+STRING  ConfigCacheFile="";
+
 #define MISS_TRIAL_TIMEOUT          0
 #define MISS_TRIAL_VIAENTRY         1
 #define MISS_TRIAL_MISSEDVIA        2
 #define MISS_TRIAL_VIATOOLONG       3
 #define MISS_TRIAL_VIATOOSHORT      4
 #define MISS_TRIAL_ROBOTINACTIVE    5
-#define MISS_TRIAL_FRAMEDATAFULL    6
+#define MISS_TRIAL_FRAMEDATAFULL    6   // Not used: trial is kept with FrameDataTruncated set.
 #define MISS_TRIAL_MOVETOOSOON      7
 
 double MovementFirstDistance=10.0;
@@ -363,7 +489,58 @@ double MovementSecondDistance=10.0;
 int    RobotFieldType=FIELD_NONE;
 double RobotFieldConstants[FIELD_CONSTANTS];
 double RobotFieldAngle;
-matrix RobotFieldMatrix;
+
+// Force-compensation index of channel trials: regression (through zero) of the
+// channel force on the ideal force of the viscous field, both perpendicular to
+// the channel. The forces function adds to the sums during the movement, so
+// the index is ready at TrialStop() without going back over the frame data.
+double CompensationViscosity=0.0;   // Viscous field the channel force is compared with
+double CompensationAngle=0.0;       // (the last one used, or the first configured).
+double CompensationSum[3];          // Channel x channel, channel x ideal, ideal x ideal.
+int    CompensationCount=0;
+double CompensationIndex=0.0;
+double CompensationR2=0.0;
+
+// Via-point checks made by the forces function.
+#define VIA_CHECK_NONE    0
+#define VIA_CHECK_MISSED  1     // Full movement, missed central target?
+#define VIA_CHECK_TOOFAR  2     // Central target only, moved too far?
+#define VIA_CHECK_MAX     3
+
+// Force-field kernel (field type and via-point check) called by the forces function.
+struct ROBOTFIELD;
+typedef void (*ROBOTFIELD_KERNEL)( const ROBOTFIELD *field, const VEC3 &X, const VEC3 &V, VEC3 &F );
+
+// Force-field as evaluated by the forces function. It is compiled for the trial
+// and when the force-field starts, so the rotation matrices are only calculated
+// when the field or channel angle changes rather than on every tick. It is only
+// compiled by the forces function (the graphics thread asks for it with
+// RobotFieldRequest() and ForceFieldRequest()), into the object not in use, and
+// handed over with a release store so a tick never sees a part-built field.
+struct ROBOTFIELD
+{
+    int     Type;
+    ROBOTFIELD_KERNEL Kernel;       // Selected from RobotFieldKernelTable.
+    double  Constants[FIELD_CONSTANTS];
+    MAT3    Matrix;                 // Viscous field rotation (FieldAngle).
+    VEC3    Position;               // Force-field origin (ForceFieldPosition).
+    MAT3    R;                      // Rotation into channel frame...
+    MAT3    _R;                     // ...and back again.
+    RAMPER *ChannelWidthRamp;       // Channel width ramp hook.
+    double  ChannelWidthInitial;
+    int     ViaCheck;               // VIA_CHECK_...
+    double  ViaDistance;            // MissedViaPointDistance or MovedTooFarDistance.
+    MAT3    ViaR;                   // Rotation of symmetry axis.
+    VEC3    ViaPosition;
+    VEC3    ChannelAxis;            // Perpendicular to the channel (row 1 of R).
+    VEC3    IdealAxis;              // Ideal viscous force along ChannelAxis (per unit velocity).
+};
+
+ROBOTFIELD  RobotFieldList[2];
+std::atomic<ROBOTFIELD *> RobotField(&RobotFieldList[0]);
+
+std::atomic<bool> RobotFieldCompileFlag(false);
+std::atomic<bool> ForceFieldStartFlag(false);
 
 TIMER   ExperimentTimer("Experiment");
 double  ExperimentTime;
@@ -372,38 +549,43 @@ double  ExperimentMinutes;
 
 /******************************************************************************/
 
-#define STATE_INITIALIZE     0
-#define STATE_SETUP          1
-#define STATE_HOME           2
-#define STATE_START          3
-#define STATE_DELAY          4
-#define STATE_GO             5
-#define STATE_MOVEWAIT       6
-#define STATE_MOVING0        7
-#define STATE_VIAPOINT       8
-#define STATE_MOVING1        9
-#define STATE_POSTMOVEDELAY 10
-#define STATE_FINISH        11
-#define STATE_FEEDBACK	    12
-#define STATE_NEXT          13
-#define STATE_INTERTRIAL    14
-#define STATE_EXIT          15
-#define STATE_TIMEOUT       16
-#define STATE_ERROR         17
-#define STATE_REST          18
-#define STATE_MAX           19
-
-int   State=STATE_INITIALIZE;
+std::atomic<int> State(STATE_INITIALIZE);   // Set by both threads.
+int   StateFrame;                   // State saved to FrameData for the tick.
 int   StateLast;
 BOOL  StateFirstFlag=FALSE;
 int   StateGraphics=STATE_INITIALIZE;
 int   StateGraphicsLast;
 char *StateText[] = { "Initialize","Setup","Home","Start","Delay","Go","MoveWait","Moving0","ViaPoint","Moving1","PostMoveDelay","Finish","Feedback","Next","InterTrial","Exit","TimeOut","Error","Rest" };
 BOOL  StateLoopTask[STATE_MAX] = { FALSE,FALSE,FALSE,FALSE,FALSE,FALSE,TRUE,TRUE,TRUE,TRUE,TRUE,FALSE,FALSE,FALSE,FALSE,FALSE,FALSE,FALSE,FALSE };
+
+// Loop timing histograms for each state (current trial and since last rest break).
+LOOPHIST_STATES LoopHistTrial(STATE_MAX,StateText);
+LOOPHIST_STATES LoopHistSession(STATE_MAX,StateText);
 TIMER StateTimer("State");
 TIMER StateGraphicsTimer("StateGraphics");
 int   StateErrorResume;
 
+// Robot state published by the forces function once per tick. The graphics
+// thread takes a copy at the start of each GraphicsIdle() so that positions and
+// state are from the same tick. The RobotHome(), RobotNotMoving(), etc. checks
+// are given the copy of the thread that calls them (LoopRobot for the forces
+// function, GraphicsRobot for StateProcess()).
+struct ROBOTSNAPSHOT
+{
+    double TrialTime;
+    int    State;
+    VEC3   RobotPosition;
+    VEC3   RobotVelocity;
+    double RobotSpeed;
+    VEC3   CursorPosition;          // As drawn (CursorPredicted).
+    VEC3   RobotForces;
+    BOOL   ForceFieldStarted;
+};
+
+SNAPSHOT<ROBOTSNAPSHOT> RobotSnapshot;
+ROBOTSNAPSHOT GraphicsRobot;
+ROBOTSNAPSHOT LoopRobot;
+
 /******************************************************************************/
 
 void ProgramExit( void );
@@ -420,88 +602,166 @@ void WaveListPlay( char *name )
 
 /******************************************************************************/
 
+// Configuration variables are also added to the cache.
+
+template<class TYPE> void ConfigSet( char *name, TYPE &variable )
+{
+    CONFIG_set(name,variable);
+    ConfigCache.Add(variable);
+}
+
+/******************************************************************************/
+
+template<class TYPE> void ConfigSet( char *name, TYPE *variable, int count )
+{
+    CONFIG_set(name,variable,count);
+    ConfigCache.Add(variable,count);
+}
+
+/******************************************************************************/
+
+void ConfigSetBOOL( char *name, BOOL &variable )
+{
+    CONFIG_setBOOL(name,variable);
+    ConfigCache.Add(variable);
+}
+
+/******************************************************************************/
+
+void ConfigLabel( char *name, int &variable )
+{
+    CONFIG_label(name,variable);
+    ConfigCache.Add(variable);
+}
+
+/******************************************************************************/
+
+void ConfigLabel( char *name, int *variable, int count )
+{
+    CONFIG_label(name,variable,count);
+    ConfigCache.Add(variable,count);
+}
+
+/******************************************************************************/
+
 void ConfigSetup( void )
 {
 int i;
 
     // Reset configuration variable list.
     CONFIG_reset();
+    ConfigCache.Reset();
 
     // Set up variable list for configuration.
-    CONFIG_set(VAR(RobotName));
-    CONFIG_setBOOL(VAR(RobotFT));
-    CONFIG_set(VAR(ForceMax));
-    CONFIG_set("GraphicsSyncTime",GraphicsVerticalRetraceSyncTime);
-    CONFIG_set("GraphicsCatchTime",GraphicsVerticalRetraceCatchTime);
-    CONFIG_set(VAR(TextPosition));
-    CONFIG_set("CursorColor",CursorColorText);
-    CONFIG_set(VAR(CursorRadius));
-    CONFIG_set(VAR(MovementFirstDistance));
-    CONFIG_set(VAR(MovementSecondDistance));
-    CONFIG_set("TargetColor",TargetColorText);
-    CONFIG_set(VAR(TargetRadius));
-    CONFIG_set(VAR(TargetOutlineWidth));
-    CONFIG_set(VAR(ViaRadius));
-    CONFIG_set(VAR(ViaHeight));
-    CONFIG_set(VAR(ViaWidth));
-    CONFIG_set(VAR(ViaEntryAngle));
-    CONFIG_set(VAR(ViaPosition));
-    CONFIG_set(VAR(MovedTooFarDistance));
-    CONFIG_set(VAR(MissedViaPointDistance));
-    CONFIG_set(VAR(StartRadius));
-    CONFIG_set(VAR(StartTolerance));
-    CONFIG_set(VAR(FinishTolerance));
-    CONFIG_set(VAR(FinishToleranceTime));
-    CONFIG_set(VAR(ViaToleranceTime));
-    CONFIG_set(VAR(ViaNotMovingSpeed));
-    CONFIG_set(VAR(ViaTimeOutTime));
-    CONFIG_set(VAR(PostMoveDelayInit));
-    CONFIG_set("MovementType",MovementTypeString);
-    CONFIG_set(VAR(MovementReactionTimeOut));
-    CONFIG_set(VAR(MovementDurationTimeOut));
-    CONFIG_set(VAR(MovementDurationTooFast));
-    CONFIG_set(VAR(MovementDurationTooSlow)); 
-    CONFIG_set(VAR(PMoveMovementTime)); 
-
-    CONFIG_set(VAR(MovementFirstTooFast)); 
-    CONFIG_set(VAR(MovementFirstTooSlow)); 
-    CONFIG_set(VAR(MovementSecondTooFast)); 
-    CONFIG_set(VAR(MovementSecondTooSlow)); 
-
-    CONFIG_set(VAR(ErrorWait));
-    CONFIG_set(VAR(TrialDelay));
-    CONFIG_set(VAR(TrialDelayMax));
-    CONFIG_set(VAR(TrialDelayOffset));
-    CONFIG_set(VAR(TrialDelayLambda));
-    CONFIG_set(VAR(InterTrialDelay));
-    CONFIG_set(VAR(FeedbackTime));
-    CONFIG_set(VAR(NotMovingSpeed));
-    CONFIG_set(VAR(NotMovingTime));
-    CONFIG_set(VAR(ForceFieldRampTime));
-    CONFIG_set(VAR(ChannelWidthRampTime));
-    CONFIG_set(VAR(ChannelWidthInitial));
-
-    CONFIG_setBOOL(VAR(RestBreakHere));
-    CONFIG_set(VAR(RestBreakTrials),RESTBREAK_MAX);
-    CONFIG_set(VAR(RestBreakSeconds));
-
-    CONFIG_set(VAR(Trials));	
+    ConfigSet(VAR(RobotName));
+    ConfigSetBOOL(VAR(RobotFT));
+
+#ifdef ROBOT_SIMULATE
+    // Simulated robot and subject (see common/robotsim.h).
+    ConfigSet("SimulateFrequency",ROBOTSIM_Parameters.Frequency);
+    ConfigSet("SimulatePriority",ROBOTSIM_Parameters.Priority);
+    ConfigSet("SimulateMass",ROBOTSIM_Parameters.Mass);
+    ConfigSet("SimulateDamping",ROBOTSIM_Parameters.Damping);
+    ConfigSet("SimulateSubjectStiffness",ROBOTSIM_Parameters.SubjectStiffness);
+    ConfigSet("SimulateSubjectDamping",ROBOTSIM_Parameters.SubjectDamping);
+    ConfigSet("SimulateSubjectNoise",ROBOTSIM_Parameters.SubjectNoise);
+    ConfigSet("SimulateSubjectMoveTime",ROBOTSIM_Parameters.SubjectMoveTime);
+    ConfigSet("SimulateSubjectReactionTime",ROBOTSIM_Parameters.SubjectReactionTime);
+    ConfigSet("SimulateSeed",ROBOTSIM_Parameters.Seed);
+#endif
+    ConfigSetBOOL(VAR(ColumnCompress));
+    ConfigSet(VAR(ForceMax));
+    ConfigSet("GraphicsSyncTime",GraphicsVerticalRetraceSyncTime);
+    ConfigSet("GraphicsCatchTime",GraphicsVerticalRetraceCatchTime);
+    ConfigSet(VAR(GraphicsIdlePeriod));
+    ConfigSet(VAR(GraphicsIdleSpinTime));
+    ConfigSetBOOL(VAR(GraphicsSceneListFlag));
+    ConfigSet(VAR(TextPosition));
+    ConfigSet("CursorColor",CursorColorText);
+    ConfigSet(VAR(CursorRadius));
+    ConfigSetBOOL(VAR(CursorPredictFlag));
+    ConfigSet(VAR(CursorPredictTime));
+    ConfigSetBOOL(VAR(CursorPredictAcceleration));
+    ConfigSet(VAR(CursorAccelerationTime));
+    ConfigSet(VAR(MovementFirstDistance));
+    ConfigSet(VAR(MovementSecondDistance));
+    ConfigSet("TargetColor",TargetColorText);
+    ConfigSet(VAR(TargetRadius));
+    ConfigSet(VAR(TargetOutlineWidth));
+    ConfigSet(VAR(ViaRadius));
+    ConfigSet(VAR(ViaHeight));
+    ConfigSet(VAR(ViaWidth));
+    ConfigSet(VAR(ViaEntryAngle));
+    ConfigSet(VAR(ViaPosition));
+    ConfigSet(VAR(MovedTooFarDistance));
+    ConfigSet(VAR(MissedViaPointDistance));
+    ConfigSet(VAR(StartRadius));
+    ConfigSet(VAR(StartTolerance));
+    ConfigSet(VAR(FinishTolerance));
+    ConfigSet(VAR(FinishToleranceTime));
+    ConfigSet(VAR(ViaToleranceTime));
+    ConfigSet(VAR(ViaNotMovingSpeed));
+    ConfigSet(VAR(ViaTimeOutTime));
+    ConfigSet(VAR(PostMoveDelayInit));
+    ConfigSet("MovementType",MovementTypeString);
+    ConfigSet(VAR(MovementReactionTimeOut));
+    ConfigSet(VAR(MovementDurationTimeOut));
+    ConfigSet(VAR(MovementDurationTooFast));
+    ConfigSet(VAR(MovementDurationTooSlow)); 
+    ConfigSet(VAR(PMoveMovementTime)); 
+
+    ConfigSet(VAR(MovementFirstTooFast)); 
+    ConfigSet(VAR(MovementFirstTooSlow)); 
+    ConfigSet(VAR(MovementSecondTooFast)); 
+    ConfigSet(VAR(MovementSecondTooSlow)); 
+
+    ConfigSet(VAR(ErrorWait));
+    ConfigSet(VAR(TrialDelay));
+    ConfigSet(VAR(TrialDelayMax));
+    ConfigSet(VAR(TrialDelayOffset));
+    ConfigSet(VAR(TrialDelayLambda));
+    ConfigSet(VAR(InterTrialDelay));
+    ConfigSet(VAR(FeedbackTime));
+    ConfigSet(VAR(NotMovingSpeed));
+    ConfigSet(VAR(NotMovingTime));
+    ConfigSet(VAR(ForceFieldRampTime));
+    ConfigSet(VAR(ChannelWidthRampTime));
+    ConfigSet(VAR(ChannelWidthInitial));
+
+    ConfigSetBOOL(VAR(RestBreakHere));
+    ConfigSet(VAR(RestBreakTrials),RESTBREAK_MAX);
+    ConfigSet(VAR(RestBreakSeconds));
+
+    ConfigSet(VAR(Trials));	
 
     for( i=0; (i < FIELD_INDEX); i++ )
     {
-        CONFIG_label(STR_stringf("FieldType%d",i),FieldIndexType[i]);
-        CONFIG_set("FieldConstants",FieldIndexConstants[i],FIELD_CONSTANTS);
-        CONFIG_set("FieldAngle",FieldIndexAngle[i]);
-        CONFIG_set("FieldContextType",FieldIndexContextType[i]);
-        CONFIG_set("FieldContextConstants",FieldIndexContextConstants[i],FIELD_CONSTANTS);
+        ConfigLabel(STR_stringf("FieldType%d",i),FieldIndexType[i]);
+        ConfigSet("FieldConstants",FieldIndexConstants[i],FIELD_CONSTANTS);
+        ConfigSet("FieldAngle",FieldIndexAngle[i]);
+        ConfigSet("FieldContextType",FieldIndexContextType[i]);
+        ConfigSet("FieldContextConstants",FieldIndexContextConstants[i],FIELD_CONSTANTS);
     }
 
     for( i=0; (i < PHASE_MAX); i++ )
     {
-        CONFIG_label(STR_stringf("PhaseTrials%d",i),PhaseTrialRange[i],2);
-        CONFIG_set("FieldIndex",PhaseFieldIndex[i],FIELD_INDEX);
-        CONFIG_setBOOL("FieldPermute",PhaseFieldPermute[i]);
+        ConfigLabel(STR_stringf("PhaseTrials%d",i),PhaseTrialRange[i],2);
+        ConfigSet("FieldIndex",PhaseFieldIndex[i],FIELD_INDEX);
+        ConfigSetBOOL("FieldPermute",PhaseFieldPermute[i]);
     }
+
+    // Worked out from the configuration (or when the trial list is made).
+    ConfigCache.Add(CursorColor);
+    ConfigCache.Add(TargetColor);
+    ConfigCache.Add(MovementType);
+    ConfigCache.Add(ViaType);
+    ConfigCache.Add(PhaseCount);
+    ConfigCache.Add(PhaseFieldIndexCount,PHASE_MAX);
+    ConfigCache.Add(RestBreakCount);
+    ConfigCache.Add(TotalTrials);
+    ConfigCache.Add(PhaseIndex);
+    ConfigCache.Add(FieldTrials,FIELD_MAX);
+    ConfigCache.Add(FieldIndexTrialCount,FIELD_INDEX);
 }
 
 /******************************************************************************/
@@ -649,72 +909,101 @@ BOOL ok=TRUE;
 
 /******************************************************************************/
 
-void GraphicsDisplayText( char *string, float size, matrix &pos )
+void GraphicsText( char *text )
 {
-static matrix p;
-void *font=GLUT_STROKE_MONO_ROMAN;
-int i,w;
-//float s=size*0.015;
-float s=size*0.01;
-
-
-    p = pos;
-    w = strlen(string);
+    if( text != NULL )
+    {
+        strncpy(GraphicsString,text,STRLEN);
+    }
+}
 
-    p(1,1) -= (w / 2) * (s * 100.0);
-  
-    glPushMatrix();
+/******************************************************************************/
 
-    glLineWidth(2.0);
-    translate(p);
-    glScalef(s,s,1);
+void FrameProcess( void )
+{
+    // Is frame recording in progres.
+    if( !FrameRecord )
+    {
+        return;
+    }
 
-    GRAPHICS_ColorSet(WHITE);
+    // Load GRAPHICS-related frame data variables.
+    GRAPHICS_FrameData();
 
-    for( i=0; (i < w); i++ )
-        glutStrokeCharacter(font,string[i]);
+    // Save current variables (FrameData is filled from them by TrialWrite).
+    FrameGraphics.RowSave();
+    FrameColumns.RowSave();
 
-    glPopMatrix();
+    // Save slowly-changing variables that are due.
+    FrameStreams.RowSave(TrialTime);
 }
 
 /******************************************************************************/
 
-void GraphicsDisplayText( void )
+// Worst-case duration (sec) of frame recording, from TrialStart() to
+// TrialStop(), given the timeouts and delays for the current trial.
+
+double FrameDataTrialDuration( void )
 {
-static matrix P(3,1);
+double delay,duration;
+
+    // Delay period (or passive movement).
+    delay = TrialDelay;
 
-    if( !STR_null(GraphicsString) )
+    if( (TrialDelayLambda != 0.0) && (TrialDelayMax > delay) )
     {
-        P = TextPosition;
-	GraphicsDisplayText(GraphicsString,1.0,P);
+        delay = TrialDelayMax;
     }
-}
-
-/******************************************************************************/
 
-void GraphicsText( char *text )
-{
-    if( text != NULL )
+    if( (PMoveMovementTime+PMoveHoldTime+PMoveRampTime) > delay )
     {
-        strncpy(GraphicsString,text,STRLEN);
+        delay = PMoveMovementTime+PMoveHoldTime+PMoveRampTime;
     }
+
+    // Reaction time, movement (including via-point) and post-movement delay,
+    // which is the mean movement time less the actual one (each within the
+    // movement duration timeout).
+    duration = delay + MovementReactionTimeOut + (2.0 * MovementDurationTimeOut);
+    duration += FinishToleranceTime + ViaToleranceTime + ViaTimeOutTime;
+
+    return(duration + FRAMEDATA_MARGIN);
 }
 
 /******************************************************************************/
 
-void FrameProcess( void )
+// Make sure FrameData has enough rows for the worst-case duration of the next
+// trial. Rows are only ever added (in chunks) between trials, so no memory is
+// allocated while frame data is being recorded.
+
+void FrameDataSize( void )
 {
-    // Is frame recording in progres.
-    if( !FrameRecord )
+int rows;
+
+    if( LoopTaskFrequency <= 0.0 )
     {
         return;
     }
 
-    // Load GRAPHICS-related frame data variables.
-    GRAPHICS_FrameData();
+    rows = (int)ceil(FrameDataTrialDuration() * LoopTaskFrequency);
+    rows = FRAMEDATA_CHUNK * (((rows + FRAMEDATA_CHUNK - 1) / FRAMEDATA_CHUNK) + FrameDataExtraChunks);
+
+    if( rows < FRAMEDATA_ROWS )
+    {
+        rows = FRAMEDATA_ROWS;
+    }
+
+    FrameStreams.SetDuration((double)rows/LoopTaskFrequency,LoopTaskFrequency);
+
+    if( rows <= FrameDataRows )
+    {
+        return;
+    }
 
-    // Save current variables for FrameData.
-    FrameData.RowSave();
+    FrameData.SetRows(rows);
+    FrameGraphics.SetRows(rows);
+    FrameColumns.SetRows(rows);
+    printf("FrameData: %d rows (%.1lf seconds at %.0lf Hz).\n",rows,(double)rows/LoopTaskFrequency,LoopTaskFrequency);
+    FrameDataRows = rows;
 }
 
 /******************************************************************************/
@@ -722,7 +1011,9 @@ void FrameProcess( void )
 void FrameStart( void )
 {
     // Start recording frame data.
-    FrameData.Reset();
+    FrameGraphics.Reset();
+    FrameColumns.Reset();
+    FrameStreams.Reset();
     FrameRecord = TRUE;
 }
 
@@ -736,6 +1027,29 @@ void FrameStop( void )
 
 /******************************************************************************/
 
+// Fill FrameData (for DATAFILE) from the rows recorded in FrameColumns, so
+// the forces function only saves each row once. A row is stored into the
+// copies of the frame variables and the GRAPHICS variables are loaded for it
+// from FrameGraphics. The GRAPHICS variables belong to the MOTOR library, so
+// this is done by TrialSave() on the graphics thread after FrameStop(), not
+// by the trial writer thread, which only reads FrameData.
+
+void FrameDataFill( void )
+{
+int row;
+
+    FrameData.Reset();
+
+    for( row=0; (row < FrameColumns.GetRow()); row++ )
+    {
+        FrameShadow.RowStore(FrameColumns,row);
+        FrameGraphics.RowLoad(row+1);
+        FrameData.RowSave();
+    }
+}
+
+/******************************************************************************/
+
 BOOL RestBreakNow( void )
 {
 BOOL flag=FALSE;
@@ -749,6 +1063,13 @@ BOOL flag=FALSE;
         RestBreakMinutesPerTrial = ExperimentTimer.ElapsedMinutes() / (double)Trial;
         RestBreakMinutesRemaining = RestBreakMinutesPerTrial * (double)(TotalTrials-Trial);
         printf("RestBreak=%d/%d, Time=%.0lf(sec), Trial=%d/%d (%.0lf%% done, %.1f minutes remaining)\n",RestBreakIndex,RestBreakCount,RestBreakSeconds,Trial,TotalTrials,RestBreakTrialsPercent,RestBreakMinutesRemaining);
+
+        // Make sure trials so far are on disk.
+        TRIALWRITER_Flush();
+
+        // Loop timing (usec) for each state since the last rest break.
+        LoopHistSession.Print(stdout);
+        LoopHistSession.Reset();
     }
 
     return(flag);
@@ -760,7 +1081,7 @@ void StateProcessLoopTask( void );
 
 /******************************************************************************/
 
-void RobotPMoveUpdate( matrix &F )
+void RobotPMoveUpdate( VEC3 &F )
 {
     PMovePosition(1,1) = RobotPosition(1,1);
     PMovePosition(2,1) = RobotPosition(2,1);
@@ -774,9 +1095,9 @@ void RobotPMoveUpdate( matrix &F )
 
     if( RobotPMove.Update(PMovePosition,PMoveVelocity,PMoveForces) )
     {
-        F(1,1) = PMoveForces(1,1);
-        F(2,1) = PMoveForces(2,1);
-        F(3,1) = 0.0;
+        F(1) = PMoveForces(1,1);
+        F(2) = PMoveForces(2,1);
+        F(3) = 0.0;
     }
 
     RobotPMove.CurrentState(PMoveState,PMoveStateTime,PMoveStateRampValue,PMoveStatePosition);
@@ -797,7 +1118,7 @@ BOOL ok;
     PMoveEndPosition(3,1) = 0.0;
 
     ok = RobotPMove.Start(PMoveStartPosition,PMoveEndPosition);
-    printf("RobotPMove.Start(...) %s.\n",STR_OkFailed(ok));
+    LOOPLOG_printf("RobotPMove.Start(...) %s.\n",STR_OkFailed(ok));
 
    // GraphicsText("Relax Arm");
 }
@@ -838,9 +1159,219 @@ matrix SC(3,1),PT(3,1),VT(3,1);
 
 /******************************************************************************/
 
+// Force-field policies, one for each field type. Forces() sets the force-field
+// forces (F is zero on entry) for the current position and velocity.
+
+template<int TYPE> struct FIELD_POLICY
+{
+    static inline void Forces( const ROBOTFIELD *field, const VEC3 &X, const VEC3 &V, VEC3 &F )
+    {
+    }
+};
+
+template<> struct FIELD_POLICY<FIELD_VISCOUS>
+{
+    static inline void Forces( const ROBOTFIELD *field, const VEC3 &X, const VEC3 &V, VEC3 &F )
+    {
+        F = field->Constants[0] * (field->Matrix * V);
+    }
+};
+
+template<> struct FIELD_POLICY<FIELD_CHANNEL>
+{
+    static inline void Forces( const ROBOTFIELD *field, const VEC3 &X, const VEC3 &V, VEC3 &F )
+    {
+    VEC3 P,V1;
+    double d;
+
+        // Next rotate position along the channel between the home position and the via point.
+
+        ChannelWidth = field->ChannelWidthInitial * field->ChannelWidthRamp->RampCurrent();
+
+        P = field->R * (X - field->Position);
+        V1 = field->R * V;
+
+        d = 0.0;
+        if( abs(P(1)) >= ChannelWidth )
+        {
+            d = sgn(P(1)) * (abs(P(1)) - ChannelWidth);
+        }
+
+        // Calculate perpendicular (X) channel forces.
+        if( d != 0.0 )
+        {
+            F(1) = (field->Constants[0] * d) + (field->Constants[1] * V1(1));
+        }
+
+        // Rotate back to original.
+        F = field->_R * F;
+    }
+};
+
+template<> struct FIELD_POLICY<FIELD_PMOVE>
+{
+    static inline void Forces( const ROBOTFIELD *field, const VEC3 &X, const VEC3 &V, VEC3 &F )
+    {
+        RobotPMoveUpdate(F);
+    }
+};
+
+template<> struct FIELD_POLICY<FIELD_2DSPRING>
+{
+    static inline void Forces( const ROBOTFIELD *field, const VEC3 &X, const VEC3 &V, VEC3 &F )
+    {
+        // Constrain movement to (x,y) = (0,0) with a virtual spring.
+        F = (field->Constants[0] * (X - field->Position)) + (field->Constants[1] * V);
+    }
+};
+
+/******************************************************************************/
+
+// Via-point check policies.
+
+template<int CHECK> struct VIA_POLICY
+{
+    static inline void Check( const ROBOTFIELD *field, const VEC3 &X )
+    {
+    }
+};
+
+template<> struct VIA_POLICY<VIA_CHECK_MISSED>
+{
+    static inline void Check( const ROBOTFIELD *field, const VEC3 &X )
+    {
+    VEC3 P1;
+
+        // Movement to peripheral target; have we missed central target?
+        P1 = field->ViaR * (X - field->ViaPosition);
+
+        if( P1(2) >= field->ViaDistance )
+        {
+            MissedViaPointFlag = TRUE;
+        }
+    }
+};
+
+template<> struct VIA_POLICY<VIA_CHECK_TOOFAR>
+{
+    static inline void Check( const ROBOTFIELD *field, const VEC3 &X )
+    {
+    VEC3 P1;
+
+        // Movement to central target only; have we moved too far?
+        P1 = field->ViaR * (X - field->ViaPosition);
+
+        if( P1(2) >= field->ViaDistance )
+        {
+            MovedTooFarFlag = TRUE;
+        }
+    }
+};
+
+/******************************************************************************/
+
+template<int TYPE,int CHECK> void RobotFieldKernel( const ROBOTFIELD *field, const VEC3 &X, const VEC3 &V, VEC3 &F )
+{
+    FIELD_POLICY<TYPE>::Forces(field,X,V,F);
+    VIA_POLICY<CHECK>::Check(field,X);
+}
+
+// Kernel for each field type and via-point check. A new field type needs a
+// FIELD_POLICY specialization and a row here.
+ROBOTFIELD_KERNEL RobotFieldKernelTable[FIELD_MAX][VIA_CHECK_MAX] =
+{
+    { RobotFieldKernel<FIELD_NONE,VIA_CHECK_NONE>,     RobotFieldKernel<FIELD_NONE,VIA_CHECK_MISSED>,     RobotFieldKernel<FIELD_NONE,VIA_CHECK_TOOFAR>     },
+    { RobotFieldKernel<FIELD_VISCOUS,VIA_CHECK_NONE>,  RobotFieldKernel<FIELD_VISCOUS,VIA_CHECK_MISSED>,  RobotFieldKernel<FIELD_VISCOUS,VIA_CHECK_TOOFAR>  },
+    { RobotFieldKernel<FIELD_CHANNEL,VIA_CHECK_NONE>,  RobotFieldKernel<FIELD_CHANNEL,VIA_CHECK_MISSED>,  RobotFieldKernel<FIELD_CHANNEL,VIA_CHECK_TOOFAR>  },
+    { RobotFieldKernel<FIELD_PMOVE,VIA_CHECK_NONE>,    RobotFieldKernel<FIELD_PMOVE,VIA_CHECK_MISSED>,    RobotFieldKernel<FIELD_PMOVE,VIA_CHECK_TOOFAR>    },
+    { RobotFieldKernel<FIELD_2DSPRING,VIA_CHECK_NONE>, RobotFieldKernel<FIELD_2DSPRING,VIA_CHECK_MISSED>, RobotFieldKernel<FIELD_2DSPRING,VIA_CHECK_TOOFAR> },
+    { RobotFieldKernel<FIELD_NONE,VIA_CHECK_NONE>,     RobotFieldKernel<FIELD_NONE,VIA_CHECK_MISSED>,     RobotFieldKernel<FIELD_NONE,VIA_CHECK_TOOFAR>     },  // FIELD_SAMEASLAST
+};
+
+/******************************************************************************/
+
+// Forces function only.
+
+void RobotFieldCompile( void )
+{
+ROBOTFIELD *field;
+MAT3 M;
+double angle;
+int i;
+
+    // Build the field in the object not currently used by the forces function.
+    field = (RobotField.load(std::memory_order_relaxed) == &RobotFieldList[0]) ? &RobotFieldList[1] : &RobotFieldList[0];
+
+    field->Type = RobotFieldType;
+
+    for( i=0; (i < FIELD_CONSTANTS); i++ )
+    {
+        field->Constants[i] = RobotFieldConstants[i];
+    }
+
+    MAT3_romxZ(D2R(RobotFieldAngle),field->Matrix);
+
+    field->Position = ForceFieldPosition;
+
+    // Channel is rotated along the symmetry axis (or towards the target for single movements).
+    angle = SymmetryAxisAngle - ForceFieldAngle;
+
+    if( MovementOrderType == ORDER_SINGLE_MOVEMENT )
+    {
+        angle += TargetAngle;
+    }
+
+    MAT3_romxZ(D2R(angle),field->R);
+    MAT3_romxZ(D2R(-angle),field->_R);
+
+    // Force-compensation index compares the channel force with this viscous field.
+    MAT3_romxZ(D2R(CompensationAngle),M);
+
+    for( i=1; (i <= 3); i++ )
+    {
+        field->ChannelAxis(i) = field->R(1,i);
+        field->IdealAxis(i) = CompensationViscosity * ((field->R(1,1) * M(1,i)) + (field->R(1,2) * M(2,i)) + (field->R(1,3) * M(3,i)));
+    }
+
+    field->ChannelWidthRamp = &ChannelWidthRamp;
+    field->ChannelWidthInitial = ChannelWidthInitial;
+
+    // Missed via-point (full movement) or moved too far (central target only) checks.
+    field->ViaDistance = ContextFullMovementFlag[ContextType] ? MissedViaPointDistance : MovedTooFarDistance;
+    field->ViaCheck = VIA_CHECK_NONE;
+
+    if( (FieldType != FIELD_PMOVE) && (field->ViaDistance != 0.0) )
+    {
+        field->ViaCheck = ContextFullMovementFlag[ContextType] ? VIA_CHECK_MISSED : VIA_CHECK_TOOFAR;
+    }
+
+    MAT3_romxZ(D2R(SymmetryAxisAngle),field->ViaR);
+    field->ViaPosition = VEC3_get(ViaPosition);
+
+    // Select kernel for field type and via-point check.
+    field->Kernel = RobotFieldKernelTable[field->Type][field->ViaCheck];
+
+    // Hand the new field to the forces function.
+    RobotField.store(field,std::memory_order_release);
+}
+
+/******************************************************************************/
+
+// Compile the force-field at the next tick (graphics thread, after the
+// variables it is compiled from have been set).
+
+void RobotFieldRequest( void )
+{
+    RobotFieldCompileFlag.store(true,std::memory_order_release);
+}
+
+/******************************************************************************/
+
+// Forces function only (it reads the robot position and compiles the field).
+
 void ForceFieldStart( void )
 {
-static matrix D(3,1);
+static VEC3 D;
 
     if( ForceFieldStarted )
     {
@@ -864,33 +1395,48 @@ static matrix D(3,1);
     {
         if( (RobotFieldType == FIELD_CHANNEL) && (ChannelOrderType == CHANNEL_SECOND) )
         {
-            ForceFieldPosition = RobotPosition;
-            D = ForceFieldPosition - FinishPosition;
-            ForceFieldAngle = R2D(atan2(D(1,1),-D(2,1)));
+            ForceFieldPosition = VEC3_get(RobotPosition);
+            D = ForceFieldPosition - VEC3_get(FinishPosition);
+            ForceFieldAngle = R2D(atan2(D(1),-D(2)));
             //printf("ForceFieldAngle=%.1lf(deg)\n",ForceFieldAngle);
             ChannelWidthRamp.Down();
        }
         else
         {
-            ForceFieldPosition = RobotPosition;
+            ForceFieldPosition = VEC3_get(RobotPosition);
         }
 
+        // Force-field position and angle have changed.
+        RobotFieldCompile();
+
         ForceFieldRamp.Up();
     }
 }
 
 /******************************************************************************/
 
+// Start the force-field at the next tick (graphics thread).
+
+void ForceFieldRequest( void )
+{
+    ForceFieldStartFlag.store(true,std::memory_order_release);
+}
+
+/******************************************************************************/
+
 void ForceFieldStop( void )
 {
-    printf("\nForceFieldStop: ContextType=%d,PassiveWaitLastFlag=%d,FieldType=%d,\n",ContextType,PassiveWaitLastFlag,FieldType);
+    LOOPLOG_printf("\nForceFieldStop: ContextType=%d,PassiveWaitLastFlag=%d,FieldType=%d,\n",ContextType,PassiveWaitLastFlag,FieldType);
 
     if( ((ContextType == PASSIVE_WAIT) && !PassiveWaitLastFlag) || (FieldType == FIELD_SAMEASLAST) )
     {
         return;
     }
 
-    printf("ForceFieldStop: DONE!\n\n");
+    // Cancel a start the forces function hasn't made yet.
+    ForceFieldStartFlag.store(false,std::memory_order_relaxed);
+
+    LOOPLOG_printf("ForceFieldStop: DONE!\n\n");
 
     if( ForceFieldStarted )
     {
@@ -901,163 +1447,159 @@ void ForceFieldStop( void )
 
 /******************************************************************************/
 
-void RobotForcesFunction( matrix &position, matrix &velocity, matrix &forces )
-{
-static int i,j;
-static matrix P,V,R,_R;
-static matrix P1,V1,R1,_R1;
-static double d, dx, dy, L;
+// Cursor position when the frame being drawn is on the screen. The frame is
+// drawn GraphicsVerticalRetraceSyncTime before the retrace and is on the
+// screen CursorPredictTime after that. Acceleration is estimated from the
+// change in velocity each tick (dt, in seconds) and low-pass filtered.
 
-    // Monitor timing of Forces Function (values saved to FrameData).
-    ForcesFunctionPeriod = RobotForcesFunctionFrequency.Loop();
-    RobotForcesFunctionLatency.Before();
+inline VEC3 CursorPredict( const VEC3 &X, const VEC3 &V, double dt )
+{
+double alpha,lead;
+VEC3 P;
 
-    TrialTime = TrialTimer.ElapsedSeconds();
-
-    // Kinematic data passed from robot API.
-    RobotPosition = position;
-    RobotVelocity = velocity;
-    RobotSpeed = norm(RobotVelocity);
+    // Not after a pause in the loop.
+    if( (dt > 0.0) && (dt < 0.1) )
+    {
+        alpha = dt / (CursorAccelerationTime + dt);
+        CursorAcceleration += alpha * (((1.0/dt) * (V - CursorVelocityLast)) - CursorAcceleration);
+    }
 
-    // Zero forces.
-    ForceFieldForces.zeros();
-    RobotForces.zeros();
+    CursorVelocityLast = V;
 
-   // Get Force/Torque sensor if required.
-    if( RobotFT && ROBOT_SensorOpened_DAQFT(RobotID) )
+    if( !CursorPredictFlag )
     {
-        ROBOT_SensorRead(RobotID);
-        ROBOT_Sensor_DAQFT(RobotID,HandleForces,HandleTorques);
+        return(X);
     }
 
-    P = RobotPosition;
-    CursorPosition = RobotPosition;
+    lead = GraphicsVerticalRetraceSyncTime + CursorPredictTime;
+    P = X + (lead * V);
 
-    // Process force-field type.
-    //switch( ForceFieldStarted ? RobotFieldType : FIELD_NONE )
-    switch( RobotFieldType )
+    if( CursorPredictAcceleration )
     {
-        case FIELD_NONE :
-           break;
+        P += (0.5 * lead * lead) * CursorAcceleration;
+    }
 
-        case FIELD_VISCOUS :   // Viscous force field.
-           ForceFieldForces = RobotFieldConstants[0] * RobotFieldMatrix * RobotVelocity;
-           break;
+    return(P);
+}
 
-        case FIELD_CHANNEL :
-           // Next rotate position along the channel between the home position and the via point.
+/******************************************************************************/
 
-           ChannelWidth = ChannelWidthInitial * ChannelWidthRamp.RampCurrent();
+// Add a tick to the force-compensation sums.
 
-           if( MovementOrderType == ORDER_SINGLE_MOVEMENT )
-           {
-               SPMX_romxZ(D2R(SymmetryAxisAngle+TargetAngle-ForceFieldAngle),R);
-               SPMX_romxZ(D2R(-(SymmetryAxisAngle+TargetAngle-ForceFieldAngle)),_R);
-           }
-           else
-           {
-               SPMX_romxZ(D2R(SymmetryAxisAngle-ForceFieldAngle),R);
-               SPMX_romxZ(D2R(-(SymmetryAxisAngle-ForceFieldAngle)),_R);
-           }
+inline void CompensationAdd( const ROBOTFIELD *field, const VEC3 &V, const VEC3 &F )
+{
+double channel,ideal;
 
-           P = R * (RobotPosition - ForceFieldPosition);
-           V = R * RobotVelocity;
+    channel = dot(field->ChannelAxis,F);
+    ideal = dot(field->IdealAxis,V);
 
-           d = 0.0;
-           if( abs(P(1,1)) >= ChannelWidth )
-           {
-               d = sgn(P(1,1)) * (abs(P(1,1)) - ChannelWidth);
-           }
- 
-           // Calculate perpendicular (X) channel forces.
-           if( d != 0.0 )
-           {
-               ForceFieldForces(1,1) = (RobotFieldConstants[0] * d) + (RobotFieldConstants[1] * V(1,1));
-           }
+    CompensationSum[0] += channel * channel;
+    CompensationSum[1] += channel * ideal;
+    CompensationSum[2] += ideal * ideal;
+    CompensationCount++;
+}
 
-           // Rotate back to original.
-           ForceFieldForces = _R * ForceFieldForces;
-           break;
+/******************************************************************************/
 
-        case FIELD_PMOVE :
-           RobotPMoveUpdate(ForceFieldForces);
-           break;
+void RobotForcesFunction( matrix &position, matrix &velocity, matrix &forces )
+{
+static VEC3 X,V,F,P;
+ROBOTFIELD *field;
+ROBOTSNAPSHOT *snapshot;
+int state=State;
 
-	case FIELD_2DSPRING :
-           // constrain movement to (x,y) = (0,0) with a virtual spring
+    // Monitor timing of Forces Function (values saved to FrameData).
+    ForcesFunctionPeriod = RobotForcesFunctionFrequency.Loop();
+    RobotForcesFunctionLatency.Before();
 
-           P = RobotPosition - ForceFieldPosition;
-           V = RobotVelocity;
-	   ForceFieldForces = (RobotFieldConstants[0] * P) + (RobotFieldConstants[1] * V);
-   	 
+    TrialTime = TrialTimer.ElapsedSeconds();
 
-	/*
-           dx = 0.0;
-           dy = 0.0;
-	   if( abs(P(1,1)) >= ChannelWidth )
-           {
-               dx = sgn(P(1,1)) * (abs(P(1,1)) - ChannelWidth);
-           }
- 	   
-	   if( abs(P(2,1)) >= ChannelWidth )
-           {
-               dy = sgn(P(2,1)) * (abs(P(2,1)) - ChannelWidth);
-           }
-           // Calculate perpendicular (X) channel forces.
-           if( dx != 0.0 )
-           {
-               ForceFieldForces(1,1) = (RobotFieldConstants[0] * dx) + (RobotFieldConstants[1] * V(1,1));
-           }
- 	   if( dy != 0.0 )
-           {
-               ForceFieldForces(2,1) = (RobotFieldConstants[0] * dy) + (RobotFieldConstants[1] * V(2,1));
-           }
+    // Kinematic data passed from robot API (fixed-size types avoid heap allocation).
+    X = VEC3_get(position);
+    V = VEC3_get(velocity);
+    RobotSpeed = norm(V);
 
-	*/
+    VEC3_put(RobotPosition,X);
+    VEC3_put(RobotVelocity,V);
 
-           break;
+    LoopRobot.RobotPosition = X;
+    LoopRobot.RobotVelocity = V;
+    LoopRobot.RobotSpeed = RobotSpeed;
+
+    // Zero forces.
+    ForceFieldForces.zeros();
 
+   // Get Force/Torque sensor if required.
+    if( RobotFT && ROBOT_SensorOpened_DAQFT(RobotID) )
+    {
+        ROBOT_SensorRead(RobotID);
+        ROBOT_Sensor_DAQFT(RobotID,HandleForces,HandleTorques);
     }
 
-    if (FieldType != FIELD_PMOVE)
+    VEC3_put(CursorPosition,X);
+
+    // Cursor drawn where the hand is expected to be (saved with the true position).
+    P = CursorPredict(X,V,ForcesFunctionPeriod/1000.0);
+    VEC3_put(CursorPredicted,P);
+
+    // Force-field compiled or started when asked by the graphics thread.
+    if( RobotFieldCompileFlag.exchange(false,std::memory_order_acquire) )
     {
-        SPMX_romxZ(D2R(SymmetryAxisAngle),R1);
-        P1 = R1 * (RobotPosition - ViaPosition);
-		
-        // Is it a full (two-part) movement via central target?
-        if( ContextFullMovementFlag[ContextType] )
-        {
-            // Movement to peripheral target; have we missed central target?
-            if( (P1(2,1) >= MissedViaPointDistance) && (MissedViaPointDistance != 0.0) )
-            {
-                MissedViaPointFlag = TRUE;
-            }
-        }
-        else
-        {
-            // Movement to central target only; have we moved too far?
-            if( (P1(2,1) >= MovedTooFarDistance) && (MovedTooFarDistance != 0.0) )
-            {
-                MovedTooFarFlag = TRUE;
-            }
-        }
+        RobotFieldCompile();
+    }
+
+    if( ForceFieldStartFlag.exchange(false,std::memory_order_acquire) )
+    {
+        ForceFieldStart();
     }
 
+    // Force-field compiled for this trial.
+    field = RobotField.load(std::memory_order_acquire);
+
+    // Force-field forces and via-point checks.
+    (*field->Kernel)(field,X,V,ForceFieldForces);
+
     // Process Finite State Machine.
     StateProcessLoopTask();
 
     // Monitor timing of Forces Function (values saved to FrameData).
     ForcesFunctionLatency = RobotForcesFunctionLatency.After();
 
+    // Timing histograms for loop task states (msec to usec).
+    if( StateLoopTask[state] )
+    {
+        LoopHistTrial.Add(state,ForcesFunctionLatency*1000.0,ForcesFunctionPeriod*1000.0);
+    }
+
     ForceFieldRampValue = ForceFieldRamp.RampCurrent();
-    RobotForces = (ForceFieldRampValue * ForceFieldForces);
+    F = ForceFieldRampValue * ForceFieldForces;
+    VEC3_put(RobotForces,F);
+
+    // Force-compensation sums (channel trials, during the movement).
+    if( (field->Type == FIELD_CHANNEL) && ForceFieldStarted && (state >= STATE_MOVING0) && (state <= STATE_MOVING1) )
+    {
+        CompensationAdd(field,V,F);
+    }
 
     // Save frame data.
+    StateFrame = State;
     FrameProcess();
 
+    // Publish robot state for the graphics thread (never blocks).
+    snapshot = &RobotSnapshot.Write();
+    snapshot->TrialTime = TrialTime;
+    snapshot->State = State;
+    snapshot->RobotPosition = X;
+    snapshot->RobotVelocity = V;
+    snapshot->RobotSpeed = RobotSpeed;
+    snapshot->CursorPosition = P;
+    snapshot->RobotForces = F;
+    snapshot->ForceFieldStarted = ForceFieldStarted;
+    RobotSnapshot.Publish();
+
     // Set forces to pass to robot API and clamp for safety.
-    forces = RobotForces;
-    forces.clampnorm(ForceMax);
+    F.clampnorm(ForceMax);
+    VEC3_put(forces,F);
 }
 
 /******************************************************************************/
@@ -1077,6 +1619,52 @@ void DeviceStop( void )
 
 /******************************************************************************/
 
+#ifdef ROBOT_SIMULATE
+void RobotSimulateSubject( void )
+{
+static int last=STATE_INITIALIZE;
+
+    // Called by the simulator each tick; the subject moves when the state changes.
+    if( State == last )
+    {
+        return;
+    }
+
+    last = State;
+
+    switch( State )
+    {
+        case STATE_SETUP :
+            // Passive trials move the arm, otherwise return to the start position.
+            if( FieldType == FIELD_PMOVE )
+            {
+                ROBOTSIM_SubjectRelax();
+                break;
+            }
+
+            ROBOTSIM_SubjectMove(StartPosition(1,1),StartPosition(2,1));
+            break;
+
+        case STATE_GO :
+            // Move to central target after a reaction time.
+            if( (FieldType == FIELD_PMOVE) || (ContextType == PASSIVE_WAIT) )
+            {
+                break;
+            }
+
+            ROBOTSIM_SubjectMove(ViaPosition(1,1),ViaPosition(2,1));
+            break;
+
+        case STATE_VIAPOINT :
+            // Stay in central target for a while and then move to peripheral target.
+            ROBOTSIM_SubjectMove(TargetPosition(1,1),TargetPosition(2,1),ViaToleranceTime+0.1,ROBOTSIM_Parameters.SubjectMoveTime);
+            break;
+    }
+}
+#endif
+
+/******************************************************************************/
+
 BOOL DeviceStart( void )
 {
 BOOL ok=TRUE;
@@ -1097,6 +1685,11 @@ BOOL ok=TRUE;
     // For some hideous reason the RAMPER object starts at 1.0; JNI to investigate.
     ForceFieldRamp.Zero();
 
+#ifdef ROBOT_SIMULATE
+    // Simulated subject follows the state machine.
+    ROBOTSIM_SubjectHook(RobotSimulateSubject);
+#endif
+
     // Open and start robot.
     if( (RobotID=ROBOT_Open(RobotName)) == ROBOT_INVALID )
     {
@@ -1171,14 +1764,14 @@ BOOL flag=FALSE;
 
 /******************************************************************************/
 
-BOOL RobotHomeRectangle(  matrix &home, double xwid, double yhgt )
+BOOL RobotHomeRectangle( const ROBOTSNAPSHOT &robot, matrix &home, double xwid, double yhgt )
 {
 BOOL flag=FALSE;
 double x,y;
 
     // Probably need to add an angle for rotated rectangle.
-    x = abs(RobotPosition(1,1) - home(1,1));
-    y = abs(RobotPosition(2,1) - home(2,1));
+    x = abs(robot.RobotPosition(1) - home(1,1));
+    y = abs(robot.RobotPosition(2) - home(2,1));
 
     flag = (x <= xwid) && (y <= yhgt);
 
@@ -1187,22 +1780,22 @@ double x,y;
 
 /******************************************************************************/
 
-double RobotDistance( matrix &home )
+double RobotDistance( const ROBOTSNAPSHOT &robot, matrix &home )
 {
 double distance;
 
-    distance = norm(RobotPosition-home);
+    distance = norm(robot.RobotPosition - VEC3_get(home));
 
     return(distance);
 }
 
 /******************************************************************************/
 
-BOOL RobotHome( matrix &home, double tolerance )
+BOOL RobotHome( const ROBOTSNAPSHOT &robot, matrix &home, double tolerance )
 {
 BOOL flag=FALSE;
 
-    if( RobotDistance(home) <= tolerance )
+    if( RobotDistance(robot,home) <= tolerance )
     {
         flag = TRUE;
     }
@@ -1212,29 +1805,29 @@ BOOL flag=FALSE;
 
 /******************************************************************************/
 
-BOOL RobotHome( void )
+BOOL RobotHome( const ROBOTSNAPSHOT &robot )
 {
 BOOL flag;
 
-    flag = RobotHome(StartPosition,StartTolerance);
+    flag = RobotHome(robot,StartPosition,StartTolerance);
 
     return(flag);
 }
 
 /******************************************************************************/
 
-BOOL RobotInsideVia( void )
+BOOL RobotInsideVia( const ROBOTSNAPSHOT &robot )
 {
 BOOL flag=FALSE;
 
     switch( ViaType )
     {
         case VIA_CIRCLE :
-            flag = RobotHome(ViaPosition,ViaRadius);
+            flag = RobotHome(robot,ViaPosition,ViaRadius);
             break;
 
         case VIA_RECTANGLE :
-            flag = RobotHomeRectangle(ViaPosition,ViaWidth,ViaHeight);
+            flag = RobotHomeRectangle(robot,ViaPosition,ViaWidth,ViaHeight);
             break;
     }
 
@@ -1243,18 +1836,18 @@ BOOL flag=FALSE;
 
 /******************************************************************************/
 
-BOOL MovementStarted( void )
+BOOL MovementStarted( const ROBOTSNAPSHOT &robot )
 {
 BOOL flag;
 
-    flag = !RobotHome(StartPosition,StartTolerance);
+    flag = !RobotHome(robot,StartPosition,StartTolerance);
 
     return(flag);
 }
 
 /******************************************************************************/
 
-BOOL MovementFinished( void )
+BOOL MovementFinished( const ROBOTSNAPSHOT &robot )
 {
 BOOL flag=FALSE;
 
@@ -1265,7 +1858,7 @@ BOOL flag=FALSE;
     }
 
     // Is robot in the finish position?
-    if( !RobotHome(FinishPosition,FinishTolerance) )
+    if( !RobotHome(robot,FinishPosition,FinishTolerance) )
     {
         MovementFinishedTimer.Reset();    
     }
@@ -1281,7 +1874,7 @@ BOOL flag=FALSE;
 
 /******************************************************************************/
 
-BOOL RobotNotMoving( void )
+BOOL RobotNotMoving( const ROBOTSNAPSHOT &robot )
 {
 BOOL flag;
 
@@ -1290,7 +1883,7 @@ BOOL flag;
         return(TRUE);
     }
 
-    if( RobotSpeed > NotMovingSpeed )
+    if( robot.RobotSpeed > NotMovingSpeed )
     {
         NotMovingTimer.Reset();
     }
@@ -1309,10 +1902,11 @@ void StateNext( int state )
         return;
     }
 
-    printf("STATE: %s[%d] > %s[%d] (%.0lf msec).\n",StateText[State],State,StateText[state],state,StateTimer.Elapsed());
+    StateLast = State;
+
+    LOOPLOG_printf("STATE: %s[%d] > %s[%d] (%.0lf msec).\n",StateText[StateLast],StateLast,StateText[state],state,StateTimer.Elapsed());
     StateTimer.Reset();
     StateFirstFlag = TRUE;
-    StateLast = State;
     State = state;
 }
 
@@ -1355,6 +1949,9 @@ void TrialSetup( void )
 {
 int i;
 
+    // Previous trial must be written before its data is changed.
+    TRIALWRITER_Flush();
+
     // Load trial variables from TrialData.
     TrialData.RowLoad(Trial);
 
@@ -1373,14 +1970,26 @@ int i;
         }
 
         RobotFieldAngle = FieldAngle;
-        SPMX_romxZ(D2R(RobotFieldAngle),RobotFieldMatrix);
     }
 
+    // Channel trials are compared with the last viscous field.
+    if( RobotFieldType == FIELD_VISCOUS )
+    {
+        CompensationViscosity = RobotFieldConstants[0];
+        CompensationAngle = RobotFieldAngle;
+    }
+
+    // Compile force-field for the forces function.
+    RobotFieldRequest();
+
     ViaEntryPosition(1,1) = ViaRadius * sin(D2R(ViaEntryAngle));
     ViaEntryPosition(2,1) = -ViaRadius * cos(D2R(ViaEntryAngle));
 
     TrialRunning = FALSE;
 
+    // Make sure there is room for the frame data of this trial.
+    FrameDataSize();
+
     StateGraphicsNext(State);
 
     printf("TrialSetup: Trial=%d FieldType=%d ContextType=%d MoveOrderType=%d\n",Trial,FieldType,ContextType,MovementOrderType);
@@ -1388,6 +1997,43 @@ int i;
 
 /******************************************************************************/
 
+void CompensationStart( void )
+{
+int i;
+
+    for( i=0; (i < 3); i++ )
+    {
+        CompensationSum[i] = 0.0;
+    }
+
+    CompensationCount = 0;
+    CompensationIndex = 0.0;
+    CompensationR2 = 0.0;
+}
+
+/******************************************************************************/
+
+void CompensationStop( void )
+{
+    // Slope and R-squared of channel force against ideal force (through zero).
+    if( CompensationSum[2] > 0.0 )
+    {
+        CompensationIndex = CompensationSum[1] / CompensationSum[2];
+    }
+
+    if( (CompensationSum[0] * CompensationSum[2]) > 0.0 )
+    {
+        CompensationR2 = (CompensationSum[1] * CompensationSum[1]) / (CompensationSum[0] * CompensationSum[2]);
+    }
+
+    if( CompensationCount > 0 )
+    {
+        printf("CompensationIndex=%.3lf R2=%.3lf (%d samples, viscous field %.2lf at %.1lf deg).\n",CompensationIndex,CompensationR2,CompensationCount,CompensationViscosity,CompensationAngle);
+    }
+}
+
+/******************************************************************************/
+
 void TrialStart( void )
 {
     printf("Starting Trial %d...\n",Trial);
@@ -1398,6 +2044,9 @@ void TrialStart( void )
     TrialTimer.Reset();
     TrialTime = TrialTimer.ElapsedSeconds();
     TrialRunning = TRUE;
+    LoopHistTrial.Reset();
+    FrameDataTruncated = FALSE;
+    CompensationStart();
 
     MovedTooFarFlag = FALSE;
     MissedViaPointFlag = FALSE; 
@@ -1407,7 +2056,7 @@ void TrialStart( void )
     // Start force-field if the channel/field is on the first movement (or PMove).
     if( (ChannelOrderType == CHANNEL_FIRST) || (FieldType == FIELD_PMOVE) )
     {
-        ForceFieldStart();
+        ForceFieldRequest();
     }
 
     // Start recording frame data for trial.
@@ -1429,6 +2078,8 @@ void TrialStop( void )
 
     TrialDuration = TrialTimer.ElapsedSeconds();
     InterTrialDelayTimer.Reset();
+
+    CompensationStop();
 }
 
 /******************************************************************************/
@@ -1436,7 +2087,7 @@ void TrialStop( void )
 void TrialAbort( void )
 {
     TrialRunning = FALSE;
-    printf("Aborting Trial %d...\n",Trial);
+    LOOPLOG_printf("Aborting Trial %d...\n",Trial);
 
     // Stop recording frame data for trial.
     FrameStop();
@@ -1447,152 +2098,496 @@ void TrialAbort( void )
 
 /******************************************************************************/
 
-BOOL TrialSave( void )
+void ContextFullMovementTime( double time )
 {
-BOOL ok=FALSE;
-int i;
+    ContextFullMovementTimeData.Data(time);
 
-    ExperimentTime = ExperimentTimer.ElapsedSeconds();
-    MissTrials = MissTrialsTotal;
-    for( i=0; (i < MISS_TRIAL_TYPES); i++ )
+    // Kept for the journal, so a resumed session has the same mean.
+    if( JournalTimeCount < RECORD_TIMES )
     {
-        MissTrialsType[i] = MissTrialsTypeTotal[i];
+        JournalTime[JournalTimeCount++] = time;
     }
+}
 
-    // Put values in the trial data
-    TrialData.RowSave(Trial);
+/******************************************************************************/
+
+// Hash of things that must be the same to resume a session from the journal.
+
+uint32_t JournalHash( void )
+{
+uint32_t hash=JOURNAL_HASH;
+int i,width;
 
-    // Set-up the data file on the first trial.
-    if( Trial == 1 )
+    // Contents as well as names, so an edited configuration isn't resumed.
+    for( i=0; (i < ConfigFileCount); i++ )
     {
-        // Open the file for trial data.
-        if( !DATAFILE_Open(DataFile,TrialData,FrameData) )
-        {
-            printf("DATAFILE: Cannot open file: %s\n",DataFile);
-            return(FALSE);
-        }
+        hash = JOURNAL_Hash(ConfigFileList[i],strlen(ConfigFileList[i]),hash);
+        CFGCACHE_FileHash(ConfigFileList[i],hash);
     }
 
-    // Write the trial data to the file.
-    printf("Saving trial %d: %d frames of data collected in %.2lf seconds.\n",Trial,FrameData.GetRow(),TrialDuration);
-    ok = DATAFILE_TrialSave(Trial);
-    printf("%s %s Trial=%d.\n",DataFile,STR_OkFailed(ok),Trial);
+    for( i=0; (i < TrialColumns.GetColumns()); i++ )
+    {
+        width = TrialColumns.GetColumnWidth(i);
+        hash = JOURNAL_Hash(TrialColumns.GetColumnName(i),strlen(TrialColumns.GetColumnName(i)),hash);
+        hash = JOURNAL_Hash(&width,sizeof(width),hash);
+    }
 
-    return(ok);
+    hash = JOURNAL_Hash(&Trials,sizeof(Trials),hash);
+
+    return(hash);
 }
 
 /******************************************************************************/
 
-void TrialExit( void )
+// Start a new journal with the trial list (the random choices are all made
+// when the list is created, so the list itself is saved).
+
+BOOL JournalStart( void )
 {
-    // Close the data file if it has been opened.
-    if( DATAFILE_Opened() )
-    {
-        if( !DATAFILE_Close() )
-        {
-            printf("Please resolve problems with data file: %s\n",DataFile);
-        }
-    }
-}
+double *record;
+int width,values,row;
+BOOL ok;
 
-/******************************************************************************/
+    width = TrialColumns.GetWidth();
+    values = 3 + (Trials * width);
+    record = new double[values];
 
-BOOL TrialNext( void )
-{
-BOOL flag=FALSE;
+    record[0] = (double)JournalHash();
+    record[1] = (double)Trials;
+    record[2] = (double)width;
 
-    if( Trial < Trials )
+    for( row=1; (row <= Trials); row++ )
     {
-        Trial++;
-        flag = TRUE;
+        TrialData.RowLoad(row);
+        TrialColumns.Sample(&record[3 + ((row-1) * width)]);
     }
 
-    return(flag);
+    ok = JOURNAL_Open(JournalFile,true) && JOURNAL_Append(RECORD_SESSION,record,values * sizeof(double));
+    delete [] record;
+
+    return(ok);
 }
 
 /******************************************************************************/
 
-void BeepGo( void )
+bool JournalRecord( int type, const void *data, int bytes )
 {
-    WaveListPlay("HighBip");
-}
+const double *session=(const double *)data;
+const JOURNALTRIAL *trial=(const JOURNALTRIAL *)data;
+int width,row,i;
 
-/******************************************************************************/
+    switch( type )
+    {
+        case RECORD_SESSION :
+            width = TrialColumns.GetWidth();
 
-void BeepError( void )
-{
-    WaveListPlay("LowBip");
-}
+            if( (bytes != (int)((3 + (Trials * width)) * sizeof(double))) || (session[0] != (double)JournalHash()) || (session[1] != (double)Trials) || (session[2] != (double)width) )
+            {
+                printf("JOURNAL: %s is not for this trial list.\n",JournalFile);
+                return(false);
+            }
 
-/******************************************************************************/
+            // Replace the new trial list with the one from the session.
+            for( row=1; (row <= Trials); row++ )
+            {
+                TrialColumns.Store(&session[3 + ((row-1) * width)]);
+                TrialData.RowSave(row);
+            }
 
-void MessageClear( void )
-{
-    GraphicsText("");
-    GRAPHICS_ClearColor(); // Default background color.
-}
+            JournalSessionFlag = TRUE;
+            break;
 
-/******************************************************************************/
+        case RECORD_TRIAL :
+            if( !JournalSessionFlag || (bytes != sizeof(JOURNALTRIAL)) || (trial->MovementTimes > RECORD_TIMES) )
+            {
+                printf("JOURNAL: %s Invalid trial record.\n",JournalFile);
+                return(false);
+            }
 
-void MessageSet( char *text, int background )
-{
-    MessageClear();
-    
-    GraphicsText(text);
+            JournalTrialLast = trial->Trial;
+            MissTrialsTotal = trial->MissTrialsTotal;
+            TrialIndexMissTotal = trial->MissTrialsTotal;
+            for( i=0; (i < MISS_TRIAL_TYPES); i++ )
+            {
+                MissTrialsTypeTotal[i] = trial->MissTrialsTypeTotal[i];
+            }
 
-    if( background != -1 )
-    {
-        GRAPHICS_ClearColor(background);
+            for( i=0; (i < trial->MovementTimes); i++ )
+            {
+                ContextFullMovementTimeData.Data(trial->MovementTime[i]);
+            }
+            break;
+
+        case RECORD_RESUME :
+            JournalResumeCount++;
+            break;
     }
+
+    return(true);
 }
 
 /******************************************************************************/
 
-void MessageSet( char *text )
+// Report where the last trial in the journal is in a data file (from its index).
+
+void TrialIndexResume( char *data )
 {
-int background=-1;
+TRIALINDEX_ENTRY entry;
+STRING file;
 
-    MessageSet(text,background);
-}
+    snprintf(file,sizeof(file),"%s.index",data);
 
-/******************************************************************************/
+    if( !TRIALINDEX_Read(file,JournalTrialLast,entry) )
+    {
+        printf("TRIALINDEX: %s does not have Trial %d (last is %d).\n",file,JournalTrialLast,TRIALINDEX_Last(file));
+        return;
+    }
 
-void ErrorFrameDataFull( void )
-{
-    MessageSet("Frame data full",GraphicsBackGround);
-    printf("Error: Frame data full\n");
+    printf("TRIALINDEX: %s Trial %d at byte %lld (%lld bytes, %d frames).\n",data,entry.Trial,(long long)entry.Offset,(long long)entry.Bytes,entry.Rows);
 }
 
 /******************************************************************************/
 
-void ErrorMessage( char *str )
+// The interrupted session didn't reach COLFILE_Close(), so its session file
+// (.col) is written from the trials in the spool file (.col.tmp).
+
+void ColumnFileResume( char *data )
 {
-    MessageSet(str,GraphicsBackGround);
-    printf("Error: %s\n",str);
-}
+STRING file;
 
-/******************************************************************************/
+    snprintf(file,sizeof(file),"%s.col",data);
 
-void ErrorMoveWaitTimeOut( void )
-{
-    MessageSet("Move After Beep",GraphicsBackGround);
-    printf("Error: MoveWaitTimeOut\n");
+    if( !COLFILE_Recover(file) )
+    {
+        printf("COLFILE: No spool file for %s\n",file);
+    }
 }
 
 /******************************************************************************/
 
-void ErrorMoveTooSlow( void )
+// Restore the trial list and progress from the journal of an interrupted
+// session. The resumed session is saved to new files (DataFile with "R1",
+// "R2", etc.), so the files from the interrupted session are kept.
+
+BOOL JournalResume( void )
 {
-    MessageSet("Too Slow");
-    printf("Error: TooSlow\n");
-}
+STRING file;
 
-/******************************************************************************/
+    JournalSessionFlag = FALSE;
+    JournalResumeCount = 0;
+    JournalTrialLast = 0;
 
-void ErrorMoveTimeOut( void )
+    if( !JOURNAL_Read(JournalFile,JournalRecord) || !JournalSessionFlag )
+    {
+        printf("JOURNAL: Cannot resume from %s\n",JournalFile);
+        return(FALSE);
+    }
+
+    if( JournalTrialLast >= Trials )
+    {
+        printf("JOURNAL: All %d trials have been completed.\n",Trials);
+        return(FALSE);
+    }
+
+    // Skip rest breaks that have already been taken.
+    for( RestBreakIndex=0; ((RestBreakIndex < RestBreakCount) && (RestBreakTrials[RestBreakIndex] <= JournalTrialLast)); RestBreakIndex++ );
+
+    // Data file of the interrupted session should have the last trial.
+    if( JournalResumeCount == 0 )
+    {
+        snprintf(file,sizeof(file),"%s",DataFile);
+    }
+    else
+    {
+        snprintf(file,sizeof(file),"%sR%d",DataFile,JournalResumeCount);
+    }
+
+    TrialIndexResume(file);
+    ColumnFileResume(file);
+
+    JournalResumeCount++;
+    snprintf(file,sizeof(file),"%sR%d",DataFile,JournalResumeCount);
+    strcpy(DataFile,file);
+
+    if( !JOURNAL_Open(JournalFile,false) || !JOURNAL_Append(RECORD_RESUME,&JournalTrialLast,sizeof(JournalTrialLast)) )
+    {
+        printf("JOURNAL: Cannot open %s\n",JournalFile);
+        return(FALSE);
+    }
+
+    printf("JOURNAL: Resuming at Trial %d/%d (MissTrials=%d), data file %s\n",JournalTrialLast+1,Trials,MissTrialsTotal,DataFile);
+
+    return(TRUE);
+}
+
+/******************************************************************************/
+
+// Write a trial to the data file (and the files next to it). This is called by
+// the trial writer thread, so the state machine and graphics don't wait for
+// the disk. TrialData, FrameData, etc., are not changed until TrialSetup().
+
+bool TrialWrite( int trial )
+{
+TRIALINDEX_ENTRY entry;
+STRING file;
+int64_t offset;
+BOOL ok;
+
+    // Set-up the data file on the first trial (or first resumed trial).
+    if( !DATAFILE_Opened() )
+    {
+        // Open the file for trial data.
+        if( !DATAFILE_Open(DataFile,TrialData,FrameData) )
+        {
+            printf("DATAFILE: Cannot open file: %s\n",DataFile);
+            return(false);
+        }
+
+        // Index of the trials in the data file.
+        snprintf(file,sizeof(file),"%s.index",DataFile);
+        if( !TRIALINDEX_Open(file,true) )
+        {
+            printf("TRIALINDEX: Cannot open file: %s\n",file);
+        }
+    }
+
+    // Write the trial data to the file.
+    printf("Saving trial %d: %d frames of data collected in %.2lf seconds.\n",trial,FrameData.GetRow(),TrialDuration);
+    offset = TRIALINDEX_FileSize(DataFile);
+    ok = DATAFILE_TrialSave(trial);
+    printf("%s %s Trial=%d.\n",DataFile,STR_OkFailed(ok),trial);
+
+    // The trial is only indexed once it is in the data file.
+    if( ok && TRIALINDEX_Opened() )
+    {
+        entry.Trial = trial;
+        entry.Offset = offset;
+        entry.Bytes = TRIALINDEX_FileSize(DataFile) - offset;
+        entry.Rows = FrameData.GetRow();
+        entry.MissTrial = TrialIndexMissTrial;
+        entry.Phase = TrialPhase;
+        entry.FieldType = FieldType;
+
+        if( !TRIALINDEX_Write(entry) )
+        {
+            printf("TRIALINDEX: Cannot save Trial %d.\n",trial);
+        }
+    }
+
+    // Columnar copy of the trial for the session file (written by TrialExit).
+    snprintf(file,sizeof(file),"%s.col",DataFile);
+    COLFILE_Compress(ColumnCompress ? true : false);
+    if( !COLFILE_Opened() && !COLFILE_Open(file,TrialColumns,FrameColumns) )
+    {
+        printf("COLFILE: Cannot open file: %s\n",file);
+    }
+    else
+    if( !COLFILE_TrialSave(trial) )
+    {
+        printf("COLFILE: Cannot save Trial %d.\n",trial);
+    }
+
+    // Loop timing histograms for the trial are saved next to the data file.
+    snprintf(file,sizeof(file),"%s.hist",DataFile);
+    if( !LoopHistTrial.Save(file,trial) )
+    {
+        printf("LOOPHIST: Cannot save %s\n",file);
+    }
+
+    // Frame variables recorded at lower rates are saved next to the data file.
+    snprintf(file,sizeof(file),"%s.streams",DataFile);
+    if( !FrameStreams.Save(file,trial) )
+    {
+        printf("FRAMEREC: Cannot save %s\n",file);
+    }
+
+    // The trial is only complete in the journal once it has been written.
+    if( ok && JOURNAL_Opened() && !JOURNAL_Append(RECORD_TRIAL,&JournalTrial,sizeof(JournalTrial)) )
+    {
+        printf("JOURNAL: Cannot save Trial %d.\n",trial);
+    }
+
+    return(ok ? true : false);
+}
+
+/******************************************************************************/
+
+BOOL TrialSave( void )
+{
+BOOL ok=FALSE;
+int i;
+
+    ExperimentTime = ExperimentTimer.ElapsedSeconds();
+    MissTrials = MissTrialsTotal;
+    for( i=0; (i < MISS_TRIAL_TYPES); i++ )
+    {
+        MissTrialsType[i] = MissTrialsTypeTotal[i];
+    }
+
+    // Put values in the trial data
+    TrialData.RowSave(Trial);
+    TrialColumns.Reset();
+    TrialColumns.RowSave();
+
+    // Stop if an earlier trial could not be written.
+    if( !TRIALWRITER_Ok() )
+    {
+        printf("TRIALWRITER: Trial %d was not saved.\n",TRIALWRITER_FailedTrial());
+        return(FALSE);
+    }
+
+    LoopHistSession.Merge(LoopHistTrial);
+
+    // Miss trial, or repeated after one (for the trial index).
+    TrialIndexMissTrial = (MissTrialsTotal > TrialIndexMissTotal);
+    TrialIndexMissTotal = MissTrialsTotal;
+
+    // Progress for the journal (appended when the trial has been written).
+    JournalTrial.Trial = Trial;
+    JournalTrial.MissTrialsTotal = MissTrialsTotal;
+    for( i=0; (i < MISS_TRIAL_TYPES); i++ )
+    {
+        JournalTrial.MissTrialsTypeTotal[i] = MissTrialsTypeTotal[i];
+    }
+    JournalTrial.MovementTimes = JournalTimeCount;
+    for( i=0; (i < JournalTimeCount); i++ )
+    {
+        JournalTrial.MovementTime[i] = JournalTime[i];
+    }
+    JournalTimeCount = 0;
+
+    // FrameData from the rows recorded by the forces function.
+    FrameDataFill();
+
+    // Files are written by a background thread, TrialSetup() waits for it.
+    ok = TRIALWRITER_Submit(TrialWrite,Trial);
+
+    return(ok);
+}
+
+/******************************************************************************/
+
+void TrialExit( void )
+{
+    // Wait for the trial writer to finish.
+    TRIALWRITER_Stop();
+
+    // Write the columnar session file.
+    if( COLFILE_Opened() )
+    {
+        COLFILE_Close();
+    }
+
+    JOURNAL_Close();
+    TRIALINDEX_Close();
+
+    // Close the data file if it has been opened.
+    if( DATAFILE_Opened() )
+    {
+        if( !DATAFILE_Close() )
+        {
+            printf("Please resolve problems with data file: %s\n",DataFile);
+        }
+    }
+}
+
+/******************************************************************************/
+
+BOOL TrialNext( void )
+{
+BOOL flag=FALSE;
+
+    if( Trial < Trials )
+    {
+        Trial++;
+        flag = TRUE;
+    }
+
+    return(flag);
+}
+
+/******************************************************************************/
+
+void BeepGo( void )
+{
+    WaveListPlay("HighBip");
+}
+
+/******************************************************************************/
+
+void BeepError( void )
+{
+    WaveListPlay("LowBip");
+}
+
+/******************************************************************************/
+
+void MessageClear( void )
+{
+    GraphicsText("");
+    GRAPHICS_ClearColor(); // Default background color.
+}
+
+/******************************************************************************/
+
+void MessageSet( char *text, int background )
+{
+    MessageClear();
+    
+    GraphicsText(text);
+
+    if( background != -1 )
+    {
+        GRAPHICS_ClearColor(background);
+    }
+}
+
+/******************************************************************************/
+
+void MessageSet( char *text )
+{
+int background=-1;
+
+    MessageSet(text,background);
+}
+
+/******************************************************************************/
+
+void ErrorFrameDataFull( void )
+{
+    LOOPLOG_printf("Warning: Frame data full (%d rows), trial kept.\n",FrameColumns.GetRow());
+}
+
+/******************************************************************************/
+
+void ErrorMessage( char *str )
+{
+    MessageSet(str,GraphicsBackGround);
+    LOOPLOG_printf("Error: %s\n",str);
+}
+
+/******************************************************************************/
+
+void ErrorMoveWaitTimeOut( void )
+{
+    MessageSet("Move After Beep",GraphicsBackGround);
+    LOOPLOG_printf("Error: MoveWaitTimeOut\n");
+}
+
+/******************************************************************************/
+
+void ErrorMoveTooSlow( void )
+{
+    MessageSet("Too Slow");
+    LOOPLOG_printf("Error: TooSlow\n");
+}
+
+/******************************************************************************/
+
+void ErrorMoveTimeOut( void )
 {
     MessageSet("Too Slow",GraphicsBackGround);
-    printf("Error: MoveTimeOut\n");
+    LOOPLOG_printf("Error: MoveTimeOut\n");
 }
 
 /******************************************************************************/
@@ -1600,7 +2595,7 @@ void ErrorMoveTimeOut( void )
 void ErrorMissedVia( void )
 {
     MessageSet("Missed Central Target",GraphicsBackGround);
-    printf("Error: MissedVia\n");
+    LOOPLOG_printf("Error: MissedVia\n");
 }
 
 /******************************************************************************/
@@ -1608,7 +2603,7 @@ void ErrorMissedVia( void )
 void ErrorMoveTooSoon( void )
 {
     MessageSet("Moved Too Soon",GraphicsBackGround);
-    printf("Error: MoveTooSoon\n");
+    LOOPLOG_printf("Error: MoveTooSoon\n");
 }
 
 /******************************************************************************/
@@ -1616,7 +2611,7 @@ void ErrorMoveTooSoon( void )
 void ErrorViaTooLong( void )
 {
     MessageSet("Too Long at CT",GraphicsBackGround);
-    printf("Error: ViaTooLong\n");
+    LOOPLOG_printf("Error: ViaTooLong\n");
 }
 
 /******************************************************************************/
@@ -1624,7 +2619,7 @@ void ErrorViaTooLong( void )
 void ErrorViaEntry( void )
 {
     MessageSet("Missed Target Entrance",GraphicsBackGround);
-    printf("Error: ViaEntry\n");
+    LOOPLOG_printf("Error: ViaEntry\n");
 }
 
 /******************************************************************************/
@@ -1632,7 +2627,7 @@ void ErrorViaEntry( void )
 void ErrorMovedTooFar( void )
 {
     MessageSet("Moved Too Far",GraphicsBackGround);
-    printf("Error: MovedTooFar\n");
+    LOOPLOG_printf("Error: MovedTooFar\n");
 }
 
 /******************************************************************************/
@@ -1640,7 +2635,7 @@ void ErrorMovedTooFar( void )
 void ErrorViaTooShort( void )
 {
     MessageSet("Slow Down at CT",GraphicsBackGround);
-    printf("Error: ViaTooShort\n");
+    LOOPLOG_printf("Error: ViaTooShort\n");
 }
 
 /******************************************************************************/
@@ -1648,7 +2643,7 @@ void ErrorViaTooShort( void )
 void ErrorRobotInactive( void )
 {
     MessageSet("Handle Switch",GraphicsBackGround);
-    printf("Error: RobotInactive\n");
+    LOOPLOG_printf("Error: RobotInactive\n");
 }
 
 /******************************************************************************/
@@ -1678,10 +2673,10 @@ int i;
     MissTrialsTypeTotal[type]++;
 
     MissTrialsPercent = 100.0 * ((double)MissTrialsTotal / (double)Trial);
-    printf("\nMiss Trials = %d/%d (%.0lf%%) [Type=%d]\n\n",MissTrialsTotal,Trial,MissTrialsPercent,type);
+    LOOPLOG_printf("\nMiss Trials = %d/%d (%.0lf%%) [Type=%d]\n\n",MissTrialsTotal,Trial,MissTrialsPercent,type);
     for( i=0; (i < MISS_TRIAL_TYPES); i++ )
     {
-        printf("MissTrialsTypeTotal[%02d]=%d\n",i,MissTrialsTypeTotal[i]);
+        LOOPLOG_printf("MissTrialsTypeTotal[%02d]=%d\n",i,MissTrialsTypeTotal[i]);
     }
 
     ErrorState(STATE_SETUP);
@@ -1737,9 +2732,9 @@ double via_y,via_x;
 
     via_y = ViaPosition(2,1) - (ViaHeight/2.0);
 
-    if( RobotPosition(2,1) >= via_y )
+    if( LoopRobot.RobotPosition(2) >= via_y )
     {
-        via_x = abs(RobotPosition(1,1) - ViaPosition(1,1));
+        via_x = abs(LoopRobot.RobotPosition(1) - ViaPosition(1,1));
 
         if( via_x <= (CursorRadius+(ViaWidth/2.0)) )
         {
@@ -1758,9 +2753,9 @@ BOOL ViaEntryAngleMissTrial( void )
 {
 BOOL flag=FALSE;
 
-    if( RobotHome(ViaPosition,ViaRadius) && (MovementOrderType == ORDER_LEAD_IN) )
+    if( RobotHome(LoopRobot,ViaPosition,ViaRadius) && (MovementOrderType == ORDER_LEAD_IN) )
     {
-        if( abs(RobotPosition(1,1)-ViaPosition(1,1)) > (ViaEntryPosition(1,1)-(CursorRadius*cos(D2R(ViaEntryAngle)))) )
+        if( abs(LoopRobot.RobotPosition(1)-ViaPosition(1,1)) > (ViaEntryPosition(1,1)-(CursorRadius*cos(D2R(ViaEntryAngle)))) )
         {
             flag = TRUE;
             ErrorViaEntry();
@@ -1788,7 +2783,7 @@ void StateProcessLoopTask( void )
     switch( State )
     {
         case STATE_MOVEWAIT :
-           if( ( MovementStarted() || (FieldType == FIELD_PMOVE) ) || (ContextType == PASSIVE_WAIT) )
+           if( ( MovementStarted(LoopRobot) || (FieldType == FIELD_PMOVE) ) || (ContextType == PASSIVE_WAIT) )
            {
                MovementDurationTimer.Reset();
                MovementFirstTimer.Reset();
@@ -1850,7 +2845,7 @@ void StateProcessLoopTask( void )
             if( ContextFullMovementFlag[ContextType] )
             {
                 // It's a full (two-part) movement, so have we entered the via-point.
-                if( RobotInsideVia() )
+                if( RobotInsideVia(LoopRobot) )
                 {
                     MovementFirstTime = MovementFirstTimer.ElapsedSeconds();
                     PassingViaTimer.Reset();
@@ -1881,7 +2876,7 @@ void StateProcessLoopTask( void )
             else
             {
                 // It's a single movement only to the central target...
-                if( MovementFinished() )
+                if( MovementFinished(LoopRobot) )
                 {
                     MovementFirstTime = MovementFirstTimer.ElapsedSeconds();                
                     MovementDurationTime = MovementDurationTimer.ElapsedSeconds();
@@ -1935,7 +2930,7 @@ void StateProcessLoopTask( void )
             }
 
             // It's a full (two-part) movement...
-            if( !RobotInsideVia() )
+            if( !RobotInsideVia(LoopRobot) )
             {
                 // We've left the via point...
                 PassingViaTime = PassingViaTimer.ElapsedSeconds();
@@ -1943,7 +2938,7 @@ void StateProcessLoopTask( void )
                 // Check if left via point too early or too fast, and if not then move to next state STATE_MOVING1
                 if( ViaNotMovingTime < ViaToleranceTime )
                 {
-                    printf("\nPassingViaTime=%0.2lf, ViaNotMovingTime=%.02lf, ViaToleranceTime=%0.2lf\n",PassingViaTime,ViaNotMovingTime,ViaToleranceTime);
+                    LOOPLOG_printf("\nPassingViaTime=%0.2lf, ViaNotMovingTime=%.02lf, ViaToleranceTime=%0.2lf\n",PassingViaTime,ViaNotMovingTime,ViaToleranceTime);
                     ErrorViaTooShort();
                     TrialAbort(); // Abort the current trial
                     MissTrial(MISS_TRIAL_VIATOOSHORT);  // Generate miss trial
@@ -1951,7 +2946,7 @@ void StateProcessLoopTask( void )
                 }
 
                 // We've been in the via-point for the right amoung of time.
-                printf("\nPassingViaTime=%0.2lf, ViaNotMovingTime=%.02lf, ViaToleranceTime=%0.2lf(sec)\n",PassingViaTime,ViaNotMovingTime,ViaToleranceTime);
+                LOOPLOG_printf("\nPassingViaTime=%0.2lf, ViaNotMovingTime=%.02lf, ViaToleranceTime=%0.2lf(sec)\n",PassingViaTime,ViaNotMovingTime,ViaToleranceTime);
                 MovementSecondTimer.Reset();
 
                 /*// Start force-field if it's a lead-in paradigm.
@@ -1965,12 +2960,12 @@ void StateProcessLoopTask( void )
             break;
 
         case STATE_MOVING1 :
-            if( MovementFinished() )
+            if( MovementFinished(LoopRobot) )
             {
                 MovementSecondTime = MovementSecondTimer.ElapsedSeconds();
                 MovementDurationTime = MovementDurationTimer.ElapsedSeconds();
 
-                ContextFullMovementTimeData.Data(MovementDurationTime);
+                ContextFullMovementTime(MovementDurationTime);
 
                 // Stop force-field if the channel/field is on the second movement.
                 if( ChannelOrderType == CHANNEL_SECOND )
@@ -2022,12 +3017,15 @@ void StateProcess( void )
             MissTrial(MISS_TRIAL_ROBOTINACTIVE);
         }
         else
-        if( FrameData.Full() )
+        if( FrameColumns.Full() && FrameRecord )
         {
-            // Abort current trial if frame data is full.
+            // Should not happen as FrameData is sized for the worst-case trial. Stop
+            // recording (the trial is kept, with FrameDataTruncated set in TrialData)
+            // and add a chunk before the next trial.
             ErrorFrameDataFull();
-            TrialAbort();
-            MissTrial(MISS_TRIAL_FRAMEDATAFULL);
+            FrameStop();
+            FrameDataTruncated = TRUE;
+            FrameDataExtraChunks++;
         }
     }
 
@@ -2049,7 +3047,7 @@ void StateProcess( void )
         case STATE_SETUP :
            // Setup details of next trial, but only when robot stationary and active.
            
-           if( !(RobotNotMoving() && RobotActive()) )
+           if( !(RobotNotMoving(GraphicsRobot) && RobotActive()) )
            {
                break;
            }
@@ -2076,7 +3074,7 @@ void StateProcess( void )
                StateNext(STATE_START);
 	   }
 
-	   if( RobotNotMoving() && RobotHome() && RobotActive() )
+	   if( RobotNotMoving(GraphicsRobot) && RobotHome(GraphicsRobot) && RobotActive() )
            {
                StateNext(STATE_START);
                break;
@@ -2114,7 +3112,7 @@ void StateProcess( void )
                break;
            }
 
-           if( MovementStarted() )
+           if( MovementStarted(GraphicsRobot) )
            {
                ErrorMoveTooSoon();
                TrialAbort();
@@ -2279,6 +3277,7 @@ void GraphicsResults( void )
     GraphicsClearStereoLatency.Results();
     GraphicsClearMonoLatency.Results();
     GraphicsIdleFrequency.Results();
+    IDLESCHED_Results();
 
     if( GraphicsVerticalRetraceSyncTime != 0.0 )
     {
@@ -2295,6 +3294,8 @@ void Results( void )
     // Print results for various timers and things.
     RobotForcesFunctionLatency.Results();
     RobotForcesFunctionFrequency.Results();
+    LoopHistSession.Print(stdout);
+    printf("TRIALWRITER: Maximum time to save a trial %.3lf seconds.\n",TRIALWRITER_MaximumTime());
     GraphicsResults();
     WaveListPlayInterval.Results();
     ContextFullMovementTimeData.Results();
@@ -2309,8 +3310,11 @@ void ProgramExit( void )
 
     // Stop, close and other final stuff.
     DeviceStop();
+    LOOPLOG_Stop();
+    GLCACHE_Free();
     GRAPHICS_Stop();
     Results();
+    IDLESCHED_Stop();
     WAVELIST_Close(WaveList);
 
     printf("ExperimentTime = %.0lf minutes.\n",ExperimentTimer.ElapsedMinutes());
@@ -2321,260 +3325,143 @@ void ProgramExit( void )
 
 /******************************************************************************/
 
-matrix TargetAngleVector( double angle, double distance )
-{
-static matrix vector(3,1);
-
-   // Create a vector for target angle.
-   vector(1,1) = distance * sin(D2R(angle));
-   vector(2,1) = distance * cos(D2R(angle));
-   vector(3,1) = 0.0;
+// Scene drawn by SCENE_Draw() (DualPlanningScene.cpp) with OpenGL.
 
-   return(vector);
-}
+SCENE GraphicsScene;
 
 /******************************************************************************/
 
-void GraphicsDisplayCursor( void )
+void SCENE_Circle( const VEC3 &posn, double radius, int color )
 {
-static matrix posn(3,1);
+    // Same as GRAPHICS_Circle(), but drawn from the geometry cache.
+    GRAPHICS_ColorSet(color);
+    GLCACHE_Disc(posn(1),posn(2),posn(3),radius);
+}
 
-    posn = CursorPosition;
-    posn(3,1) = 1.0;
-    GRAPHICS_Circle(&posn,CursorRadius,CursorColor);
+/******************************************************************************/
 
+void SCENE_Ring( const VEC3 &posn, double radius, double width, int color )
+{
+    GRAPHICS_ColorSet(color);
+    GLCACHE_Ring(posn(1),posn(2),posn(3),radius,width);
 }
 
 /******************************************************************************/
 
-void GraphicsDisplayRing( matrix *posn, double radius, double width, int color )
+void SCENE_Rectangle( const VEC3 &posn, double width, double height, int color )
 {
 static matrix P(3,1);
 
-    P.zeros();
-    if( posn != NULL )
-    {
-        P = *posn;
-    }
-
-    GRAPHICS_Circle(&P,radius,color);
-    P(3,1) += 0.1;
-    GRAPHICS_Circle(&P,radius-width,GraphicsBackGround);
+    VEC3_put(P,posn);
+    GRAPHICS_Rectangle(&P,width,height,color);
 }
 
 /******************************************************************************/
 
-void GraphicsDisplayTarget( void )
+void SCENE_String( const VEC3 &posn, double scale, const char *text, int color )
 {
-static matrix posn(3,1),R(3,3),S(3,1),E(3,1);
-static matrix StartToCentralVector(3,1);
-double StartToCentralDistance;
-BOOL DisplayTargetFlag;
-BOOL FilledTargetFlag;
-BOOL DualTargetFlag;
-int attr;
-double i;
-
-    // The following code was in GraphicsDisplay()...
-
-   
-    if( (FieldType == FIELD_PMOVE) || (ContextType == PASSIVE_MOVE) )
-	{
-        // Deliberate mixture of finish and start variables for passive-return trials.
-        attr = RobotHome(FinishPosition,StartTolerance) ? StartColor : NotStartColor;	    
+    glPushMatrix();
 
-        posn = FinishPosition;
-        posn(3,1) = 0.0;
+    glLineWidth(2.0);
+    glTranslated(posn(1),posn(2),posn(3));
+    glScaled(scale,scale,1.0);
 
-        GRAPHICS_Circle(&posn,StartRadius,attr);
+    GRAPHICS_ColorSet(color);
 
-        return;
-    }
+    GLCACHE_String(GLUT_STROKE_MONO_ROMAN,text);
 
-    // Display via point for movement.
-    posn = ViaPosition;
-    posn(3,1) = 0.0;
-    if ( ContextType != PASSIVE_WAIT ) 
-  	{
-       switch( ViaType )
-       {
-           case VIA_CIRCLE :
-               GRAPHICS_Circle(&posn,ViaRadius,ViaColor);
-               break;
+    glPopMatrix();
+}
 
-           case VIA_RECTANGLE :
-               GRAPHICS_Rectangle(&posn,ViaWidth,ViaHeight,ViaColor);
-               break;
-       }
-	}
+/******************************************************************************/
 
-    /*if( MovementOrderType == ORDER_LEAD_IN )
-    {
-        for( i=-1.0; (i <= 1.0); i+=2.0 )
-        {
-            S(1,1) = i * (ViaRadius-(ViaEntryLineLength/2.0)) * sin(D2R(ViaEntryAngle));
-            S(2,1) = -(ViaRadius-(ViaEntryLineLength/2.0)) * cos(D2R(ViaEntryAngle));
-            S += ViaPosition;
-            S(3,1) = 0.5;
+void SCENE_Teapot( double size, double angle, int color )
+{
+    glPushMatrix();
+    GRAPHICS_ColorSet(color);
+    glRotated(angle,1.0,1.0,1.0);
+    glLineWidth(1.0);
+    glutWireTeapot(size);
+    glPopMatrix();
+}
 
-            E(1,1) = i * (ViaRadius+(ViaEntryLineLength/2.0)) * sin(D2R(ViaEntryAngle));
-            E(2,1) = -(ViaRadius+(ViaEntryLineLength/2.0)) * cos(D2R(ViaEntryAngle));
-            E += ViaPosition;
-            E(3,1) = 0.5;
+/******************************************************************************/
 
-            GRAPHICS_Line(S,E,ViaEntryLineWidth,WHITE);
-        }
-    }*/
+void GraphicsDisplayScene( void )
+{
+SCENE &scene=GraphicsScene;
+
+    scene.State = StateGraphics;
+    scene.FieldType = FieldType;
+    scene.ContextType = ContextType;
+    scene.MovementOrderType = MovementOrderType;
+    scene.ViaType = ViaType;
+
+    scene.RobotPosition = GraphicsRobot.RobotPosition;
+    scene.CursorPosition = GraphicsRobot.CursorPosition;
+    scene.StartPosition = VEC3_get(StartPosition);
+    scene.FinishPosition = VEC3_get(FinishPosition);
+    scene.ViaPosition = VEC3_get(ViaPosition);
+    scene.TargetPosition = VEC3_get(TargetPosition);
+    scene.TextPosition = VEC3_get(TextPosition);
+
+    scene.SymmetryAxisAngle = SymmetryAxisAngle;
+    scene.TargetAngle = TargetAngle;
+    scene.MovementSecondDistance = MovementSecondDistance;
+    scene.TargetResolveDistance = TargetResolveDistance;
+
+    scene.StartRadius = StartRadius;
+    scene.StartTolerance = StartTolerance;
+    scene.ViaRadius = ViaRadius;
+    scene.ViaWidth = ViaWidth;
+    scene.ViaHeight = ViaHeight;
+    scene.TargetRadius = TargetRadius;
+    scene.TargetOutlineWidth = TargetOutlineWidth;
+    scene.CursorRadius = CursorRadius;
+
+    scene.StartColor = StartColor;
+    scene.NotStartColor = NotStartColor;
+    scene.ViaColor = ViaColor;
+    scene.TargetColor = TargetColor;
+    scene.CursorColor = CursorColor;
+    scene.TextColor = WHITE;
+
+    scene.Text = GraphicsString;
+
+    scene.TeapotSize = TeapotSize * RestBreakRemainPercent;
+    scene.TeapotAngle = StateTimer.ElapsedSeconds() * TeapotRotateSpeed;
+
+    scene.TargetResolveFlag = (TargetResolveFlag != FALSE);
+
+    SCENE_Draw(scene);
+
+    TargetResolveFlag = scene.TargetResolveFlag;
+}
 
-    switch( MovementOrderType )
-    {
-        case ORDER_FOLLOW_THROUGH :
-            SPMX_romxZ(D2R(SymmetryAxisAngle),R);
-            break;
+/******************************************************************************/
 
-        case ORDER_LEAD_IN :
-            SPMX_romxZ(D2R(SymmetryAxisAngle+TargetAngle),R);
-            break;
+void GraphicsDisplay( void )
+{
+BOOL scene;
 
-        case ORDER_SINGLE_MOVEMENT :
-            // This isn't used in current paradigm so hasnt' been tested.
-            SPMX_romxZ(D2R(SymmetryAxisAngle+TargetAngle),R);
-            break;
-    }
+    // Mark time before we start drawing the graphics scene.
+    GraphicsDisplayLatency.Before();
 
-    StartToCentralVector = RobotPosition - StartPosition;
-    StartToCentralVector = R * StartToCentralVector;
-    StartToCentralDistance = StartToCentralVector(2,1);
+    // Clear "stereo" graphics buffers.
+    GraphicsClearStereoLatency.Before();
+    GRAPHICS_ClearStereo();
+    GraphicsClearStereoLatency.After();
 
-    DisplayTargetFlag = FALSE;
-    FilledTargetFlag = TRUE;
-    DualTargetFlag = FALSE;
+    // In stereo, the scene is the same for each eye except for the view, so
+    // compile it once and draw the list for each eye.
+    scene = GraphicsSceneListFlag && (GraphicsMode != GRAPHICS_DISPLAY_2D) && GLCACHE_SceneStart();
 
-    switch( ContextType )
+    if( scene )
     {
-        case TARGET_STATIC_ON :
-            DisplayTargetFlag = TRUE;
-            break;
-
-        case TARGET_APPEAR :
-            if( !TargetResolveFlag )
-            {
-                TargetResolveFlag = (StartToCentralDistance > TargetResolveDistance);
-            }
-
-            DisplayTargetFlag = TargetResolveFlag;
-            break;
-
-        case TARGET_STOP :
-            if( !TargetResolveFlag )
-            {
-                TargetResolveFlag = (StartToCentralDistance > TargetResolveDistance);
-            }
-
-            DisplayTargetFlag = !TargetResolveFlag;
-            break;
-
-        case TARGET_CENTRAL_ONLY :
-            DisplayTargetFlag = FALSE;
-            break;
-            
-            
-        case TARGET_VISUAL_ONLY :
-            DisplayTargetFlag = TRUE;
-            break;
-
-        case TARGET_DUAL_OFF :
-            if( !TargetResolveFlag )
-            {
-                TargetResolveFlag = (StartToCentralDistance > TargetResolveDistance);
-            }
-
-            DisplayTargetFlag = !TargetResolveFlag;
-            DualTargetFlag = DisplayTargetFlag;
-            break;
-
-        case DUAL_PLANNING :
-            if( !TargetResolveFlag )
-            {
-                TargetResolveFlag = (StartToCentralDistance > TargetResolveDistance);
-            }
-
-            DisplayTargetFlag = TRUE;
-            DualTargetFlag = !TargetResolveFlag;
-            break;
-
-        case TARGET_STATIC_GO :
-            DisplayTargetFlag = TRUE;
-            FilledTargetFlag = (StateGraphics >= STATE_GO);
-            break;
-
-        case DUAL_PLANNING_GO :
-            DisplayTargetFlag = TRUE;
-            FilledTargetFlag = (StateGraphics >= STATE_GO);
-            DualTargetFlag = TRUE;
-            break;
-
-		case PASSIVE_WAIT :
-			//show only the home position
-			break;
-    }
-
-    if( DisplayTargetFlag )
-    {
-        posn = TargetPosition;
-
-        if( FilledTargetFlag )
-        {
-            GRAPHICS_Circle(&posn,TargetRadius,TargetColor);
-        }
-        else
-        {
-            GraphicsDisplayRing(&posn,TargetRadius,TargetOutlineWidth,TargetColor);
-        }
+        GraphicsDisplayScene();
+        GLCACHE_SceneEnd();
     }
 
-    if( DualTargetFlag )
-    {
-        posn = ViaPosition + TargetAngleVector(SymmetryAxisAngle-TargetAngle,MovementSecondDistance);
-
-        if( FilledTargetFlag && (ContextType != DUAL_PLANNING_GO) )
-        {
-            GRAPHICS_Circle(&posn,TargetRadius,TargetColor);
-        }
-        else
-        {
-             GraphicsDisplayRing(&posn,TargetRadius,TargetOutlineWidth,TargetColor);
-        }
-    }
-}
-
-/******************************************************************************/
-
-void GraphicsDisplayTeaPot( void )
-{
-    glPushMatrix();
-    GRAPHICS_ColorSet(WHITE);
-    glRotated(StateTimer.ElapsedSeconds() * TeapotRotateSpeed,1.0,1.0,1.0);
-    glLineWidth(1.0);
-    glutWireTeapot(TeapotSize * RestBreakRemainPercent);
-    glPopMatrix();
-}
-
-/******************************************************************************/
-
-void GraphicsDisplay( void )
-{
-int attr;
-static matrix posn;
-
-    // Mark time before we start drawing the graphics scene.
-    GraphicsDisplayLatency.Before();
-
-    // Clear "stereo" graphics buffers.
-    GraphicsClearStereoLatency.Before();
-    GRAPHICS_ClearStereo();
-    GraphicsClearStereoLatency.After();
-
     // Loop for each eye (stereo 3D).
     GRAPHICS_EyeLoop(eye)
     {
@@ -2586,38 +3473,14 @@ static matrix posn;
         GRAPHICS_ClearMono();
         GraphicsClearMonoLatency.After();
 
-        // Display text.
-        GraphicsDisplayText();
-
-        // Display rotating teapot during rest period.
-        if( StateGraphics == STATE_REST )
-        {
-            GraphicsDisplayTeaPot();
-            continue;
-        }
-
-        // Display home position at start of trial.
-        if( (StateGraphics >= STATE_SETUP) && (StateGraphics <= STATE_INTERTRIAL) && (FieldType != FIELD_PMOVE) )
-        {
-            attr = RobotHome() ? StartColor : NotStartColor;
-
-            posn = StartPosition;
-            posn(3,1) = 0.0;
-
-            GRAPHICS_Circle(&posn,StartRadius,attr);
-        }
-
-        // Display targets when trial running.
-        if( (StateGraphics >= STATE_START) && (StateGraphics <= STATE_INTERTRIAL) )
+        // Display the scene.
+        if( scene )
         {
-            // Display target for movement.
-            GraphicsDisplayTarget();
+            GLCACHE_SceneCall();
         }
-
-        // Display robot position cursor.
-        if( StateGraphics != STATE_ERROR )
+        else
         {
-            GraphicsDisplayCursor();
+            GraphicsDisplayScene();
         }
     }
 
@@ -2635,12 +3498,69 @@ static matrix posn;
 
 /******************************************************************************/
 
+// Sleep until the idle function's next deadline: the state machine is
+// processed at least every GraphicsIdlePeriod and, with vertical retrace
+// timing, a frame is drawn GraphicsVerticalRetraceSyncTime before the next
+// retrace. Around the retrace itself it doesn't sleep (as before), so that
+// GRAPHICS_VerticalRetraceCatch() still catches it.
+
+void GraphicsIdleWait( void )
+{
+double period,retrace,draw,wait;
+
+    if( GraphicsIdlePeriod == 0.0 )
+    {
+        Sleep(0);
+        return;
+    }
+
+    if( GraphicsVerticalRetraceSyncTime == 0.0 )
+    {
+        IDLESCHED_Wait(GraphicsIdlePeriod,false);
+        return;
+    }
+
+    // Time (sec) until the next vertical retrace.
+    period = GRAPHICS_VerticalRetracePeriod;
+    retrace = GRAPHICS_VerticalRetraceOnsetTimeUntilNext() / 1000.0;
+
+    if( (retrace <= GraphicsIdleSpinTime) || (retrace >= (period - GraphicsIdleSpinTime)) )
+    {
+        Sleep(0);
+        return;
+    }
+
+    // Next draw point (in the next cycle if this one has passed).
+    draw = retrace - GraphicsVerticalRetraceSyncTime;
+
+    if( draw <= 0.0 )
+    {
+        draw += period;
+    }
+
+    wait = (draw < (retrace - GraphicsIdleSpinTime)) ? draw : (retrace - GraphicsIdleSpinTime);
+
+    if( wait < GraphicsIdlePeriod )
+    {
+        IDLESCHED_Wait(wait,true);
+    }
+    else
+    {
+        IDLESCHED_Wait(GraphicsIdlePeriod,false);
+    }
+}
+
+/******************************************************************************/
+
 void GraphicsIdle( void )
 {
 BOOL draw=FALSE;
 
     GraphicsIdleFrequency.Loop();
 
+    // Robot position and state published by the forces function.
+    GraphicsRobot = RobotSnapshot.Read();
+
     // Process Finite State Machine.
     StateProcess();
 
@@ -2668,11 +3588,12 @@ BOOL draw=FALSE;
     // Draw graphics frame only if draw flag set.
     if( draw )
     {
-        StateGraphicsNext(State); // Safe to set graphics state at this point.
+        StateGraphicsNext(GraphicsRobot.State); // Safe to set graphics state at this point.
         GraphicsDisplay();
     }
 
-    Sleep(0);
+    // Sleep until there is something to do.
+    GraphicsIdleWait();
 }
 
 /******************************************************************************/
@@ -2718,6 +3639,12 @@ void GraphicsMainLoop( void )
     GraphicsDisplayFrequency.Reset();
     GraphicsIdleFrequency.Reset();
 
+    // High-resolution sleeps for the idle function.
+    if( !IDLESCHED_Start(GraphicsIdleSpinTime) )
+    {
+        printf("IDLESCHED: Cannot start timer (idle function will not sleep).\n");
+    }
+
     // Give control to GLUT's main loop.
     glutMainLoop();
 }
@@ -2727,7 +3654,7 @@ void GraphicsMainLoop( void )
 void Usage( void )
 {
     printf("----------------------------------\n");
-    printf("%s /C:Config(1)[,...Config(n)] /M:MetaConfig /D:DataFile\n",MODULE_NAME);
+    printf("%s /C:Config(1)[,...Config(n)] /M:MetaConfig /D:DataFile [/resume]\n",MODULE_NAME);
     printf("----------------------------------\n");
 
     exit(0);
@@ -2735,6 +3662,43 @@ void Usage( void )
 
 /******************************************************************************/
 
+// Variables are added to the MATDAT (for the DATAFILE) and the matching
+// COLTABLE (for the columnar session file) with the same name.
+
+template<class T> void TrialVariable( const char *name, T &variable )
+{
+    TrialData.AddVariable(name,variable);
+    TrialColumns.AddVariable(name,variable);
+}
+
+template<class T> void TrialVariable( const char *name, T *variable, int count )
+{
+    TrialData.AddVariable(name,variable,count);
+    TrialColumns.AddVariable(name,variable,count);
+}
+
+// FrameColumns samples the variable and FrameData a copy (see FrameDataFill).
+
+template<class T> void FrameVariable( const char *name, T &variable )
+{
+T *copy=new T(variable);
+
+    FrameColumns.AddVariable(name,variable);
+    FrameShadow.AddVariable(name,*copy);
+    FrameData.AddVariable(name,*copy);
+}
+
+template<class T> void FrameVariable( const char *name, T *variable, int count )
+{
+T *copy=new T[count];
+
+    FrameColumns.AddVariable(name,variable,count);
+    FrameShadow.AddVariable(name,copy,count);
+    FrameData.AddVariable(name,copy,count);
+}
+
+/******************************************************************************/
+
 BOOL Initialize( void )
 {
 int i;
@@ -2760,6 +3724,16 @@ int i;
 
     ContextFullMovementTimeData.Data(PostMoveDelayInit);
 
+    // Until a viscous field is used, channel trials are compared with the first one configured.
+    for( i=0; ((i < FIELD_INDEX) && (CompensationViscosity == 0.0)); i++ )
+    {
+        if( FieldIndexType[i] == FIELD_VISCOUS )
+        {
+            CompensationViscosity = FieldIndexConstants[i][0];
+            CompensationAngle = FieldIndexAngle[i];
+        }
+    }
+
     for( i=0; (i < MISS_TRIAL_TYPES); i++ )
     {
         MissTrialsTypeTotal[i] = 0;
@@ -2767,92 +3741,143 @@ int i;
     }
 
     // Add each variable to the TrialData matrix.
-    TrialData.AddVariable(VAR(ExperimentTime));
-    TrialData.AddVariable(VAR(ConfigIndex));
-    TrialData.AddVariable(VAR(PhaseIndex));
-    TrialData.AddVariable(VAR(TrialPhase));
-    TrialData.AddVariable(VAR(MovementType));
-    TrialData.AddVariable(VAR(MovementDirection));
-    TrialData.AddVariable(VAR(FieldIndex));
-    TrialData.AddVariable(VAR(FieldType));
-    TrialData.AddVariable(VAR(FieldConstants),FIELD_CONSTANTS);
-    TrialData.AddVariable(VAR(FieldAngle));
-    TrialData.AddVariable(VAR(PassiveWaitFirstFlag));
-    TrialData.AddVariable(VAR(PassiveWaitLastFlag));
-    TrialData.AddVariable(VAR(ContextType));
-    TrialData.AddVariable(VAR(ContextConstants),FIELD_CONSTANTS);
-    TrialData.AddVariable(VAR(TrialDelay));
-    TrialData.AddVariable(VAR(InterTrialDelay));
-    TrialData.AddVariable(VAR(TargetAngle));
-    TrialData.AddVariable(VAR(TargetPosition));
-    TrialData.AddVariable(VAR(MovementFirstDistance));
-    TrialData.AddVariable(VAR(MovementSecondDistance));
-    TrialData.AddVariable(VAR(ViaPosition));
-    TrialData.AddVariable(VAR(SymmetryAxisAngle));
-    TrialData.AddVariable(VAR(TargetResolveDistance));
-    TrialData.AddVariable(VAR(MovementOrderType));
-	TrialData.AddVariable(VAR(ChannelOrderType));
-    TrialData.AddVariable(VAR(MovedTooFarDistance)); 
-    TrialData.AddVariable(VAR(MissedViaPointDistance)); 
-    TrialData.AddVariable(VAR(StartPosition));
-    TrialData.AddVariable(VAR(FinishPosition));
-    TrialData.AddVariable(VAR(MissTrials));
-    TrialData.AddVariable(VAR(MissTrialsType),MISS_TRIAL_TYPES);
-    TrialData.AddVariable(VAR(TrialDuration));
-    TrialData.AddVariable(VAR(MovementReactionTime));
-    TrialData.AddVariable(VAR(MovementDurationTime));
-    TrialData.AddVariable(VAR(MovementFirstTime));
-    TrialData.AddVariable(VAR(MovementFirstTooSlow));
-    TrialData.AddVariable(VAR(MovementFirstTooFast));
-    TrialData.AddVariable(VAR(MovementSecondTime));
-    TrialData.AddVariable(VAR(MovementSecondTooSlow));
-    TrialData.AddVariable(VAR(MovementSecondTooFast));
-    TrialData.AddVariable(VAR(PMoveStartPosition));
-    TrialData.AddVariable(VAR(PMoveEndPosition));
-    TrialData.AddVariable(VAR(ViaToleranceTime));
-    TrialData.AddVariable(VAR(ViaTimeOutTime));
-    TrialData.AddVariable(VAR(PostMoveDelayTime));
-    TrialData.AddVariable(VAR(PostMoveDelayInit));   
-    TrialData.AddVariable(VAR(PassingViaTime));   
-    TrialData.AddVariable(VAR(ViaNotMovingTime));   
+    TrialVariable(VAR(ExperimentTime));
+    TrialVariable(VAR(ConfigIndex));
+    TrialVariable(VAR(PhaseIndex));
+    TrialVariable(VAR(TrialPhase));
+    TrialVariable(VAR(MovementType));
+    TrialVariable(VAR(MovementDirection));
+    TrialVariable(VAR(FieldIndex));
+    TrialVariable(VAR(FieldType));
+    TrialVariable(VAR(FieldConstants),FIELD_CONSTANTS);
+    TrialVariable(VAR(FieldAngle));
+    TrialVariable(VAR(PassiveWaitFirstFlag));
+    TrialVariable(VAR(PassiveWaitLastFlag));
+    TrialVariable(VAR(ContextType));
+    TrialVariable(VAR(ContextConstants),FIELD_CONSTANTS);
+    TrialVariable(VAR(TrialDelay));
+    TrialVariable(VAR(InterTrialDelay));
+    TrialVariable(VAR(TargetAngle));
+    TrialVariable(VAR(TargetPosition));
+    TrialVariable(VAR(MovementFirstDistance));
+    TrialVariable(VAR(MovementSecondDistance));
+    TrialVariable(VAR(ViaPosition));
+    TrialVariable(VAR(SymmetryAxisAngle));
+    TrialVariable(VAR(TargetResolveDistance));
+    TrialVariable(VAR(MovementOrderType));
+	TrialVariable(VAR(ChannelOrderType));
+    TrialVariable(VAR(MovedTooFarDistance)); 
+    TrialVariable(VAR(MissedViaPointDistance)); 
+    TrialVariable(VAR(StartPosition));
+    TrialVariable(VAR(FinishPosition));
+    TrialVariable(VAR(MissTrials));
+    TrialVariable(VAR(MissTrialsType),MISS_TRIAL_TYPES);
+    TrialVariable(VAR(TrialDuration));
+    TrialVariable(VAR(MovementReactionTime));
+    TrialVariable(VAR(MovementDurationTime));
+    TrialVariable(VAR(MovementFirstTime));
+    TrialVariable(VAR(MovementFirstTooSlow));
+    TrialVariable(VAR(MovementFirstTooFast));
+    TrialVariable(VAR(MovementSecondTime));
+    TrialVariable(VAR(MovementSecondTooSlow));
+    TrialVariable(VAR(MovementSecondTooFast));
+    TrialVariable(VAR(PMoveStartPosition));
+    TrialVariable(VAR(PMoveEndPosition));
+    TrialVariable(VAR(ViaToleranceTime));
+    TrialVariable(VAR(ViaTimeOutTime));
+    TrialVariable(VAR(PostMoveDelayTime));
+    TrialVariable(VAR(PostMoveDelayInit));   
+    TrialVariable(VAR(PassingViaTime));   
+    TrialVariable(VAR(ViaNotMovingTime));   
+    TrialVariable(VAR(CompensationIndex));
+    TrialVariable(VAR(CompensationR2));
+    TrialVariable(VAR(FrameDataTruncated));
     
     // Add each variable to the FrameData matrix.
-    FrameData.AddVariable(VAR(TrialTime));         
-    FrameData.AddVariable(VAR(State));
-    FrameData.AddVariable(VAR(StateGraphics));
-    FrameData.AddVariable(VAR(ForcesFunctionLatency));
-    FrameData.AddVariable(VAR(ForcesFunctionPeriod));
-    FrameData.AddVariable(VAR(RobotPosition));
-    FrameData.AddVariable(VAR(RobotVelocity));     
-    FrameData.AddVariable(VAR(RobotForces));       
-    FrameData.AddVariable(VAR(HandleForces));
-    FrameData.AddVariable(VAR(HandleTorques));
-    FrameData.AddVariable(VAR(CursorPosition));
-    FrameData.AddVariable(VAR(ForceFieldRampValue));
-    FrameData.AddVariable(VAR(TargetResolveFlag));
-    FrameData.AddVariable(VAR(PMoveState));
-    FrameData.AddVariable(VAR(PMoveStateTime));
-    FrameData.AddVariable(VAR(PMoveStateRampValue));
-    FrameData.AddVariable(VAR(PMoveStatePosition));
+    FrameVariable(VAR(TrialTime));         
+    FrameVariable("State",StateFrame);
+    FrameVariable(VAR(ForcesFunctionLatency));
+    FrameVariable(VAR(ForcesFunctionPeriod));
+    FrameVariable(VAR(RobotPosition));
+    FrameVariable(VAR(RobotVelocity));     
+    FrameVariable(VAR(RobotForces));       
+    FrameVariable(VAR(HandleForces));
+    FrameVariable(VAR(CursorPosition));
+    FrameVariable(VAR(CursorPredicted));
+
+    // Slowly-changing variables have their own sample rate (and time column).
+    FrameStreams.AddVariable(VAR(StateGraphics),FRAMEREC_CHANGE);
+    FrameStreams.AddVariable(VAR(ForceFieldRampValue),FRAMESTREAM_RATE);
+    FrameStreams.AddVariable(VAR(TargetResolveFlag),FRAMEREC_CHANGE);
+    FrameStreams.AddVariable(VAR(HandleTorques),FRAMESTREAM_RATE);
+    FrameStreams.AddVariable(VAR(PMoveState),FRAMEREC_CHANGE);
+    FrameStreams.AddVariable(VAR(PMoveStateTime),FRAMESTREAM_RATE);
+    FrameStreams.AddVariable(VAR(PMoveStateRampValue),FRAMESTREAM_RATE);
+    FrameStreams.AddVariable(VAR(PMoveStatePosition),FRAMESTREAM_RATE);
 
     // Add GRAPHICS variables to FrameData matrix.
     GRAPHICS_FrameData(&FrameData);
+    GRAPHICS_FrameData(&FrameGraphics);
 
-    // Set rows of FrameData to maximum.
+    // Set rows of FrameData to minimum (resized for each trial in TrialSetup).
     FrameData.SetRows(FRAMEDATA_ROWS);
+    FrameGraphics.SetRows(FRAMEDATA_ROWS);
+    FrameColumns.SetRows(FRAMEDATA_ROWS);
+    FrameDataRows = FRAMEDATA_ROWS;
+
+    // One row of TrialColumns for each trial.
+    TrialColumns.SetRows(1);
 
     return(TRUE);
 }
 
 /******************************************************************************/
 
+// Start a plan for a number of trials.
+
+void TrialPlanStart( int trials )
+{
+    TrialPlan.assign(trials+1,TRIALPLAN());
+    TrialPlanConfig.assign(TrialColumns.GetWidth(),0.0);
+}
+
+/******************************************************************************/
+
+// Sample the TrialData variables for the configuration file that is loaded.
+
+int TrialPlanConfigAdd( void )
+{
+int width=TrialColumns.GetWidth();
+int config=(int)TrialPlanConfig.size() / width;
+
+    TrialPlanConfig.resize((config+1) * width);
+    TrialColumns.Sample(&TrialPlanConfig[config * width]);
+
+    return(config);
+}
+
+/******************************************************************************/
+
+VEC3 TrialPlanAngleVector( double angle, double distance )
+{
+    // Same as the dual target in SCENE_Draw().
+    return(VEC3(distance * sin(D2R(angle)),distance * cos(D2R(angle)),0.0));
+}
+
+/******************************************************************************/
+
 BOOL TrialListSubset( void )
 {
+TRIALPLAN *plan;
+VEC3 via;
 BOOL ok;
-int i;
+int config,i;
 
     TrialOffset = TotalTrials;
 
+    config = TrialPlanConfigAdd();
+    via = VEC3_get(ViaPosition);
+
     // Create list of trials.
     for( ok=TRUE,TrialPhaseLast=-1,Trial=1; ((Trial <= Trials) && ok); )
     {
@@ -2881,85 +3906,96 @@ int i;
             PhaseFieldIndexPermute.Init(0,PhaseFieldIndexCount[TrialPhase]-1,PhaseFieldPermute[TrialPhase]);
         }
 
-        FieldIndex = PhaseFieldIndex[TrialPhase][PhaseFieldIndexPermute.GetNext()];
-        FieldIndexTrialCount[FieldIndex]++;
+        plan = &TrialPlan[TrialOffset+Trial];
+        plan->Made = TRUE;
+        plan->Config = config;
+        plan->PhaseIndex = PhaseIndex;
+        plan->TrialPhase = TrialPhase;
+
+        plan->FieldIndex = PhaseFieldIndex[TrialPhase][PhaseFieldIndexPermute.GetNext()];
+        FieldIndexTrialCount[plan->FieldIndex]++;
 
-        FieldType = FieldIndexType[FieldIndex];
-        FieldTrials[FieldType]++;
+        plan->FieldType = FieldIndexType[plan->FieldIndex];
+        FieldTrials[plan->FieldType]++;
 
-        FieldAngle = FieldIndexAngle[FieldIndex];
+        plan->FieldAngle = FieldIndexAngle[plan->FieldIndex];
 
         for( i=0; (i < FIELD_CONSTANTS); i++ )
         {
-            FieldConstants[i] = FieldIndexConstants[FieldIndex][i];
+            plan->FieldConstants[i] = FieldIndexConstants[plan->FieldIndex][i];
         }
 
-        ContextType = FieldIndexContextType[FieldIndex];
+        plan->ContextType = FieldIndexContextType[plan->FieldIndex];
 
         for( i=0; (i < FIELD_CONSTANTS); i++ )
         {
-            ContextConstants[i] = FieldIndexContextConstants[FieldIndex][i];
+            plan->ContextConstants[i] = FieldIndexContextConstants[plan->FieldIndex][i];
         }
 
-        TargetAngle = ContextConstants[0];
-        SymmetryAxisAngle = ContextConstants[1];
-        TargetResolveDistance = ContextConstants[2];
-        MovementOrderType = (int)ContextConstants[3];
-        ChannelOrderType = (int)ContextConstants[4];
+        plan->TargetAngle = plan->ContextConstants[0];
+        plan->SymmetryAxisAngle = plan->ContextConstants[1];
+        plan->TargetResolveDistance = plan->ContextConstants[2];
+        plan->MovementOrderType = (int)plan->ContextConstants[3];
+        plan->ChannelOrderType = (int)plan->ContextConstants[4];
 
-        switch( MovementOrderType )
+        switch( plan->MovementOrderType )
         {
             case ORDER_FOLLOW_THROUGH :
-                StartPosition = ViaPosition - TargetAngleVector(SymmetryAxisAngle,MovementFirstDistance);
-                TargetPosition = ViaPosition + TargetAngleVector(SymmetryAxisAngle+TargetAngle,MovementSecondDistance);
+                plan->StartPosition = via - TrialPlanAngleVector(plan->SymmetryAxisAngle,MovementFirstDistance);
+                plan->TargetPosition = via + TrialPlanAngleVector(plan->SymmetryAxisAngle+plan->TargetAngle,MovementSecondDistance);
                 break;
 
             case ORDER_LEAD_IN :
-                StartPosition = ViaPosition - TargetAngleVector(SymmetryAxisAngle+TargetAngle,MovementFirstDistance);
-                TargetPosition = ViaPosition + TargetAngleVector(SymmetryAxisAngle,MovementSecondDistance);
+                plan->StartPosition = via - TrialPlanAngleVector(plan->SymmetryAxisAngle+plan->TargetAngle,MovementFirstDistance);
+                plan->TargetPosition = via + TrialPlanAngleVector(plan->SymmetryAxisAngle,MovementSecondDistance);
                 break;
 
             case ORDER_SINGLE_MOVEMENT :
+                // For the rest of the configuration file, as before.
                 MovementSecondDistance = MovementFirstDistance;
 
-                StartPosition = ViaPosition;
-                TargetPosition = ViaPosition + TargetAngleVector(SymmetryAxisAngle+TargetAngle,MovementSecondDistance);
+                plan->StartPosition = via;
+                plan->TargetPosition = via + TrialPlanAngleVector(plan->SymmetryAxisAngle+plan->TargetAngle,MovementSecondDistance);
                 break;
         }
 
+        plan->MovementSecondDistance = MovementSecondDistance;
+
         switch( MovementType )
         {
             case MOVETYPE_OUTANDBACK :
-                FinishPosition = StartPosition;
+                plan->FinishPosition = plan->StartPosition;
                 break;
 
             case MOVETYPE_OUTTHENBACK :
             case MOVETYPE_OUTONLY :
-                FinishPosition = TargetPosition;
+                plan->FinishPosition = plan->TargetPosition;
                 break;
         }
 
         // Is it a single movement only to central target?
-        if( !ContextFullMovementFlag[ContextType] && (MovementOrderType != ORDER_SINGLE_MOVEMENT) )
+        if( !ContextFullMovementFlag[plan->ContextType] && (plan->MovementOrderType != ORDER_SINGLE_MOVEMENT) )
         {
-            FinishPosition = ViaPosition;
+            plan->FinishPosition = via;
         }
 
         // Move direction (Out,Back,OutAndBack).
-        MovementDirection = MoveTypeDirection[MovementType];
+        plan->MovementDirection = MoveTypeDirection[MovementType];
+
+        plan->TrialDelay = TrialDelay;
 
         if( TrialDelayLambda != 0.0 )
         {
             // Code from RandomDotsTask for "exponential delay time".
             do
             {
-                TrialDelay = TrialDelayOffset + (-1.0 * log(RandomUniform(0.00001,1.0))) / TrialDelayLambda;
+                plan->TrialDelay = TrialDelayOffset + (-1.0 * log(RandomUniform(0.00001,1.0))) / TrialDelayLambda;
             }
-            while( TrialDelay > TrialDelayMax );
+            while( plan->TrialDelay > TrialDelayMax );
         }
 
-        // Save TrialData row for this trial.
-        TrialData.RowSave(TrialOffset+Trial);
+        plan->PassiveWaitFirstFlag = FALSE;
+        plan->PassiveWaitLastFlag = FALSE;
 
         // Increment trial number depending on movement type...
         Trial += MoveTypeTrials[MovementType];
@@ -2970,7 +4006,125 @@ int i;
 
 /******************************************************************************/
 
-BOOL TrialList( void )
+// Add the "back" movements (JNI 31/May/2016) and mark where passive-wait
+// trials start and finish, in one pass over the plan looking one trial behind
+// and one ahead. Returns the number of trials (odd if there are back
+// movements, so the last even-numbered trial is ignored).
+
+int TrialPlanFinish( std::vector<TRIALPLAN> &plan, int trials, BOOL back, int fieldtrials[] )
+{
+TRIALPLAN *last,*move,*next;
+int trial,i;
+
+    if( back && ((trials%2) == 0) )
+    {
+        trials--;
+    }
+
+    for( trial=1; (trial <= (trials-2)); trial+=2 )
+    {
+        last = &plan[trial];
+        move = &plan[trial+1];
+        next = &plan[trial+2];
+
+        // Turn a copy of the next trial into a passive "back" movement to its start position.
+        if( back )
+        {
+            *move = *next;
+            move->Made = TRUE;
+            move->MovementDirection = MOVEDIR_BACK;
+
+            move->FieldType = FIELD_PMOVE;
+            fieldtrials[move->FieldType]++;
+
+            move->FieldAngle = 0.0;
+
+            for( i=0; (i < FIELD_CONSTANTS); i++ )
+            {
+                move->FieldConstants[i] = 0.0;
+            }
+
+            move->ContextType = PASSIVE_MOVE;
+            move->FinishPosition = next->StartPosition;
+        }
+
+        if( (last->ContextType != PASSIVE_WAIT) && (next->ContextType == PASSIVE_WAIT) )
+        {
+            next->PassiveWaitFirstFlag = TRUE;
+        }
+
+        if( (last->ContextType == PASSIVE_WAIT) && (next->ContextType != PASSIVE_WAIT) )
+        {
+            last->PassiveWaitLastFlag = TRUE;
+        }
+
+        if( (last->ContextType == PASSIVE_WAIT) && (next->ContextType == PASSIVE_WAIT) && (move->FieldType == FIELD_PMOVE) && !move->PassiveWaitLastFlag )
+        {
+            move->FieldType = FIELD_SAMEASLAST;
+        }
+    }
+
+    return(trials);
+}
+
+/******************************************************************************/
+
+// Save the plan to TrialData, one row for each trial that was made.
+
+void TrialPlanSave( void )
+{
+const TRIALPLAN *plan;
+int width,trial,i;
+
+    width = TrialColumns.GetWidth();
+
+    for( trial=1; (trial < (int)TrialPlan.size()); trial++ )
+    {
+        plan = &TrialPlan[trial];
+
+        if( !plan->Made )
+        {
+            continue;
+        }
+
+        // Variables of the configuration file, then those of the trial.
+        TrialColumns.Store(&TrialPlanConfig[plan->Config * width]);
+
+        PhaseIndex = plan->PhaseIndex;
+        TrialPhase = plan->TrialPhase;
+        FieldIndex = plan->FieldIndex;
+        FieldType = plan->FieldType;
+        FieldAngle = plan->FieldAngle;
+
+        for( i=0; (i < FIELD_CONSTANTS); i++ )
+        {
+            FieldConstants[i] = plan->FieldConstants[i];
+            ContextConstants[i] = plan->ContextConstants[i];
+        }
+
+        ContextType = plan->ContextType;
+        TargetAngle = plan->TargetAngle;
+        SymmetryAxisAngle = plan->SymmetryAxisAngle;
+        TargetResolveDistance = plan->TargetResolveDistance;
+        MovementOrderType = plan->MovementOrderType;
+        ChannelOrderType = plan->ChannelOrderType;
+        MovementSecondDistance = plan->MovementSecondDistance;
+        MovementDirection = plan->MovementDirection;
+        TrialDelay = plan->TrialDelay;
+        PassiveWaitFirstFlag = plan->PassiveWaitFirstFlag;
+        PassiveWaitLastFlag = plan->PassiveWaitLastFlag;
+
+        VEC3_put(StartPosition,plan->StartPosition);
+        VEC3_put(TargetPosition,plan->TargetPosition);
+        VEC3_put(FinishPosition,plan->FinishPosition);
+
+        TrialData.RowSave(trial);
+    }
+}
+
+/******************************************************************************/
+
+BOOL TrialListMake( void )
 {
 int i;
 BOOL ok=TRUE;
@@ -3019,6 +4173,7 @@ BOOL ok=TRUE;
 
     // Set rows of TrialData to the number of trials.
     TrialData.SetRows(TotalTrials);
+    TrialPlanStart(TotalTrials);
 
     printf("Making list of %d trials (ESCape to abort)...\n",TotalTrials);
 
@@ -3051,80 +4206,122 @@ BOOL ok=TRUE;
         //printf("%d %s Trials=%d TotalTrials=%d\n",ConfigIndex,ConfigFileList[ConfigIndex],Trials,TotalTrials);
     }
 
-    // Create the "back" movements here (JNI 31/May/2016).
-    if( MovementType != MOVETYPE_OUTANDBACK )
+    if( !ok )
     {
-        // Make sure we have an odd number of trials...
-        if( (TotalTrials%2) == 0 )
+        return(FALSE);
+    }
+
+    // Create the "back" movements, etc., and save the list to TrialData.
+    TotalTrials = TrialPlanFinish(TrialPlan,TotalTrials,(MovementType != MOVETYPE_OUTANDBACK),FieldTrials);
+    TrialPlanSave();
+
+    return(TRUE);
+}
+
+/******************************************************************************/
+
+// Key for the cache (the program, data file and configuration files).
+
+BOOL ConfigCacheKey( uint32_t &key )
+{
+static const char build[]=MODULE_NAME " " __DATE__ " " __TIME__;
+int i,width;
+
+    width = TrialColumns.GetWidth();
+
+    key = JOURNAL_Hash(build,strlen(build));
+    key = JOURNAL_Hash(DataFile,strlen(DataFile),key);
+    key = JOURNAL_Hash(&width,sizeof(width),key);
+
+    for( i=0; (i < ConfigFileCount); i++ )
+    {
+        key = JOURNAL_Hash(ConfigFileList[i],strlen(ConfigFileList[i]),key);
+
+        if( !CFGCACHE_FileHash(ConfigFileList[i],key) )
         {
-            // Ignore the last even-numbered trial...
-            TotalTrials--;
+            return(FALSE);
         }
+    }
 
-        // Start at the last trial and work backwards...
-        for( Trial=TotalTrials; (Trial >= 2); ) 
-        {
-            // Load the odd numbered trial and decrement the trial number.
-            TrialData.RowLoad(Trial);
-            Trial--;
+    return(TRUE);
+}
 
-            // Make changes here to turn trial into a "back" movement...
-            MovementDirection = MOVEDIR_BACK;
+/******************************************************************************/
 
-            FieldType = FIELD_PMOVE;
-            FieldTrials[FieldType]++;
+// Configuration and trial list from the cache, if it was saved with the same
+// configuration files (each row of TrialData as in the journal).
 
-            FieldAngle = 0.0;
+BOOL ConfigCacheLoad( void )
+{
+std::vector<double> list;
+uint32_t key;
+int width,rows,row;
 
-            for( i=0; (i < FIELD_CONSTANTS); i++ )
-            {
-                FieldConstants[i] = 0.0;
-            }	
+    if( !ConfigCacheKey(key) || !ConfigCache.Load(ConfigCacheFile,key,list) )
+    {
+        return(FALSE);
+    }
 
-            ContextType = PASSIVE_MOVE;
+    width = TrialColumns.GetWidth();
+    rows = (int)list[0];
 
-            // Set finish position of this trial to home position of the next trial.
-            FinishPosition = StartPosition;
-          
-            // Save the even numbered "back" trial and decrement trial number.
-            TrialData.RowSave(Trial);
-            Trial--;
-        }
+    TrialData.SetRows(rows);
+
+    for( row=1; (row <= rows); row++ )
+    {
+        TrialColumns.Store(&list[1 + ((row-1) * width)]);
+        TrialData.RowSave(row);
     }
 
-    for( Trial=1; (Trial <= (TotalTrials-2)); Trial+=2 )
+    return(TRUE);
+}
+
+/******************************************************************************/
+
+void ConfigCacheSave( void )
+{
+std::vector<double> list;
+uint32_t key;
+int width,rows,row;
+
+    width = TrialColumns.GetWidth();
+    rows = TrialData.GetRows();
+
+    list.resize(1 + (rows * width));
+    list[0] = (double)rows;
+
+    for( row=1; (row <= rows); row++ )
     {
-        TrialData.RowLoad(Trial);
-        ContextTypeLast = ContextType;
-        TrialData.RowLoad(Trial+2);
-        ContextTypeNext = ContextType;
+        TrialData.RowLoad(row);
+        TrialColumns.Sample(&list[1 + ((row-1) * width)]);
+    }
 
-        if( (ContextTypeLast != PASSIVE_WAIT) && (ContextType == PASSIVE_WAIT) )
-        {
-            TrialData.RowLoad(Trial+2);
-            PassiveWaitFirstFlag = TRUE;
-            TrialData.RowSave(Trial+2);
-        }
+    if( !ConfigCacheKey(key) || !ConfigCache.Save(ConfigCacheFile,key,list) )
+    {
+        printf("CFGCACHE: Cannot write %s.\n",ConfigCacheFile);
+    }
+}
 
-        if( (ContextTypeLast == PASSIVE_WAIT) && (ContextType != PASSIVE_WAIT) )
-        {
-            TrialData.RowLoad(Trial);
-            PassiveWaitLastFlag = TRUE;
-            TrialData.RowSave(Trial);
-        }
+/******************************************************************************/
 
-        TrialData.RowLoad(Trial+1);
+BOOL TrialList( void )
+{
+int i;
+BOOL ok=TRUE;
 
-        if( (ContextTypeLast == PASSIVE_WAIT) && (ContextTypeNext == PASSIVE_WAIT) && (FieldType == FIELD_PMOVE) && !PassiveWaitLastFlag )
+    // Configuration files not changed since the cache was saved?
+    if( ConfigCacheLoad() )
+    {
+        printf("CFGCACHE: %s Trials=%d (configuration not changed).\n",ConfigCacheFile,TrialData.GetRows());
+    }
+    else
+    {
+        if( !TrialListMake() )
         {
-            FieldType = FIELD_SAMEASLAST;
-            TrialData.RowSave(Trial+1);
+            return(FALSE);
         }
-    }
 
-    if( !ok )
-    {
-        return(FALSE);
+        ConfigCacheSave();
     }
 
     printf("RestBreakCount = %d\n",RestBreakCount);
@@ -3136,12 +4333,26 @@ BOOL ok=TRUE;
     // Total number of trails.
     Trials = TotalTrials;
 
+    // Restore an interrupted session from the journal, or start a new journal.
+    if( JournalResumeFlag )
+    {
+        if( !JournalResume() )
+        {
+            return(FALSE);
+        }
+    }
+    else
+    if( !JournalStart() )
+    {
+        printf("JOURNAL: Cannot create %s (session cannot be resumed).\n",JournalFile);
+    }
+
     // Save trial list to file.
     ok = DATAFILE_Save(TrialListFile,TrialData);
     printf("%s %s Trials=%d.\n",TrialListFile,STR_OkFailed(ok),TrialData.GetRows());
 
-    // Reset trial number, etc.
-    Trial = 1;
+    // Reset trial number (next trial if resuming), etc.
+    Trial = JournalTrialLast + 1;
     TrialSetup();
 
     StateNext(STATE_INITIALIZE);
@@ -3153,12 +4364,18 @@ BOOL ok=TRUE;
 
 void main( int argc, char *argv[] )
 {
+    // Resume an interrupted session (not a MOTOR.LIB parameter).
+    JournalResumeFlag = JOURNAL_Parameter(argc,argv,"/resume");
+
     // Initialize MOTOR.LIB, command-line parameters, configuration files, etc.
     if( !MOTOR_Parameters(argc,argv,DataName,DataFile,TrialListFile,ConfigFileCount,ConfigFileList) )
     {
         exit(0);
     }
 
+    snprintf(JournalFile,sizeof(JournalFile),"%s.journal",DataFile);
+    snprintf(ConfigCacheFile,sizeof(ConfigCacheFile),"%s.cfgcache",DataFile);
+
     // Initialize variables, etc.
     if( !Initialize() )
     {
@@ -3172,6 +4389,12 @@ void main( int argc, char *argv[] )
         ProgramExit();
     }
 
+    // Messages from the robot loop are written by a background thread.
+    LOOPLOG_Start();
+
+    // Trial data files are written by a background thread.
+    TRIALWRITER_Start();
+
     // Start the robot.
     if( DeviceStart() )
     {
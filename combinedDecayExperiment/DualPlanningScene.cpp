@@ -0,0 +1,264 @@
+/******************************************************************************/
+/*                                                                            */
+/* MODULE  : DualPlanningScene.cpp                                            */
+/*                                                                            */
+/* PURPOSE : Graphics scene of DualPlanningClean, shared with the tools.      */
+/*                                                                            */
+/* DATE    : 17/Oct/2026                                                      */
+/*                                                                            */
+/* CHANGES                                                                    */
+/*                                                                            */
+/* V1.0  HRS 17/Oct/2026 - Initial development.                               */
+/*                                                                            */
+/******************************************************************************/
+
+#include <math.h>
+#include <string.h>
+
+#include "DualPlanningScene.h"
+
+/******************************************************************************/
+
+#define SCENE_D2R(d)       ((d) * (3.14159265358979323846 / 180.0))
+
+#define SCENE_TEXTSCALE    0.01             // Stroke font units to cm.
+
+/******************************************************************************/
+
+static VEC3 SCENE_AngleVector( double angle, double distance )
+{
+    // Same as TargetAngleVector().
+    return(VEC3(distance * sin(SCENE_D2R(angle)),distance * cos(SCENE_D2R(angle)),0.0));
+}
+
+/******************************************************************************/
+
+static VEC3 SCENE_Plane( const VEC3 &posn, double z )
+{
+    return(VEC3(posn(1),posn(2),z));
+}
+
+/******************************************************************************/
+
+static bool SCENE_Home( const SCENE &scene, const VEC3 &home )
+{
+    // Same as RobotHome().
+    return(norm(scene.RobotPosition - home) <= scene.StartTolerance);
+}
+
+/******************************************************************************/
+
+static void SCENE_Text( const SCENE &scene )
+{
+VEC3 p;
+int w;
+
+    if( (scene.Text == NULL) || (scene.Text[0] == 0) )
+    {
+        return;
+    }
+
+    // Roughly centred on the text position (half the characters to the left).
+    p = scene.TextPosition;
+    w = strlen(scene.Text);
+
+    p(1) -= (double)(w / 2) * (SCENE_TEXTSCALE * 100.0);
+
+    SCENE_String(p,SCENE_TEXTSCALE,scene.Text,scene.TextColor);
+}
+
+/******************************************************************************/
+
+static void SCENE_Target( SCENE &scene )
+{
+static MAT3 R;
+VEC3 posn;
+double StartToCentralDistance;
+bool DisplayTargetFlag;
+bool FilledTargetFlag;
+bool DualTargetFlag;
+int attr;
+
+    if( (scene.FieldType == FIELD_PMOVE) || (scene.ContextType == PASSIVE_MOVE) )
+    {
+        // Deliberate mixture of finish and start variables for passive-return trials.
+        attr = SCENE_Home(scene,scene.FinishPosition) ? scene.StartColor : scene.NotStartColor;
+
+        SCENE_Circle(SCENE_Plane(scene.FinishPosition,0.0),scene.StartRadius,attr);
+
+        return;
+    }
+
+    // Display via point for movement.
+    posn = SCENE_Plane(scene.ViaPosition,0.0);
+
+    if( scene.ContextType != PASSIVE_WAIT )
+    {
+        switch( scene.ViaType )
+        {
+            case VIA_CIRCLE :
+                SCENE_Circle(posn,scene.ViaRadius,scene.ViaColor);
+                break;
+
+            case VIA_RECTANGLE :
+                SCENE_Rectangle(posn,scene.ViaWidth,scene.ViaHeight,scene.ViaColor);
+                break;
+        }
+    }
+
+    switch( scene.MovementOrderType )
+    {
+        case ORDER_FOLLOW_THROUGH :
+            MAT3_romxZ(SCENE_D2R(scene.SymmetryAxisAngle),R);
+            break;
+
+        case ORDER_LEAD_IN :
+            MAT3_romxZ(SCENE_D2R(scene.SymmetryAxisAngle+scene.TargetAngle),R);
+            break;
+
+        case ORDER_SINGLE_MOVEMENT :
+            // This isn't used in current paradigm so hasnt' been tested.
+            MAT3_romxZ(SCENE_D2R(scene.SymmetryAxisAngle+scene.TargetAngle),R);
+            break;
+    }
+
+    posn = R * (scene.RobotPosition - scene.StartPosition);
+    StartToCentralDistance = posn(2);
+
+    DisplayTargetFlag = false;
+    FilledTargetFlag = true;
+    DualTargetFlag = false;
+
+    switch( scene.ContextType )
+    {
+        case TARGET_STATIC_ON :
+            DisplayTargetFlag = true;
+            break;
+
+        case TARGET_APPEAR :
+            if( !scene.TargetResolveFlag )
+            {
+                scene.TargetResolveFlag = (StartToCentralDistance > scene.TargetResolveDistance);
+            }
+
+            DisplayTargetFlag = scene.TargetResolveFlag;
+            break;
+
+        case TARGET_STOP :
+            if( !scene.TargetResolveFlag )
+            {
+                scene.TargetResolveFlag = (StartToCentralDistance > scene.TargetResolveDistance);
+            }
+
+            DisplayTargetFlag = !scene.TargetResolveFlag;
+            break;
+
+        case TARGET_CENTRAL_ONLY :
+            DisplayTargetFlag = false;
+            break;
+
+        case TARGET_VISUAL_ONLY :
+            DisplayTargetFlag = true;
+            break;
+
+        case TARGET_DUAL_OFF :
+            if( !scene.TargetResolveFlag )
+            {
+                scene.TargetResolveFlag = (StartToCentralDistance > scene.TargetResolveDistance);
+            }
+
+            DisplayTargetFlag = !scene.TargetResolveFlag;
+            DualTargetFlag = DisplayTargetFlag;
+            break;
+
+        case DUAL_PLANNING :
+            if( !scene.TargetResolveFlag )
+            {
+                scene.TargetResolveFlag = (StartToCentralDistance > scene.TargetResolveDistance);
+            }
+
+            DisplayTargetFlag = true;
+            DualTargetFlag = !scene.TargetResolveFlag;
+            break;
+
+        case TARGET_STATIC_GO :
+            DisplayTargetFlag = true;
+            FilledTargetFlag = (scene.State >= STATE_GO);
+            break;
+
+        case DUAL_PLANNING_GO :
+            DisplayTargetFlag = true;
+            FilledTargetFlag = (scene.State >= STATE_GO);
+            DualTargetFlag = true;
+            break;
+
+        case PASSIVE_WAIT :
+            // Show only the home position.
+            break;
+    }
+
+    if( DisplayTargetFlag )
+    {
+        if( FilledTargetFlag )
+        {
+            SCENE_Circle(scene.TargetPosition,scene.TargetRadius,scene.TargetColor);
+        }
+        else
+        {
+            SCENE_Ring(scene.TargetPosition,scene.TargetRadius,scene.TargetOutlineWidth,scene.TargetColor);
+        }
+    }
+
+    if( DualTargetFlag )
+    {
+        posn = scene.ViaPosition + SCENE_AngleVector(scene.SymmetryAxisAngle-scene.TargetAngle,scene.MovementSecondDistance);
+
+        if( FilledTargetFlag && (scene.ContextType != DUAL_PLANNING_GO) )
+        {
+            SCENE_Circle(posn,scene.TargetRadius,scene.TargetColor);
+        }
+        else
+        {
+            SCENE_Ring(posn,scene.TargetRadius,scene.TargetOutlineWidth,scene.TargetColor);
+        }
+    }
+}
+
+/******************************************************************************/
+
+void SCENE_Draw( SCENE &scene )
+{
+int attr;
+
+    // Display text.
+    SCENE_Text(scene);
+
+    // Display rotating teapot during rest period.
+    if( scene.State == STATE_REST )
+    {
+        SCENE_Teapot(scene.TeapotSize,scene.TeapotAngle,scene.TextColor);
+        return;
+    }
+
+    // Display home position at start of trial.
+    if( (scene.State >= STATE_SETUP) && (scene.State <= STATE_INTERTRIAL) && (scene.FieldType != FIELD_PMOVE) )
+    {
+        attr = SCENE_Home(scene,scene.StartPosition) ? scene.StartColor : scene.NotStartColor;
+
+        SCENE_Circle(SCENE_Plane(scene.StartPosition,0.0),scene.StartRadius,attr);
+    }
+
+    // Display targets when trial running.
+    if( (scene.State >= STATE_START) && (scene.State <= STATE_INTERTRIAL) )
+    {
+        SCENE_Target(scene);
+    }
+
+    // Display robot position cursor.
+    if( scene.State != STATE_ERROR )
+    {
+        SCENE_Circle(SCENE_Plane(scene.CursorPosition,1.0),scene.CursorRadius,scene.CursorColor);
+    }
+}
+
+/******************************************************************************/
@@ -0,0 +1,162 @@
+/******************************************************************************/
+/*                                                                            */
+/* MODULE  : DualPlanningScene.h                                              */
+/*                                                                            */
+/* PURPOSE : Graphics scene of DualPlanningClean, shared with the tools.      */
+/*                                                                            */
+/* DATE    : 17/Oct/2026                                                      */
+/*                                                                            */
+/* CHANGES                                                                    */
+/*                                                                            */
+/* V1.0  HRS 17/Oct/2026 - Initial development.                               */
+/*                                                                            */
+/******************************************************************************/
+
+// SCENE_Draw() is what GraphicsDisplayScene() draws for a frame: the text,
+// the home position, the via point and targets for the context type, the
+// cursor and the teapot during a rest break. It only decides what is drawn
+// where; the drawing is done by the SCENE_Circle(), etc., functions below,
+// which each program provides. DualPlanningClean.cpp draws with OpenGL
+// (GLCACHE), tools/drawbench.cpp with SWGRAPH, so the benchmark draws the
+// same scene as the experiment.
+//
+// Positions are in cm. Colours are passed through to the drawing functions
+// as they are (GRAPHICS colour codes in the experiment, 0xRRGGBB in SWGRAPH).
+
+#ifndef DUALPLANNINGSCENE_H
+#define DUALPLANNINGSCENE_H
+
+#include "../common/vec3.h"
+
+/******************************************************************************/
+
+// States.
+#define STATE_INITIALIZE     0
+#define STATE_SETUP          1
+#define STATE_HOME           2
+#define STATE_START          3
+#define STATE_DELAY          4
+#define STATE_GO             5
+#define STATE_MOVEWAIT       6
+#define STATE_MOVING0        7
+#define STATE_VIAPOINT       8
+#define STATE_MOVING1        9
+#define STATE_POSTMOVEDELAY 10
+#define STATE_FINISH        11
+#define STATE_FEEDBACK	    12
+#define STATE_NEXT          13
+#define STATE_INTERTRIAL    14
+#define STATE_EXIT          15
+#define STATE_TIMEOUT       16
+#define STATE_ERROR         17
+#define STATE_REST          18
+#define STATE_MAX           19
+
+// Field types.
+#define FIELD_NONE       0
+#define FIELD_VISCOUS    1
+#define FIELD_CHANNEL    2
+#define FIELD_PMOVE      3
+#define FIELD_2DSPRING   4
+#define FIELD_SAMEASLAST 5
+#define FIELD_MAX        6
+
+// Target context types.
+#define TARGET_STATIC_ON	0
+#define TARGET_APPEAR		1
+#define TARGET_STOP		2
+#define TARGET_CENTRAL_ONLY	3
+#define TARGET_VISUAL_ONLY	4
+#define TARGET_DUAL_OFF	        5
+#define DUAL_PLANNING           6
+#define TARGET_STATIC_GO	7
+#define DUAL_PLANNING_GO        8
+#define PASSIVE_WAIT		9
+#define PASSIVE_MOVE		10
+
+// Movement order types.
+#define ORDER_FOLLOW_THROUGH  0
+#define ORDER_LEAD_IN         1
+#define ORDER_SINGLE_MOVEMENT 2
+
+// Channel order types.
+#define CHANNEL_FIRST  0
+#define CHANNEL_SECOND 1
+
+// Via point types.
+#define VIA_CIRCLE    0
+#define VIA_RECTANGLE 1
+
+/******************************************************************************/
+
+struct SCENE
+{
+    int     State;                  // StateGraphics.
+    int     FieldType;
+    int     ContextType;
+    int     MovementOrderType;
+    int     ViaType;
+
+    VEC3    RobotPosition;
+    VEC3    CursorPosition;
+    VEC3    StartPosition;
+    VEC3    FinishPosition;
+    VEC3    ViaPosition;
+    VEC3    TargetPosition;
+    VEC3    TextPosition;
+
+    double  SymmetryAxisAngle;      // Degrees.
+    double  TargetAngle;            // Degrees.
+    double  MovementSecondDistance;
+    double  TargetResolveDistance;
+
+    double  StartRadius;
+    double  StartTolerance;
+    double  ViaRadius;
+    double  ViaWidth;
+    double  ViaHeight;
+    double  TargetRadius;
+    double  TargetOutlineWidth;
+    double  CursorRadius;
+
+    int     StartColor;
+    int     NotStartColor;
+    int     ViaColor;
+    int     TargetColor;
+    int     CursorColor;
+    int     TextColor;              // Also the teapot.
+
+    const char *Text;               // NULL or "" for none.
+
+    double  TeapotSize;             // Rest break teapot (cm).
+    double  TeapotAngle;            // Degrees.
+
+    // Set once the robot has moved TargetResolveDistance along the symmetry
+    // axis, for the context types that change then. Reset for each trial.
+    bool    TargetResolveFlag;
+};
+
+/******************************************************************************/
+
+void SCENE_Draw( SCENE &scene );
+
+// Provided by the program drawing the scene.
+
+// Filled circle (GRAPHICS_Circle()).
+void SCENE_Circle( const VEC3 &posn, double radius, int color );
+
+// Ring from radius-width to radius (GraphicsDisplayRing()).
+void SCENE_Ring( const VEC3 &posn, double radius, double width, int color );
+
+// Filled rectangle centred on posn (GRAPHICS_Rectangle()).
+void SCENE_Rectangle( const VEC3 &posn, double width, double height, int color );
+
+// Stroke text (GLUT_STROKE_MONO_ROMAN) starting at posn, scaled from font units to cm.
+void SCENE_String( const VEC3 &posn, double scale, const char *text, int color );
+
+// Wire teapot rotated about (1,1,1).
+void SCENE_Teapot( double size, double angle, int color );
+
+/******************************************************************************/
+
+#endif
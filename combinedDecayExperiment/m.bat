@@ -1,3 +1,5 @@
 U:\Experiments\MemoryDecay\CleanVersion\DualPlanningClean /m:%1 /d:t:\%2 %3 %4 %5
 rem U:\Experiments\MemoryDecay\CleanVersion\Previous\DualPlanningClean /m:%1 /d:t:\%2 %3 %4 %5
 copy t:\%2*.dat .\data
+copy t:\%2*.col .\data
+copy t:\%2*.index .\data
@@ -0,0 +1,278 @@
+/******************************************************************************/
+/*                                                                            */
+/* MODULE  : cfgcache.cpp                                                     */
+/*                                                                            */
+/* PURPOSE : Binary cache of the configuration and trial list.                */
+/*                                                                            */
+/* DATE    : 17/Oct/2026                                                      */
+/*                                                                            */
+/* CHANGES                                                                    */
+/*                                                                            */
+/* V1.0  HRS 17/Oct/2026 - Initial development.                               */
+/*                                                                            */
+/******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+
+#include <string>
+
+#include "journal.h"
+#include "cfgcache.h"
+
+/******************************************************************************/
+
+void CFGCACHE::Reset( void )
+{
+    Item.clear();
+}
+
+/******************************************************************************/
+
+void CFGCACHE::AddBytes( void *variable, int bytes )
+{
+ITEM item;
+
+    item.Variable = variable;
+    item.Bytes = bytes;
+    item.Count = NULL;
+    item.Sample = NULL;
+    item.Store = NULL;
+
+    Item.push_back(item);
+}
+
+/******************************************************************************/
+
+void CFGCACHE::Add( double &variable )
+{
+    AddBytes(&variable,sizeof(double));
+}
+
+/******************************************************************************/
+
+void CFGCACHE::Add( int &variable )
+{
+    AddBytes(&variable,sizeof(int));
+}
+
+/******************************************************************************/
+
+void CFGCACHE::Add( double *variable, int count )
+{
+    AddBytes(variable,count * sizeof(double));
+}
+
+/******************************************************************************/
+
+void CFGCACHE::Add( int *variable, int count )
+{
+    AddBytes(variable,count * sizeof(int));
+}
+
+/******************************************************************************/
+
+int CFGCACHE::Variables( void )
+{
+    return((int)Item.size());
+}
+
+/******************************************************************************/
+
+int CFGCACHE::ItemBytes( const ITEM &item )
+{
+    return((item.Count == NULL) ? item.Bytes : (item.Count(item.Variable) * (int)sizeof(double)));
+}
+
+/******************************************************************************/
+
+uint32_t CFGCACHE::Layout( void )
+{
+uint32_t hash=JOURNAL_HASH;
+int i,bytes;
+
+    for( i=0; (i < (int)Item.size()); i++ )
+    {
+        bytes = ItemBytes(Item[i]);
+        hash = JOURNAL_Hash(&bytes,sizeof(bytes),hash);
+    }
+
+    return(hash);
+}
+
+/******************************************************************************/
+
+bool CFGCACHE::Save( const char *file, uint32_t key, const std::vector<double> &list )
+{
+CFGCACHE_HEADER header;
+std::vector<char> value;
+std::vector<double> element;
+std::string part;
+FILE *FP;
+int i,bytes,offset;
+bool ok;
+
+    // Values of the variables, one after the other.
+    for( bytes=0,i=0; (i < (int)Item.size()); i++ )
+    {
+        bytes += ItemBytes(Item[i]);
+    }
+
+    value.resize(bytes);
+
+    for( offset=0,i=0; (i < (int)Item.size()); i++ )
+    {
+        bytes = ItemBytes(Item[i]);
+
+        if( Item[i].Count == NULL )
+        {
+            memcpy(&value[offset],Item[i].Variable,bytes);
+        }
+        else
+        {
+            // Through a buffer of doubles, as the value may not be aligned.
+            element.resize(bytes / sizeof(double));
+            Item[i].Sample(Item[i].Variable,element.data(),(int)element.size());
+            memcpy(&value[offset],element.data(),bytes);
+        }
+
+        offset += bytes;
+    }
+
+    memset(&header,0,sizeof(header));
+    memcpy(header.Magic,CFGCACHE_MAGIC,sizeof(header.Magic));
+    header.Version = CFGCACHE_VERSION;
+    header.Key = key;
+    header.Layout = Layout();
+    header.Bytes = (int32_t)value.size();
+    header.Values = (int32_t)list.size();
+
+    header.Check = JOURNAL_Hash(&header,sizeof(header)-sizeof(header.Check));
+    header.Check = JOURNAL_Hash(value.data(),value.size(),header.Check);
+    header.Check = JOURNAL_Hash(list.data(),list.size() * sizeof(double),header.Check);
+
+    part = std::string(file) + ".part";
+
+    if( (FP=fopen(part.c_str(),"wb")) == NULL )
+    {
+        return(false);
+    }
+
+    ok = (fwrite(&header,sizeof(header),1,FP) == 1);
+    ok = ok && ((value.size() == 0) || (fwrite(value.data(),value.size(),1,FP) == 1));
+    ok = ok && ((list.size() == 0) || (fwrite(list.data(),list.size() * sizeof(double),1,FP) == 1));
+    ok = (fclose(FP) == 0) && ok;
+
+    if( !ok )
+    {
+        remove(part.c_str());
+        return(false);
+    }
+
+    remove(file);
+
+    return(rename(part.c_str(),file) == 0);
+}
+
+/******************************************************************************/
+
+bool CFGCACHE::Load( const char *file, uint32_t key, std::vector<double> &list )
+{
+CFGCACHE_HEADER header;
+std::vector<char> value;
+std::vector<double> values,element;
+uint32_t check;
+FILE *FP;
+int i,bytes,offset;
+bool ok;
+
+    if( (FP=fopen(file,"rb")) == NULL )
+    {
+        return(false);
+    }
+
+    ok = (fread(&header,sizeof(header),1,FP) == 1);
+    ok = ok && (memcmp(header.Magic,CFGCACHE_MAGIC,sizeof(header.Magic)) == 0);
+    ok = ok && (header.Version == CFGCACHE_VERSION) && (header.Key == key) && (header.Layout == Layout());
+    ok = ok && (header.Bytes >= 0) && (header.Values >= 0);
+
+    if( ok )
+    {
+        value.resize(header.Bytes);
+        values.resize(header.Values);
+
+        ok = (value.size() == 0) || (fread(value.data(),value.size(),1,FP) == 1);
+        ok = ok && ((values.size() == 0) || (fread(values.data(),values.size() * sizeof(double),1,FP) == 1));
+    }
+
+    fclose(FP);
+
+    if( !ok )
+    {
+        return(false);
+    }
+
+    check = JOURNAL_Hash(&header,sizeof(header)-sizeof(header.Check));
+    check = JOURNAL_Hash(value.data(),value.size(),check);
+    check = JOURNAL_Hash(values.data(),values.size() * sizeof(double),check);
+
+    for( bytes=0,i=0; (i < (int)Item.size()); i++ )
+    {
+        bytes += ItemBytes(Item[i]);
+    }
+
+    if( (check != header.Check) || (bytes != header.Bytes) )
+    {
+        return(false);
+    }
+
+    // The cache is good, so put the values back in the variables.
+    for( offset=0,i=0; (i < (int)Item.size()); i++ )
+    {
+        bytes = ItemBytes(Item[i]);
+
+        if( Item[i].Count == NULL )
+        {
+            memcpy(Item[i].Variable,&value[offset],bytes);
+        }
+        else
+        {
+            element.resize(bytes / sizeof(double));
+            memcpy(element.data(),&value[offset],bytes);
+            Item[i].Store(Item[i].Variable,element.data(),(int)element.size());
+        }
+
+        offset += bytes;
+    }
+
+    list.swap(values);
+
+    return(true);
+}
+
+/******************************************************************************/
+
+bool CFGCACHE_FileHash( const char *file, uint32_t &hash )
+{
+char buffer[64*1024];
+FILE *FP;
+size_t bytes;
+bool ok;
+
+    if( (FP=fopen(file,"rb")) == NULL )
+    {
+        return(false);
+    }
+
+    while( (bytes=fread(buffer,1,sizeof(buffer),FP)) > 0 )
+    {
+        hash = JOURNAL_Hash(buffer,bytes,hash);
+    }
+
+    ok = (ferror(FP) == 0);
+    fclose(FP);
+
+    return(ok);
+}
+
+/******************************************************************************/
@@ -0,0 +1,148 @@
+/******************************************************************************/
+/*                                                                            */
+/* MODULE  : cfgcache.h                                                       */
+/*                                                                            */
+/* PURPOSE : Binary cache of the configuration and trial list.                */
+/*                                                                            */
+/* DATE    : 17/Oct/2026                                                      */
+/*                                                                            */
+/* CHANGES                                                                    */
+/*                                                                            */
+/* V1.0  HRS 17/Oct/2026 - Initial development.                               */
+/*                                                                            */
+/******************************************************************************/
+
+// CFGCACHE has a list of variables (the configuration variables and those
+// worked out from them when the trial list is made). Save() writes their
+// values and the trial list to a cache file and Load() puts them back, but
+// only if the cache was saved with the same key. The key is made from
+// everything the values depend on: the contents of the configuration files
+// (CFGCACHE_FileHash()), the data file and the program build. Editing a
+// configuration file changes the key, so the cache is ignored and made again.
+//
+// The variables must be added in the same order (and with the same sizes)
+// for Save() and Load(), which is checked. The cache is written to a .part
+// file which is renamed when it is complete, and has a check of the whole
+// file, so a cache that wasn't completely written is also ignored.
+
+#ifndef CFGCACHE_H
+#define CFGCACHE_H
+
+#include <stdint.h>
+
+#include <vector>
+
+/******************************************************************************/
+
+#define CFGCACHE_MAGIC     "CFGCACHE"
+#define CFGCACHE_VERSION   1
+
+struct CFGCACHE_HEADER
+{
+    char     Magic[8];
+    int32_t  Version;
+    uint32_t Key;
+    uint32_t Layout;            // Sizes of the variables.
+    int32_t  Bytes;             // Values of the variables.
+    int32_t  Values;            // Trial list (doubles).
+    uint32_t Check;             // JOURNAL_Hash() of the header before Check and the data.
+};
+
+typedef int  (*CFGCACHE_COUNT)( void *variable );
+typedef void (*CFGCACHE_SAMPLE)( void *variable, double *value, int count );
+typedef void (*CFGCACHE_STORE)( void *variable, const double *value, int count );
+
+/******************************************************************************/
+
+class CFGCACHE
+{
+private:
+    struct ITEM
+    {
+        void *Variable;
+        int Bytes;                      // Plain variables are copied as bytes.
+        CFGCACHE_COUNT Count;           // Otherwise, doubles.
+        CFGCACHE_SAMPLE Sample;
+        CFGCACHE_STORE Store;
+    };
+
+    std::vector<ITEM> Item;
+
+    template<class MATRIX> static int CountMatrix( void *variable )
+    {
+        return(((MATRIX *)variable)->rows());
+    }
+
+    template<class MATRIX> static void SampleMatrix( void *variable, double *value, int count )
+    {
+    MATRIX &m=*(MATRIX *)variable;
+    int i;
+
+        for( i=0; (i < count); i++ )
+        {
+            value[i] = m(i+1,1);
+        }
+    }
+
+    template<class MATRIX> static void StoreMatrix( void *variable, const double *value, int count )
+    {
+    MATRIX &m=*(MATRIX *)variable;
+    int i;
+
+        for( i=0; (i < count); i++ )
+        {
+            m(i+1,1) = value[i];
+        }
+    }
+
+    void AddBytes( void *variable, int bytes );
+    int ItemBytes( const ITEM &item );
+    uint32_t Layout( void );
+
+public:
+    // Start the list of variables again.
+    void Reset( void );
+
+    void Add( double &variable );
+    void Add( int &variable );
+    void Add( double *variable, int count );
+    void Add( int *variable, int count );
+
+    // String (e.g., STRING).
+    template<int N> void Add( char (&variable)[N] )
+    {
+        AddBytes(variable,N);
+    }
+
+    // Column vector (MOTOR matrix), which may be resized after it is added.
+    template<class MATRIX> void Add( MATRIX &variable )
+    {
+    ITEM item;
+
+        item.Variable = &variable;
+        item.Bytes = 0;
+        item.Count = CountMatrix<MATRIX>;
+        item.Sample = SampleMatrix<MATRIX>;
+        item.Store = StoreMatrix<MATRIX>;
+
+        Item.push_back(item);
+    }
+
+    int Variables( void );
+
+    // Save the variables and trial list (false if the cache cannot be written).
+    bool Save( const char *file, uint32_t key, const std::vector<double> &list );
+
+    // Load the variables and trial list (false, with nothing changed, if the
+    // cache doesn't exist or isn't for this key and list of variables).
+    bool Load( const char *file, uint32_t key, std::vector<double> &list );
+};
+
+/******************************************************************************/
+
+// Continue a hash with the contents of a file (false if it cannot be read).
+bool CFGCACHE_FileHash( const char *file, uint32_t &hash );
+
+/******************************************************************************/
+
+#endif
@@ -0,0 +1,590 @@
+/******************************************************************************/
+/*                                                                            */
+/* MODULE  : colcodec.cpp                                                     */
+/*                                                                            */
+/* PURPOSE : Lossless compression of columns of doubles (COLFILE).            */
+/*                                                                            */
+/* DATE    : 17/Oct/2026                                                      */
+/*                                                                            */
+/* CHANGES                                                                    */
+/*                                                                            */
+/* V1.0  HRS 17/Oct/2026 - Initial development.                               */
+/*                                                                            */
+/******************************************************************************/
+
+#include <limits.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+
+#include "colcodec.h"
+
+/******************************************************************************/
+
+#define COLCODEC_SYMBOLS    256
+#define COLCODEC_FASTBITS   10      // Decode table size (bits).
+
+/******************************************************************************/
+
+// Differences from the previous row, or from a straight line through the two
+// previous rows (the first rows are left as they are). The bit patterns of
+// doubles with the same sign and exponent are in order, so integer
+// differences of them work for smooth signals.
+
+static void COLCODEC_Transform( const uint64_t *value, int rows, int width, int transform, uint64_t *residual )
+{
+int i,n;
+
+    n = rows * width;
+
+    for( i=0; (i < n); i++ )
+    {
+        if( i < width )
+        {
+            residual[i] = value[i];
+        }
+        else
+        if( transform == COLCODEC_XOR )
+        {
+            residual[i] = value[i] ^ value[i-width];
+        }
+        else
+        if( (transform == COLCODEC_DELTA) || (i < (2*width)) )
+        {
+            residual[i] = value[i] - value[i-width];
+        }
+        else
+        {
+            residual[i] = value[i] - ((2 * value[i-width]) - value[i-(2*width)]);
+        }
+    }
+}
+
+/******************************************************************************/
+
+static void COLCODEC_TransformInverse( uint64_t *value, int rows, int width, int transform )
+{
+int i,n;
+
+    n = rows * width;
+
+    for( i=width; (i < n); i++ )
+    {
+        if( transform == COLCODEC_XOR )
+        {
+            value[i] ^= value[i-width];
+        }
+        else
+        if( (transform == COLCODEC_DELTA) || (i < (2*width)) )
+        {
+            value[i] += value[i-width];
+        }
+        else
+        {
+            value[i] += (2 * value[i-width]) - value[i-(2*width)];
+        }
+    }
+}
+
+/******************************************************************************/
+
+static long COLCODEC_NonZeroBytes( const uint64_t *residual, int n )
+{
+long count;
+uint64_t r;
+int i;
+
+    for( count=0,i=0; (i < n); i++ )
+    {
+        for( r=residual[i]; (r != 0); r >>= 8 )
+        {
+            count += ((r & 0xFF) != 0);
+        }
+    }
+
+    return(count);
+}
+
+/******************************************************************************/
+
+// Huffman code lengths for byte frequencies, limited to COLCODEC_CODEBITS by
+// flattening the frequencies until the tree is shallow enough.
+
+static void COLCODEC_Lengths( const unsigned long *frequency, unsigned char *length )
+{
+typedef std::pair<unsigned long,int> NODE;
+unsigned long weight[COLCODEC_SYMBOLS];
+int parent[2*COLCODEC_SYMBOLS];
+int depth,maximum,nodes,symbols,s,i;
+
+    for( s=0; (s < COLCODEC_SYMBOLS); s++ )
+    {
+        weight[s] = frequency[s];
+    }
+
+    for( ;; )
+    {
+        std::priority_queue<NODE,std::vector<NODE>,std::greater<NODE> > queue;
+
+        memset(length,0,COLCODEC_SYMBOLS);
+
+        for( symbols=0,s=0; (s < COLCODEC_SYMBOLS); s++ )
+        {
+            if( weight[s] != 0 )
+            {
+                queue.push(NODE(weight[s],s));
+                symbols++;
+            }
+        }
+
+        if( symbols == 0 )
+        {
+            return;
+        }
+
+        // A single symbol still needs a one bit code.
+        if( symbols == 1 )
+        {
+            length[queue.top().second] = 1;
+            return;
+        }
+
+        for( nodes=COLCODEC_SYMBOLS; (queue.size() > 1); nodes++ )
+        {
+            NODE x=queue.top();
+            queue.pop();
+            NODE y=queue.top();
+            queue.pop();
+
+            parent[x.second] = nodes;
+            parent[y.second] = nodes;
+            queue.push(NODE(x.first+y.first,nodes));
+        }
+
+        parent[nodes-1] = -1;
+
+        for( maximum=0,s=0; (s < COLCODEC_SYMBOLS); s++ )
+        {
+            if( weight[s] == 0 )
+            {
+                continue;
+            }
+
+            for( depth=0,i=s; (parent[i] != -1); i=parent[i] )
+            {
+                depth++;
+            }
+
+            length[s] = (unsigned char)depth;
+            maximum = std::max(maximum,depth);
+        }
+
+        if( maximum <= COLCODEC_CODEBITS )
+        {
+            return;
+        }
+
+        for( s=0; (s < COLCODEC_SYMBOLS); s++ )
+        {
+            if( weight[s] != 0 )
+            {
+                weight[s] = (weight[s] >> 1) | 1;
+            }
+        }
+    }
+}
+
+/******************************************************************************/
+
+// Canonical codes (shorter codes first, then in symbol order).
+
+static void COLCODEC_Codes( const unsigned char *length, unsigned short *code )
+{
+int count[COLCODEC_CODEBITS+1],next[COLCODEC_CODEBITS+1];
+int s,l,c;
+
+    memset(count,0,sizeof(count));
+
+    for( s=0; (s < COLCODEC_SYMBOLS); s++ )
+    {
+        count[length[s]]++;
+    }
+
+    count[0] = 0;
+
+    for( c=0,l=1; (l <= COLCODEC_CODEBITS); l++ )
+    {
+        c = (c + count[l-1]) << 1;
+        next[l] = c;
+    }
+
+    for( s=0; (s < COLCODEC_SYMBOLS); s++ )
+    {
+        if( length[s] != 0 )
+        {
+            code[s] = (unsigned short)next[length[s]]++;
+        }
+    }
+}
+
+/******************************************************************************/
+
+static void COLCODEC_Plane( const unsigned char *plane, int n, std::vector<unsigned char> &output )
+{
+unsigned long frequency[COLCODEC_SYMBOLS];
+unsigned char length[COLCODEC_SYMBOLS];
+unsigned short code[COLCODEC_SYMBOLS];
+unsigned long long bits,accumulator;
+size_t start,bytes;
+int i,s,count;
+
+    memset(frequency,0,sizeof(frequency));
+
+    for( i=0; (i < n); i++ )
+    {
+        frequency[plane[i]]++;
+    }
+
+    if( frequency[0] == (unsigned long)n )
+    {
+        output.push_back(COLCODEC_ZERO);
+        return;
+    }
+
+    COLCODEC_Lengths(frequency,length);
+
+    for( bits=0,s=0; (s < COLCODEC_SYMBOLS); s++ )
+    {
+        bits += (unsigned long long)frequency[s] * length[s];
+    }
+
+    bytes = (size_t)((bits + 7) / 8);
+
+    if( (COLCODEC_SYMBOLS/2 + 4 + bytes) >= (size_t)n )
+    {
+        output.push_back(COLCODEC_RAW);
+        output.insert(output.end(),plane,plane+n);
+        return;
+    }
+
+    COLCODEC_Codes(length,code);
+
+    output.push_back(COLCODEC_HUFFMAN);
+
+    for( s=0; (s < COLCODEC_SYMBOLS); s += 2 )
+    {
+        output.push_back((unsigned char)(length[s] | (length[s+1] << 4)));
+    }
+
+    for( i=0; (i < 4); i++ )
+    {
+        output.push_back((unsigned char)(bytes >> (8*i)));
+    }
+
+    start = output.size();
+    output.reserve(start + bytes);
+
+    // Codes are written most significant bit first.
+    for( accumulator=0,count=0,i=0; (i < n); i++ )
+    {
+        s = plane[i];
+        accumulator = (accumulator << length[s]) | code[s];
+        count += length[s];
+
+        while( count >= 8 )
+        {
+            count -= 8;
+            output.push_back((unsigned char)(accumulator >> count));
+        }
+
+        accumulator &= (1ULL << count) - 1;
+    }
+
+    if( count > 0 )
+    {
+        output.push_back((unsigned char)(accumulator << (8 - count)));
+    }
+}
+
+/******************************************************************************/
+
+void COLCODEC_Encode( const double *data, int rows, int width, std::vector<unsigned char> &output )
+{
+std::vector<uint64_t> value,residual,trial;
+std::vector<unsigned char> plane;
+long bytes,best;
+int transform,t,i,b,n;
+
+    n = rows * width;
+
+    if( n <= 0 )
+    {
+        output.push_back(COLCODEC_XOR);
+        return;
+    }
+
+    value.resize(n);
+    residual.resize(n);
+    trial.resize(n);
+    plane.resize(n);
+
+    memcpy(value.data(),data,n * sizeof(double));
+
+    // Use whichever difference leaves fewest non-zero bytes.
+    for( transform=0,best=0,t=0; (t < COLCODEC_TRANSFORMS); t++ )
+    {
+        COLCODEC_Transform(value.data(),rows,width,t,trial.data());
+        bytes = COLCODEC_NonZeroBytes(trial.data(),n);
+
+        if( (t == 0) || (bytes < best) )
+        {
+            transform = t;
+            best = bytes;
+            residual.swap(trial);
+        }
+    }
+
+    output.push_back((unsigned char)transform);
+
+    for( b=0; (b < 8); b++ )
+    {
+        for( i=0; (i < n); i++ )
+        {
+            plane[i] = (unsigned char)(residual[i] >> (8*b));
+        }
+
+        COLCODEC_Plane(plane.data(),n,output);
+    }
+}
+
+/******************************************************************************/
+
+static bool COLCODEC_PlaneDecode( const unsigned char *&input, const unsigned char *end, int n, int b, uint64_t *residual )
+{
+unsigned char length[COLCODEC_SYMBOLS];
+unsigned short code[COLCODEC_SYMBOLS];
+unsigned short table[1 << COLCODEC_FASTBITS];
+int count[COLCODEC_CODEBITS+1];
+unsigned char sorted[COLCODEC_SYMBOLS];
+unsigned long long accumulator;
+const unsigned char *bits;
+size_t bytes,position;
+unsigned long kraft;
+int mode,i,s,l,c,have,index,first,fill;
+
+    if( input >= end )
+    {
+        return(false);
+    }
+
+    mode = *input++;
+
+    if( mode == COLCODEC_ZERO )
+    {
+        return(true);
+    }
+
+    if( mode == COLCODEC_RAW )
+    {
+        if( (end - input) < n )
+        {
+            return(false);
+        }
+
+        for( i=0; (i < n); i++ )
+        {
+            residual[i] |= (uint64_t)input[i] << (8*b);
+        }
+
+        input += n;
+        return(true);
+    }
+
+    if( (mode != COLCODEC_HUFFMAN) || ((end - input) < (COLCODEC_SYMBOLS/2 + 4)) )
+    {
+        return(false);
+    }
+
+    for( s=0; (s < COLCODEC_SYMBOLS); s += 2 )
+    {
+        length[s] = *input & 0x0F;
+        length[s+1] = *input >> 4;
+        input++;
+    }
+
+    for( bytes=0,i=0; (i < 4); i++ )
+    {
+        bytes |= (size_t)*input++ << (8*i);
+    }
+
+    if( (size_t)(end - input) < bytes )
+    {
+        return(false);
+    }
+
+    bits = input;
+    input += bytes;
+
+    // Lengths from a damaged file may not be a prefix code (sum of 2^-length
+    // over 1), which would give codes too long for their length.
+    for( kraft=0,s=0; (s < COLCODEC_SYMBOLS); s++ )
+    {
+        if( length[s] != 0 )
+        {
+            kraft += 1UL << (COLCODEC_CODEBITS - length[s]);
+        }
+    }
+
+    if( kraft > (1UL << COLCODEC_CODEBITS) )
+    {
+        return(false);
+    }
+
+    COLCODEC_Codes(length,code);
+
+    // Symbols in canonical order for codes longer than the table.
+    memset(count,0,sizeof(count));
+
+    for( s=0; (s < COLCODEC_SYMBOLS); s++ )
+    {
+        count[length[s]]++;
+    }
+
+    for( index=0,l=1; (l <= COLCODEC_CODEBITS); l++ )
+    {
+        for( s=0; (s < COLCODEC_SYMBOLS); s++ )
+        {
+            if( length[s] == l )
+            {
+                sorted[index++] = (unsigned char)s;
+            }
+        }
+    }
+
+    // Table entries are symbol plus length (0 for longer codes).
+    memset(table,0,sizeof(table));
+
+    for( s=0; (s < COLCODEC_SYMBOLS); s++ )
+    {
+        if( (length[s] == 0) || (length[s] > COLCODEC_FASTBITS) )
+        {
+            continue;
+        }
+
+        fill = 1 << (COLCODEC_FASTBITS - length[s]);
+        index = code[s] << (COLCODEC_FASTBITS - length[s]);
+
+        if( (index + fill) > (1 << COLCODEC_FASTBITS) )
+        {
+            return(false);
+        }
+
+        for( i=0; (i < fill); i++ )
+        {
+            table[index + i] = (unsigned short)(s | (length[s] << 8));
+        }
+    }
+
+    for( accumulator=0,have=0,position=0,i=0; (i < n); i++ )
+    {
+        // Keep at least COLCODEC_CODEBITS bits (zeros after the end).
+        while( have <= 56 )
+        {
+            accumulator = (accumulator << 8) | ((position < bytes) ? bits[position] : 0);
+            position++;
+            have += 8;
+        }
+
+        s = table[(accumulator >> (have - COLCODEC_FASTBITS)) & ((1 << COLCODEC_FASTBITS) - 1)];
+
+        if( s != 0 )
+        {
+            have -= s >> 8;
+            s &= 0xFF;
+        }
+        else
+        {
+            // Canonical decode one bit at a time.
+            for( c=0,first=0,index=0,l=1; (l <= COLCODEC_CODEBITS); l++ )
+            {
+                c |= (int)((accumulator >> --have) & 1);
+
+                if( (c - first) < count[l] )
+                {
+                    break;
+                }
+
+                index += count[l];
+                first = (first + count[l]) << 1;
+                c <<= 1;
+            }
+
+            if( (l > COLCODEC_CODEBITS) || ((index + c - first) >= COLCODEC_SYMBOLS) )
+            {
+                return(false);
+            }
+
+            s = sorted[index + c - first];
+        }
+
+        residual[i] |= (uint64_t)s << (8*b);
+    }
+
+    // Check the codes didn't run past the end.
+    if( (position > bytes) && (((position - bytes) * 8) > (size_t)have) )
+    {
+        return(false);
+    }
+
+    return(true);
+}
+
+/******************************************************************************/
+
+bool COLCODEC_Decode( const unsigned char *input, size_t bytes, int rows, int width, double *data )
+{
+std::vector<uint64_t> residual;
+const unsigned char *end;
+int transform,b,n;
+
+    end = input + bytes;
+
+    if( (bytes < 1) || (rows < 0) || (width < 1) || (rows > (INT_MAX / width)) )
+    {
+        return(false);
+    }
+
+    n = rows * width;
+
+    transform = *input++;
+
+    if( n <= 0 )
+    {
+        return(true);
+    }
+
+    if( (transform < 0) || (transform >= COLCODEC_TRANSFORMS) )
+    {
+        return(false);
+    }
+
+    residual.assign(n,0);
+
+    for( b=0; (b < 8); b++ )
+    {
+        if( !COLCODEC_PlaneDecode(input,end,n,b,residual.data()) )
+        {
+            return(false);
+        }
+    }
+
+    COLCODEC_TransformInverse(residual.data(),rows,width,transform);
+    memcpy(data,residual.data(),n * sizeof(double));
+
+    return(true);
+}
+
+/******************************************************************************/
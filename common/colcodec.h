@@ -0,0 +1,64 @@
+/******************************************************************************/
+/*                                                                            */
+/* MODULE  : colcodec.h                                                       */
+/*                                                                            */
+/* PURPOSE : Lossless compression of columns of doubles (COLFILE).            */
+/*                                                                            */
+/* DATE    : 17/Oct/2026                                                      */
+/*                                                                            */
+/* CHANGES                                                                    */
+/*                                                                            */
+/* V1.0  HRS 17/Oct/2026 - Initial development.                               */
+/*                                                                            */
+/******************************************************************************/
+
+// A block is Rows x Width doubles (the rows of one variable for one trial).
+// Each value is replaced by its difference from the previous row (XOR or
+// integer difference of the bit patterns) or from a straight line through the
+// previous two rows, whichever leaves fewest non-zero bytes. Smooth
+// kinematics then leave mostly zero high-order bytes and constants leave
+// nothing at all. The differences are split into eight
+// byte planes, and each plane is stored as all zero, Huffman coded, or raw
+// (whichever is smallest).
+//
+// Block layout:
+//
+//   uint8   Transform                 COLCODEC_XOR, _DELTA or _LINEAR.
+//   Plane x 8 (least significant byte first):
+//     uint8   Mode                    COLCODEC_ZERO, _HUFFMAN or _RAW.
+//     HUFFMAN: uint8 Lengths[128]     Code length of each byte (4 bits).
+//              uint32 Bytes           Size of coded bits (MSB first).
+//              uint8 Bits[Bytes]
+//     RAW:     uint8 Plane[Rows*Width]
+
+#ifndef COLCODEC_H
+#define COLCODEC_H
+
+#include <stddef.h>
+
+#include <vector>
+
+/******************************************************************************/
+
+#define COLCODEC_XOR        0
+#define COLCODEC_DELTA      1
+#define COLCODEC_LINEAR     2
+#define COLCODEC_TRANSFORMS 3
+
+#define COLCODEC_ZERO       0
+#define COLCODEC_HUFFMAN    1
+#define COLCODEC_RAW        2
+
+#define COLCODEC_CODEBITS   15      // Maximum Huffman code length.
+
+/******************************************************************************/
+
+// Append the compressed block to the output buffer.
+void COLCODEC_Encode( const double *data, int rows, int width, std::vector<unsigned char> &output );
+
+// Decompress a block (returns false if it is not valid).
+bool COLCODEC_Decode( const unsigned char *input, size_t bytes, int rows, int width, double *data );
+
+/******************************************************************************/
+
+#endif
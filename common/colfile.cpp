@@ -0,0 +1,1467 @@
+/******************************************************************************/
+/*                                                                            */
+/* MODULE  : colfile.cpp                                                      */
+/*                                                                            */
+/* PURPOSE : Columnar binary session file (writer and memory-mapped reader).  */
+/*                                                                            */
+/* DATE    : 17/Oct/2026                                                      */
+/*                                                                            */
+/* CHANGES                                                                    */
+/*                                                                            */
+/* V1.0  HRS 17/Oct/2026 - Initial development.                               */
+/*                                                                            */
+/* V1.1  HRS 17/Oct/2026 - Compressed columns (COLCODEC).                     */
+/*                                                                            */
+/* V1.2  HRS 17/Oct/2026 - Sample() and Store() for the session journal.      */
+/*                                                                            */
+/* V1.3  HRS 17/Oct/2026 - RowSave() uses a plan compiled from the variables. */
+/*                                                                            */
+/* V1.4  HRS 17/Oct/2026 - COLFILE_WRITER (more than one file at a time).     */
+/*                                                                            */
+/******************************************************************************/
+
+#if !defined(_WIN32)
+#define _FILE_OFFSET_BITS 64
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "colcodec.h"
+#include "colfile.h"
+
+/******************************************************************************/
+
+static int COLFILE_Seek( FILE *FP, int64_t offset )
+{
+#if defined(_WIN32)
+    return(_fseeki64(FP,offset,SEEK_SET));
+#else
+    return(fseeko(FP,(off_t)offset,SEEK_SET));
+#endif
+}
+
+/******************************************************************************/
+
+static int64_t COLFILE_Tell( FILE *FP )
+{
+#if defined(_WIN32)
+    return(_ftelli64(FP));
+#else
+    return((int64_t)ftello(FP));
+#endif
+}
+
+/******************************************************************************/
+
+static int64_t COLFILE_Align( int64_t offset )
+{
+    return(((offset + COLFILE_ALIGN - 1) / COLFILE_ALIGN) * COLFILE_ALIGN);
+}
+
+/******************************************************************************/
+
+COLTABLE::COLTABLE( const char *name )
+{
+    snprintf(Name,sizeof(Name),"%s",name);
+    Columns = 0;
+    Rows = 0;
+    Row = 0;
+}
+
+/******************************************************************************/
+
+COLTABLE::~COLTABLE( void )
+{
+int i;
+
+    for( i=0; (i < Columns); i++ )
+    {
+        delete [] Column[i].Data;
+    }
+}
+
+/******************************************************************************/
+
+void COLTABLE::SampleDouble( void *variable, double *value, int count )
+{
+double *d=(double *)variable;
+int i;
+
+    for( i=0; (i < count); i++ )
+    {
+        value[i] = d[i];
+    }
+}
+
+/******************************************************************************/
+
+void COLTABLE::SampleInt( void *variable, double *value, int count )
+{
+int *n=(int *)variable;
+int i;
+
+    for( i=0; (i < count); i++ )
+    {
+        value[i] = (double)n[i];
+    }
+}
+
+/******************************************************************************/
+
+void COLTABLE::StoreDouble( void *variable, const double *value, int count )
+{
+double *d=(double *)variable;
+int i;
+
+    for( i=0; (i < count); i++ )
+    {
+        d[i] = value[i];
+    }
+}
+
+/******************************************************************************/
+
+void COLTABLE::StoreInt( void *variable, const double *value, int count )
+{
+int *n=(int *)variable;
+int i;
+
+    for( i=0; (i < count); i++ )
+    {
+        n[i] = (int)value[i];
+    }
+}
+
+/******************************************************************************/
+
+bool COLTABLE::Add( const char *name, void *variable, COLFILE_SAMPLE sample, COLFILE_STORE store, COLFILE_ADDRESS address, int width )
+{
+COLUMN *column;
+
+    if( (Columns >= COLFILE_VARIABLES) || (width < 1) || (Rows != 0) )
+    {
+        printf("COLTABLE: %s Cannot add %s.\n",Name,name);
+        return(false);
+    }
+
+    column = &Column[Columns++];
+
+    snprintf(column->Name,sizeof(column->Name),"%s",name);
+    column->Variable = variable;
+    column->Sample = sample;
+    column->Store = store;
+    column->Address = address;
+    column->Width = width;
+    column->Data = NULL;
+
+    return(true);
+}
+
+/******************************************************************************/
+
+bool COLTABLE::AddVariable( const char *name, double &variable )
+{
+    return(Add(name,&variable,SampleDouble,StoreDouble,NULL,1));
+}
+
+/******************************************************************************/
+
+bool COLTABLE::AddVariable( const char *name, int &variable )
+{
+    return(Add(name,&variable,SampleInt,StoreInt,NULL,1));
+}
+
+/******************************************************************************/
+
+bool COLTABLE::AddVariable( const char *name, double *variable, int count )
+{
+    return(Add(name,variable,SampleDouble,StoreDouble,NULL,count));
+}
+
+/******************************************************************************/
+
+bool COLTABLE::AddVariable( const char *name, int *variable, int count )
+{
+    return(Add(name,variable,SampleInt,StoreInt,NULL,count));
+}
+
+/******************************************************************************/
+
+// Work out how RowSave() copies each variable.
+
+void COLTABLE::Compile( void )
+{
+COLUMN *column;
+STEP *step;
+const double *address;
+int i;
+
+    for( i=0; (i < Columns); i++ )
+    {
+        column = &Column[i];
+        step = &Plan[i];
+
+        step->Pack = COLFILE_PACK_SAMPLE;
+        step->Width = column->Width;
+        step->Source = column->Variable;
+        step->Data = column->Data;
+        step->Sample = column->Sample;
+
+        if( column->Sample == SampleDouble )
+        {
+            step->Pack = (column->Width == 1) ? COLFILE_PACK_DOUBLE : COLFILE_PACK_COPY;
+        }
+        else
+        if( column->Sample == SampleInt )
+        {
+            step->Pack = COLFILE_PACK_INT;
+        }
+        else
+        if( (column->Address != NULL) && ((address=(*column->Address)(column->Variable,column->Width)) != NULL) )
+        {
+            step->Pack = (column->Width == 1) ? COLFILE_PACK_DOUBLE : COLFILE_PACK_COPY;
+            step->Source = address;
+        }
+    }
+}
+
+/******************************************************************************/
+
+void COLTABLE::SetRows( int rows )
+{
+int i;
+
+    if( rows <= Rows )
+    {
+        return;
+    }
+
+    for( i=0; (i < Columns); i++ )
+    {
+        delete [] Column[i].Data;
+        Column[i].Data = new double[rows * Column[i].Width];
+    }
+
+    Rows = rows;
+    Row = 0;
+
+    Compile();
+}
+
+/******************************************************************************/
+
+void COLTABLE::Reset( void )
+{
+    Row = 0;
+
+    // Matrix storage is found again in case it has moved between trials.
+    Compile();
+}
+
+/******************************************************************************/
+
+int COLTABLE::GetWidth( void ) const
+{
+int i,width;
+
+    for( width=0,i=0; (i < Columns); i++ )
+    {
+        width += Column[i].Width;
+    }
+
+    return(width);
+}
+
+/******************************************************************************/
+
+void COLTABLE::Sample( double *values ) const
+{
+int i;
+
+    for( i=0; (i < Columns); i++ )
+    {
+        (*Column[i].Sample)(Column[i].Variable,values,Column[i].Width);
+        values += Column[i].Width;
+    }
+}
+
+/******************************************************************************/
+
+void COLTABLE::Store( const double *values )
+{
+int i;
+
+    for( i=0; (i < Columns); i++ )
+    {
+        (*Column[i].Store)(Column[i].Variable,values,Column[i].Width);
+        values += Column[i].Width;
+    }
+}
+
+/******************************************************************************/
+
+void COLTABLE::RowStore( const COLTABLE &table, int row )
+{
+int i;
+
+    if( (row < 0) || (row >= table.Row) )
+    {
+        return;
+    }
+
+    for( i=0; ((i < Columns) && (i < table.Columns)); i++ )
+    {
+        if( (Column[i].Width == table.Column[i].Width) && (table.Column[i].Data != NULL) )
+        {
+            (*Column[i].Store)(Column[i].Variable,&table.Column[i].Data[row * Column[i].Width],Column[i].Width);
+        }
+    }
+}
+
+/******************************************************************************/
+
+bool COLTABLE::Full( void ) const
+{
+    return(Row >= Rows);
+}
+
+/******************************************************************************/
+
+int COLTABLE::GetRow( void ) const
+{
+    return(Row);
+}
+
+/******************************************************************************/
+
+int COLTABLE::GetRows( void ) const
+{
+    return(Rows);
+}
+
+/******************************************************************************/
+
+const char *COLTABLE::GetName( void ) const
+{
+    return(Name);
+}
+
+/******************************************************************************/
+
+int COLTABLE::GetColumns( void ) const
+{
+    return(Columns);
+}
+
+/******************************************************************************/
+
+const char *COLTABLE::GetColumnName( int column ) const
+{
+    return(Column[column].Name);
+}
+
+/******************************************************************************/
+
+int COLTABLE::GetColumnWidth( int column ) const
+{
+    return(Column[column].Width);
+}
+
+/******************************************************************************/
+
+const double *COLTABLE::GetColumnData( int column ) const
+{
+    return(Column[column].Data);
+}
+
+/******************************************************************************/
+
+COLFILE_WRITER::COLFILE_WRITER( void )
+{
+    Tables = 0;
+    CompressFlag = true;
+    SpoolFP = NULL;
+    RawBytes = 0;
+    CodedBytes = 0;
+}
+
+/******************************************************************************/
+
+COLFILE_WRITER::~COLFILE_WRITER( void )
+{
+    if( SpoolFP != NULL )
+    {
+        Close();
+    }
+}
+
+/******************************************************************************/
+
+void COLFILE_WRITER::Compress( bool flag )
+{
+    CompressFlag = flag;
+}
+
+/******************************************************************************/
+
+bool COLFILE_WRITER::Open( const char *file, COLTABLE *table[], int tables )
+{
+COLFILE_SPOOL header;
+COLFILE_TABLE info;
+COLFILE_VARIABLE variable;
+bool ok;
+int t,c;
+
+    if( SpoolFP != NULL )
+    {
+        return(false);
+    }
+
+    if( (tables < 1) || (tables > COLFILE_TABLES) )
+    {
+        return(false);
+    }
+
+    for( t=0; (t < tables); t++ )
+    {
+        Table[t] = table[t];
+    }
+
+    Tables = tables;
+    File = file;
+    Spool = File + ".tmp";
+    Segment.clear();
+    RawBytes = 0;
+    CodedBytes = 0;
+
+    // Tables and variables as they are written to the session file.
+    TableInfo.clear();
+    VariableInfo.clear();
+
+    for( t=0; (t < Tables); t++ )
+    {
+        memset(&info,0,sizeof(info));
+        snprintf(info.Name,sizeof(info.Name),"%s",Table[t]->GetName());
+        info.FirstVariable = (int32_t)VariableInfo.size();
+        info.Variables = Table[t]->GetColumns();
+        TableInfo.push_back(info);
+
+        for( c=0; (c < Table[t]->GetColumns()); c++ )
+        {
+            memset(&variable,0,sizeof(variable));
+            snprintf(variable.Name,sizeof(variable.Name),"%s",Table[t]->GetColumnName(c));
+            variable.Table = t;
+            variable.Width = Table[t]->GetColumnWidth(c);
+            variable.Encoding = CompressFlag ? COLFILE_COLCODEC : COLFILE_RAW;
+            VariableInfo.push_back(variable);
+        }
+    }
+
+    if( (SpoolFP=fopen(Spool.c_str(),"w+b")) == NULL )
+    {
+        printf("COLFILE: Cannot open %s\n",Spool.c_str());
+        return(false);
+    }
+
+    // The spool file starts with the tables and variables (for COLFILE_Recover).
+    memset(&header,0,sizeof(header));
+    memcpy(header.Magic,COLFILE_SPOOLMAGIC,sizeof(header.Magic));
+    header.Version = COLFILE_SPOOLVERSION;
+    header.Tables = (int32_t)TableInfo.size();
+    header.Variables = (int32_t)VariableInfo.size();
+    header.Encoding = CompressFlag ? COLFILE_COLCODEC : COLFILE_RAW;
+
+    ok = (fwrite(&header,sizeof(header),1,SpoolFP) == 1);
+    ok = ok && (fwrite(TableInfo.data(),sizeof(COLFILE_TABLE),TableInfo.size(),SpoolFP) == TableInfo.size());
+    ok = ok && (VariableInfo.empty() || (fwrite(VariableInfo.data(),sizeof(COLFILE_VARIABLE),VariableInfo.size(),SpoolFP) == VariableInfo.size()));
+    ok = ok && (fflush(SpoolFP) == 0);
+
+    if( !ok )
+    {
+        printf("COLFILE: Cannot write %s\n",Spool.c_str());
+        fclose(SpoolFP);
+        SpoolFP = NULL;
+        remove(Spool.c_str());
+    }
+
+    return(ok);
+}
+
+/******************************************************************************/
+
+bool COLFILE_WRITER::Open( const char *file, COLTABLE &table1, COLTABLE &table2 )
+{
+COLTABLE *table[2]={ &table1,&table2 };
+
+    return(Open(file,table,2));
+}
+
+/******************************************************************************/
+
+bool COLFILE_WRITER::Opened( void ) const
+{
+    return(SpoolFP != NULL);
+}
+
+/******************************************************************************/
+
+void COLFILE_WRITER::TrialEncode( COLTABLE *table[], int tables, bool compress, COLFILE_TRIAL &trial )
+{
+std::vector<unsigned char> buffer;
+int64_t bytes;
+int t,c,rows;
+
+    trial.Data.clear();
+    trial.Bytes.clear();
+    trial.RawBytes = 0;
+
+    for( t=0; (t < tables); t++ )
+    {
+        rows = table[t]->GetRow();
+        trial.Rows[t] = rows;
+
+        for( c=0; (c < table[t]->GetColumns()); c++ )
+        {
+            bytes = (int64_t)rows * table[t]->GetColumnWidth(c) * sizeof(double);
+            trial.RawBytes += bytes;
+
+            if( compress )
+            {
+                buffer.clear();
+                COLCODEC_Encode(table[t]->GetColumnData(c),rows,table[t]->GetColumnWidth(c),buffer);
+                trial.Data.insert(trial.Data.end(),buffer.begin(),buffer.end());
+                bytes = (int64_t)buffer.size();
+            }
+            else
+            {
+                trial.Data.insert(trial.Data.end(),(const unsigned char *)table[t]->GetColumnData(c),(const unsigned char *)table[t]->GetColumnData(c) + bytes);
+            }
+
+            trial.Bytes.push_back(bytes);
+        }
+    }
+}
+
+/******************************************************************************/
+
+bool COLFILE_WRITER::TrialAppend( int trial, const COLFILE_TRIAL &encoded )
+{
+COLFILE_SEGMENT segment;
+COLFILE_SPOOLTRIAL header;
+bool ok=true;
+int t;
+
+    if( SpoolFP == NULL )
+    {
+        return(false);
+    }
+
+    if( encoded.Bytes.size() != VariableInfo.size() )
+    {
+        return(false);
+    }
+
+    fseek(SpoolFP,0,SEEK_END);
+
+    // Each trial has a header and the size of each column block, so the spool
+    // file can be read back without the segment table (COLFILE_Recover).
+    memset(&header,0,sizeof(header));
+    memcpy(header.Magic,COLFILE_TRIALMAGIC,sizeof(header.Magic));
+    header.Trial = trial;
+    header.Bytes = (int64_t)encoded.Data.size();
+
+    for( t=0; (t < Tables); t++ )
+    {
+        header.Rows[t] = encoded.Rows[t];
+    }
+
+    ok = (fwrite(&header,sizeof(header),1,SpoolFP) == 1);
+    ok = ok && (encoded.Bytes.empty() || (fwrite(encoded.Bytes.data(),sizeof(int64_t),encoded.Bytes.size(),SpoolFP) == encoded.Bytes.size()));
+
+    segment.Trial = trial;
+    segment.Offset = COLFILE_Tell(SpoolFP);
+    segment.Bytes = encoded.Bytes;
+
+    for( t=0; (t < Tables); t++ )
+    {
+        segment.Rows[t] = encoded.Rows[t];
+    }
+
+    if( ok && !encoded.Data.empty() )
+    {
+        ok = (fwrite(encoded.Data.data(),1,encoded.Data.size(),SpoolFP) == encoded.Data.size());
+    }
+
+    if( ok )
+    {
+        ok = (fflush(SpoolFP) == 0);
+    }
+
+    if( ok )
+    {
+        Segment.push_back(segment);
+        RawBytes += encoded.RawBytes;
+        CodedBytes += (int64_t)encoded.Data.size();
+    }
+
+    return(ok);
+}
+
+/******************************************************************************/
+
+bool COLFILE_WRITER::TrialSave( int trial )
+{
+    if( SpoolFP == NULL )
+    {
+        return(false);
+    }
+
+    TrialEncode(Table,Tables,CompressFlag,Encoded);
+
+    return(TrialAppend(trial,Encoded));
+}
+
+/******************************************************************************/
+
+// Offset in the spool file of a column block (variables numbered across tables).
+
+int64_t COLFILE_WRITER::SpoolOffset( const COLFILE_SEGMENT &segment, int variable )
+{
+int64_t offset;
+int v;
+
+    for( offset=segment.Offset,v=0; (v < variable); v++ )
+    {
+        offset += segment.Bytes[v];
+    }
+
+    return(offset);
+}
+
+/******************************************************************************/
+
+bool COLFILE_WRITER::Write( FILE *FP )
+{
+COLFILE_HEADER header;
+std::vector<COLFILE_TABLE> tables=TableInfo;
+std::vector<COLFILE_VARIABLE> variables=VariableInfo;
+std::vector<COLFILE_INDEX> index;
+std::vector<COLFILE_BLOCK> blocks;
+std::vector<unsigned char> buffer;
+COLFILE_INDEX entry;
+int64_t offset,bytes,rows;
+size_t s;
+bool ok=true;
+int t,v;
+
+    // Tables and index (first row of each trial in the whole column).
+    for( t=0; (t < Tables); t++ )
+    {
+        for( rows=0,s=0; (s < Segment.size()); s++ )
+        {
+            rows += Segment[s].Rows[t];
+        }
+
+        tables[t].Rows = rows;
+    }
+
+    for( s=0; (s < Segment.size()); s++ )
+    {
+        for( t=0; (t < Tables); t++ )
+        {
+            entry.Trial = Segment[s].Trial;
+            entry.FirstRow = (s == 0) ? 0 : (index[((s-1) * Tables) + t].FirstRow + index[((s-1) * Tables) + t].Rows);
+            entry.Rows = Segment[s].Rows[t];
+            index.push_back(entry);
+        }
+    }
+
+    // Column data offsets (compressed columns start with a block for each trial).
+    offset = sizeof(header) + (tables.size() * sizeof(COLFILE_TABLE)) + (variables.size() * sizeof(COLFILE_VARIABLE)) + (index.size() * sizeof(COLFILE_INDEX));
+
+    for( v=0; (v < (int)variables.size()); v++ )
+    {
+        offset = COLFILE_Align(offset);
+        variables[v].Offset = offset;
+
+        bytes = (variables[v].Encoding == COLFILE_RAW) ? 0 : (int64_t)(Segment.size() * sizeof(COLFILE_BLOCK));
+
+        for( s=0; (s < Segment.size()); s++ )
+        {
+            bytes += Segment[s].Bytes[v];
+        }
+
+        variables[v].Bytes = bytes;
+        offset += bytes;
+    }
+
+    memset(&header,0,sizeof(header));
+    memcpy(header.Magic,COLFILE_MAGIC,sizeof(header.Magic));
+    header.Version = COLFILE_VERSION;
+    header.Tables = (int32_t)tables.size();
+    header.Variables = (int32_t)variables.size();
+    header.Trials = (int32_t)Segment.size();
+    header.FileSize = offset;
+
+    ok = ok && (fwrite(&header,sizeof(header),1,FP) == 1);
+    ok = ok && (fwrite(tables.data(),sizeof(COLFILE_TABLE),tables.size(),FP) == tables.size());
+    ok = ok && (fwrite(variables.data(),sizeof(COLFILE_VARIABLE),variables.size(),FP) == variables.size());
+    ok = ok && (index.empty() || (fwrite(index.data(),sizeof(COLFILE_INDEX),index.size(),FP) == index.size()));
+
+    // Copy each column from the trials in the spool file.
+    for( v=0; (v < (int)variables.size()) && ok; v++ )
+    {
+        ok = (COLFILE_Seek(FP,variables[v].Offset) == 0);
+
+        if( ok && (variables[v].Encoding != COLFILE_RAW) )
+        {
+            blocks.resize(Segment.size());
+            offset = variables[v].Offset + (int64_t)(blocks.size() * sizeof(COLFILE_BLOCK));
+
+            for( s=0; (s < Segment.size()); s++ )
+            {
+                blocks[s].Offset = offset;
+                blocks[s].Bytes = Segment[s].Bytes[v];
+                offset += blocks[s].Bytes;
+            }
+
+            ok = blocks.empty() || (fwrite(blocks.data(),sizeof(COLFILE_BLOCK),blocks.size(),FP) == blocks.size());
+        }
+
+        for( s=0; (s < Segment.size()) && ok; s++ )
+        {
+            bytes = Segment[s].Bytes[v];
+
+            if( bytes == 0 )
+            {
+                continue;
+            }
+
+            buffer.resize((size_t)bytes);
+
+            ok = (COLFILE_Seek(SpoolFP,SpoolOffset(Segment[s],v)) == 0);
+            ok = ok && (fread(buffer.data(),1,(size_t)bytes,SpoolFP) == (size_t)bytes);
+            ok = ok && (fwrite(buffer.data(),1,(size_t)bytes,FP) == (size_t)bytes);
+        }
+    }
+
+    // Make sure file is full size (last column may be empty).
+    if( ok && (COLFILE_Tell(FP) < header.FileSize) )
+    {
+        ok = (COLFILE_Seek(FP,header.FileSize-1) == 0) && (fputc(0,FP) != EOF);
+    }
+
+    return(ok);
+}
+
+/******************************************************************************/
+
+bool COLFILE_WRITER::Close( bool verbose )
+{
+FILE *FP;
+bool ok;
+
+    if( SpoolFP == NULL )
+    {
+        return(false);
+    }
+
+    if( (FP=fopen(File.c_str(),"wb")) == NULL )
+    {
+        printf("COLFILE: Cannot open %s\n",File.c_str());
+        ok = false;
+    }
+    else
+    {
+        ok = Write(FP);
+
+        if( fclose(FP) != 0 )
+        {
+            ok = false;
+        }
+    }
+
+    fclose(SpoolFP);
+    SpoolFP = NULL;
+
+    // Spool file is kept if the session file could not be written.
+    if( ok )
+    {
+        remove(Spool.c_str());
+    }
+
+    if( verbose || !ok )
+    {
+        printf("COLFILE: %s %s Trials=%d (%.1lf MB, compression %.1lf:1).\n",File.c_str(),ok ? "Ok" : "Failed",(int)Segment.size(),(double)CodedBytes/1.0E6,Ratio());
+    }
+
+    return(ok);
+}
+
+/******************************************************************************/
+
+// Tables, variables and trials from an open spool file (as Open() and
+// TrialAppend() wrote them). Stops at a trial that isn't complete.
+
+bool COLFILE_WRITER::SpoolRead( void )
+{
+COLFILE_SPOOL header;
+COLFILE_SPOOLTRIAL trial;
+COLFILE_SEGMENT segment;
+int64_t size,bytes,end;
+size_t v;
+bool ok;
+int t;
+
+    if( (COLFILE_Seek(SpoolFP,0) != 0) || (fseek(SpoolFP,0,SEEK_END) != 0) || ((size=COLFILE_Tell(SpoolFP)) < 0) || (COLFILE_Seek(SpoolFP,0) != 0) )
+    {
+        return(false);
+    }
+
+    if( (fread(&header,sizeof(header),1,SpoolFP) != 1) || (memcmp(header.Magic,COLFILE_SPOOLMAGIC,sizeof(header.Magic)) != 0) || (header.Version != COLFILE_SPOOLVERSION) )
+    {
+        return(false);
+    }
+
+    if( (header.Tables < 1) || (header.Tables > COLFILE_TABLES) || (header.Variables < 0) || (header.Variables > (COLFILE_TABLES * COLFILE_VARIABLES)) )
+    {
+        return(false);
+    }
+
+    TableInfo.resize(header.Tables);
+    VariableInfo.resize(header.Variables);
+
+    ok = (fread(TableInfo.data(),sizeof(COLFILE_TABLE),TableInfo.size(),SpoolFP) == TableInfo.size());
+    ok = ok && (VariableInfo.empty() || (fread(VariableInfo.data(),sizeof(COLFILE_VARIABLE),VariableInfo.size(),SpoolFP) == VariableInfo.size()));
+
+    for( v=0; (v < VariableInfo.size()) && ok; v++ )
+    {
+        ok = (VariableInfo[v].Table >= 0) && (VariableInfo[v].Table < header.Tables) && (VariableInfo[v].Width >= 1);
+    }
+
+    if( !ok )
+    {
+        return(false);
+    }
+
+    Tables = header.Tables;
+    CompressFlag = (header.Encoding == COLFILE_COLCODEC);
+    Segment.clear();
+    RawBytes = 0;
+    CodedBytes = 0;
+
+    for( t=0; (t < Tables); t++ )
+    {
+        Table[t] = NULL;
+    }
+
+    // Trials up to the first one that wasn't completely written.
+    while( fread(&trial,sizeof(trial),1,SpoolFP) == 1 )
+    {
+        if( memcmp(trial.Magic,COLFILE_TRIALMAGIC,sizeof(trial.Magic)) != 0 )
+        {
+            break;
+        }
+
+        segment.Trial = (int)trial.Trial;
+        segment.Bytes.resize(VariableInfo.size());
+
+        if( !segment.Bytes.empty() && (fread(segment.Bytes.data(),sizeof(int64_t),segment.Bytes.size(),SpoolFP) != segment.Bytes.size()) )
+        {
+            break;
+        }
+
+        for( ok=true,t=0; (t < Tables); t++ )
+        {
+            ok = ok && (trial.Rows[t] >= 0) && (trial.Rows[t] <= 0x7FFFFFFF);
+            segment.Rows[t] = (int)trial.Rows[t];
+        }
+
+        for( bytes=0,v=0; (v < segment.Bytes.size()) && ok; v++ )
+        {
+            ok = (segment.Bytes[v] >= 0);
+            bytes += segment.Bytes[v];
+        }
+
+        segment.Offset = COLFILE_Tell(SpoolFP);
+        end = segment.Offset + trial.Bytes;
+
+        if( !ok || (bytes != trial.Bytes) || (end > size) || (COLFILE_Seek(SpoolFP,end) != 0) )
+        {
+            break;
+        }
+
+        Segment.push_back(segment);
+        CodedBytes += bytes;
+
+        for( v=0; (v < VariableInfo.size()); v++ )
+        {
+            RawBytes += (int64_t)segment.Rows[VariableInfo[v].Table] * VariableInfo[v].Width * sizeof(double);
+        }
+    }
+
+    return(true);
+}
+
+/******************************************************************************/
+
+bool COLFILE_WRITER::Recover( const char *file, bool verbose )
+{
+    if( SpoolFP != NULL )
+    {
+        return(false);
+    }
+
+    File = file;
+    Spool = File + ".tmp";
+
+    if( (SpoolFP=fopen(Spool.c_str(),"rb")) == NULL )
+    {
+        return(false);
+    }
+
+    if( !SpoolRead() )
+    {
+        printf("COLFILE: %s is not a spool file.\n",Spool.c_str());
+        fclose(SpoolFP);
+        SpoolFP = NULL;
+        return(false);
+    }
+
+    if( verbose )
+    {
+        printf("COLFILE: Recovering %s from %s (Trials=%d).\n",File.c_str(),Spool.c_str(),(int)Segment.size());
+    }
+
+    // Written as by Close(), which removes the spool file.
+    return(Close(verbose));
+}
+
+/******************************************************************************/
+
+int COLFILE_WRITER::Trials( void ) const
+{
+    return((int)Segment.size());
+}
+
+/******************************************************************************/
+
+double COLFILE_WRITER::Ratio( void ) const
+{
+    return((CodedBytes == 0) ? 1.0 : (double)RawBytes/(double)CodedBytes);
+}
+
+/******************************************************************************/
+
+// Session file written by the experiment programs.
+
+static COLFILE_WRITER COLFILE_Writer;
+
+/******************************************************************************/
+
+void COLFILE_Compress( bool flag )
+{
+    COLFILE_Writer.Compress(flag);
+}
+
+/******************************************************************************/
+
+bool COLFILE_Open( const char *file, COLTABLE *table[], int tables )
+{
+    return(COLFILE_Writer.Open(file,table,tables));
+}
+
+/******************************************************************************/
+
+bool COLFILE_Open( const char *file, COLTABLE &table1, COLTABLE &table2 )
+{
+    return(COLFILE_Writer.Open(file,table1,table2));
+}
+
+/******************************************************************************/
+
+bool COLFILE_Opened( void )
+{
+    return(COLFILE_Writer.Opened());
+}
+
+/******************************************************************************/
+
+bool COLFILE_TrialSave( int trial )
+{
+    return(COLFILE_Writer.TrialSave(trial));
+}
+
+/******************************************************************************/
+
+bool COLFILE_Close( void )
+{
+    return(COLFILE_Writer.Close());
+}
+
+/******************************************************************************/
+
+bool COLFILE_Recover( const char *file )
+{
+COLFILE_WRITER writer;
+
+    return(writer.Recover(file));
+}
+
+/******************************************************************************/
+
+COLFILE_READER::COLFILE_READER( void )
+{
+    Map = NULL;
+    Size = 0;
+#if defined(_WIN32)
+    File = INVALID_HANDLE_VALUE;
+    Mapping = NULL;
+#else
+    File = -1;
+#endif
+    Header = NULL;
+    Table = NULL;
+    Variable = NULL;
+    Index = NULL;
+}
+
+/******************************************************************************/
+
+COLFILE_READER::~COLFILE_READER( void )
+{
+    Close();
+}
+
+/******************************************************************************/
+
+bool COLFILE_READER::Open( const char *file )
+{
+const char *base;
+int64_t size;
+int v;
+#if defined(_WIN32)
+LARGE_INTEGER length;
+#else
+struct stat info;
+#endif
+
+    Close();
+
+#if defined(_WIN32)
+    if( (File=CreateFileA(file,GENERIC_READ,FILE_SHARE_READ,NULL,OPEN_EXISTING,FILE_ATTRIBUTE_NORMAL,NULL)) == INVALID_HANDLE_VALUE )
+    {
+        return(false);
+    }
+
+    if( !GetFileSizeEx((HANDLE)File,&length) || ((Mapping=CreateFileMappingA((HANDLE)File,NULL,PAGE_READONLY,0,0,NULL)) == NULL) )
+    {
+        Close();
+        return(false);
+    }
+
+    Size = length.QuadPart;
+    Map = MapViewOfFile((HANDLE)Mapping,FILE_MAP_READ,0,0,0);
+#else
+    if( (File=open(file,O_RDONLY)) < 0 )
+    {
+        return(false);
+    }
+
+    if( fstat(File,&info) != 0 )
+    {
+        Close();
+        return(false);
+    }
+
+    Size = (int64_t)info.st_size;
+    Map = mmap(NULL,(size_t)Size,PROT_READ,MAP_SHARED,File,0);
+
+    if( Map == MAP_FAILED )
+    {
+        Map = NULL;
+    }
+#endif
+
+    if( (Map == NULL) || (Size < (int64_t)sizeof(COLFILE_HEADER)) )
+    {
+        Close();
+        return(false);
+    }
+
+    base = (const char *)Map;
+    Header = (const COLFILE_HEADER *)base;
+
+    if( (memcmp(Header->Magic,COLFILE_MAGIC,sizeof(Header->Magic)) != 0) || (Header->Version != COLFILE_VERSION) || (Header->FileSize > Size) )
+    {
+        Close();
+        return(false);
+    }
+
+    size = sizeof(COLFILE_HEADER) + (Header->Tables * sizeof(COLFILE_TABLE)) + (Header->Variables * sizeof(COLFILE_VARIABLE)) + ((int64_t)Header->Trials * Header->Tables * sizeof(COLFILE_INDEX));
+
+    if( size > Size )
+    {
+        Close();
+        return(false);
+    }
+
+    Table = (const COLFILE_TABLE *)(base + sizeof(COLFILE_HEADER));
+    Variable = (const COLFILE_VARIABLE *)(Table + Header->Tables);
+    Index = (const COLFILE_INDEX *)(Variable + Header->Variables);
+
+    // Check columns are inside the file.
+    for( v=0; (v < Header->Variables); v++ )
+    {
+        if( (Variable[v].Table < 0) || (Variable[v].Table >= Header->Tables) || (Variable[v].Width < 1) || (Variable[v].Offset < 0) || (Variable[v].Bytes < 0) || ((Variable[v].Offset + Variable[v].Bytes) > Size) )
+        {
+            Close();
+            return(false);
+        }
+
+        if( (Variable[v].Encoding == COLFILE_RAW) && (Variable[v].Bytes < (Table[Variable[v].Table].Rows * Variable[v].Width * (int64_t)sizeof(double))) )
+        {
+            Close();
+            return(false);
+        }
+
+        if( (Variable[v].Encoding == COLFILE_COLCODEC) && (Variable[v].Bytes < ((int64_t)Header->Trials * (int64_t)sizeof(COLFILE_BLOCK))) )
+        {
+            Close();
+            return(false);
+        }
+    }
+
+    Cache.resize(Header->Variables);
+
+    return(true);
+}
+
+/******************************************************************************/
+
+void COLFILE_READER::Close( void )
+{
+#if defined(_WIN32)
+    if( Map != NULL )
+    {
+        UnmapViewOfFile(Map);
+    }
+
+    if( Mapping != NULL )
+    {
+        CloseHandle((HANDLE)Mapping);
+    }
+
+    if( File != INVALID_HANDLE_VALUE )
+    {
+        CloseHandle((HANDLE)File);
+    }
+
+    File = INVALID_HANDLE_VALUE;
+    Mapping = NULL;
+#else
+    if( Map != NULL )
+    {
+        munmap(Map,(size_t)Size);
+    }
+
+    if( File >= 0 )
+    {
+        close(File);
+    }
+
+    File = -1;
+#endif
+
+    Map = NULL;
+    Size = 0;
+    Header = NULL;
+    Table = NULL;
+    Variable = NULL;
+    Index = NULL;
+    Cache.clear();
+}
+
+/******************************************************************************/
+
+int COLFILE_READER::Tables( void ) const
+{
+    return((Header == NULL) ? 0 : Header->Tables);
+}
+
+/******************************************************************************/
+
+int COLFILE_READER::Trials( void ) const
+{
+    return((Header == NULL) ? 0 : Header->Trials);
+}
+
+/******************************************************************************/
+
+int COLFILE_READER::TableFind( const char *name ) const
+{
+int t;
+
+    for( t=0; (t < Tables()); t++ )
+    {
+        if( strncmp(Table[t].Name,name,COLFILE_NAME) == 0 )
+        {
+            return(t);
+        }
+    }
+
+    return(-1);
+}
+
+/******************************************************************************/
+
+int COLFILE_READER::VariableFind( int table, const char *name ) const
+{
+int v;
+
+    if( (table < 0) || (table >= Tables()) )
+    {
+        return(-1);
+    }
+
+    for( v=Table[table].FirstVariable; (v < (Table[table].FirstVariable + Table[table].Variables)); v++ )
+    {
+        if( strncmp(Variable[v].Name,name,COLFILE_NAME) == 0 )
+        {
+            return(v);
+        }
+    }
+
+    return(-1);
+}
+
+/******************************************************************************/
+
+const COLFILE_TABLE &COLFILE_READER::TableGet( int table ) const
+{
+    return(Table[table]);
+}
+
+/******************************************************************************/
+
+const COLFILE_VARIABLE &COLFILE_READER::VariableGet( int variable ) const
+{
+    return(Variable[variable]);
+}
+
+/******************************************************************************/
+
+int COLFILE_READER::Trial( int index ) const
+{
+    return((int)Index[index * Tables()].Trial);
+}
+
+/******************************************************************************/
+
+bool COLFILE_READER::Compressed( int variable ) const
+{
+    return(Variable[variable].Encoding != COLFILE_RAW);
+}
+
+/******************************************************************************/
+
+// Decode all trials of a compressed column into the cache.
+
+// Decode the block of one trial into the cache (already sized for the column).
+
+bool COLFILE_READER::DecodeBlock( int variable, int index ) const
+{
+const COLFILE_VARIABLE *v;
+const COLFILE_BLOCK *block;
+const COLFILE_INDEX *entry;
+int64_t end;
+
+    v = &Variable[variable];
+    block = (const COLFILE_BLOCK *)((const char *)Map + v->Offset) + index;
+    entry = &Index[(index * Tables()) + v->Table];
+    end = v->Offset + v->Bytes;
+
+    if( (block->Offset < v->Offset) || (block->Bytes < 0) || ((block->Offset + block->Bytes) > end) || (entry->FirstRow < 0) || (entry->Rows < 0) || ((entry->FirstRow + entry->Rows) > Table[v->Table].Rows) )
+    {
+        return(false);
+    }
+
+    return(COLCODEC_Decode((const unsigned char *)Map + block->Offset,(size_t)block->Bytes,(int)entry->Rows,v->Width,Cache[variable].data() + (entry->FirstRow * v->Width)));
+}
+
+/******************************************************************************/
+
+bool COLFILE_READER::Decode( int variable ) const
+{
+std::vector<double> &data=Cache[variable];
+int i;
+
+    if( Variable[variable].Encoding != COLFILE_COLCODEC )
+    {
+        return(false);
+    }
+
+    data.resize((size_t)(Table[Variable[variable].Table].Rows * Variable[variable].Width));
+
+    for( i=0; (i < Trials()); i++ )
+    {
+        if( !DecodeBlock(variable,i) )
+        {
+            data.clear();
+            return(false);
+        }
+    }
+
+    return(true);
+}
+
+/******************************************************************************/
+
+void COLFILE_READER::LoadThread( const COLFILE_READER *reader, LOAD *load )
+{
+int jobs,job;
+
+    jobs = (int)load->Ok.size();
+
+    while( (job=load->Next++) < jobs )
+    {
+        load->Ok[job] = reader->DecodeBlock(load->Column[job / reader->Trials()],job % reader->Trials()) ? 1 : 0;
+    }
+}
+
+/******************************************************************************/
+
+bool COLFILE_READER::Load( const int variable[], int count, int threads ) const
+{
+std::vector<std::thread> thread;
+LOAD load;
+int i,j,v,jobs;
+bool ok=true;
+
+    // Compressed columns that haven't been decoded, each sized for its rows.
+    for( i=0; (i < count); i++ )
+    {
+        v = variable[i];
+
+        if( (v < 0) || (v >= Header->Variables) )
+        {
+            ok = false;
+            continue;
+        }
+
+        if( (Variable[v].Encoding != COLFILE_COLCODEC) || !Cache[v].empty() || (Table[Variable[v].Table].Rows == 0) )
+        {
+            continue;
+        }
+
+        Cache[v].resize((size_t)(Table[Variable[v].Table].Rows * Variable[v].Width));
+        load.Column.push_back(v);
+    }
+
+    // A job is one trial of one column.
+    jobs = (int)load.Column.size() * Trials();
+    load.Ok.assign(jobs,0);
+    load.Next = 0;
+
+    if( threads <= 0 )
+    {
+        threads = (int)std::thread::hardware_concurrency();
+    }
+
+    if( threads > jobs )
+    {
+        threads = jobs;
+    }
+
+    for( i=1; (i < threads); i++ )
+    {
+        thread.push_back(std::thread(LoadThread,this,&load));
+    }
+
+    LoadThread(this,&load);
+
+    for( i=0; (i < (int)thread.size()); i++ )
+    {
+        thread[i].join();
+    }
+
+    // A column with a block that couldn't be decoded isn't kept.
+    for( i=0; (i < (int)load.Column.size()); i++ )
+    {
+        for( j=0; (j < Trials()); j++ )
+        {
+            if( !load.Ok[(i * Trials()) + j] )
+            {
+                Cache[load.Column[i]].clear();
+                ok = false;
+                break;
+            }
+        }
+    }
+
+    return(ok);
+}
+
+/******************************************************************************/
+
+COLFILE_SPAN COLFILE_READER::Column( int variable ) const
+{
+COLFILE_SPAN span;
+
+    span.Rows = Table[Variable[variable].Table].Rows;
+    span.Width = Variable[variable].Width;
+
+    if( Variable[variable].Encoding == COLFILE_RAW )
+    {
+        span.Data = (const double *)((const char *)Map + Variable[variable].Offset);
+    }
+    else
+    if( !Cache[variable].empty() || (span.Rows == 0) || Decode(variable) )
+    {
+        span.Data = Cache[variable].data();
+    }
+    else
+    {
+        span.Data = NULL;
+        span.Rows = 0;
+    }
+
+    return(span);
+}
+
+/******************************************************************************/
+
+COLFILE_SPAN COLFILE_READER::Column( int variable, int index ) const
+{
+const COLFILE_INDEX *entry;
+COLFILE_SPAN span;
+
+    entry = &Index[(index * Tables()) + Variable[variable].Table];
+    span = Column(variable);
+
+    if( span.Data == NULL )
+    {
+        return(span);
+    }
+
+    span.Data += entry->FirstRow * span.Width;
+    span.Rows = entry->Rows;
+
+    return(span);
+}
+
+/******************************************************************************/
@@ -0,0 +1,506 @@
+/******************************************************************************/
+/*                                                                            */
+/* MODULE  : colfile.h                                                        */
+/*                                                                            */
+/* PURPOSE : Columnar binary session file (writer and memory-mapped reader).  */
+/*                                                                            */
+/* DATE    : 17/Oct/2026                                                      */
+/*                                                                            */
+/* CHANGES                                                                    */
+/*                                                                            */
+/* V1.0  HRS 17/Oct/2026 - Initial development.                               */
+/*                                                                            */
+/* V1.1  HRS 17/Oct/2026 - Compressed columns (COLCODEC).                     */
+/*                                                                            */
+/* V1.2  HRS 17/Oct/2026 - Sample() and Store() for the session journal.      */
+/*                                                                            */
+/* V1.3  HRS 17/Oct/2026 - RowSave() uses a plan compiled from the variables. */
+/*                                                                            */
+/* V1.4  HRS 17/Oct/2026 - COLFILE_WRITER (more than one file at a time).     */
+/*                                                                            */
+/******************************************************************************/
+
+// A COLTABLE holds one column per variable (added with VAR(), as for MATDAT)
+// for the current trial. RowSave() copies the current values of the variables
+// into the next row. Storage is allocated by SetRows() (between trials), so
+// RowSave() can be called from the robot forces function.
+//
+// SetRows() and Reset() compile the variables into a plan, so RowSave() is a
+// direct copy from each variable's storage into its column, with no function
+// call per variable. A matrix is copied directly if its elements
+// are contiguous (otherwise it is sampled element by element as before). The
+// storage of a variable must not move during a trial.
+//
+// COLFILE_Open(), COLFILE_TrialSave() and COLFILE_Close() are used like the
+// DATAFILE functions. Trials are appended to a spool file (file.tmp) during
+// the session. COLFILE_Close() then writes the session file, with each
+// variable as one contiguous column across all trials. The functions use one COLFILE_WRITER;
+// other programs (e.g., tools/datconvert) can write several files at once with
+// their own. TrialEncode() only reads the tables it is given, so trials can be
+// encoded in parallel and then appended in order with TrialAppend().
+//
+// The layout (native byte order) is:
+//
+//   COLFILE_HEADER
+//   COLFILE_TABLE[Tables]
+//   COLFILE_VARIABLE[Variables]
+//   COLFILE_INDEX[Trials][Tables]    First row and rows of each trial.
+//   Column data, each starting on a COLFILE_ALIGN boundary (doubles,
+//   Rows x Width, with the Width values of a row together).
+//
+// By default each trial of each column is compressed by COLCODEC_Encode()
+// when the trial is saved (on the trial writer thread). A compressed column
+// (Encoding COLFILE_COLCODEC) is a COLFILE_BLOCK[Trials] table followed by
+// the blocks. COLFILE_Compress(false) writes raw doubles as before.
+//
+// The spool file describes itself, so if the program stops before Close()
+// COLFILE_Recover() can write the session file from it:
+//
+//   COLFILE_SPOOL
+//   COLFILE_TABLE[Tables]            Rows not used.
+//   COLFILE_VARIABLE[Variables]      Offset and Bytes not used.
+//   For each trial:
+//     COLFILE_SPOOLTRIAL
+//     int64_t[Variables]             Size of each column block.
+//     Column blocks.
+//
+// A trial that wasn't completely written (the last one) is left out.
+//
+// COLFILE_READER maps the file into memory and returns COLFILE_SPANs that
+// point straight into the mapping, so reading one variable only touches the
+// pages of that column. Compressed columns are decoded into a cache the
+// first time they are read.
+
+#ifndef COLFILE_H
+#define COLFILE_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+/******************************************************************************/
+
+#define COLFILE_MAGIC      "COLFILE1"
+#define COLFILE_VERSION    2
+#define COLFILE_ALIGN      4096
+#define COLFILE_NAME       32
+#define COLFILE_VARIABLES  128     // Maximum variables per table.
+#define COLFILE_TABLES     8
+
+#define COLFILE_RAW        0       // Variable encoding.
+#define COLFILE_COLCODEC   1
+
+struct COLFILE_HEADER
+{
+    char    Magic[8];
+    int32_t Version;
+    int32_t Tables;
+    int32_t Variables;
+    int32_t Trials;
+    int64_t FileSize;
+};
+
+struct COLFILE_TABLE
+{
+    char    Name[COLFILE_NAME];
+    int32_t FirstVariable;
+    int32_t Variables;
+    int64_t Rows;
+};
+
+struct COLFILE_VARIABLE
+{
+    char    Name[COLFILE_NAME];
+    int32_t Table;
+    int32_t Width;
+    int64_t Offset;             // Start of column data in file.
+    int32_t Encoding;           // COLFILE_RAW or COLFILE_COLCODEC.
+    int32_t Reserved;
+    int64_t Bytes;              // Size of column data in file.
+};
+
+struct COLFILE_BLOCK
+{
+    int64_t Offset;             // Compressed block for one trial.
+    int64_t Bytes;
+};
+
+struct COLFILE_INDEX
+{
+    int64_t Trial;
+    int64_t FirstRow;
+    int64_t Rows;
+};
+
+#define COLFILE_SPOOLMAGIC "COLSPOOL"
+#define COLFILE_TRIALMAGIC "COLTRIAL"
+#define COLFILE_SPOOLVERSION 1
+
+struct COLFILE_SPOOL
+{
+    char    Magic[8];
+    int32_t Version;
+    int32_t Tables;
+    int32_t Variables;
+    int32_t Encoding;           // COLFILE_RAW or COLFILE_COLCODEC.
+};
+
+struct COLFILE_SPOOLTRIAL
+{
+    char    Magic[8];
+    int64_t Trial;
+    int64_t Rows[COLFILE_TABLES];
+    int64_t Bytes;              // Column blocks (after the block sizes).
+};
+
+typedef void (*COLFILE_SAMPLE)( void *variable, double *value, int count );
+typedef void (*COLFILE_STORE)( void *variable, const double *value, int count );
+typedef const double *(*COLFILE_ADDRESS)( void *variable, int count );
+
+#define COLFILE_PACK_DOUBLE 0      // How RowSave() copies a variable.
+#define COLFILE_PACK_COPY   1
+#define COLFILE_PACK_INT    2
+#define COLFILE_PACK_SAMPLE 3
+
+/******************************************************************************/
+
+class COLTABLE
+{
+private:
+    struct COLUMN
+    {
+        char Name[COLFILE_NAME];
+        void *Variable;
+        COLFILE_SAMPLE Sample;
+        COLFILE_STORE Store;
+        COLFILE_ADDRESS Address;
+        int Width;
+        double *Data;
+    };
+
+    // One step of the plan compiled for RowSave().
+    struct STEP
+    {
+        int Pack;
+        int Width;
+        const void *Source;
+        double *Data;
+        COLFILE_SAMPLE Sample;
+    };
+
+    char Name[COLFILE_NAME];
+    COLUMN Column[COLFILE_VARIABLES];
+    STEP Plan[COLFILE_VARIABLES];
+    int Columns;
+    int Rows;
+    int Row;
+
+    static void SampleDouble( void *variable, double *value, int count );
+    static void SampleInt( void *variable, double *value, int count );
+    static void StoreDouble( void *variable, const double *value, int count );
+    static void StoreInt( void *variable, const double *value, int count );
+
+    template<class MATRIX> static void SampleMatrix( void *variable, double *value, int count )
+    {
+    MATRIX &m=*(MATRIX *)variable;
+    int i;
+
+        for( i=0; (i < count); i++ )
+        {
+            value[i] = m(i+1,1);
+        }
+    }
+
+    template<class MATRIX> static void StoreMatrix( void *variable, const double *value, int count )
+    {
+    MATRIX &m=*(MATRIX *)variable;
+    int i;
+
+        for( i=0; (i < count); i++ )
+        {
+            m(i+1,1) = value[i];
+        }
+    }
+
+    // Matrix elements, if they are contiguous in memory.
+    template<class MATRIX> static const double *AddressMatrix( void *variable, int count )
+    {
+    MATRIX &m=*(MATRIX *)variable;
+    const double *address=&m(1,1);
+    int i;
+
+        for( i=1; (i < count); i++ )
+        {
+            if( &m(i+1,1) != (address + i) )
+            {
+                return(NULL);
+            }
+        }
+
+        return(address);
+    }
+
+    bool Add( const char *name, void *variable, COLFILE_SAMPLE sample, COLFILE_STORE store, COLFILE_ADDRESS address, int width );
+    void Compile( void );
+
+public:
+    COLTABLE( const char *name );
+   ~COLTABLE( void );
+
+    bool AddVariable( const char *name, double &variable );
+    bool AddVariable( const char *name, int &variable );
+    bool AddVariable( const char *name, double *variable, int count );
+    bool AddVariable( const char *name, int *variable, int count );
+
+    // Column vector (MOTOR matrix).
+    template<class MATRIX> bool AddVariable( const char *name, MATRIX &variable )
+    {
+        return(Add(name,&variable,SampleMatrix<MATRIX>,StoreMatrix<MATRIX>,AddressMatrix<MATRIX>,variable.rows()));
+    }
+
+    // Storage for a trial (only ever grows).
+    void SetRows( int rows );
+
+    // Start of a trial (also compiles the plan again).
+    void Reset( void );
+
+    // Copy current values of the variables to the next row.
+    inline void RowSave( void )
+    {
+    const STEP *step;
+    const double *source;
+    double *data;
+    int i,k;
+
+        if( Row >= Rows )
+        {
+            return;
+        }
+
+        for( i=0; (i < Columns); i++ )
+        {
+            step = &Plan[i];
+            data = &step->Data[Row * step->Width];
+
+            switch( step->Pack )
+            {
+                case COLFILE_PACK_DOUBLE :
+                    *data = *(const double *)step->Source;
+                    break;
+
+                case COLFILE_PACK_COPY :
+                    source = (const double *)step->Source;
+                    for( k=0; (k < step->Width); k++ )
+                    {
+                        data[k] = source[k];
+                    }
+                    break;
+
+                case COLFILE_PACK_INT :
+                    for( k=0; (k < step->Width); k++ )
+                    {
+                        data[k] = (double)((const int *)step->Source)[k];
+                    }
+                    break;
+
+                default :
+                    (*step->Sample)((void *)step->Source,data,step->Width);
+                    break;
+            }
+        }
+
+        Row++;
+    }
+
+    // Current values of the variables packed into GetWidth() values, and
+    // the reverse (used to save and restore the trial list).
+    int GetWidth( void ) const;
+    void Sample( double *values ) const;
+    void Store( const double *values );
+
+    // Store a row of a table with the same variables into this table's
+    // variables (e.g., copies of them, to fill another table afterwards).
+    void RowStore( const COLTABLE &table, int row );
+
+    bool Full( void ) const;
+    int GetRow( void ) const;
+    int GetRows( void ) const;
+
+    // Used by COLFILE functions.
+    const char *GetName( void ) const;
+    int GetColumns( void ) const;
+    const char *GetColumnName( int column ) const;
+    int GetColumnWidth( int column ) const;
+    const double *GetColumnData( int column ) const;
+};
+
+/******************************************************************************/
+
+// Each trial in the spool file is the column blocks of each table in turn
+// (compressed by COLCODEC_Encode() or raw doubles), after its header.
+struct COLFILE_SEGMENT
+{
+    int Trial;
+    int64_t Offset;                 // First column block.
+    int Rows[COLFILE_TABLES];
+    std::vector<int64_t> Bytes;     // Size of each column block.
+};
+
+// Encoded column blocks of a trial.
+struct COLFILE_TRIAL
+{
+    int Rows[COLFILE_TABLES];
+    std::vector<int64_t> Bytes;
+    std::vector<unsigned char> Data;
+    int64_t RawBytes;
+};
+
+class COLFILE_WRITER
+{
+private:
+    COLTABLE *Table[COLFILE_TABLES];
+    int Tables;
+    bool CompressFlag;
+    std::string File;
+    std::string Spool;
+    FILE *SpoolFP;
+    std::vector<COLFILE_TABLE> TableInfo;
+    std::vector<COLFILE_VARIABLE> VariableInfo;
+    std::vector<COLFILE_SEGMENT> Segment;
+    COLFILE_TRIAL Encoded;
+    int64_t RawBytes;
+    int64_t CodedBytes;
+
+    static int64_t SpoolOffset( const COLFILE_SEGMENT &segment, int variable );
+    bool SpoolRead( void );
+    bool Write( FILE *FP );
+
+public:
+    COLFILE_WRITER( void );
+   ~COLFILE_WRITER( void );
+
+    // Compress columns (default) or write raw doubles (set before Open).
+    void Compress( bool flag );
+
+    bool Open( const char *file, COLTABLE *table[], int tables );
+    bool Open( const char *file, COLTABLE &table1, COLTABLE &table2 );
+    bool Opened( void ) const;
+
+    // Encode and append the current rows of the tables.
+    bool TrialSave( int trial );
+
+    // Encode tables with the same variables as those given to Open(), then
+    // append the encoded trial to the file.
+    static void TrialEncode( COLTABLE *table[], int tables, bool compress, COLFILE_TRIAL &trial );
+    bool TrialAppend( int trial, const COLFILE_TRIAL &encoded );
+
+    bool Close( bool verbose=true );
+
+    // Write a session file from the spool left when the program stopped
+    // before Close() (false if there isn't one or it can't be read).
+    bool Recover( const char *file, bool verbose=true );
+
+    int Trials( void ) const;
+    double Ratio( void ) const;
+};
+
+/******************************************************************************/
+
+bool COLFILE_Open( const char *file, COLTABLE *table[], int tables );
+bool COLFILE_Open( const char *file, COLTABLE &table1, COLTABLE &table2 );
+bool COLFILE_TrialSave( int trial );
+bool COLFILE_Close( void );
+bool COLFILE_Opened( void );
+
+// Compress columns (default) or write raw doubles (set before COLFILE_Open).
+void COLFILE_Compress( bool flag );
+
+// Session file from an interrupted session's spool (file.tmp).
+bool COLFILE_Recover( const char *file );
+
+/******************************************************************************/
+
+struct COLFILE_SPAN
+{
+    const double *Data;
+    int64_t Rows;
+    int Width;
+
+    inline double operator()( int64_t row, int value=0 ) const
+    {
+        return(Data[(row * Width) + value]);
+    }
+};
+
+class COLFILE_READER
+{
+private:
+    void *Map;
+    int64_t Size;
+#if defined(_WIN32)
+    void *File;
+    void *Mapping;
+#else
+    int File;
+#endif
+
+    const COLFILE_HEADER *Header;
+    const COLFILE_TABLE *Table;
+    const COLFILE_VARIABLE *Variable;
+    const COLFILE_INDEX *Index;
+
+    // Decoded compressed columns.
+    mutable std::vector< std::vector<double> > Cache;
+
+    // Trial blocks of the columns being decoded by Load() (each thread takes
+    // the next one until there are none left).
+    struct LOAD
+    {
+        std::vector<int> Column;
+        std::vector<char> Ok;
+        std::atomic<int> Next;
+    };
+
+    bool DecodeBlock( int variable, int index ) const;
+    bool Decode( int variable ) const;
+    static void LoadThread( const COLFILE_READER *reader, LOAD *load );
+
+public:
+    COLFILE_READER( void );
+   ~COLFILE_READER( void );
+
+    bool Open( const char *file );
+    void Close( void );
+
+    int Tables( void ) const;
+    int Trials( void ) const;
+
+    // Table or variable index from name (-1 if not found).
+    int TableFind( const char *name ) const;
+    int VariableFind( int table, const char *name ) const;
+
+    const COLFILE_TABLE &TableGet( int table ) const;
+    const COLFILE_VARIABLE &VariableGet( int variable ) const;
+
+    // Trial number for an entry in the index (0...Trials()-1).
+    int Trial( int index ) const;
+
+    bool Compressed( int variable ) const;
+
+    // Decode the compressed columns of some variables with several threads
+    // (instead of each one the first time Column() is called). False if any
+    // cannot be decoded.
+    bool Load( const int variable[], int count, int threads ) const;
+
+    // Whole column, or the rows for one entry in the index (Data is NULL if
+    // a compressed column cannot be decoded).
+    COLFILE_SPAN Column( int variable ) const;
+    COLFILE_SPAN Column( int variable, int index ) const;
+};
+
+/******************************************************************************/
+
+#endif
@@ -0,0 +1,282 @@
+/******************************************************************************/
+/*                                                                            */
+/* MODULE  : framerec.cpp                                                     */
+/*                                                                            */
+/* PURPOSE : Multi-rate frame recording (one stream per variable).            */
+/*                                                                            */
+/* DATE    : 17/Oct/2026                                                      */
+/*                                                                            */
+/* CHANGES                                                                    */
+/*                                                                            */
+/* V1.0  HRS 17/Oct/2026 - Initial development.                               */
+/*                                                                            */
+/******************************************************************************/
+
+#include <math.h>
+#include <string.h>
+
+#include "framerec.h"
+
+/******************************************************************************/
+
+FRAMEREC::FRAMEREC( const char *name )
+{
+    snprintf(Name,sizeof(Name),"%s",name);
+    Streams = 0;
+    Saved = false;
+}
+
+/******************************************************************************/
+
+FRAMEREC::~FRAMEREC( void )
+{
+int i;
+
+    for( i=0; (i < Streams); i++ )
+    {
+        delete [] Stream[i].Buffer;
+    }
+}
+
+/******************************************************************************/
+
+void FRAMEREC::SampleDouble( void *variable, double *value, int count )
+{
+double *d=(double *)variable;
+int i;
+
+    for( i=0; (i < count); i++ )
+    {
+        value[i] = d[i];
+    }
+}
+
+/******************************************************************************/
+
+void FRAMEREC::SampleInt( void *variable, double *value, int count )
+{
+int *n=(int *)variable;
+int i;
+
+    for( i=0; (i < count); i++ )
+    {
+        value[i] = (double)n[i];
+    }
+}
+
+/******************************************************************************/
+
+bool FRAMEREC::Add( const char *name, void *variable, FRAMEREC_SAMPLE sample, int count, double rate )
+{
+STREAM *stream;
+
+    if( (Streams >= FRAMEREC_STREAMS) || (count < 1) || (count > FRAMEREC_VALUES) )
+    {
+        printf("FRAMEREC: %s Cannot add %s.\n",Name,name);
+        return(false);
+    }
+
+    stream = &Stream[Streams++];
+
+    snprintf(stream->Name,sizeof(stream->Name),"%s",name);
+    stream->Variable = variable;
+    stream->Sample = sample;
+    stream->Count = count;
+    stream->Rate = rate;
+    stream->Buffer = NULL;
+    stream->Rows = 0;
+    stream->Row = 0;
+    stream->Dropped = 0;
+
+    return(true);
+}
+
+/******************************************************************************/
+
+bool FRAMEREC::AddVariable( const char *name, double &variable, double rate )
+{
+    return(Add(name,&variable,SampleDouble,1,rate));
+}
+
+/******************************************************************************/
+
+bool FRAMEREC::AddVariable( const char *name, int &variable, double rate )
+{
+    return(Add(name,&variable,SampleInt,1,rate));
+}
+
+/******************************************************************************/
+
+bool FRAMEREC::AddVariable( const char *name, double *variable, int count, double rate )
+{
+    return(Add(name,variable,SampleDouble,count,rate));
+}
+
+/******************************************************************************/
+
+void FRAMEREC::SetDuration( double seconds, double frequency )
+{
+STREAM *stream;
+int i,rows;
+
+    for( i=0; (i < Streams); i++ )
+    {
+        stream = &Stream[i];
+
+        // Streams with a rate need fewer rows than the loop.
+        if( (stream->Rate > 0.0) && (stream->Rate < frequency) )
+        {
+            rows = (int)ceil(seconds * stream->Rate) + 2;
+        }
+        else
+        {
+            rows = (int)ceil(seconds * frequency) + 2;
+        }
+
+        if( rows <= stream->Rows )
+        {
+            continue;
+        }
+
+        delete [] stream->Buffer;
+        stream->Buffer = new double[rows * (1 + stream->Count)];
+        stream->Rows = rows;
+        stream->Row = 0;
+    }
+}
+
+/******************************************************************************/
+
+void FRAMEREC::Reset( void )
+{
+int i;
+
+    for( i=0; (i < Streams); i++ )
+    {
+        Stream[i].Row = 0;
+        Stream[i].Next = 0.0;
+        Stream[i].Changed = true;
+        Stream[i].Dropped = 0;
+    }
+}
+
+/******************************************************************************/
+
+void FRAMEREC::RowSave( double time )
+{
+STREAM *stream;
+double value[FRAMEREC_VALUES],*row;
+int i;
+
+    for( i=0; (i < Streams); i++ )
+    {
+        stream = &Stream[i];
+
+        if( stream->Rate > 0.0 )
+        {
+            if( time < stream->Next )
+            {
+                continue;
+            }
+
+            // Next sample time (don't try to catch up after a gap).
+            stream->Next += 1.0 / stream->Rate;
+
+            if( stream->Next <= time )
+            {
+                stream->Next = time + (1.0 / stream->Rate);
+            }
+        }
+
+        (*stream->Sample)(stream->Variable,value,stream->Count);
+
+        if( stream->Rate < 0.0 )
+        {
+            // First sample of the trial is always saved.
+            if( !stream->Changed && (memcmp(value,stream->Last,stream->Count * sizeof(double)) == 0) )
+            {
+                continue;
+            }
+
+            memcpy(stream->Last,value,stream->Count * sizeof(double));
+            stream->Changed = false;
+        }
+
+        if( stream->Row >= stream->Rows )
+        {
+            stream->Dropped++;
+            continue;
+        }
+
+        row = &stream->Buffer[stream->Row++ * (1 + stream->Count)];
+        row[0] = time;
+        memcpy(&row[1],value,stream->Count * sizeof(double));
+    }
+}
+
+/******************************************************************************/
+
+int FRAMEREC::GetRows( void ) const
+{
+int i,rows;
+
+    for( rows=0,i=0; (i < Streams); i++ )
+    {
+        rows += Stream[i].Row;
+    }
+
+    return(rows);
+}
+
+/******************************************************************************/
+
+unsigned long FRAMEREC::Dropped( void ) const
+{
+unsigned long dropped;
+int i;
+
+    for( dropped=0,i=0; (i < Streams); i++ )
+    {
+        dropped += Stream[i].Dropped;
+    }
+
+    return(dropped);
+}
+
+/******************************************************************************/
+
+bool FRAMEREC::Save( const char *file, int trial )
+{
+const STREAM *stream;
+FILE *FP;
+bool ok=true;
+int i;
+
+    if( (FP=fopen(file,Saved ? "ab" : "wb")) == NULL )
+    {
+        return(false);
+    }
+
+    Saved = true;
+
+    for( i=0; (i < Streams) && ok; i++ )
+    {
+        stream = &Stream[i];
+
+        fprintf(FP,"FRAMEREC Trial=%d Stream=%s Rate=%.1lf Columns=%d Rows=%d\n",trial,stream->Name,stream->Rate,1+stream->Count,stream->Row);
+
+        if( stream->Row > 0 )
+        {
+            ok = (fwrite(stream->Buffer,sizeof(double) * (1 + stream->Count),stream->Row,FP) == (size_t)stream->Row);
+        }
+    }
+
+    if( fclose(FP) != 0 )
+    {
+        ok = false;
+    }
+
+    return(ok);
+}
+
+/******************************************************************************/
@@ -0,0 +1,128 @@
+/******************************************************************************/
+/*                                                                            */
+/* MODULE  : framerec.h                                                       */
+/*                                                                            */
+/* PURPOSE : Multi-rate frame recording (one stream per variable).            */
+/*                                                                            */
+/* DATE    : 17/Oct/2026                                                      */
+/*                                                                            */
+/* CHANGES                                                                    */
+/*                                                                            */
+/* V1.0  HRS 17/Oct/2026 - Initial development.                               */
+/*                                                                            */
+/******************************************************************************/
+
+// FrameData saves every variable on every tick of the robot loop. Variables
+// that change slowly (state flags, PMove state, torques, etc.) can instead be
+// added to a FRAMEREC with their own sample rate:
+//
+//   FRAMEREC_TICK     Every call to RowSave() (i.e., full loop rate).
+//   FRAMEREC_CHANGE   Only when one of the values changes.
+//   rate > 0.0        At the given rate (Hz).
+//
+// Each variable is a separate stream with its own time column. Storage is
+// allocated by SetDuration() between trials, so RowSave() does not allocate
+// and can be called from the robot forces function.
+//
+// Save() appends a trial to a file, which is truncated by the first Save()
+// of the session (rather than by Trial 1, as that may be saved twice when it
+// is missed and repeated). Each stream is a text header line,
+//
+//   FRAMEREC Trial=%d Stream=%s Rate=%.1lf Columns=%d Rows=%d
+//
+// followed by Rows x Columns native doubles (row by row, time first).
+
+#ifndef FRAMEREC_H
+#define FRAMEREC_H
+
+#include <stdio.h>
+
+/******************************************************************************/
+
+#define FRAMEREC_TICK     0.0
+#define FRAMEREC_CHANGE  -1.0
+
+#define FRAMEREC_STREAMS  32
+#define FRAMEREC_VALUES   16
+#define FRAMEREC_NAME     32
+
+typedef void (*FRAMEREC_SAMPLE)( void *variable, double *value, int count );
+
+/******************************************************************************/
+
+class FRAMEREC
+{
+private:
+    struct STREAM
+    {
+        char Name[FRAMEREC_NAME];
+        void *Variable;
+        FRAMEREC_SAMPLE Sample;
+        int Count;
+        double Rate;
+        double Next;
+        bool Changed;
+        double Last[FRAMEREC_VALUES];
+        double *Buffer;
+        int Rows;
+        int Row;
+        unsigned long Dropped;
+    };
+
+    char Name[FRAMEREC_NAME];
+    STREAM Stream[FRAMEREC_STREAMS];
+    int Streams;
+    bool Saved;                         // File started by Save().
+
+    static void SampleDouble( void *variable, double *value, int count );
+    static void SampleInt( void *variable, double *value, int count );
+
+    template<class MATRIX> static void SampleMatrix( void *variable, double *value, int count )
+    {
+    MATRIX &m=*(MATRIX *)variable;
+    int i;
+
+        for( i=0; (i < count); i++ )
+        {
+            value[i] = m(i+1,1);
+        }
+    }
+
+    bool Add( const char *name, void *variable, FRAMEREC_SAMPLE sample, int count, double rate );
+
+public:
+    FRAMEREC( const char *name );
+   ~FRAMEREC( void );
+
+    // Add a variable (use with VAR(), as for MATDAT).
+    bool AddVariable( const char *name, double &variable, double rate );
+    bool AddVariable( const char *name, int &variable, double rate );
+    bool AddVariable( const char *name, double *variable, int count, double rate );
+
+    // Column vector (MOTOR matrix), the type is a template parameter so that
+    // this module doesn't depend on motor.h.
+    template<class MATRIX> bool AddVariable( const char *name, MATRIX &variable, double rate )
+    {
+        return(Add(name,&variable,SampleMatrix<MATRIX>,variable.rows(),rate));
+    }
+
+    // Make sure there is storage for a trial of this duration (sec) with
+    // RowSave() called at this frequency (Hz). Storage only ever grows.
+    void SetDuration( double seconds, double frequency );
+
+    // Start of a trial.
+    void Reset( void );
+
+    // Sample each stream that is due at this time (sec).
+    void RowSave( double time );
+
+    int GetRows( void ) const;          // Total samples over all streams.
+    unsigned long Dropped( void ) const;
+
+    // Append the streams for a trial to a file (next to the data file).
+    bool Save( const char *file, int trial );
+};
+
+/******************************************************************************/
+
+#endif
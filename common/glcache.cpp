@@ -0,0 +1,425 @@
+/******************************************************************************/
+/*                                                                            */
+/* MODULE  : glcache.cpp                                                      */
+/*                                                                            */
+/* PURPOSE : Cached OpenGL geometry for discs, rings and stroke text.         */
+/*                                                                            */
+/* DATE    : 17/Oct/2026                                                      */
+/*                                                                            */
+/* CHANGES                                                                    */
+/*                                                                            */
+/* V1.0  HRS 17/Oct/2026 - Initial development.                               */
+/*                                                                            */
+/* V1.1  HRS 17/Oct/2026 - Scene list made once per frame for both eyes.      */
+/*                                                                            */
+/******************************************************************************/
+
+#include <math.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+#include <windows.h>
+#endif
+
+#include <GL/gl.h>
+#include <GL/glut.h>
+
+#include "glcache.h"
+
+/******************************************************************************/
+
+#define GLCACHE_PI       3.14159265358979323846
+
+struct GLCACHE_STRING
+{
+    void *Font;
+    std::string Text;
+    GLuint List;
+};
+
+static GLuint                        GLCACHE_DiscList=0;
+static std::map<int,GLuint>          GLCACHE_RingList;      // Key is inner/outer ratio (1/10000).
+static std::vector<GLCACHE_STRING>   GLCACHE_StringList;
+static int                           GLCACHE_StringNext=0;  // Oldest string, replaced next.
+
+static GLuint                        GLCACHE_SceneList=0;
+static bool                          GLCACHE_Compiling=false;
+
+// Made before the next scene list is compiled.
+static std::vector<int>              GLCACHE_RingMissing;
+static std::vector<GLCACHE_STRING>   GLCACHE_StringMissing;
+
+/******************************************************************************/
+
+static void GLCACHE_DiscVertices( void )
+{
+double a;
+int i;
+
+    glBegin(GL_TRIANGLE_FAN);
+    glVertex2d(0.0,0.0);
+
+    for( i=0; (i <= GLCACHE_SLICES); i++ )
+    {
+        a = (2.0 * GLCACHE_PI * (double)i) / (double)GLCACHE_SLICES;
+        glVertex2d(cos(a),sin(a));
+    }
+
+    glEnd();
+}
+
+/******************************************************************************/
+
+static void GLCACHE_RingVertices( double inner )
+{
+double a,c,s;
+int i;
+
+    glBegin(GL_TRIANGLE_STRIP);
+
+    for( i=0; (i <= GLCACHE_SLICES); i++ )
+    {
+        a = (2.0 * GLCACHE_PI * (double)i) / (double)GLCACHE_SLICES;
+        c = cos(a);
+        s = sin(a);
+
+        glVertex2d(c,s);
+        glVertex2d(inner*c,inner*s);
+    }
+
+    glEnd();
+}
+
+/******************************************************************************/
+
+static GLuint GLCACHE_DiscMake( void )
+{
+GLuint list;
+
+    if( (list=glGenLists(1)) == 0 )
+    {
+        return(0);
+    }
+
+    glNewList(list,GL_COMPILE);
+    GLCACHE_DiscVertices();
+    glEndList();
+
+    return(list);
+}
+
+/******************************************************************************/
+
+static GLuint GLCACHE_RingMake( double inner )
+{
+GLuint list;
+
+    if( (list=glGenLists(1)) == 0 )
+    {
+        return(0);
+    }
+
+    glNewList(list,GL_COMPILE);
+    GLCACHE_RingVertices(inner);
+    glEndList();
+
+    return(list);
+}
+
+/******************************************************************************/
+
+void GLCACHE_Disc( double x, double y, double z, double radius )
+{
+    if( (GLCACHE_DiscList == 0) && !GLCACHE_Compiling )
+    {
+        GLCACHE_DiscList = GLCACHE_DiscMake();
+    }
+
+    if( radius <= 0.0 )
+    {
+        return;
+    }
+
+    glPushMatrix();
+    glTranslated(x,y,z);
+    glScaled(radius,radius,1.0);
+
+    if( GLCACHE_DiscList != 0 )
+    {
+        glCallList(GLCACHE_DiscList);
+    }
+    else
+    {
+        // No list yet (or it couldn't be made), so the vertices.
+        GLCACHE_DiscVertices();
+    }
+
+    glPopMatrix();
+}
+
+/******************************************************************************/
+
+void GLCACHE_Ring( double x, double y, double z, double radius, double width )
+{
+std::map<int,GLuint>::iterator item;
+GLuint list=0;
+double inner;
+int key;
+
+    if( radius <= 0.0 )
+    {
+        return;
+    }
+
+    // No hole, so it's a disc.
+    if( width >= radius )
+    {
+        GLCACHE_Disc(x,y,z,radius);
+        return;
+    }
+
+    inner = (radius - width) / radius;
+    key = (int)floor((inner * 10000.0) + 0.5);
+
+    glPushMatrix();
+    glTranslated(x,y,z);
+    glScaled(radius,radius,1.0);
+
+    if( (item=GLCACHE_RingList.find(key)) != GLCACHE_RingList.end() )
+    {
+        glCallList(item->second);
+    }
+    else
+    if( !GLCACHE_Compiling && ((list=GLCACHE_RingMake((double)key / 10000.0)) != 0) )
+    {
+        GLCACHE_RingList[key] = list;
+        glCallList(list);
+    }
+    else
+    {
+        // Vertices now, and its own list is made again later (after the scene
+        // list when compiling, or the next time it's drawn if it failed).
+        GLCACHE_RingVertices((double)key / 10000.0);
+
+        if( GLCACHE_Compiling )
+        {
+            GLCACHE_RingMissing.push_back(key);
+        }
+    }
+
+    glPopMatrix();
+}
+
+/******************************************************************************/
+
+static void GLCACHE_StringCharacters( void *font, const char *string )
+{
+    for( ; (*string != 0); string++ )
+    {
+        glutStrokeCharacter(font,*string);
+    }
+}
+
+/******************************************************************************/
+
+static int GLCACHE_StringFind( void *font, const char *string )
+{
+int i;
+
+    for( i=0; (i < (int)GLCACHE_StringList.size()); i++ )
+    {
+        if( (GLCACHE_StringList[i].Font == font) && (GLCACHE_StringList[i].Text == string) )
+        {
+            return(i);
+        }
+    }
+
+    return(-1);
+}
+
+/******************************************************************************/
+
+// Make a list for a new string, or the oldest one again.
+
+static void GLCACHE_StringMake( void *font, const char *string, GLenum mode )
+{
+GLCACHE_STRING item;
+GLuint list;
+int i;
+
+    if( (int)GLCACHE_StringList.size() < GLCACHE_STRINGS )
+    {
+        if( (list=glGenLists(1)) == 0 )
+        {
+            if( mode == GL_COMPILE_AND_EXECUTE )
+            {
+                GLCACHE_StringCharacters(font,string);
+            }
+
+            return;
+        }
+
+        item.List = list;
+        GLCACHE_StringList.push_back(item);
+        i = (int)GLCACHE_StringList.size() - 1;
+    }
+    else
+    {
+        i = GLCACHE_StringNext;
+        GLCACHE_StringNext = (GLCACHE_StringNext + 1) % GLCACHE_STRINGS;
+    }
+
+    GLCACHE_StringList[i].Font = font;
+    GLCACHE_StringList[i].Text = string;
+
+    glNewList(GLCACHE_StringList[i].List,mode);
+    GLCACHE_StringCharacters(font,string);
+    glEndList();
+}
+
+/******************************************************************************/
+
+void GLCACHE_String( void *font, const char *string )
+{
+GLCACHE_STRING item;
+int i;
+
+    if( (i=GLCACHE_StringFind(font,string)) >= 0 )
+    {
+        glCallList(GLCACHE_StringList[i].List);
+        return;
+    }
+
+    if( !GLCACHE_Compiling )
+    {
+        GLCACHE_StringMake(font,string,GL_COMPILE_AND_EXECUTE);
+        return;
+    }
+
+    // Characters in the scene list now, its own list afterwards.
+    GLCACHE_StringCharacters(font,string);
+
+    item.Font = font;
+    item.Text = string;
+    item.List = 0;
+    GLCACHE_StringMissing.push_back(item);
+}
+
+/******************************************************************************/
+
+bool GLCACHE_SceneStart( void )
+{
+GLuint list;
+int i,key;
+
+    // Lists for the rings and strings that weren't cached in the last scene
+    // (not made then, as replacing a string's list would change that scene).
+    for( i=0; (i < (int)GLCACHE_RingMissing.size()); i++ )
+    {
+        key = GLCACHE_RingMissing[i];
+
+        // A list that can't be made isn't cached, so it's tried again.
+        if( (GLCACHE_RingList.find(key) == GLCACHE_RingList.end()) && ((list=GLCACHE_RingMake((double)key / 10000.0)) != 0) )
+        {
+            GLCACHE_RingList[key] = list;
+        }
+    }
+
+    for( i=0; (i < (int)GLCACHE_StringMissing.size()); i++ )
+    {
+        if( GLCACHE_StringFind(GLCACHE_StringMissing[i].Font,GLCACHE_StringMissing[i].Text.c_str()) < 0 )
+        {
+            GLCACHE_StringMake(GLCACHE_StringMissing[i].Font,GLCACHE_StringMissing[i].Text.c_str(),GL_COMPILE);
+        }
+    }
+
+    GLCACHE_RingMissing.clear();
+    GLCACHE_StringMissing.clear();
+
+    // The disc is in every scene, so make it first.
+    if( GLCACHE_DiscList == 0 )
+    {
+        GLCACHE_DiscList = GLCACHE_DiscMake();
+    }
+
+    // The same list is compiled again for each frame.
+    if( GLCACHE_SceneList == 0 )
+    {
+        GLCACHE_SceneList = glGenLists(1);
+    }
+
+    if( GLCACHE_SceneList == 0 )
+    {
+        return(false);
+    }
+
+    glNewList(GLCACHE_SceneList,GL_COMPILE);
+    GLCACHE_Compiling = true;
+
+    return(true);
+}
+
+/******************************************************************************/
+
+void GLCACHE_SceneEnd( void )
+{
+    if( GLCACHE_Compiling )
+    {
+        glEndList();
+        GLCACHE_Compiling = false;
+    }
+}
+
+/******************************************************************************/
+
+void GLCACHE_SceneCall( void )
+{
+    if( GLCACHE_SceneList != 0 )
+    {
+        glCallList(GLCACHE_SceneList);
+    }
+}
+
+/******************************************************************************/
+
+void GLCACHE_Free( void )
+{
+std::map<int,GLuint>::iterator item;
+int i;
+
+    if( GLCACHE_DiscList != 0 )
+    {
+        glDeleteLists(GLCACHE_DiscList,1);
+        GLCACHE_DiscList = 0;
+    }
+
+    for( item=GLCACHE_RingList.begin(); (item != GLCACHE_RingList.end()); item++ )
+    {
+        if( item->second != 0 )
+        {
+            glDeleteLists(item->second,1);
+        }
+    }
+
+    for( i=0; (i < (int)GLCACHE_StringList.size()); i++ )
+    {
+        glDeleteLists(GLCACHE_StringList[i].List,1);
+    }
+
+    if( GLCACHE_SceneList != 0 )
+    {
+        glDeleteLists(GLCACHE_SceneList,1);
+        GLCACHE_SceneList = 0;
+    }
+
+    GLCACHE_RingList.clear();
+    GLCACHE_StringList.clear();
+    GLCACHE_StringNext = 0;
+    GLCACHE_RingMissing.clear();
+    GLCACHE_StringMissing.clear();
+}
+
+/******************************************************************************/
@@ -0,0 +1,68 @@
+/******************************************************************************/
+/*                                                                            */
+/* MODULE  : glcache.h                                                        */
+/*                                                                            */
+/* PURPOSE : Cached OpenGL geometry for discs, rings and stroke text.         */
+/*                                                                            */
+/* DATE    : 17/Oct/2026                                                      */
+/*                                                                            */
+/* CHANGES                                                                    */
+/*                                                                            */
+/* V1.0  HRS 17/Oct/2026 - Initial development.                               */
+/*                                                                            */
+/* V1.1  HRS 17/Oct/2026 - Scene list made once per frame for both eyes.      */
+/*                                                                            */
+/******************************************************************************/
+
+// The graphics scene is a few circles, rings and a line of text, but they
+// were made again for every frame (and for each eye): GRAPHICS_Circle()
+// generates the vertices of the circle, rings were two circles drawn over
+// each other and text was a glutStrokeCharacter() call per character.
+// GLCACHE compiles each shape once into an OpenGL display list (a unit disc,
+// a unit ring for each inner/outer ratio and each text string) so drawing it
+// is a transform and one glCallList().
+//
+// The lists belong to the OpenGL context, so they are made the first time
+// they are drawn (in the graphics thread) and GLCACHE_Free() must be called
+// before the context is closed. The number of text strings is limited; the
+// oldest is replaced when a new one is needed.
+//
+// In stereo the whole scene is the same for both eyes except for the view,
+// so GLCACHE_SceneStart() and GLCACHE_SceneEnd() compile it once per frame
+// into a scene list which GLCACHE_SceneCall() draws after each eye's view is
+// set. Display lists cannot be made while another is being compiled, so a
+// ring or string that isn't cached yet is put in the scene list as vertices
+// and its own list is made before the next scene is compiled.
+
+#ifndef GLCACHE_H
+#define GLCACHE_H
+
+/******************************************************************************/
+
+#define GLCACHE_SLICES   64             // Segments of a disc or ring.
+#define GLCACHE_STRINGS  32             // Text strings kept as lists.
+
+/******************************************************************************/
+
+// Filled disc in the x-y plane (current colour).
+void GLCACHE_Disc( double x, double y, double z, double radius );
+
+// Ring in the x-y plane, from radius-width to radius (current colour).
+void GLCACHE_Ring( double x, double y, double z, double radius, double width );
+
+// Stroke text at the current transform, as glutStrokeCharacter() for each character.
+void GLCACHE_String( void *font, const char *string );
+
+// Compile the scene drawn between them into the scene list (false if it can't be made).
+bool GLCACHE_SceneStart( void );
+void GLCACHE_SceneEnd( void );
+
+// Draw the scene list.
+void GLCACHE_SceneCall( void );
+
+// Delete the lists (with the OpenGL context still current).
+void GLCACHE_Free( void );
+
+/******************************************************************************/
+
+#endif
@@ -0,0 +1,209 @@
+/******************************************************************************/
+/*                                                                            */
+/* MODULE  : idlesched.cpp                                                    */
+/*                                                                            */
+/* PURPOSE : Sleep until the next deadline of the graphics idle function.     */
+/*                                                                            */
+/* DATE    : 17/Oct/2026                                                      */
+/*                                                                            */
+/* CHANGES                                                                    */
+/*                                                                            */
+/* V1.0  HRS 17/Oct/2026 - Initial development.                               */
+/*                                                                            */
+/******************************************************************************/
+
+#include <stdio.h>
+
+#include <chrono>
+#include <thread>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <mmsystem.h>
+#pragma comment(lib,"winmm.lib")
+#else
+#include <time.h>
+#endif
+
+#include "idlesched.h"
+
+/******************************************************************************/
+
+#if defined(_WIN32) && !defined(CREATE_WAITABLE_TIMER_HIGH_RESOLUTION)
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+static double IDLESCHED_Spin=0.001;
+static bool   IDLESCHED_Started=false;
+static double IDLESCHED_StartTime=0.0;
+
+#if defined(_WIN32)
+static HANDLE IDLESCHED_Timer=NULL;
+static bool   IDLESCHED_Period=false;   // timeBeginPeriod(1) in use.
+#endif
+
+// Statistics.
+static long   IDLESCHED_Waits=0;
+static long   IDLESCHED_Precise=0;
+static double IDLESCHED_SleepTime=0.0;
+static double IDLESCHED_SpinTime=0.0;
+static double IDLESCHED_LateTotal=0.0;
+static double IDLESCHED_LateMax=0.0;
+
+/******************************************************************************/
+
+double IDLESCHED_Time( void )
+{
+    return(std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+/******************************************************************************/
+
+bool IDLESCHED_Start( double spin )
+{
+    IDLESCHED_Stop();
+
+    IDLESCHED_Spin = spin;
+
+#if defined(_WIN32)
+    // High-resolution timer (Windows 10 1803 or later), otherwise a normal one at 1 msec.
+    if( (IDLESCHED_Timer=CreateWaitableTimerExW(NULL,NULL,CREATE_WAITABLE_TIMER_HIGH_RESOLUTION,TIMER_ALL_ACCESS)) == NULL )
+    {
+        IDLESCHED_Period = (timeBeginPeriod(1) == TIMERR_NOERROR);
+        IDLESCHED_Timer = CreateWaitableTimerExW(NULL,NULL,0,TIMER_ALL_ACCESS);
+    }
+
+    if( IDLESCHED_Timer == NULL )
+    {
+        return(false);
+    }
+#endif
+
+    IDLESCHED_Waits = 0;
+    IDLESCHED_Precise = 0;
+    IDLESCHED_SleepTime = 0.0;
+    IDLESCHED_SpinTime = 0.0;
+    IDLESCHED_LateTotal = 0.0;
+    IDLESCHED_LateMax = 0.0;
+
+    IDLESCHED_StartTime = IDLESCHED_Time();
+    IDLESCHED_Started = true;
+
+    return(true);
+}
+
+/******************************************************************************/
+
+void IDLESCHED_Stop( void )
+{
+#if defined(_WIN32)
+    if( IDLESCHED_Timer != NULL )
+    {
+        CloseHandle(IDLESCHED_Timer);
+        IDLESCHED_Timer = NULL;
+    }
+
+    if( IDLESCHED_Period )
+    {
+        timeEndPeriod(1);
+        IDLESCHED_Period = false;
+    }
+#endif
+
+    IDLESCHED_Started = false;
+}
+
+/******************************************************************************/
+
+static void IDLESCHED_Sleep( double seconds )
+{
+#if defined(_WIN32)
+LARGE_INTEGER due;
+
+    // Relative time in 100 nsec units.
+    due.QuadPart = -(LONGLONG)(seconds * 1.0E7);
+
+    if( SetWaitableTimer(IDLESCHED_Timer,&due,0,NULL,NULL,FALSE) )
+    {
+        WaitForSingleObject(IDLESCHED_Timer,INFINITE);
+    }
+#else
+struct timespec wait;
+
+    wait.tv_sec = (time_t)seconds;
+    wait.tv_nsec = (long)((seconds - (double)wait.tv_sec) * 1.0E9);
+
+    clock_nanosleep(CLOCK_MONOTONIC,0,&wait,NULL);
+#endif
+}
+
+/******************************************************************************/
+
+void IDLESCHED_Wait( double seconds, bool precise )
+{
+double now,deadline,sleep,finish,late;
+
+    if( !IDLESCHED_Started )
+    {
+        std::this_thread::yield();
+        return;
+    }
+
+    now = IDLESCHED_Time();
+    deadline = now + seconds;
+    IDLESCHED_Waits++;
+
+    // Sleep, leaving the spin time for a precise deadline.
+    sleep = precise ? (seconds - IDLESCHED_Spin) : seconds;
+
+    if( sleep > 0.0 )
+    {
+        IDLESCHED_Sleep(sleep);
+        IDLESCHED_SleepTime += (IDLESCHED_Time() - now);
+    }
+
+    if( !precise )
+    {
+        return;
+    }
+
+    // Spin for the rest.
+    now = IDLESCHED_Time();
+
+    while( IDLESCHED_Time() < deadline )
+    {
+        std::this_thread::yield();
+    }
+
+    finish = IDLESCHED_Time();
+    late = finish - deadline;
+    IDLESCHED_SpinTime += (finish - now);
+
+    IDLESCHED_Precise++;
+    IDLESCHED_LateTotal += late;
+
+    if( late > IDLESCHED_LateMax )
+    {
+        IDLESCHED_LateMax = late;
+    }
+}
+
+/******************************************************************************/
+
+void IDLESCHED_Results( void )
+{
+double elapsed;
+
+    elapsed = IDLESCHED_Time() - IDLESCHED_StartTime;
+
+    if( !IDLESCHED_Started || (elapsed <= 0.0) )
+    {
+        return;
+    }
+
+    printf("IDLESCHED: Waits=%ld Sleep=%.1lf%% Spin=%.1lf%% Precise=%ld Late Mean=%.3lf Max=%.3lf (msec).\n",
+           IDLESCHED_Waits,100.0 * IDLESCHED_SleepTime / elapsed,100.0 * IDLESCHED_SpinTime / elapsed,IDLESCHED_Precise,
+           (IDLESCHED_Precise > 0) ? (1000.0 * IDLESCHED_LateTotal / (double)IDLESCHED_Precise) : 0.0,1000.0 * IDLESCHED_LateMax);
+}
+
+/******************************************************************************/
@@ -0,0 +1,47 @@
+/******************************************************************************/
+/*                                                                            */
+/* MODULE  : idlesched.h                                                      */
+/*                                                                            */
+/* PURPOSE : Sleep until the next deadline of the graphics idle function.     */
+/*                                                                            */
+/* DATE    : 17/Oct/2026                                                      */
+/*                                                                            */
+/* CHANGES                                                                    */
+/*                                                                            */
+/* V1.0  HRS 17/Oct/2026 - Initial development.                               */
+/*                                                                            */
+/******************************************************************************/
+
+// The graphics idle function used to return straight away with Sleep(0), so
+// it ran continuously on one core. IDLESCHED_Wait() instead sleeps until the
+// next time something has to be done. A precise deadline (e.g., the point
+// before the vertical retrace where a frame is drawn) is met by sleeping
+// until IDLESCHED_Start()'s spin time before it and then spinning (yielding
+// the processor) for the rest, as the sleep itself is only accurate to the
+// timer resolution. Other deadlines (e.g., the next check of the state
+// machine) are only slept for.
+//
+// Sleeps use a high-resolution waitable timer on Windows (or the 1 msec
+// multimedia timer resolution where there isn't one) and clock_nanosleep()
+// elsewhere. IDLESCHED_Results() prints how much of the time was spent
+// asleep and how late precise deadlines were met.
+
+#ifndef IDLESCHED_H
+#define IDLESCHED_H
+
+/******************************************************************************/
+
+bool IDLESCHED_Start( double spin );
+void IDLESCHED_Stop( void );
+
+// Time (sec) from a steady clock.
+double IDLESCHED_Time( void );
+
+// Wait (sec), spinning for the last part if the deadline is precise.
+void IDLESCHED_Wait( double seconds, bool precise );
+
+void IDLESCHED_Results( void );
+
+/******************************************************************************/
+
+#endif
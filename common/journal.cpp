@@ -0,0 +1,252 @@
+/******************************************************************************/
+/*                                                                            */
+/* MODULE  : journal.cpp                                                      */
+/*                                                                            */
+/* PURPOSE : Append-only session journal for resuming interrupted sessions.   */
+/*                                                                            */
+/* DATE    : 17/Oct/2026                                                      */
+/*                                                                            */
+/* CHANGES                                                                    */
+/*                                                                            */
+/* V1.0  HRS 17/Oct/2026 - Initial development.                               */
+/*                                                                            */
+/******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+
+#include <mutex>
+#include <vector>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "journal.h"
+
+/******************************************************************************/
+
+static FILE        *JOURNAL_FP=NULL;
+static std::mutex   JOURNAL_Mutex;
+
+/******************************************************************************/
+
+uint32_t JOURNAL_Hash( const void *data, size_t bytes, uint32_t hash )
+{
+const unsigned char *b=(const unsigned char *)data;
+size_t i;
+
+    for( i=0; (i < bytes); i++ )
+    {
+        hash ^= b[i];
+        hash *= 16777619U;
+    }
+
+    return(hash);
+}
+
+/******************************************************************************/
+
+static uint32_t JOURNAL_Check( const JOURNAL_RECORD &record, const void *data )
+{
+uint32_t hash;
+
+    hash = JOURNAL_Hash(&record.Type,sizeof(record.Type));
+    hash = JOURNAL_Hash(&record.Bytes,sizeof(record.Bytes),hash);
+    hash = JOURNAL_Hash(data,(size_t)record.Bytes,hash);
+
+    return(hash);
+}
+
+/******************************************************************************/
+
+// Read records from the current position. Returns the end of the last whole
+// record, and ok is false if the function returned false.
+
+static long JOURNAL_Scan( FILE *FP, JOURNAL_FUNCTION function, bool &ok )
+{
+std::vector<unsigned char> data;
+JOURNAL_RECORD record;
+long end;
+
+    ok = true;
+    end = ftell(FP);
+
+    while( ok && (fread(&record,sizeof(record),1,FP) == 1) )
+    {
+        if( (record.Magic != JOURNAL_MAGIC) || (record.Bytes < 0) || (record.Bytes > JOURNAL_BYTES) )
+        {
+            break;
+        }
+
+        data.resize((size_t)record.Bytes + 1);
+
+        if( fread(data.data(),1,(size_t)record.Bytes,FP) != (size_t)record.Bytes )
+        {
+            break;
+        }
+
+        if( record.Check != JOURNAL_Check(record,data.data()) )
+        {
+            break;
+        }
+
+        if( function != NULL )
+        {
+            ok = (*function)(record.Type,data.data(),record.Bytes);
+        }
+
+        end = ftell(FP);
+    }
+
+    return(end);
+}
+
+/******************************************************************************/
+
+bool JOURNAL_Open( const char *file, bool create )
+{
+long end;
+bool ok;
+
+    JOURNAL_Close();
+
+    std::lock_guard<std::mutex> lock(JOURNAL_Mutex);
+
+    if( create )
+    {
+        JOURNAL_FP = fopen(file,"wb");
+        return(JOURNAL_FP != NULL);
+    }
+
+    if( (JOURNAL_FP=fopen(file,"r+b")) == NULL )
+    {
+        return(false);
+    }
+
+    // Remove a record that was not completely written.
+    end = JOURNAL_Scan(JOURNAL_FP,NULL,ok);
+    fflush(JOURNAL_FP);
+
+#if defined(_WIN32)
+    ok = (_chsize(_fileno(JOURNAL_FP),end) == 0);
+#else
+    ok = (ftruncate(fileno(JOURNAL_FP),(off_t)end) == 0);
+#endif
+
+    if( !ok || (fseek(JOURNAL_FP,end,SEEK_SET) != 0) )
+    {
+        fclose(JOURNAL_FP);
+        JOURNAL_FP = NULL;
+        return(false);
+    }
+
+    return(true);
+}
+
+/******************************************************************************/
+
+void JOURNAL_Close( void )
+{
+std::lock_guard<std::mutex> lock(JOURNAL_Mutex);
+
+    if( JOURNAL_FP != NULL )
+    {
+        fclose(JOURNAL_FP);
+        JOURNAL_FP = NULL;
+    }
+}
+
+/******************************************************************************/
+
+bool JOURNAL_Opened( void )
+{
+std::lock_guard<std::mutex> lock(JOURNAL_Mutex);
+
+    return(JOURNAL_FP != NULL);
+}
+
+/******************************************************************************/
+
+bool JOURNAL_Append( int type, const void *data, int bytes )
+{
+std::lock_guard<std::mutex> lock(JOURNAL_Mutex);
+JOURNAL_RECORD record;
+bool ok;
+
+    if( (JOURNAL_FP == NULL) || (bytes < 0) || (bytes > JOURNAL_BYTES) )
+    {
+        return(false);
+    }
+
+    record.Magic = JOURNAL_MAGIC;
+    record.Type = type;
+    record.Bytes = bytes;
+    record.Check = JOURNAL_Check(record,data);
+
+    ok = (fwrite(&record,sizeof(record),1,JOURNAL_FP) == 1);
+    ok = ok && ((bytes == 0) || (fwrite(data,1,(size_t)bytes,JOURNAL_FP) == (size_t)bytes));
+    ok = ok && (fflush(JOURNAL_FP) == 0);
+
+    // Make sure the record is on the disk, not just in the operating system.
+#if defined(_WIN32)
+    ok = ok && (_commit(_fileno(JOURNAL_FP)) == 0);
+#else
+    ok = ok && (fsync(fileno(JOURNAL_FP)) == 0);
+#endif
+
+    return(ok);
+}
+
+/******************************************************************************/
+
+bool JOURNAL_Read( const char *file, JOURNAL_FUNCTION function )
+{
+FILE *FP;
+bool ok;
+
+    if( (FP=fopen(file,"rb")) == NULL )
+    {
+        return(false);
+    }
+
+    JOURNAL_Scan(FP,function,ok);
+    fclose(FP);
+
+    return(ok);
+}
+
+/******************************************************************************/
+
+bool JOURNAL_Parameter( int &argc, char *argv[], const char *flag )
+{
+bool found=false;
+int i,j,k;
+
+    for( i=1; (i < argc); )
+    {
+        for( k=0; ((argv[i][k] != 0) && (tolower((unsigned char)argv[i][k]) == tolower((unsigned char)flag[k]))); k++ );
+
+        if( (argv[i][k] != 0) || (flag[k] != 0) )
+        {
+            i++;
+            continue;
+        }
+
+        // Remove it so the rest of the command line is parsed as usual.
+        for( j=i; (j < (argc-1)); j++ )
+        {
+            argv[j] = argv[j+1];
+        }
+
+        argc--;
+        found = true;
+    }
+
+    return(found);
+}
+
+/******************************************************************************/
@@ -0,0 +1,67 @@
+/******************************************************************************/
+/*                                                                            */
+/* MODULE  : journal.h                                                        */
+/*                                                                            */
+/* PURPOSE : Append-only session journal for resuming interrupted sessions.   */
+/*                                                                            */
+/* DATE    : 17/Oct/2026                                                      */
+/*                                                                            */
+/* CHANGES                                                                    */
+/*                                                                            */
+/* V1.0  HRS 17/Oct/2026 - Initial development.                               */
+/*                                                                            */
+/******************************************************************************/
+
+// The journal is a file of records, each a JOURNAL_RECORD followed by Bytes of
+// data. The record type and data are up to the program. JOURNAL_Append()
+// writes a whole record and flushes it to the disk (fsync) before returning,
+// so after a crash the journal holds every record that was appended.
+//
+// JOURNAL_Read() calls a function for each record in turn. A record that was
+// only partly written when the program died (or fails its check) ends the
+// journal. JOURNAL_Open() without create removes it before appending.
+
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/******************************************************************************/
+
+#define JOURNAL_MAGIC      0x4C4E524AU  // "JRNL".
+#define JOURNAL_HASH       2166136261U  // FNV-1a initial value.
+#define JOURNAL_BYTES      (64*1024*1024)
+
+struct JOURNAL_RECORD
+{
+    uint32_t Magic;
+    int32_t  Type;
+    int32_t  Bytes;
+    uint32_t Check;     // JOURNAL_Hash() of type, bytes and data.
+};
+
+// Function called for each record (returns false to stop reading).
+typedef bool (*JOURNAL_FUNCTION)( int type, const void *data, int bytes );
+
+/******************************************************************************/
+
+// Open the journal to append records (create starts a new, empty journal).
+bool JOURNAL_Open( const char *file, bool create );
+void JOURNAL_Close( void );
+bool JOURNAL_Opened( void );
+
+bool JOURNAL_Append( int type, const void *data, int bytes );
+
+// Read records (returns false if the file can't be read or function fails).
+bool JOURNAL_Read( const char *file, JOURNAL_FUNCTION function );
+
+// FNV-1a hash (continue a hash by passing the previous value).
+uint32_t JOURNAL_Hash( const void *data, size_t bytes, uint32_t hash=JOURNAL_HASH );
+
+// Remove a flag (e.g., "/resume") from the command line (true if it was there).
+bool JOURNAL_Parameter( int &argc, char *argv[], const char *flag );
+
+/******************************************************************************/
+
+#endif
@@ -0,0 +1,447 @@
+/******************************************************************************/
+/*                                                                            */
+/* MODULE  : kinemetric.cpp                                                   */
+/*                                                                            */
+/* PURPOSE : Per-trial kinematic metrics from the FrameData columns.          */
+/*                                                                            */
+/* DATE    : 17/Oct/2026                                                      */
+/*                                                                            */
+/* CHANGES                                                                    */
+/*                                                                            */
+/* V1.0  HRS 17/Oct/2026 - Initial development.                               */
+/*                                                                            */
+/******************************************************************************/
+
+#include <math.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define KINEMETRIC_SSE2
+#endif
+
+#include "kinemetric.h"
+
+/******************************************************************************/
+
+#define KINEMETRIC_PI  3.14159265358979323846
+
+/******************************************************************************/
+
+void KINEMETRIC_Defaults( KINEMETRIC_TRIAL &trial )
+{
+    trial.Rows = 0;
+    trial.Time = NULL;
+    trial.State = NULL;
+    trial.Position = NULL;
+    trial.Velocity = NULL;
+    trial.Forces = NULL;
+
+    trial.Channel = KINEMETRIC_CHANNEL_NONE;
+    trial.SymmetryAxisAngle = 0.0;
+    trial.TargetAngle = 0.0;
+    trial.SingleMovement = false;
+    trial.FinishPosition[0] = 0.0;
+    trial.FinishPosition[1] = 0.0;
+    trial.ChannelStopStates = 0;
+
+    trial.ViaState = -1;
+    trial.ViaNotMovingSpeed = 5.0;
+    trial.ViaToleranceTime = 0.0;
+
+    trial.OnsetFraction = 0.1;
+}
+
+/******************************************************************************/
+
+double KINEMETRIC_ForceFieldAngle( const double position[2], const double finish[2] )
+{
+double angle;
+
+    // Same as ForceFieldStart(): D = ForceFieldPosition - FinishPosition.
+    angle = atan2(position[0]-finish[0],-(position[1]-finish[1])) * 180.0 / KINEMETRIC_PI;
+
+    return(angle);
+}
+
+/******************************************************************************/
+
+static inline double KINEMETRIC_Speed2( const double *V, int row )
+{
+    return((V[(row*3)+0] * V[(row*3)+0]) + (V[(row*3)+1] * V[(row*3)+1]) + (V[(row*3)+2] * V[(row*3)+2]));
+}
+
+/******************************************************************************/
+
+// Largest squared speed in rows first...last-1 (returns row of the peak).
+
+static int KINEMETRIC_PeakSpeed( const double *V, int first, int last, double &peak )
+{
+int row,best=-1;
+double s;
+
+    peak = -1.0;
+    row = first;
+
+#if defined(KINEMETRIC_SSE2)
+    __m128d a,b,c,x,y,z,s2,m;
+    double lanes[2];
+
+    // Two rows (six doubles) at a time: (x0,y0) (z0,x1) (y1,z1).
+    m = _mm_set1_pd(-1.0);
+
+    for( ; ((row+1) < last); row+=2 )
+    {
+        a = _mm_loadu_pd(&V[(row*3)+0]);
+        b = _mm_loadu_pd(&V[(row*3)+2]);
+        c = _mm_loadu_pd(&V[(row*3)+4]);
+
+        x = _mm_shuffle_pd(a,b,2);
+        y = _mm_shuffle_pd(a,c,1);
+        z = _mm_shuffle_pd(b,c,2);
+
+        s2 = _mm_add_pd(_mm_add_pd(_mm_mul_pd(x,x),_mm_mul_pd(y,y)),_mm_mul_pd(z,z));
+
+        // Only go back for the row if this pair has a new peak.
+        if( _mm_movemask_pd(_mm_cmpgt_pd(s2,m)) != 0 )
+        {
+            _mm_storeu_pd(lanes,s2);
+
+            if( lanes[0] > peak )
+            {
+                peak = lanes[0];
+                best = row;
+            }
+
+            if( lanes[1] > peak )
+            {
+                peak = lanes[1];
+                best = row+1;
+            }
+
+            m = _mm_set1_pd(peak);
+        }
+    }
+#endif
+
+    for( ; (row < last); row++ )
+    {
+        s = KINEMETRIC_Speed2(V,row);
+
+        if( s > peak )
+        {
+            peak = s;
+            best = row;
+        }
+    }
+
+    return(best);
+}
+
+/******************************************************************************/
+
+// Largest and smallest rotated P(1) and F(1), and the sum of F(1), for rows
+// first...last-1. P(1) = c*(x-ox) - s*(y-oy), F(1) = c*Fx - s*Fy.
+
+struct KINEMETRIC_CHANNEL
+{
+    double c,s;
+    double Origin[2];
+    double PMax,PMin;
+    double FMax,FMin;
+    double FSum;
+};
+
+static void KINEMETRIC_ChannelPass( const double *X, const double *F, int first, int last, KINEMETRIC_CHANNEL &channel )
+{
+int row;
+double p,f;
+
+    channel.PMax = channel.FMax = -HUGE_VAL;
+    channel.PMin = channel.FMin = HUGE_VAL;
+    channel.FSum = 0.0;
+    row = first;
+
+#if defined(KINEMETRIC_SSE2)
+    __m128d a,b,c,x,y,P,Q;
+    __m128d pmax,pmin,fmax,fmin,fsum;
+    __m128d C,S,OX,OY;
+    double lanes[2];
+
+    C = _mm_set1_pd(channel.c);
+    S = _mm_set1_pd(channel.s);
+    OX = _mm_set1_pd(channel.Origin[0]);
+    OY = _mm_set1_pd(channel.Origin[1]);
+
+    pmax = fmax = _mm_set1_pd(-HUGE_VAL);
+    pmin = fmin = _mm_set1_pd(HUGE_VAL);
+    fsum = _mm_setzero_pd();
+
+    for( ; ((row+1) < last); row+=2 )
+    {
+        a = _mm_loadu_pd(&X[(row*3)+0]);
+        b = _mm_loadu_pd(&X[(row*3)+2]);
+        c = _mm_loadu_pd(&X[(row*3)+4]);
+
+        x = _mm_sub_pd(_mm_shuffle_pd(a,b,2),OX);
+        y = _mm_sub_pd(_mm_shuffle_pd(a,c,1),OY);
+        P = _mm_sub_pd(_mm_mul_pd(C,x),_mm_mul_pd(S,y));
+
+        a = _mm_loadu_pd(&F[(row*3)+0]);
+        b = _mm_loadu_pd(&F[(row*3)+2]);
+        c = _mm_loadu_pd(&F[(row*3)+4]);
+
+        x = _mm_shuffle_pd(a,b,2);
+        y = _mm_shuffle_pd(a,c,1);
+        Q = _mm_sub_pd(_mm_mul_pd(C,x),_mm_mul_pd(S,y));
+
+        pmax = _mm_max_pd(pmax,P);
+        pmin = _mm_min_pd(pmin,P);
+        fmax = _mm_max_pd(fmax,Q);
+        fmin = _mm_min_pd(fmin,Q);
+        fsum = _mm_add_pd(fsum,Q);
+    }
+
+    _mm_storeu_pd(lanes,pmax);
+    channel.PMax = (lanes[0] > lanes[1]) ? lanes[0] : lanes[1];
+    _mm_storeu_pd(lanes,pmin);
+    channel.PMin = (lanes[0] < lanes[1]) ? lanes[0] : lanes[1];
+    _mm_storeu_pd(lanes,fmax);
+    channel.FMax = (lanes[0] > lanes[1]) ? lanes[0] : lanes[1];
+    _mm_storeu_pd(lanes,fmin);
+    channel.FMin = (lanes[0] < lanes[1]) ? lanes[0] : lanes[1];
+    _mm_storeu_pd(lanes,fsum);
+    channel.FSum = lanes[0] + lanes[1];
+#endif
+
+    for( ; (row < last); row++ )
+    {
+        p = (channel.c * (X[(row*3)+0] - channel.Origin[0])) - (channel.s * (X[(row*3)+1] - channel.Origin[1]));
+        f = (channel.c * F[(row*3)+0]) - (channel.s * F[(row*3)+1]);
+
+        channel.PMax = (p > channel.PMax) ? p : channel.PMax;
+        channel.PMin = (p < channel.PMin) ? p : channel.PMin;
+        channel.FMax = (f > channel.FMax) ? f : channel.FMax;
+        channel.FMin = (f < channel.FMin) ? f : channel.FMin;
+        channel.FSum += f;
+    }
+}
+
+/******************************************************************************/
+
+// Via-point dwell. Returns the row where the hand had been still for
+// ViaToleranceTime (-1 if it never was), as STATE_VIAPOINT does with
+// ViaNotMovingTimer. The timer is taken to start on entering the via point.
+
+static int KINEMETRIC_Via( const KINEMETRIC_TRIAL &trial, KINEMETRIC_RESULT &result )
+{
+int row,first=-1,last=-1,still=-1;
+double reset=0.0,speed2;
+
+    speed2 = trial.ViaNotMovingSpeed * trial.ViaNotMovingSpeed;
+
+    for( row=0; (row < trial.Rows); row++ )
+    {
+        if( (int)trial.State[row] != trial.ViaState )
+        {
+            if( first >= 0 )
+            {
+                break;
+            }
+
+            continue;
+        }
+
+        if( first < 0 )
+        {
+            first = row;
+            reset = trial.Time[row];
+        }
+
+        last = row;
+
+        if( still >= 0 )
+        {
+            continue;
+        }
+
+        if( KINEMETRIC_Speed2(trial.Velocity,row) >= speed2 )
+        {
+            reset = trial.Time[row];
+        }
+        else
+        if( (trial.Time[row] - reset) >= trial.ViaToleranceTime )
+        {
+            still = row;
+        }
+    }
+
+    if( first < 0 )
+    {
+        return(-1);
+    }
+
+    // Until the first row after the via point (or the last row).
+    result.ViaDwell = trial.Time[(last+1 < trial.Rows) ? last+1 : last] - trial.Time[first];
+    result.ViaStillTime = (still >= 0) ? trial.Time[still] : -1.0;
+
+    return(still);
+}
+
+/******************************************************************************/
+
+void KINEMETRIC_Trial( const KINEMETRIC_TRIAL &trial, KINEMETRIC_RESULT &result )
+{
+KINEMETRIC_CHANNEL channel;
+double peak,threshold,angle,forcefieldangle;
+int row,first,last,still=-1;
+
+    result.PeakSpeed = 0.0;
+    result.PeakSpeedTime = -1.0;
+    result.OnsetTime = -1.0;
+    result.ChannelAngle = 0.0;
+    result.ChannelFirstRow = -1;
+    result.ChannelLastRow = -1;
+    result.PerpendicularError = 0.0;
+    result.LateralForcePeak = 0.0;
+    result.LateralForceMean = 0.0;
+    result.ViaDwell = 0.0;
+    result.ViaStillTime = -1.0;
+
+    if( trial.Rows <= 0 )
+    {
+        return;
+    }
+
+    // Peak speed, then back from the peak to where speed crossed the threshold.
+    row = KINEMETRIC_PeakSpeed(trial.Velocity,0,trial.Rows,peak);
+    result.PeakSpeed = sqrt(peak);
+    result.PeakSpeedTime = trial.Time[row];
+
+    if( peak > 0.0 )
+    {
+        threshold = trial.OnsetFraction * trial.OnsetFraction * peak;
+
+        for( ; ((row > 0) && (KINEMETRIC_Speed2(trial.Velocity,row-1) >= threshold)); row-- );
+
+        result.OnsetTime = trial.Time[row];
+    }
+
+    if( trial.ViaState >= 0 )
+    {
+        still = KINEMETRIC_Via(trial,result);
+    }
+
+    if( trial.Channel == KINEMETRIC_CHANNEL_NONE )
+    {
+        return;
+    }
+
+    // Where the channel starts and what ForceFieldStart() did there.
+    first = -1;
+    forcefieldangle = 0.0;
+
+    if( trial.Channel == KINEMETRIC_CHANNEL_FIRST )
+    {
+        first = 0;
+    }
+    else
+    if( still >= 0 )
+    {
+        first = still;
+        forcefieldangle = KINEMETRIC_ForceFieldAngle(&trial.Position[first*3],trial.FinishPosition);
+    }
+
+    if( first < 0 )
+    {
+        return;
+    }
+
+    // Channel is on until one of the stop states.
+    for( last=first+1; ((last < trial.Rows) && !(trial.ChannelStopStates & KINEMETRIC_STATE((int)trial.State[last]))); last++ );
+
+    // Same angle as RobotFieldCompile().
+    angle = trial.SymmetryAxisAngle - forcefieldangle;
+
+    if( trial.SingleMovement )
+    {
+        angle += trial.TargetAngle;
+    }
+
+    channel.c = cos(angle * KINEMETRIC_PI / 180.0);
+    channel.s = sin(angle * KINEMETRIC_PI / 180.0);
+    channel.Origin[0] = trial.Position[(first*3)+0];
+    channel.Origin[1] = trial.Position[(first*3)+1];
+
+    KINEMETRIC_ChannelPass(trial.Position,trial.Forces,first,last,channel);
+
+    result.ChannelAngle = angle;
+    result.ChannelFirstRow = first;
+    result.ChannelLastRow = last-1;
+    result.PerpendicularError = (fabs(channel.PMax) >= fabs(channel.PMin)) ? channel.PMax : channel.PMin;
+    result.LateralForcePeak = (fabs(channel.FMax) >= fabs(channel.FMin)) ? channel.FMax : channel.FMin;
+    result.LateralForceMean = channel.FSum / (double)(last - first);
+}
+
+/******************************************************************************/
+
+// Each thread takes the next trial until there are none left.
+
+struct KINEMETRIC_BATCH
+{
+    const KINEMETRIC_TRIAL *Trial;
+    KINEMETRIC_RESULT *Result;
+    int Trials;
+    std::atomic<int> Next;
+};
+
+static void KINEMETRIC_Thread( KINEMETRIC_BATCH *batch )
+{
+int t;
+
+    while( (t=batch->Next++) < batch->Trials )
+    {
+        KINEMETRIC_Trial(batch->Trial[t],batch->Result[t]);
+    }
+}
+
+/******************************************************************************/
+
+void KINEMETRIC_Batch( const KINEMETRIC_TRIAL trial[], KINEMETRIC_RESULT result[], int trials, int threads )
+{
+std::vector<std::thread> thread;
+KINEMETRIC_BATCH batch;
+int i;
+
+    if( threads <= 0 )
+    {
+        threads = (int)std::thread::hardware_concurrency();
+    }
+
+    if( threads > trials )
+    {
+        threads = trials;
+    }
+
+    batch.Trial = trial;
+    batch.Result = result;
+    batch.Trials = trials;
+    batch.Next = 0;
+
+    for( i=1; (i < threads); i++ )
+    {
+        thread.push_back(std::thread(KINEMETRIC_Thread,&batch));
+    }
+
+    KINEMETRIC_Thread(&batch);
+
+    for( i=0; (i < (int)thread.size()); i++ )
+    {
+        thread[i].join();
+    }
+}
+
+/******************************************************************************/
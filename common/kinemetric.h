@@ -0,0 +1,107 @@
+/******************************************************************************/
+/*                                                                            */
+/* MODULE  : kinemetric.h                                                     */
+/*                                                                            */
+/* PURPOSE : Per-trial kinematic metrics from the FrameData columns.          */
+/*                                                                            */
+/* DATE    : 17/Oct/2026                                                      */
+/*                                                                            */
+/* CHANGES                                                                    */
+/*                                                                            */
+/* V1.0  HRS 17/Oct/2026 - Initial development.                               */
+/*                                                                            */
+/******************************************************************************/
+
+// KINEMETRIC_Trial() calculates the usual per-trial measures (peak speed,
+// movement onset, perpendicular error from the channel, lateral force in the
+// channel and via-point dwell) from the RobotPosition, RobotVelocity and
+// RobotForces columns of one trial (Rows x 3, as saved by COLTABLE and read
+// by COLFILE_READER). KINEMETRIC_Batch() does a list of trials on a number of
+// threads. The loops over rows work on two rows at a time with SSE2 where
+// the compiler has it (x86-64 always does).
+//
+// The channel is the one the robot forces function used. Position and
+// forces are rotated by the same matrix as RobotFieldCompile() (R = romxZ of
+// SymmetryAxisAngle - ForceFieldAngle, plus TargetAngle for single
+// movements) about ForceFieldPosition, so element 1 of the rotated vector is
+// perpendicular to the channel. For a channel on the first movement,
+// ForceFieldPosition is the hand position at the start of the trial and
+// ForceFieldAngle is zero. For a channel on the second movement,
+// ForceFieldStart() is called once the hand has been still in the via point
+// for ViaToleranceTime, so the row where that happens is found as the
+// experiment does (ViaNotMovingTimer) and ForceFieldAngle is calculated from
+// the hand position there and FinishPosition.
+
+#ifndef KINEMETRIC_H
+#define KINEMETRIC_H
+
+#include <stdint.h>
+
+/******************************************************************************/
+
+#define KINEMETRIC_CHANNEL_NONE   0
+#define KINEMETRIC_CHANNEL_FIRST  1    // As ChannelOrderType CHANNEL_FIRST.
+#define KINEMETRIC_CHANNEL_SECOND 2    // As ChannelOrderType CHANNEL_SECOND.
+
+#define KINEMETRIC_STATE(S)  (1U << (S))
+
+struct KINEMETRIC_TRIAL
+{
+    // FrameData columns for the trial.
+    int           Rows;
+    const double *Time;                // TrialTime.
+    const double *State;
+    const double *Position;            // RobotPosition (3 per row).
+    const double *Velocity;            // RobotVelocity (3 per row).
+    const double *Forces;              // RobotForces (3 per row).
+
+    // Channel (KINEMETRIC_CHANNEL_NONE if it isn't a channel trial).
+    int      Channel;
+    double   SymmetryAxisAngle;        // Degrees.
+    double   TargetAngle;              // Degrees (only for single movements).
+    bool     SingleMovement;           // MovementOrderType ORDER_SINGLE_MOVEMENT.
+    double   FinishPosition[2];
+    uint32_t ChannelStopStates;        // KINEMETRIC_STATE() of states that stop the channel.
+
+    // Via point (ViaState is -1 if there isn't one).
+    int      ViaState;                 // e.g., STATE_VIAPOINT.
+    double   ViaNotMovingSpeed;
+    double   ViaToleranceTime;
+
+    // Onset is where speed first rises above this fraction of peak speed.
+    double   OnsetFraction;
+};
+
+struct KINEMETRIC_RESULT
+{
+    double PeakSpeed;
+    double PeakSpeedTime;
+    double OnsetTime;                  // -1 if there is no movement.
+
+    double ChannelAngle;               // Degrees (angle of R).
+    int    ChannelFirstRow;            // Rows with the channel on (-1 if none).
+    int    ChannelLastRow;
+    double PerpendicularError;         // Largest (signed) rotated P(1).
+    double LateralForcePeak;           // Largest (signed) rotated F(1).
+    double LateralForceMean;
+
+    double ViaDwell;                   // Time in the via-point state (seconds).
+    double ViaStillTime;               // TrialTime where ViaNotMovingTime was reached (-1 if never).
+};
+
+/******************************************************************************/
+
+// Defaults for the parts of a KINEMETRIC_TRIAL that aren't columns.
+void KINEMETRIC_Defaults( KINEMETRIC_TRIAL &trial );
+
+// ForceFieldAngle for a channel on the second movement (degrees).
+double KINEMETRIC_ForceFieldAngle( const double position[2], const double finish[2] );
+
+void KINEMETRIC_Trial( const KINEMETRIC_TRIAL &trial, KINEMETRIC_RESULT &result );
+
+// Calculate trials on threads (0 for one per processor).
+void KINEMETRIC_Batch( const KINEMETRIC_TRIAL trial[], KINEMETRIC_RESULT result[], int trials, int threads=0 );
+
+/******************************************************************************/
+
+#endif
@@ -0,0 +1,313 @@
+/******************************************************************************/
+/*                                                                            */
+/* MODULE  : loophist.cpp                                                     */
+/*                                                                            */
+/* PURPOSE : Log-linear (HDR-style) timing histograms for the robot loop.     */
+/*                                                                            */
+/* DATE    : 17/Oct/2026                                                      */
+/*                                                                            */
+/* CHANGES                                                                    */
+/*                                                                            */
+/* V1.0  HRS 17/Oct/2026 - Initial development.                               */
+/*                                                                            */
+/******************************************************************************/
+
+#include <math.h>
+#include <string.h>
+
+#include "loophist.h"
+
+/******************************************************************************/
+
+LOOPHIST::LOOPHIST( void )
+{
+    Reset();
+}
+
+/******************************************************************************/
+
+void LOOPHIST::Reset( void )
+{
+    memset(Bucket,0,sizeof(Bucket));
+    Total = 0;
+    Minimum = 0;
+    Maximum = 0;
+    Sum = 0.0;
+}
+
+/******************************************************************************/
+
+void LOOPHIST::Merge( const LOOPHIST &histogram )
+{
+int i;
+
+    if( histogram.Total == 0 )
+    {
+        return;
+    }
+
+    for( i=0; (i < LOOPHIST_BUCKETS); i++ )
+    {
+        Bucket[i] += histogram.Bucket[i];
+    }
+
+    if( (Total == 0) || (histogram.Minimum < Minimum) )
+    {
+        Minimum = histogram.Minimum;
+    }
+
+    if( histogram.Maximum > Maximum )
+    {
+        Maximum = histogram.Maximum;
+    }
+
+    Total += histogram.Total;
+    Sum += histogram.Sum;
+}
+
+/******************************************************************************/
+
+unsigned long LOOPHIST::Count( void ) const
+{
+    return(Total);
+}
+
+/******************************************************************************/
+
+double LOOPHIST::Min( void ) const
+{
+    return((double)Minimum / 1000.0);
+}
+
+/******************************************************************************/
+
+double LOOPHIST::Max( void ) const
+{
+    return((double)Maximum / 1000.0);
+}
+
+/******************************************************************************/
+
+double LOOPHIST::Mean( void ) const
+{
+double mean=0.0;
+
+    if( Total != 0 )
+    {
+        mean = (Sum / (double)Total) / 1000.0;
+    }
+
+    return(mean);
+}
+
+/******************************************************************************/
+
+unsigned long long LOOPHIST::BucketLow( int index )
+{
+unsigned long long low;
+int shift;
+
+    if( index < (2 * LOOPHIST_SUB) )
+    {
+        low = (unsigned long long)index;
+    }
+    else
+    {
+        shift = (index / LOOPHIST_SUB) - 1;
+        low = (unsigned long long)((index % LOOPHIST_SUB) + LOOPHIST_SUB) << shift;
+    }
+
+    return(low);
+}
+
+/******************************************************************************/
+
+unsigned long long LOOPHIST::BucketWidth( int index )
+{
+unsigned long long width=1;
+
+    if( index >= (2 * LOOPHIST_SUB) )
+    {
+        width = 1ULL << ((index / LOOPHIST_SUB) - 1);
+    }
+
+    return(width);
+}
+
+/******************************************************************************/
+
+double LOOPHIST::Percentile( double percent ) const
+{
+unsigned long long count,target;
+double value;
+int i;
+
+    if( Total == 0 )
+    {
+        return(0.0);
+    }
+
+    target = (unsigned long long)ceil((percent / 100.0) * (double)Total);
+
+    if( target < 1 )
+    {
+        target = 1;
+    }
+
+    // Middle of the bucket containing the target count, within the min and max.
+    for( count=0,i=0; (i < LOOPHIST_BUCKETS); i++ )
+    {
+        count += Bucket[i];
+
+        if( count >= target )
+        {
+            break;
+        }
+    }
+
+    value = (double)BucketLow(i) + ((double)(BucketWidth(i) - 1) / 2.0);
+
+    if( value < (double)Minimum )
+    {
+        value = (double)Minimum;
+    }
+
+    if( value > (double)Maximum )
+    {
+        value = (double)Maximum;
+    }
+
+    return(value / 1000.0);
+}
+
+/******************************************************************************/
+
+void LOOPHIST::Write( FILE *stream, bool buckets ) const
+{
+int i;
+
+    fprintf(stream,"Count=%lu Min=%.1lf Mean=%.1lf P50=%.1lf P90=%.1lf P99=%.1lf P99.9=%.1lf Max=%.1lf",Total,Min(),Mean(),Percentile(50.0),Percentile(90.0),Percentile(99.0),Percentile(99.9),Max());
+
+    if( buckets )
+    {
+        fprintf(stream," Buckets=");
+
+        for( i=0; (i < LOOPHIST_BUCKETS); i++ )
+        {
+            if( Bucket[i] != 0 )
+            {
+                fprintf(stream," %llu:%lu",BucketLow(i),Bucket[i]);
+            }
+        }
+    }
+
+    fprintf(stream,"\n");
+}
+
+/******************************************************************************/
+
+LOOPHIST_STATES::LOOPHIST_STATES( int states, char *text[] )
+{
+    States = states;
+    StateText = text;
+    Histogram = new LOOPHIST[States * LOOPHIST_TYPES];
+    Saved = false;
+}
+
+/******************************************************************************/
+
+LOOPHIST_STATES::~LOOPHIST_STATES( void )
+{
+    delete [] Histogram;
+}
+
+/******************************************************************************/
+
+void LOOPHIST_STATES::Reset( void )
+{
+int i;
+
+    for( i=0; (i < (States * LOOPHIST_TYPES)); i++ )
+    {
+        Histogram[i].Reset();
+    }
+}
+
+/******************************************************************************/
+
+void LOOPHIST_STATES::Merge( const LOOPHIST_STATES &histograms )
+{
+int i;
+
+    for( i=0; (i < (States * LOOPHIST_TYPES)) && (i < (histograms.States * LOOPHIST_TYPES)); i++ )
+    {
+        Histogram[i].Merge(histograms.Histogram[i]);
+    }
+}
+
+/******************************************************************************/
+
+const LOOPHIST &LOOPHIST_STATES::Get( int state, int type ) const
+{
+    return(Histogram[(state * LOOPHIST_TYPES) + type]);
+}
+
+/******************************************************************************/
+
+bool LOOPHIST_STATES::Save( const char *file, int trial )
+{
+FILE *FP;
+int state,type;
+static const char *TypeText[LOOPHIST_TYPES] = { "Latency","Period" };
+
+    // Not (trial <= 1), as a missed Trial 1 is saved again when it's repeated.
+    if( (FP=fopen(file,Saved ? "a" : "w")) == NULL )
+    {
+        return(false);
+    }
+
+    Saved = true;
+
+    // One line per state and type with data (times in microseconds, buckets in nanoseconds).
+    for( state=0; (state < States); state++ )
+    {
+        for( type=0; (type < LOOPHIST_TYPES); type++ )
+        {
+            if( Get(state,type).Count() == 0 )
+            {
+                continue;
+            }
+
+            fprintf(FP,"Trial=%d State=%s Type=%s ",trial,StateText[state],TypeText[type]);
+            Get(state,type).Write(FP,true);
+        }
+    }
+
+    fclose(FP);
+
+    return(true);
+}
+
+/******************************************************************************/
+
+void LOOPHIST_STATES::Print( FILE *stream ) const
+{
+int state;
+
+    fprintf(stream,"%-14s %9s %8s %8s %8s %8s %8s | %8s %8s %8s\n","State","Ticks","Lat-P50","Lat-P99","Lat-P99.9","Lat-Max","Lat-Mean","Per-P50","Per-P99.9","Per-Max");
+
+    for( state=0; (state < States); state++ )
+    {
+        const LOOPHIST &latency=Get(state,LOOPHIST_LATENCY);
+        const LOOPHIST &period=Get(state,LOOPHIST_PERIOD);
+
+        if( latency.Count() == 0 )
+        {
+            continue;
+        }
+
+        fprintf(stream,"%-14s %9lu %8.1lf %8.1lf %8.1lf %8.1lf %8.1lf | %8.1lf %8.1lf %8.1lf\n",StateText[state],latency.Count(),latency.Percentile(50.0),latency.Percentile(99.0),latency.Percentile(99.9),latency.Max(),latency.Mean(),period.Percentile(50.0),period.Percentile(99.9),period.Max());
+    }
+}
+
+/******************************************************************************/
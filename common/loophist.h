@@ -0,0 +1,172 @@
+/******************************************************************************/
+/*                                                                            */
+/* MODULE  : loophist.h                                                       */
+/*                                                                            */
+/* PURPOSE : Log-linear (HDR-style) timing histograms for the robot loop.     */
+/*                                                                            */
+/* DATE    : 17/Oct/2026                                                      */
+/*                                                                            */
+/* CHANGES                                                                    */
+/*                                                                            */
+/* V1.0  HRS 17/Oct/2026 - Initial development.                               */
+/*                                                                            */
+/******************************************************************************/
+
+// Values are counted in nanosecond buckets. Below 64 ns each bucket is 1 ns
+// wide, and above that each power of two is split into 32 buckets, so the
+// relative error is never more than about 3% across the whole range (up to
+// about half an hour). Add() is a few integer operations and an increment, so
+// it can be called from the robot forces function every tick.
+//
+// LOOPHIST_STATES keeps a latency and a period histogram for each state of
+// the experiment's finite state machine.
+
+#ifndef LOOPHIST_H
+#define LOOPHIST_H
+
+#include <stdio.h>
+
+/******************************************************************************/
+
+#define LOOPHIST_SUBBITS   5
+#define LOOPHIST_SUB       (1 << LOOPHIST_SUBBITS)
+#define LOOPHIST_MSB       40
+#define LOOPHIST_BUCKETS   ((LOOPHIST_MSB - LOOPHIST_SUBBITS + 1) * LOOPHIST_SUB + LOOPHIST_SUB)
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/******************************************************************************/
+
+class LOOPHIST
+{
+private:
+    unsigned long Bucket[LOOPHIST_BUCKETS];
+    unsigned long Total;
+    unsigned long long Minimum;
+    unsigned long long Maximum;
+    double Sum;
+
+    static inline int MostSignificantBit( unsigned long long value )
+    {
+#if defined(_MSC_VER)
+    unsigned long index;
+
+        _BitScanReverse64(&index,value);
+        return((int)index);
+#else
+        return(63 - __builtin_clzll(value));
+#endif
+    }
+
+public:
+    LOOPHIST( void );
+
+    void Reset( void );
+
+    // Add a value in nanoseconds.
+    inline void Add( unsigned long long nsec )
+    {
+    int index,msb,shift;
+
+        if( nsec < (2 * LOOPHIST_SUB) )
+        {
+            index = (int)nsec;
+        }
+        else
+        {
+            msb = MostSignificantBit(nsec);
+
+            if( msb > LOOPHIST_MSB )
+            {
+                msb = LOOPHIST_MSB;
+                nsec = (2ULL << LOOPHIST_MSB) - 1ULL;
+            }
+
+            shift = msb - LOOPHIST_SUBBITS;
+            index = (shift * LOOPHIST_SUB) + (int)(nsec >> shift);
+        }
+
+        Bucket[index]++;
+        Total++;
+        Sum += (double)nsec;
+
+        if( (Total == 1) || (nsec < Minimum) )
+        {
+            Minimum = nsec;
+        }
+
+        if( nsec > Maximum )
+        {
+            Maximum = nsec;
+        }
+    }
+
+    // Add a value in microseconds.
+    inline void AddMicroseconds( double usec )
+    {
+        Add((usec <= 0.0) ? 0ULL : (unsigned long long)(usec * 1000.0));
+    }
+
+    void Merge( const LOOPHIST &histogram );
+
+    unsigned long Count( void ) const;
+    double Min( void ) const;           // Microseconds.
+    double Max( void ) const;
+    double Mean( void ) const;
+    double Percentile( double percent ) const;
+
+    // Lower edge and width of a bucket (nanoseconds).
+    static unsigned long long BucketLow( int index );
+    static unsigned long long BucketWidth( int index );
+
+    // Summary line plus non-zero buckets ("low:count" in nanoseconds).
+    void Write( FILE *stream, bool buckets ) const;
+};
+
+/******************************************************************************/
+
+#define LOOPHIST_LATENCY  0
+#define LOOPHIST_PERIOD   1
+#define LOOPHIST_TYPES    2
+
+class LOOPHIST_STATES
+{
+private:
+    int States;
+    char **StateText;
+    LOOPHIST *Histogram;
+    bool Saved;                         // File started by Save().
+
+public:
+    LOOPHIST_STATES( int states, char *text[] );
+   ~LOOPHIST_STATES( void );
+
+    void Reset( void );
+
+    // Latency and period (microseconds) of one tick of the loop in this state.
+    inline void Add( int state, double latency, double period )
+    {
+        if( (state >= 0) && (state < States) )
+        {
+            Histogram[(state * LOOPHIST_TYPES) + LOOPHIST_LATENCY].AddMicroseconds(latency);
+            Histogram[(state * LOOPHIST_TYPES) + LOOPHIST_PERIOD].AddMicroseconds(period);
+        }
+    }
+
+    void Merge( const LOOPHIST_STATES &histograms );
+
+    const LOOPHIST &Get( int state, int type ) const;
+
+    // Append histograms for a trial to a file (next to the data file). The
+    // first Save() of the session truncates the file.
+    bool Save( const char *file, int trial );
+
+    // Print a table of percentiles for states with data.
+    void Print( FILE *stream ) const;
+};
+
+/******************************************************************************/
+
+#endif
@@ -0,0 +1,400 @@
+/******************************************************************************/
+/*                                                                            */
+/* MODULE  : looplog.cpp                                                      */
+/*                                                                            */
+/* PURPOSE : Deferred console logging for the real-time robot loop.           */
+/*                                                                            */
+/* DATE    : 17/Oct/2026                                                      */
+/*                                                                            */
+/* CHANGES                                                                    */
+/*                                                                            */
+/* V1.0  HRS 17/Oct/2026 - Initial development.                               */
+/*                                                                            */
+/******************************************************************************/
+
+// The ring buffer is a bounded multiple-producer queue (both the robot loop
+// and the graphics thread log state transitions). Each slot has a sequence
+// number, so producers only need one compare-and-swap on the head counter and
+// never wait for the consumer. The single consumer is the background thread.
+
+#include <string.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "looplog.h"
+
+/******************************************************************************/
+
+struct LOOPLOG_SLOT
+{
+    std::atomic<unsigned long> Sequence;
+    LOOPLOG_RECORD Record;
+};
+
+static LOOPLOG_SLOT  LOOPLOG_Ring[LOOPLOG_SLOTS];
+static std::atomic<unsigned long> LOOPLOG_Head(0);
+static std::atomic<unsigned long> LOOPLOG_Tail(0);
+static std::atomic<unsigned long> LOOPLOG_DropCount(0);
+static std::atomic<bool> LOOPLOG_Running(false);
+static std::atomic<bool> LOOPLOG_Exit(false);
+static std::thread   LOOPLOG_Thread;
+static FILE         *LOOPLOG_Stream=stdout;
+static bool          LOOPLOG_TimeStampFlag=false;
+static long long     LOOPLOG_TickStart=0;
+
+/******************************************************************************/
+
+long long LOOPLOG_Tick( void )
+{
+long long tick;
+
+    tick = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+
+    return(tick);
+}
+
+/******************************************************************************/
+
+static long long LOOPLOG_ArgInt( const LOOPLOG_ARG &arg )
+{
+long long value=0;
+
+    switch( arg.Type )
+    {
+        case LOOPLOG_INT :
+            value = arg.i;
+            break;
+
+        case LOOPLOG_DOUBLE :
+            value = (long long)arg.d;
+            break;
+    }
+
+    return(value);
+}
+
+/******************************************************************************/
+
+static double LOOPLOG_ArgDouble( const LOOPLOG_ARG &arg )
+{
+double value=0.0;
+
+    switch( arg.Type )
+    {
+        case LOOPLOG_INT :
+            value = (double)arg.i;
+            break;
+
+        case LOOPLOG_DOUBLE :
+            value = arg.d;
+            break;
+    }
+
+    return(value);
+}
+
+/******************************************************************************/
+
+// Format a record one conversion at a time, using the argument type saved by
+// LOOPLOG_printf() rather than the length modifiers in the format string.
+
+static void LOOPLOG_Format( FILE *stream, const LOOPLOG_RECORD &record )
+{
+const char *f;
+char spec[32],text[256];
+int a,n;
+char conversion;
+
+    if( LOOPLOG_TimeStampFlag )
+    {
+        fprintf(stream,"[%10.3lf] ",(double)(record.Tick - LOOPLOG_TickStart) / 1.0E9);
+    }
+
+    for( f=record.Format,a=0; (*f != 0); )
+    {
+        if( *f != '%' )
+        {
+            fputc(*f++,stream);
+            continue;
+        }
+
+        if( f[1] == '%' )
+        {
+            fputc('%',stream);
+            f += 2;
+            continue;
+        }
+
+        // Flags, width and precision are kept, length modifiers are replaced.
+        n = 0;
+        spec[n++] = *f++;
+
+        while( (*f != 0) && (strchr("-+ #0123456789.",*f) != NULL) && (n < 24) )
+        {
+            spec[n++] = *f++;
+        }
+
+        while( (*f != 0) && (strchr("hlLqjzt",*f) != NULL) )
+        {
+            f++;
+        }
+
+        conversion = *f;
+
+        if( conversion != 0 )
+        {
+            f++;
+        }
+
+        if( a >= record.Count )
+        {
+            fputs("?",stream);
+            continue;
+        }
+
+        const LOOPLOG_ARG &arg=record.Arg[a++];
+
+        text[0] = 0;
+
+        switch( conversion )
+        {
+            case 'd' :
+            case 'i' :
+            case 'u' :
+            case 'x' :
+            case 'X' :
+            case 'o' :
+                spec[n++] = 'l';
+                spec[n++] = 'l';
+                spec[n++] = conversion;
+                spec[n] = 0;
+                snprintf(text,sizeof(text),spec,LOOPLOG_ArgInt(arg));
+                break;
+
+            case 'c' :
+                spec[n++] = conversion;
+                spec[n] = 0;
+                snprintf(text,sizeof(text),spec,(int)LOOPLOG_ArgInt(arg));
+                break;
+
+            case 'f' :
+            case 'F' :
+            case 'e' :
+            case 'E' :
+            case 'g' :
+            case 'G' :
+                spec[n++] = conversion;
+                spec[n] = 0;
+                snprintf(text,sizeof(text),spec,LOOPLOG_ArgDouble(arg));
+                break;
+
+            case 's' :
+                spec[n++] = conversion;
+                spec[n] = 0;
+                snprintf(text,sizeof(text),spec,(arg.Type == LOOPLOG_STRING) ? &record.Text[arg.s] : "?");
+                break;
+
+            case 'p' :
+                spec[n++] = conversion;
+                spec[n] = 0;
+                snprintf(text,sizeof(text),spec,(arg.Type == LOOPLOG_POINTER) ? arg.p : NULL);
+                break;
+        }
+
+        fputs(text,stream);
+    }
+}
+
+/******************************************************************************/
+
+// Take the oldest record from the ring buffer (background thread only).
+
+static bool LOOPLOG_Next( LOOPLOG_RECORD &record )
+{
+LOOPLOG_SLOT *slot;
+unsigned long tail;
+
+    tail = LOOPLOG_Tail.load(std::memory_order_relaxed);
+    slot = &LOOPLOG_Ring[tail & (LOOPLOG_SLOTS-1)];
+
+    if( slot->Sequence.load(std::memory_order_acquire) != (tail+1) )
+    {
+        return(false);
+    }
+
+    record = slot->Record;
+    slot->Sequence.store(tail+LOOPLOG_SLOTS,std::memory_order_release);
+    LOOPLOG_Tail.store(tail+1,std::memory_order_release);
+
+    return(true);
+}
+
+/******************************************************************************/
+
+static void LOOPLOG_ThreadFunction( void )
+{
+LOOPLOG_RECORD record;
+bool written;
+
+    for( ;; )
+    {
+        written = false;
+
+        while( LOOPLOG_Next(record) )
+        {
+            LOOPLOG_Format(LOOPLOG_Stream,record);
+            written = true;
+        }
+
+        if( written )
+        {
+            fflush(LOOPLOG_Stream);
+        }
+
+        if( LOOPLOG_Exit.load() && (LOOPLOG_Tail.load() == LOOPLOG_Head.load()) )
+        {
+            break;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+/******************************************************************************/
+
+void LOOPLOG_Record( LOOPLOG_RECORD &record )
+{
+LOOPLOG_SLOT *slot;
+unsigned long head;
+long diff;
+
+    // Not running, so just write it now.
+    if( !LOOPLOG_Running.load(std::memory_order_acquire) )
+    {
+        LOOPLOG_Format(LOOPLOG_Stream,record);
+        fflush(LOOPLOG_Stream);
+        return;
+    }
+
+    head = LOOPLOG_Head.load(std::memory_order_relaxed);
+
+    for( ;; )
+    {
+        slot = &LOOPLOG_Ring[head & (LOOPLOG_SLOTS-1)];
+        diff = (long)(slot->Sequence.load(std::memory_order_acquire) - head);
+
+        if( diff == 0 )
+        {
+            if( LOOPLOG_Head.compare_exchange_weak(head,head+1,std::memory_order_relaxed) )
+            {
+                break;
+            }
+        }
+        else
+        if( diff < 0 )
+        {
+            // Ring buffer full.
+            LOOPLOG_DropCount++;
+            return;
+        }
+        else
+        {
+            head = LOOPLOG_Head.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->Record = record;
+    slot->Sequence.store(head+1,std::memory_order_release);
+}
+
+/******************************************************************************/
+
+bool LOOPLOG_Start( FILE *stream )
+{
+unsigned long i;
+
+    if( LOOPLOG_Running.load() )
+    {
+        return(true);
+    }
+
+    LOOPLOG_Stream = stream;
+    LOOPLOG_TickStart = LOOPLOG_Tick();
+
+    for( i=0; (i < LOOPLOG_SLOTS); i++ )
+    {
+        LOOPLOG_Ring[i].Sequence.store(i);
+    }
+
+    LOOPLOG_Head.store(0);
+    LOOPLOG_Tail.store(0);
+    LOOPLOG_DropCount.store(0);
+    LOOPLOG_Exit.store(false);
+
+    LOOPLOG_Thread = std::thread(LOOPLOG_ThreadFunction);
+    LOOPLOG_Running.store(true);
+
+    return(true);
+}
+
+/******************************************************************************/
+
+void LOOPLOG_Flush( void )
+{
+unsigned long head;
+
+    if( !LOOPLOG_Running.load() )
+    {
+        return;
+    }
+
+    // Wait for the background thread to write everything logged so far.
+    head = LOOPLOG_Head.load();
+
+    while( (long)(LOOPLOG_Tail.load() - head) < 0 )
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    fflush(LOOPLOG_Stream);
+}
+
+/******************************************************************************/
+
+void LOOPLOG_Stop( void )
+{
+    if( !LOOPLOG_Running.load() )
+    {
+        return;
+    }
+
+    // New messages are written directly from now on.
+    LOOPLOG_Running.store(false);
+    LOOPLOG_Exit.store(true);
+    LOOPLOG_Thread.join();
+
+    if( LOOPLOG_DropCount.load() != 0 )
+    {
+        fprintf(LOOPLOG_Stream,"LOOPLOG: %lu messages dropped (ring buffer full).\n",LOOPLOG_DropCount.load());
+    }
+
+    fflush(LOOPLOG_Stream);
+}
+
+/******************************************************************************/
+
+void LOOPLOG_TimeStamp( bool flag )
+{
+    LOOPLOG_TimeStampFlag = flag;
+}
+
+/******************************************************************************/
+
+unsigned long LOOPLOG_Dropped( void )
+{
+    return(LOOPLOG_DropCount.load());
+}
+
+/******************************************************************************/
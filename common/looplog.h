@@ -0,0 +1,162 @@
+/******************************************************************************/
+/*                                                                            */
+/* MODULE  : looplog.h                                                        */
+/*                                                                            */
+/* PURPOSE : Deferred console logging for the real-time robot loop.           */
+/*                                                                            */
+/* DATE    : 17/Oct/2026                                                      */
+/*                                                                            */
+/* CHANGES                                                                    */
+/*                                                                            */
+/* V1.0  HRS 17/Oct/2026 - Initial development.                               */
+/*                                                                            */
+/******************************************************************************/
+
+// LOOPLOG_printf() takes the same arguments as printf() but only copies the
+// format pointer, a time stamp and the argument values into a fixed-size
+// ring buffer. A background thread does the formatting and console output, so
+// the robot forces function never waits on console I/O. The format must be a
+// string literal (or otherwise remain valid). String arguments are copied.
+// If the ring buffer is full the message is dropped and counted. Before
+// LOOPLOG_Start() or after LOOPLOG_Stop() messages are written immediately.
+
+#ifndef LOOPLOG_H
+#define LOOPLOG_H
+
+#include <stdio.h>
+
+/******************************************************************************/
+
+#define LOOPLOG_ARGS     8      // Maximum arguments per message.
+#define LOOPLOG_TEXT     96     // Space for copies of string arguments.
+#define LOOPLOG_SLOTS    1024   // Ring buffer size (power of two).
+
+#define LOOPLOG_INT      0
+#define LOOPLOG_DOUBLE   1
+#define LOOPLOG_STRING   2
+#define LOOPLOG_POINTER  3
+
+struct LOOPLOG_ARG
+{
+    int Type;
+
+    union
+    {
+        long long i;
+        double d;
+        int s;                  // Offset of string in LOOPLOG_RECORD::Text.
+        const void *p;
+    };
+};
+
+struct LOOPLOG_RECORD
+{
+    long long Tick;             // Time stamp (steady clock, nanoseconds).
+    const char *Format;
+    int Count;
+    LOOPLOG_ARG Arg[LOOPLOG_ARGS];
+    int Length;
+    char Text[LOOPLOG_TEXT];
+};
+
+/******************************************************************************/
+
+bool LOOPLOG_Start( FILE *stream=stdout );
+void LOOPLOG_Stop( void );
+void LOOPLOG_Flush( void );
+void LOOPLOG_TimeStamp( bool flag );
+unsigned long LOOPLOG_Dropped( void );
+
+// Used by LOOPLOG_printf().
+long long LOOPLOG_Tick( void );
+void LOOPLOG_Record( LOOPLOG_RECORD &record );
+
+/******************************************************************************/
+
+inline void LOOPLOG_ArgPut( LOOPLOG_RECORD &record, long long value )
+{
+    record.Arg[record.Count].Type = LOOPLOG_INT;
+    record.Arg[record.Count].i = value;
+}
+
+inline void LOOPLOG_ArgPut( LOOPLOG_RECORD &record, int value )                { LOOPLOG_ArgPut(record,(long long)value); }
+inline void LOOPLOG_ArgPut( LOOPLOG_RECORD &record, unsigned int value )       { LOOPLOG_ArgPut(record,(long long)value); }
+inline void LOOPLOG_ArgPut( LOOPLOG_RECORD &record, long value )               { LOOPLOG_ArgPut(record,(long long)value); }
+inline void LOOPLOG_ArgPut( LOOPLOG_RECORD &record, unsigned long value )      { LOOPLOG_ArgPut(record,(long long)value); }
+inline void LOOPLOG_ArgPut( LOOPLOG_RECORD &record, unsigned long long value ) { LOOPLOG_ArgPut(record,(long long)value); }
+inline void LOOPLOG_ArgPut( LOOPLOG_RECORD &record, char value )               { LOOPLOG_ArgPut(record,(long long)value); }
+
+inline void LOOPLOG_ArgPut( LOOPLOG_RECORD &record, double value )
+{
+    record.Arg[record.Count].Type = LOOPLOG_DOUBLE;
+    record.Arg[record.Count].d = value;
+}
+
+inline void LOOPLOG_ArgPut( LOOPLOG_RECORD &record, float value )
+{
+    LOOPLOG_ArgPut(record,(double)value);
+}
+
+inline void LOOPLOG_ArgPut( LOOPLOG_RECORD &record, const char *value )
+{
+int i;
+
+    record.Arg[record.Count].Type = LOOPLOG_STRING;
+    record.Arg[record.Count].s = record.Length;
+
+    // Copy string (truncated if there isn't enough space).
+    for( i=0; (value != NULL) && (value[i] != 0) && (record.Length < (LOOPLOG_TEXT-1)); i++ )
+    {
+        record.Text[record.Length++] = value[i];
+    }
+
+    record.Text[record.Length++] = 0;
+}
+
+inline void LOOPLOG_ArgPut( LOOPLOG_RECORD &record, char *value )
+{
+    LOOPLOG_ArgPut(record,(const char *)value);
+}
+
+inline void LOOPLOG_ArgPut( LOOPLOG_RECORD &record, const void *value )
+{
+    record.Arg[record.Count].Type = LOOPLOG_POINTER;
+    record.Arg[record.Count].p = value;
+}
+
+/******************************************************************************/
+
+// End of the arguments.
+inline void LOOPLOG_ArgList( LOOPLOG_RECORD & )
+{
+}
+
+template<class T,class... ARGS> inline void LOOPLOG_ArgList( LOOPLOG_RECORD &record, T value, ARGS... args )
+{
+    if( record.Count < LOOPLOG_ARGS )
+    {
+        LOOPLOG_ArgPut(record,value);
+        record.Count++;
+    }
+
+    LOOPLOG_ArgList(record,args...);
+}
+
+/******************************************************************************/
+
+template<class... ARGS> inline void LOOPLOG_printf( const char *format, ARGS... args )
+{
+LOOPLOG_RECORD record;
+
+    record.Tick = LOOPLOG_Tick();
+    record.Format = format;
+    record.Count = 0;
+    record.Length = 0;
+
+    LOOPLOG_ArgList(record,args...);
+    LOOPLOG_Record(record);
+}
+
+/******************************************************************************/
+
+#endif
@@ -0,0 +1,502 @@
+/******************************************************************************/
+/*                                                                            */
+/* MODULE  : robotsim.cpp                                                     */
+/*                                                                            */
+/* PURPOSE : Simulated robot (point-mass plant and subject) for Linux.        */
+/*                                                                            */
+/* DATE    : 17/Oct/2026                                                      */
+/*                                                                            */
+/* CHANGES                                                                    */
+/*                                                                            */
+/* V1.0  HRS 17/Oct/2026 - Initial development.                               */
+/*                                                                            */
+/******************************************************************************/
+
+#include <errno.h>
+#include <math.h>
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+
+#include <atomic>
+#include <mutex>
+#include <random>
+
+#include "robotsim.h"
+
+/******************************************************************************/
+
+ROBOTSIM_PARAMETERS ROBOTSIM_Parameters =
+{
+    1000.0,     // Frequency
+    80.0,       // Priority
+    2.0,        // Mass
+    0.02,       // Damping
+    3.0,        // SubjectStiffness
+    0.3,        // SubjectDamping
+    0.2,        // SubjectNoise
+    0.5,        // SubjectMoveTime
+    0.25,       // SubjectReactionTime
+    0.05,       // SubjectReactionSD
+    0.0,        // Seed
+    0.0,        // StartX
+    0.0,        // StartY
+};
+
+#define ROBOTSIM_ID  0
+
+// Movement requested for the subject.
+struct ROBOTSIM_MOVE
+{
+    bool   Relax;
+    double X,Y;
+    double Delay;
+    double Duration;
+};
+
+static pthread_t             ROBOTSIM_Thread;
+static std::atomic<bool>     ROBOTSIM_Opened(false);
+static std::atomic<bool>     ROBOTSIM_Running(false);
+static std::atomic<bool>     ROBOTSIM_ActivatedFlag(true);
+static ROBOTSIM_FUNCTION     ROBOTSIM_Function=NULL;
+static void                (*ROBOTSIM_Hook)( void )=NULL;
+static double                ROBOTSIM_LoopPeriod=0.001;
+
+static std::mutex            ROBOTSIM_MoveMutex;
+static ROBOTSIM_MOVE         ROBOTSIM_MoveNext;
+static unsigned long         ROBOTSIM_MoveCount=0;
+static std::atomic<double>   ROBOTSIM_Time(0.0);
+
+// Seed (ROBOTSIM_Parameters.Seed or the time) set by ROBOTSIM_Start(). The loop
+// thread's noise uses it and the subject's reaction times use it plus one.
+static unsigned long         ROBOTSIM_Seed=1;
+static std::mt19937          ROBOTSIM_SubjectRandom(1);
+
+// Loop timing (written by loop thread, read after it has stopped).
+static unsigned long         ROBOTSIM_Ticks;
+static unsigned long         ROBOTSIM_Overruns;
+static double                ROBOTSIM_LatenessMax;
+static double                ROBOTSIM_ExecuteSum;
+static double                ROBOTSIM_ExecuteMax;
+static bool                  ROBOTSIM_RealTime;
+
+/******************************************************************************/
+
+static double ROBOTSIM_Seconds( const struct timespec &t )
+{
+    return((double)t.tv_sec + ((double)t.tv_nsec / 1.0E9));
+}
+
+/******************************************************************************/
+
+static void ROBOTSIM_TimeAdd( struct timespec &t, long nsec )
+{
+    t.tv_nsec += nsec;
+
+    while( t.tv_nsec >= 1000000000L )
+    {
+        t.tv_nsec -= 1000000000L;
+        t.tv_sec++;
+    }
+}
+
+/******************************************************************************/
+
+// Minimum-jerk position and velocity scale (0 to 1) at time t of duration d.
+
+static void ROBOTSIM_MinimumJerk( double t, double d, double &p, double &v )
+{
+double s;
+
+    if( (d <= 0.0) || (t >= d) )
+    {
+        p = 1.0;
+        v = 0.0;
+        return;
+    }
+
+    if( t <= 0.0 )
+    {
+        p = 0.0;
+        v = 0.0;
+        return;
+    }
+
+    s = t / d;
+    p = (10.0 * pow(s,3.0)) - (15.0 * pow(s,4.0)) + (6.0 * pow(s,5.0));
+    v = ((30.0 * pow(s,2.0)) - (60.0 * pow(s,3.0)) + (30.0 * pow(s,4.0))) / d;
+}
+
+/******************************************************************************/
+
+static void *ROBOTSIM_ThreadFunction( void * )
+{
+struct timespec next,now;
+double position[3],velocity[3],forces[3];
+double time,dt,lateness,execute,acceleration;
+double start[2],goal[2],desired[2],desiredv[2],subject[2];
+double onset,duration,p,v;
+bool relax;
+unsigned long move=0;
+ROBOTSIM_MOVE request;
+long period;
+int i;
+
+    std::mt19937 random(ROBOTSIM_Seed);
+    std::normal_distribution<double> noise(0.0,1.0);
+
+    period = (long)(1.0E9 / ROBOTSIM_Parameters.Frequency);
+    dt = (double)period / 1.0E9;
+
+    for( i=0; (i < 3); i++ )
+    {
+        position[i] = 0.0;
+        velocity[i] = 0.0;
+        forces[i] = 0.0;
+    }
+
+    position[0] = ROBOTSIM_Parameters.StartX;
+    position[1] = ROBOTSIM_Parameters.StartY;
+
+    // Subject starts relaxed at the initial position.
+    relax = true;
+    onset = 0.0;
+    duration = 0.0;
+
+    for( i=0; (i < 2); i++ )
+    {
+        start[i] = goal[i] = desired[i] = position[i];
+        desiredv[i] = 0.0;
+    }
+
+    time = 0.0;
+    clock_gettime(CLOCK_MONOTONIC,&next);
+
+    while( ROBOTSIM_Running.load(std::memory_order_relaxed) )
+    {
+        ROBOTSIM_TimeAdd(next,period);
+        clock_nanosleep(CLOCK_MONOTONIC,TIMER_ABSTIME,&next,NULL);
+
+        clock_gettime(CLOCK_MONOTONIC,&now);
+        lateness = ROBOTSIM_Seconds(now) - ROBOTSIM_Seconds(next);
+
+        time += dt;
+        ROBOTSIM_Time.store(time,std::memory_order_relaxed);
+
+        // Experiment's subject hook (sets goals based on current state, etc.)
+        if( ROBOTSIM_Hook != NULL )
+        {
+            (*ROBOTSIM_Hook)();
+        }
+
+        // New movement request? (Never wait for the lock in the loop.)
+        if( ROBOTSIM_MoveMutex.try_lock() )
+        {
+            if( ROBOTSIM_MoveCount != move )
+            {
+                move = ROBOTSIM_MoveCount;
+                request = ROBOTSIM_MoveNext;
+
+                for( i=0; (i < 2); i++ )
+                {
+                    // Relaxed subject starts from where the hand is now.
+                    start[i] = relax ? position[i] : desired[i];
+                }
+
+                relax = request.Relax;
+                goal[0] = request.X;
+                goal[1] = request.Y;
+                onset = time + request.Delay;
+                duration = request.Duration;
+            }
+
+            ROBOTSIM_MoveMutex.unlock();
+        }
+
+        // Subject forces.
+        ROBOTSIM_MinimumJerk(time-onset,duration,p,v);
+
+        for( i=0; (i < 2); i++ )
+        {
+            desired[i] = start[i] + (p * (goal[i] - start[i]));
+            desiredv[i] = v * (goal[i] - start[i]);
+
+            subject[i] = ROBOTSIM_Parameters.SubjectNoise * noise(random);
+
+            if( !relax )
+            {
+                subject[i] += ROBOTSIM_Parameters.SubjectStiffness * (desired[i] - position[i]);
+                subject[i] += ROBOTSIM_Parameters.SubjectDamping * (desiredv[i] - velocity[i]);
+            }
+        }
+
+        // Robot forces function.
+        (*ROBOTSIM_Function)(position,velocity,forces);
+
+        if( !ROBOTSIM_ActivatedFlag.load(std::memory_order_relaxed) )
+        {
+            forces[0] = forces[1] = forces[2] = 0.0;
+        }
+
+        clock_gettime(CLOCK_MONOTONIC,&now);
+        execute = ROBOTSIM_Seconds(now) - ROBOTSIM_Seconds(next);
+
+        // Plant dynamics (semi-implicit Euler); 100 converts m/sec^2 to cm/sec^2.
+        for( i=0; (i < 2); i++ )
+        {
+            acceleration = 100.0 * (forces[i] + subject[i] - (ROBOTSIM_Parameters.Damping * velocity[i])) / ROBOTSIM_Parameters.Mass;
+            velocity[i] += acceleration * dt;
+            position[i] += velocity[i] * dt;
+        }
+
+        // Loop timing.
+        ROBOTSIM_Ticks++;
+
+        if( execute > dt )
+        {
+            ROBOTSIM_Overruns++;
+        }
+
+        if( lateness > ROBOTSIM_LatenessMax )
+        {
+            ROBOTSIM_LatenessMax = lateness;
+        }
+
+        ROBOTSIM_ExecuteSum += (execute - lateness);
+
+        if( (execute - lateness) > ROBOTSIM_ExecuteMax )
+        {
+            ROBOTSIM_ExecuteMax = execute - lateness;
+        }
+    }
+
+    return(NULL);
+}
+
+/******************************************************************************/
+
+int ROBOTSIM_Open( const char *name )
+{
+    if( ROBOTSIM_Opened.load() || (ROBOTSIM_Parameters.Frequency <= 0.0) || (ROBOTSIM_Parameters.Mass <= 0.0) )
+    {
+        return(-1);
+    }
+
+    ROBOTSIM_LoopPeriod = 1.0 / ROBOTSIM_Parameters.Frequency;
+    ROBOTSIM_Opened.store(true);
+
+    printf("ROBOTSIM: Simulating %s at %.0lf Hz (Mass=%.2lf kg, Damping=%.3lf N/cm/sec).\n",name,ROBOTSIM_Parameters.Frequency,ROBOTSIM_Parameters.Mass,ROBOTSIM_Parameters.Damping);
+
+    return(ROBOTSIM_ID);
+}
+
+/******************************************************************************/
+
+bool ROBOTSIM_Start( int id, ROBOTSIM_FUNCTION function )
+{
+pthread_attr_t attr;
+struct sched_param param;
+int rc;
+
+    if( (id != ROBOTSIM_ID) || !ROBOTSIM_Opened.load() || ROBOTSIM_Running.load() || (function == NULL) )
+    {
+        return(false);
+    }
+
+    ROBOTSIM_Seed = (ROBOTSIM_Parameters.Seed != 0.0) ? (unsigned long)ROBOTSIM_Parameters.Seed : (unsigned long)::time(NULL);
+    ROBOTSIM_SubjectRandom.seed(ROBOTSIM_Seed + 1);
+
+    ROBOTSIM_Function = function;
+    ROBOTSIM_Ticks = 0;
+    ROBOTSIM_Overruns = 0;
+    ROBOTSIM_LatenessMax = 0.0;
+    ROBOTSIM_ExecuteSum = 0.0;
+    ROBOTSIM_ExecuteMax = 0.0;
+    ROBOTSIM_Running.store(true);
+
+    // Avoid page faults in the loop thread (needs privileges, so ignore errors).
+    mlockall(MCL_CURRENT | MCL_FUTURE);
+
+    // Real-time priority thread.
+    pthread_attr_init(&attr);
+    pthread_attr_setinheritsched(&attr,PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setschedpolicy(&attr,SCHED_FIFO);
+    memset(&param,0,sizeof(param));
+    param.sched_priority = (int)ROBOTSIM_Parameters.Priority;
+    pthread_attr_setschedparam(&attr,&param);
+
+    rc = pthread_create(&ROBOTSIM_Thread,&attr,ROBOTSIM_ThreadFunction,NULL);
+    pthread_attr_destroy(&attr);
+    ROBOTSIM_RealTime = (rc == 0);
+
+    if( rc == EPERM )
+    {
+        // Not allowed real-time scheduling, so run with normal priority.
+        printf("ROBOTSIM: No permission for SCHED_FIFO, using normal priority.\n");
+        rc = pthread_create(&ROBOTSIM_Thread,NULL,ROBOTSIM_ThreadFunction,NULL);
+    }
+
+    if( rc != 0 )
+    {
+        printf("ROBOTSIM: Cannot create loop thread (%s).\n",strerror(rc));
+        ROBOTSIM_Running.store(false);
+        return(false);
+    }
+
+    return(true);
+}
+
+/******************************************************************************/
+
+void ROBOTSIM_Stop( int id )
+{
+    if( (id != ROBOTSIM_ID) || !ROBOTSIM_Running.load() )
+    {
+        return;
+    }
+
+    ROBOTSIM_Running.store(false);
+    pthread_join(ROBOTSIM_Thread,NULL);
+
+    ROBOTSIM_Report();
+}
+
+/******************************************************************************/
+
+void ROBOTSIM_Close( int id )
+{
+    ROBOTSIM_Stop(id);
+    ROBOTSIM_Opened.store(false);
+}
+
+/******************************************************************************/
+
+bool ROBOTSIM_Started( int id )
+{
+    return((id == ROBOTSIM_ID) && ROBOTSIM_Running.load());
+}
+
+/******************************************************************************/
+
+bool ROBOTSIM_Activated( int id )
+{
+    return((id == ROBOTSIM_ID) && ROBOTSIM_ActivatedFlag.load());
+}
+
+/******************************************************************************/
+
+void ROBOTSIM_Activate( int id, bool flag )
+{
+    if( id == ROBOTSIM_ID )
+    {
+        ROBOTSIM_ActivatedFlag.store(flag);
+    }
+}
+
+/******************************************************************************/
+
+double ROBOTSIM_Frequency( int id )
+{
+    return((id == ROBOTSIM_ID) ? (1.0 / ROBOTSIM_LoopPeriod) : 0.0);
+}
+
+/******************************************************************************/
+
+double ROBOTSIM_Period( int id )
+{
+    return((id == ROBOTSIM_ID) ? ROBOTSIM_LoopPeriod : 0.0);
+}
+
+/******************************************************************************/
+
+void ROBOTSIM_Report( FILE *stream )
+{
+double mean;
+
+    if( ROBOTSIM_Ticks == 0 )
+    {
+        return;
+    }
+
+    mean = ROBOTSIM_ExecuteSum / (double)ROBOTSIM_Ticks;
+
+    fprintf(stream,"ROBOTSIM: %lu ticks at %.0lf Hz (%s).\n",ROBOTSIM_Ticks,ROBOTSIM_Frequency(ROBOTSIM_ID),ROBOTSIM_RealTime ? "SCHED_FIFO" : "normal priority");
+    fprintf(stream,"ROBOTSIM: Loop time mean=%.1lf max=%.1lf usec, wake-up lateness max=%.1lf usec.\n",mean*1.0E6,ROBOTSIM_ExecuteMax*1.0E6,ROBOTSIM_LatenessMax*1.0E6);
+    fprintf(stream,"ROBOTSIM: Headroom mean=%.0lf%% worst=%.0lf%%, overruns=%lu.\n",100.0*(1.0-(mean/ROBOTSIM_LoopPeriod)),100.0*(1.0-((ROBOTSIM_ExecuteMax+ROBOTSIM_LatenessMax)/ROBOTSIM_LoopPeriod)),ROBOTSIM_Overruns);
+}
+
+/******************************************************************************/
+
+void ROBOTSIM_SubjectHook( void (*function)( void ) )
+{
+    ROBOTSIM_Hook = function;
+}
+
+/******************************************************************************/
+
+static void ROBOTSIM_SubjectRequest( const ROBOTSIM_MOVE &request )
+{
+    std::lock_guard<std::mutex> lock(ROBOTSIM_MoveMutex);
+
+    ROBOTSIM_MoveNext = request;
+    ROBOTSIM_MoveCount++;
+}
+
+/******************************************************************************/
+
+void ROBOTSIM_SubjectMove( double x, double y, double delay, double duration )
+{
+ROBOTSIM_MOVE request;
+
+    request.Relax = false;
+    request.X = x;
+    request.Y = y;
+    request.Delay = delay;
+    request.Duration = duration;
+
+    ROBOTSIM_SubjectRequest(request);
+}
+
+/******************************************************************************/
+
+void ROBOTSIM_SubjectMove( double x, double y )
+{
+std::normal_distribution<double> reaction(ROBOTSIM_Parameters.SubjectReactionTime,ROBOTSIM_Parameters.SubjectReactionSD);
+double delay;
+
+    // Default movement time and a random reaction time.
+    delay = reaction(ROBOTSIM_SubjectRandom);
+
+    if( delay < 0.0 )
+    {
+        delay = 0.0;
+    }
+
+    ROBOTSIM_SubjectMove(x,y,delay,ROBOTSIM_Parameters.SubjectMoveTime);
+}
+
+/******************************************************************************/
+
+void ROBOTSIM_SubjectRelax( void )
+{
+ROBOTSIM_MOVE request;
+
+    request.Relax = true;
+    request.X = 0.0;
+    request.Y = 0.0;
+    request.Delay = 0.0;
+    request.Duration = 0.0;
+
+    ROBOTSIM_SubjectRequest(request);
+}
+
+/******************************************************************************/
+
+double ROBOTSIM_SubjectTime( void )
+{
+    return(ROBOTSIM_Time.load(std::memory_order_relaxed));
+}
+
+/******************************************************************************/
@@ -0,0 +1,144 @@
+/******************************************************************************/
+/*                                                                            */
+/* MODULE  : robotsim.h                                                       */
+/*                                                                            */
+/* PURPOSE : Simulated robot (point-mass plant and subject) for Linux.        */
+/*                                                                            */
+/* DATE    : 17/Oct/2026                                                      */
+/*                                                                            */
+/* CHANGES                                                                    */
+/*                                                                            */
+/* V1.0  HRS 17/Oct/2026 - Initial development.                               */
+/*                                                                            */
+/******************************************************************************/
+
+// The plant is a point-mass hand in the horizontal plane with viscous
+// damping. It is moved by the robot forces (returned by the forces function)
+// plus the forces of a simulated subject, which tracks minimum-jerk movements
+// to goals set by the experiment (usually from a hook function that looks at
+// the current state) using spring-damper "muscles" with additive force noise.
+//
+// The forces function is called on a SCHED_FIFO thread at the configured
+// frequency (1, 2, 4 or 8 kHz, etc.) using absolute clock_nanosleep() wake-ups,
+// and timing is reported when the simulation stops so loop headroom can be
+// measured without a vBOT.
+//
+// Units are the same as the experiment programs: position (cm), velocity
+// (cm/sec), force (N), mass (kg), damping (N/cm/sec) and stiffness (N/cm).
+//
+// Compile with ROBOT_SIMULATE defined (and include this after motor.h) to map
+// the ROBOT_... functions used by the experiment programs onto the simulator.
+
+#ifndef ROBOTSIM_H
+#define ROBOTSIM_H
+
+#include <stdio.h>
+
+/******************************************************************************/
+
+struct ROBOTSIM_PARAMETERS
+{
+    double Frequency;           // Loop frequency (Hz).
+    double Priority;            // SCHED_FIFO priority of loop thread.
+    double Mass;                // Point-mass of hand and handle (kg).
+    double Damping;             // Plant viscous damping (N/cm/sec).
+    double SubjectStiffness;    // Subject spring constant (N/cm).
+    double SubjectDamping;      // Subject damping constant (N/cm/sec).
+    double SubjectNoise;        // Standard deviation of subject force noise (N).
+    double SubjectMoveTime;     // Minimum-jerk movement duration (sec).
+    double SubjectReactionTime; // Mean delay before movement starts (sec).
+    double SubjectReactionSD;   // Standard deviation of reaction time (sec).
+    double Seed;                // Random number seed (0 for time-based seed).
+    double StartX;              // Initial hand position (cm).
+    double StartY;
+};
+
+extern ROBOTSIM_PARAMETERS ROBOTSIM_Parameters;
+
+// Loop function called at each tick with position and velocity, returning forces.
+typedef void (*ROBOTSIM_FUNCTION)( const double *position, const double *velocity, double *forces );
+
+/******************************************************************************/
+
+int    ROBOTSIM_Open( const char *name );
+bool   ROBOTSIM_Start( int id, ROBOTSIM_FUNCTION function );
+void   ROBOTSIM_Stop( int id );
+void   ROBOTSIM_Close( int id );
+bool   ROBOTSIM_Started( int id );
+bool   ROBOTSIM_Activated( int id );
+void   ROBOTSIM_Activate( int id, bool flag );
+double ROBOTSIM_Frequency( int id );
+double ROBOTSIM_Period( int id );
+void   ROBOTSIM_Report( FILE *stream=stdout );
+
+// Simulated subject (call from the hook function or the experiment program).
+void   ROBOTSIM_SubjectHook( void (*function)( void ) );
+void   ROBOTSIM_SubjectMove( double x, double y );
+void   ROBOTSIM_SubjectMove( double x, double y, double delay, double duration );
+void   ROBOTSIM_SubjectRelax( void );
+double ROBOTSIM_SubjectTime( void );
+
+/******************************************************************************/
+
+#ifdef ROBOT_SIMULATE
+
+// Call a MOTOR forces function, void func( matrix &position, matrix &velocity,
+// matrix &forces ), from the simulator. The matrix type is a template
+// parameter so that this module doesn't depend on motor.h.
+
+template<class MATRIX> class ROBOTSIM_ADAPTER
+{
+public:
+    static void (*Function)( MATRIX &position, MATRIX &velocity, MATRIX &forces );
+
+    static void Call( const double *position, const double *velocity, double *forces )
+    {
+    static MATRIX P(3,1),V(3,1),F(3,1);
+    int i;
+
+        for( i=0; (i < 3); i++ )
+        {
+            P(i+1,1) = position[i];
+            V(i+1,1) = velocity[i];
+            F(i+1,1) = 0.0;
+        }
+
+        (*Function)(P,V,F);
+
+        for( i=0; (i < 3); i++ )
+        {
+            forces[i] = F(i+1,1);
+        }
+    }
+};
+
+template<class MATRIX> void (*ROBOTSIM_ADAPTER<MATRIX>::Function)( MATRIX &position, MATRIX &velocity, MATRIX &forces )=NULL;
+
+template<class MATRIX> inline bool ROBOTSIM_Start( int id, void (*function)( MATRIX &position, MATRIX &velocity, MATRIX &forces ) )
+{
+    ROBOTSIM_ADAPTER<MATRIX>::Function = function;
+
+    return(ROBOTSIM_Start(id,ROBOTSIM_ADAPTER<MATRIX>::Call));
+}
+
+#define ROBOT_Open(name)                    ROBOTSIM_Open(name)
+#define ROBOT_Start(id,function)            ROBOTSIM_Start(id,function)
+#define ROBOT_Stop(id)                      ROBOTSIM_Stop(id)
+#define ROBOT_Close(id)                     ROBOTSIM_Close(id)
+#define ROBOT_Safe(id)                      (true)
+#define ROBOT_Activated(id)                 ROBOTSIM_Activated(id)
+#define ROBOT_Ramped(id)                    ROBOTSIM_Activated(id)
+#define ROBOT_LoopTaskGetFrequency(id)      ROBOTSIM_Frequency(id)
+#define ROBOT_LoopTaskGetPeriod(id)         ROBOTSIM_Period(id)
+#define ROBOT_SensorOpen(id)                (true)
+#define ROBOT_SensorClose(id)               ((void)0)
+#define ROBOT_SensorRead(id)                ((void)0)
+#define ROBOT_SensorOpened_DAQFT(...)       (false)
+#define ROBOT_Sensor_DAQFT(id,force,torque) ((void)0)
+#define ROBOT_SensorBiasReset_DAQFT(id)     (false)
+
+#endif
+
+/******************************************************************************/
+
+#endif
@@ -0,0 +1,88 @@
+/******************************************************************************/
+/*                                                                            */
+/* MODULE  : snapshot.h                                                       */
+/*                                                                            */
+/* PURPOSE : Wait-free triple-buffer snapshot between two threads.            */
+/*                                                                            */
+/* DATE    : 17/Oct/2026                                                      */
+/*                                                                            */
+/* CHANGES                                                                    */
+/*                                                                            */
+/* V1.0  HRS 17/Oct/2026 - Initial development.                               */
+/*                                                                            */
+/******************************************************************************/
+
+// One writer (the robot forces function) fills in Write() and calls Publish()
+// once per tick. One reader (the graphics thread) calls Read() to get the most
+// recently published copy. Neither side ever waits for the other: there are
+// three buffers, one owned by each side and one in the middle which is swapped
+// atomically. The buffer returned by Read() is not touched by the writer until
+// the next call to Read(), so the reader always sees a coherent copy.
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <atomic>
+
+/******************************************************************************/
+
+template<class T> class SNAPSHOT
+{
+private:
+
+    // Middle buffer index, with the FRESH bit set when it has not been read.
+    enum { INDEX=0x03, FRESH=0x04 };
+
+    T Buffer[3];
+    int WriteIndex;
+    int ReadIndex;
+    std::atomic<int> Middle;
+
+public:
+
+    SNAPSHOT( void )
+    {
+        WriteIndex = 0;
+        Middle.store(1);
+        ReadIndex = 2;
+    }
+
+    // Buffer for the writer to fill in.
+    inline T &Write( void )
+    {
+        return(Buffer[WriteIndex]);
+    }
+
+    // Make the writer's buffer the latest snapshot (writer thread only).
+    inline void Publish( void )
+    {
+    int last;
+
+        last = Middle.exchange(WriteIndex | FRESH,std::memory_order_acq_rel);
+        WriteIndex = last & INDEX;
+    }
+
+    // Is there a snapshot which hasn't been read yet?
+    inline bool Fresh( void ) const
+    {
+        return((Middle.load(std::memory_order_acquire) & FRESH) != 0);
+    }
+
+    // Latest snapshot (reader thread only).
+    inline const T &Read( void )
+    {
+    int last;
+
+        if( Fresh() )
+        {
+            last = Middle.exchange(ReadIndex,std::memory_order_acq_rel);
+            ReadIndex = last & INDEX;
+        }
+
+        return(Buffer[ReadIndex]);
+    }
+};
+
+/******************************************************************************/
+
+#endif
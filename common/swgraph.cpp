@@ -0,0 +1,670 @@
+/******************************************************************************/
+/*                                                                            */
+/* MODULE  : swgraph.cpp                                                      */
+/*                                                                            */
+/* PURPOSE : Headless software rasterizer with a simulated vertical retrace.  */
+/*                                                                            */
+/* DATE    : 17/Oct/2026                                                      */
+/*                                                                            */
+/* CHANGES                                                                    */
+/*                                                                            */
+/* V1.0  HRS 17/Oct/2026 - Initial development.                               */
+/*                                                                            */
+/******************************************************************************/
+
+#include <stdio.h>
+#include <math.h>
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "journal.h"
+#include "swgraph.h"
+
+/******************************************************************************/
+
+static bool     SWGRAPH_Started=false;
+static int      SWGRAPH_Width=0;
+static int      SWGRAPH_Height=0;
+static double   SWGRAPH_Scale=1.0;          // Pixels per cm.
+static int      SWGRAPH_Eyes=1;
+static int      SWGRAPH_Eye=0;
+
+static std::vector<uint32_t> SWGRAPH_Buffer[SWGRAPH_EYES];
+
+// Simulated vertical retrace.
+static double   SWGRAPH_Period=0.0;
+static double   SWGRAPH_SyncTime=0.0;
+static double   SWGRAPH_Retrace=0.0;        // Retrace the current frame is aimed at.
+static bool     SWGRAPH_Drawing=false;
+
+static std::chrono::steady_clock::time_point SWGRAPH_FrameStart;
+
+// Statistics.
+static std::vector<double> SWGRAPH_DrawTime;
+static long     SWGRAPH_Missed=0;           // Retraces without a new frame.
+static long     SWGRAPH_Late=0;             // Frames that missed their retrace.
+
+/******************************************************************************/
+
+bool SWGRAPH_Start( int width, int height, double pixelspercm, int eyes, double frequency, double synctime )
+{
+int eye;
+
+    SWGRAPH_Stop();
+
+    if( (width < 1) || (height < 1) || (pixelspercm <= 0.0) || (eyes < 1) || (eyes > SWGRAPH_EYES) || (frequency <= 0.0) )
+    {
+        return(false);
+    }
+
+    SWGRAPH_Width = width;
+    SWGRAPH_Height = height;
+    SWGRAPH_Scale = pixelspercm;
+    SWGRAPH_Eyes = eyes;
+    SWGRAPH_Eye = 0;
+
+    for( eye=0; (eye < SWGRAPH_Eyes); eye++ )
+    {
+        SWGRAPH_Buffer[eye].assign((size_t)width * (size_t)height,0);
+    }
+
+    SWGRAPH_Period = 1.0 / frequency;
+    SWGRAPH_SyncTime = (synctime < SWGRAPH_Period) ? synctime : SWGRAPH_Period;
+    SWGRAPH_Retrace = SWGRAPH_Period;
+    SWGRAPH_Drawing = false;
+
+    SWGRAPH_DrawTime.clear();
+    SWGRAPH_Missed = 0;
+    SWGRAPH_Late = 0;
+
+    SWGRAPH_Started = true;
+
+    return(true);
+}
+
+/******************************************************************************/
+
+void SWGRAPH_Stop( void )
+{
+int eye;
+
+    for( eye=0; (eye < SWGRAPH_EYES); eye++ )
+    {
+        std::vector<uint32_t>().swap(SWGRAPH_Buffer[eye]);
+    }
+
+    SWGRAPH_Started = false;
+}
+
+/******************************************************************************/
+
+void SWGRAPH_ClearStereo( uint32_t color )
+{
+int eye;
+
+    if( !SWGRAPH_Started )
+    {
+        return;
+    }
+
+    // The frame starts here.
+    SWGRAPH_FrameStart = std::chrono::steady_clock::now();
+    SWGRAPH_Drawing = true;
+
+    for( eye=0; (eye < SWGRAPH_Eyes); eye++ )
+    {
+        std::fill(SWGRAPH_Buffer[eye].begin(),SWGRAPH_Buffer[eye].end(),color);
+    }
+}
+
+/******************************************************************************/
+
+void SWGRAPH_ViewCalib( int eye )
+{
+    if( (eye >= 0) && (eye < SWGRAPH_Eyes) )
+    {
+        SWGRAPH_Eye = eye;
+    }
+}
+
+/******************************************************************************/
+
+void SWGRAPH_ClearMono( uint32_t color )
+{
+    if( !SWGRAPH_Started )
+    {
+        return;
+    }
+
+    std::fill(SWGRAPH_Buffer[SWGRAPH_Eye].begin(),SWGRAPH_Buffer[SWGRAPH_Eye].end(),color);
+}
+
+/******************************************************************************/
+
+// Fill pixels x0...x1 of a row (clipped to the buffer).
+
+static inline void SWGRAPH_Span( int y, int x0, int x1, uint32_t color )
+{
+uint32_t *row;
+
+    if( (y < 0) || (y >= SWGRAPH_Height) )
+    {
+        return;
+    }
+
+    x0 = (x0 < 0) ? 0 : x0;
+    x1 = (x1 >= SWGRAPH_Width) ? (SWGRAPH_Width-1) : x1;
+
+    if( x0 > x1 )
+    {
+        return;
+    }
+
+    row = &SWGRAPH_Buffer[SWGRAPH_Eye][(size_t)y * (size_t)SWGRAPH_Width];
+    std::fill(row+x0,row+x1+1,color);
+}
+
+/******************************************************************************/
+
+// Screen position (pixels) of a position (cm).
+
+static inline double SWGRAPH_PixelX( double x )
+{
+    return((0.5 * (double)SWGRAPH_Width) + (x * SWGRAPH_Scale));
+}
+
+static inline double SWGRAPH_PixelY( double y )
+{
+    return((0.5 * (double)SWGRAPH_Height) - (y * SWGRAPH_Scale));
+}
+
+/******************************************************************************/
+
+// Pixels (with their centres inside) of a circle along a row, false if none.
+
+static inline bool SWGRAPH_CircleSpan( double cx, double cy, double r, int y, int &x0, int &x1 )
+{
+double dy,w;
+
+    dy = ((double)y + 0.5) - cy;
+
+    if( fabs(dy) > r )
+    {
+        return(false);
+    }
+
+    w = sqrt((r*r) - (dy*dy));
+    x0 = (int)ceil(cx - w - 0.5);
+    x1 = (int)floor(cx + w - 0.5);
+
+    return(x0 <= x1);
+}
+
+/******************************************************************************/
+
+void SWGRAPH_Circle( double x, double y, double radius, uint32_t color )
+{
+double cx,cy,r;
+int row,y0,y1,x0,x1;
+
+    if( !SWGRAPH_Started || (radius <= 0.0) )
+    {
+        return;
+    }
+
+    cx = SWGRAPH_PixelX(x);
+    cy = SWGRAPH_PixelY(y);
+    r = radius * SWGRAPH_Scale;
+
+    y0 = std::max((int)floor(cy - r),0);
+    y1 = std::min((int)ceil(cy + r),SWGRAPH_Height-1);
+
+    for( row=y0; (row <= y1); row++ )
+    {
+        if( SWGRAPH_CircleSpan(cx,cy,r,row,x0,x1) )
+        {
+            SWGRAPH_Span(row,x0,x1,color);
+        }
+    }
+}
+
+/******************************************************************************/
+
+void SWGRAPH_Ring( double x, double y, double radius, double width, uint32_t color )
+{
+double cx,cy,r,ri;
+int row,y0,y1,x0,x1,i0,i1;
+
+    if( !SWGRAPH_Started || (radius <= 0.0) )
+    {
+        return;
+    }
+
+    if( width >= radius )
+    {
+        SWGRAPH_Circle(x,y,radius,color);
+        return;
+    }
+
+    cx = SWGRAPH_PixelX(x);
+    cy = SWGRAPH_PixelY(y);
+    r = radius * SWGRAPH_Scale;
+    ri = (radius - width) * SWGRAPH_Scale;
+
+    y0 = std::max((int)floor(cy - r),0);
+    y1 = std::min((int)ceil(cy + r),SWGRAPH_Height-1);
+
+    for( row=y0; (row <= y1); row++ )
+    {
+        if( !SWGRAPH_CircleSpan(cx,cy,r,row,x0,x1) )
+        {
+            continue;
+        }
+
+        // Outer span less the inner one.
+        if( SWGRAPH_CircleSpan(cx,cy,ri,row,i0,i1) )
+        {
+            SWGRAPH_Span(row,x0,i0-1,color);
+            SWGRAPH_Span(row,i1+1,x1,color);
+        }
+        else
+        {
+            SWGRAPH_Span(row,x0,x1,color);
+        }
+    }
+}
+
+/******************************************************************************/
+
+// Convex polygon (pixels). Pixels with their centres on the top or left edge
+// are filled and those on the bottom or right edge aren't, so shapes that
+// share an edge don't overlap.
+
+static void SWGRAPH_Polygon( const double *px, const double *py, int n, uint32_t color )
+{
+double yc,xmin,xmax,x,t;
+double top,bottom;
+int row,y0,y1,i,j;
+
+    top = bottom = py[0];
+
+    for( i=1; (i < n); i++ )
+    {
+        top = std::min(top,py[i]);
+        bottom = std::max(bottom,py[i]);
+    }
+
+    y0 = std::max((int)ceil(top - 0.5),0);
+    y1 = std::min((int)ceil(bottom - 0.5) - 1,SWGRAPH_Height-1);
+
+    for( row=y0; (row <= y1); row++ )
+    {
+        yc = (double)row + 0.5;
+        xmin = 1.0E30;
+        xmax = -1.0E30;
+
+        // Where the edges cross the centre of the row.
+        for( i=0; (i < n); i++ )
+        {
+            j = (i + 1) % n;
+
+            if( (yc < std::min(py[i],py[j])) || (yc >= std::max(py[i],py[j])) )
+            {
+                continue;
+            }
+
+            t = (yc - py[i]) / (py[j] - py[i]);
+            x = px[i] + (t * (px[j] - px[i]));
+
+            xmin = std::min(xmin,x);
+            xmax = std::max(xmax,x);
+        }
+
+        if( xmin <= xmax )
+        {
+            SWGRAPH_Span(row,(int)ceil(xmin - 0.5),(int)ceil(xmax - 0.5) - 1,color);
+        }
+    }
+}
+
+/******************************************************************************/
+
+void SWGRAPH_Rectangle( double x, double y, double width, double height, uint32_t color )
+{
+double px[4],py[4],cx,cy,w,h;
+
+    if( !SWGRAPH_Started || (width <= 0.0) || (height <= 0.0) )
+    {
+        return;
+    }
+
+    cx = SWGRAPH_PixelX(x);
+    cy = SWGRAPH_PixelY(y);
+    w = 0.5 * width * SWGRAPH_Scale;
+    h = 0.5 * height * SWGRAPH_Scale;
+
+    px[0] = cx - w; py[0] = cy - h;
+    px[1] = cx + w; py[1] = cy - h;
+    px[2] = cx + w; py[2] = cy + h;
+    px[3] = cx - w; py[3] = cy + h;
+
+    SWGRAPH_Polygon(px,py,4,color);
+}
+
+/******************************************************************************/
+
+void SWGRAPH_Line( double x1, double y1, double x2, double y2, double width, uint32_t color )
+{
+double px[4],py[4],ax,ay,bx,by,dx,dy,length;
+
+    if( !SWGRAPH_Started || (width <= 0.0) )
+    {
+        return;
+    }
+
+    ax = SWGRAPH_PixelX(x1);
+    ay = SWGRAPH_PixelY(y1);
+    bx = SWGRAPH_PixelX(x2);
+    by = SWGRAPH_PixelY(y2);
+
+    if( (length=sqrt(((bx-ax)*(bx-ax)) + ((by-ay)*(by-ay)))) == 0.0 )
+    {
+        return;
+    }
+
+    // Half the width either side of the line.
+    dx = -0.5 * width * (by - ay) / length;
+    dy = 0.5 * width * (bx - ax) / length;
+
+    px[0] = ax + dx; py[0] = ay + dy;
+    px[1] = bx + dx; py[1] = by + dy;
+    px[2] = bx - dx; py[2] = by - dy;
+    px[3] = ax - dx; py[3] = ay - dy;
+
+    SWGRAPH_Polygon(px,py,4,color);
+}
+
+/******************************************************************************/
+
+// Stroke font for SWGRAPH_String(), straight lines on a 5 x 9 grid with the
+// baseline at row 2 and capitals from row 2 to 8, from " " to "_". Each glyph
+// is one or more polylines (separated by spaces) of column/row digit pairs.
+
+#define SWGRAPH_FONT_FIRST   ' '
+#define SWGRAPH_FONT_LAST    '_'
+#define SWGRAPH_FONT_ADVANCE 104.76     // Font units per character (as GLUT_STROKE_MONO_ROMAN).
+#define SWGRAPH_FONT_HEIGHT  100.0      // Font units from the baseline to the top of a capital.
+#define SWGRAPH_FONT_LOWER   0.7        // Height of lower case (drawn as capitals).
+
+static const char *SWGRAPH_Font[(SWGRAPH_FONT_LAST - SWGRAPH_FONT_FIRST) + 1] =
+{
+    "",                                     // Space
+    "2223 2528",                            // !
+    "1817 3837",                            // "
+    "1218 3238 0434 0636",                  // #
+    "473818070615354443321203 2129",        // $
+    "0248 0818 3242",                       // %
+    "42071828372503031232 3344",            // &
+    "2827",                                 // '
+    "38272332",                             // (
+    "18373312",                             // )
+    "2327 0446 0644",                       // *
+    "1535 2426",                            // +
+    "2311",                                 // ,
+    "1535",                                 // -
+    "2223",                                 // .
+    "0248",                                 // /
+    "183847433212030718 0348",              // 0
+    "172822 1232",                          // 1
+    "07183847460242",                       // 2
+    "071838474635 25354443321203",          // 3
+    "380444 3832",                          // 4
+    "480805354443321203",                   // 5
+    "4738180703123243443505",               // 6
+    "084822",                               // 7
+    "150607183847463515 1504031232434435",  // 8
+    "4515060718384743321203",               // 9
+    "2223 2526",                            // :
+    "2311 2526",                            // ;
+    "480542",                               // <
+    "1434 1636",                            // =
+    "084502",                               // >
+    "0718384746352524 2322",                // ?
+    "43322213040718384736262535",           // @
+    "022842 1535",                          // A
+    "02083847463505 3544433202",            // B
+    "4738180703123243",                     // C
+    "02082847432202",                       // D
+    "48080242 0535",                        // E
+    "480802 0535",                          // F
+    "47381807031232434525",                 // G
+    "0208 4248 0545",                       // H
+    "1838 2822 1232",                       // I
+    "4843321203",                           // J
+    "0208 4804 1542",                       // K
+    "080242",                               // L
+    "0208254842",                           // M
+    "02084248",                             // N
+    "183847433212030718",                   // O
+    "02083847463505",                       // P
+    "183847433212030718 2442",              // Q
+    "02083847463505 2542",                  // R
+    "473818070615354443321203",             // S
+    "0848 2822",                            // T
+    "080312324348",                         // U
+    "082248",                               // V
+    "0812253248",                           // W
+    "0248 0842",                            // X
+    "0825 4825 2522",                       // Y
+    "08480242",                             // Z
+    "38181232",                             // [
+    "0842",                                 // Backslash
+    "18383212",                             // ]
+    "062746",                               // ^
+    "0242",                                 // _
+};
+
+/******************************************************************************/
+
+void SWGRAPH_String( double x, double y, double scale, const char *text, double width, uint32_t color )
+{
+const char *glyph;
+double height,gx,gy,lx,ly;
+int c,i;
+bool first;
+
+    if( !SWGRAPH_Started || (text == NULL) )
+    {
+        return;
+    }
+
+    for( i=0; (text[i] != 0); i++, x+=(SWGRAPH_FONT_ADVANCE * scale) )
+    {
+        c = (unsigned char)text[i];
+        height = SWGRAPH_FONT_HEIGHT;
+
+        // Lower case is drawn as smaller capitals.
+        if( (c >= 'a') && (c <= 'z') )
+        {
+            c -= 'a' - 'A';
+            height *= SWGRAPH_FONT_LOWER;
+        }
+
+        if( (c < SWGRAPH_FONT_FIRST) || (c > SWGRAPH_FONT_LAST) )
+        {
+            continue;
+        }
+
+        lx = ly = 0.0;
+
+        for( glyph=SWGRAPH_Font[c - SWGRAPH_FONT_FIRST], first=true; (*glyph != 0); )
+        {
+            if( *glyph == ' ' )
+            {
+                glyph++;
+                first = true;
+                continue;
+            }
+
+            if( glyph[1] == 0 )
+            {
+                break;
+            }
+
+            // Column 0 to 4 fills the middle of the advance; row 2 is the baseline.
+            gx = x + (scale * (22.0 + (15.0 * (double)(glyph[0] - '0'))));
+            gy = y + (scale * height * (double)(glyph[1] - '2') / 6.0);
+            glyph += 2;
+
+            if( !first )
+            {
+                SWGRAPH_Line(lx,ly,gx,gy,width,color);
+            }
+
+            lx = gx;
+            ly = gy;
+            first = false;
+        }
+    }
+}
+
+/******************************************************************************/
+
+double SWGRAPH_SwapBuffers( void )
+{
+double draw,finish,shown,late;
+
+    if( !SWGRAPH_Started )
+    {
+        return(0.0);
+    }
+
+    draw = 0.0;
+
+    if( SWGRAPH_Drawing )
+    {
+        draw = std::chrono::duration<double>(std::chrono::steady_clock::now() - SWGRAPH_FrameStart).count();
+        SWGRAPH_Drawing = false;
+    }
+
+    SWGRAPH_DrawTime.push_back(draw);
+
+    // The frame was started at the draw point before its retrace.
+    finish = (SWGRAPH_Retrace - SWGRAPH_SyncTime) + draw;
+    shown = SWGRAPH_Retrace;
+
+    if( finish > SWGRAPH_Retrace )
+    {
+        late = ceil((finish - SWGRAPH_Retrace) / SWGRAPH_Period);
+        shown += late * SWGRAPH_Period;
+
+        SWGRAPH_Late++;
+        SWGRAPH_Missed += (long)late;
+    }
+
+    // The next frame is aimed at the retrace after this one is shown.
+    SWGRAPH_Retrace = shown + SWGRAPH_Period;
+
+    return(shown);
+}
+
+/******************************************************************************/
+
+double SWGRAPH_Time( void )
+{
+    return(SWGRAPH_Retrace);
+}
+
+/******************************************************************************/
+
+double SWGRAPH_FrameTime( void )
+{
+    return(SWGRAPH_DrawTime.empty() ? 0.0 : SWGRAPH_DrawTime.back());
+}
+
+/******************************************************************************/
+
+void SWGRAPH_Results( void )
+{
+std::vector<double> draw;
+double total;
+int frames,i;
+
+    if( (frames=(int)SWGRAPH_DrawTime.size()) == 0 )
+    {
+        return;
+    }
+
+    draw = SWGRAPH_DrawTime;
+    std::sort(draw.begin(),draw.end());
+
+    for( total=0.0,i=0; (i < frames); i++ )
+    {
+        total += draw[i];
+    }
+
+    printf("SWGRAPH: %dx%d Eyes=%d Frames=%d Draw Mean=%.3lf 50%%=%.3lf 99%%=%.3lf Max=%.3lf (msec) SyncTime=%.3lf (msec).\n",
+           SWGRAPH_Width,SWGRAPH_Height,SWGRAPH_Eyes,frames,1000.0 * total / (double)frames,
+           1000.0 * draw[frames / 2],1000.0 * draw[((frames-1) * 99) / 100],1000.0 * draw[frames-1],1000.0 * SWGRAPH_SyncTime);
+
+    printf("SWGRAPH: Late=%ld frames (%.2lf%%) Missed=%ld retraces Simulated=%.3lf (sec).\n",
+           SWGRAPH_Late,100.0 * (double)SWGRAPH_Late / (double)frames,SWGRAPH_Missed,SWGRAPH_Retrace - SWGRAPH_Period);
+}
+
+/******************************************************************************/
+
+uint32_t SWGRAPH_Check( int eye )
+{
+    if( !SWGRAPH_Started || (eye < 0) || (eye >= SWGRAPH_Eyes) )
+    {
+        return(0);
+    }
+
+    return(JOURNAL_Hash(SWGRAPH_Buffer[eye].data(),SWGRAPH_Buffer[eye].size() * sizeof(uint32_t)));
+}
+
+/******************************************************************************/
+
+bool SWGRAPH_Save( const char *file, int eye )
+{
+std::vector<unsigned char> row;
+uint32_t pixel;
+FILE *FP;
+int x,y;
+bool ok;
+
+    if( !SWGRAPH_Started || (eye < 0) || (eye >= SWGRAPH_Eyes) )
+    {
+        return(false);
+    }
+
+    if( (FP=fopen(file,"wb")) == NULL )
+    {
+        return(false);
+    }
+
+    ok = (fprintf(FP,"P6\n%d %d\n255\n",SWGRAPH_Width,SWGRAPH_Height) > 0);
+    row.resize(3 * SWGRAPH_Width);
+
+    for( y=0; (ok && (y < SWGRAPH_Height)); y++ )
+    {
+        for( x=0; (x < SWGRAPH_Width); x++ )
+        {
+            pixel = SWGRAPH_Buffer[eye][((size_t)y * (size_t)SWGRAPH_Width) + x];
+
+            row[(3*x)+0] = (unsigned char)((pixel >> 16) & 0xFF);
+            row[(3*x)+1] = (unsigned char)((pixel >> 8) & 0xFF);
+            row[(3*x)+2] = (unsigned char)(pixel & 0xFF);
+        }
+
+        ok = (fwrite(row.data(),row.size(),1,FP) == 1);
+    }
+
+    ok = (fclose(FP) == 0) && ok;
+
+    return(ok);
+}
+
+/******************************************************************************/
@@ -0,0 +1,87 @@
+/******************************************************************************/
+/*                                                                            */
+/* MODULE  : swgraph.h                                                        */
+/*                                                                            */
+/* PURPOSE : Headless software rasterizer with a simulated vertical retrace.  */
+/*                                                                            */
+/* DATE    : 17/Oct/2026                                                      */
+/*                                                                            */
+/* CHANGES                                                                    */
+/*                                                                            */
+/* V1.0  HRS 17/Oct/2026 - Initial development.                               */
+/*                                                                            */
+/******************************************************************************/
+
+// SWGRAPH stands in for the GRAPHICS_... calls the experiments use to draw a
+// frame, so the cost of a scene can be measured on any machine without the
+// lab display (e.g., tools/drawbench.cpp). Shapes are filled on the CPU into
+// one 32-bit (0xRRGGBB) buffer per eye. Positions and sizes are in cm in the
+// x-y plane with the origin at the centre of the screen, except the width
+// of a line, which is in pixels (as glLineWidth() for GRAPHICS_Line()).
+// Text is drawn with a built-in stroke font of straight lines, the same size
+// and spacing as GLUT_STROKE_MONO_ROMAN but not the same shapes.
+//
+//   SWGRAPH_ClearStereo()   GRAPHICS_ClearStereo()  (every eye's buffer)
+//   SWGRAPH_ViewCalib()     GRAPHICS_ViewCalib()    (selects the eye's buffer)
+//   SWGRAPH_ClearMono()     GRAPHICS_ClearMono()    (the eye's buffer)
+//   SWGRAPH_Circle()        GRAPHICS_Circle()
+//   SWGRAPH_Ring()          GLCACHE_Ring()
+//   SWGRAPH_Rectangle()     GRAPHICS_Rectangle()
+//   SWGRAPH_Line()          GRAPHICS_Line()
+//   SWGRAPH_String()        GLCACHE_String()        (at a position and scale)
+//   SWGRAPH_SwapBuffers()   GRAPHICS_SwapBuffers()
+//
+// The vertical retrace is simulated. Each frame starts at its draw point,
+// the sync time before a retrace (as GraphicsVerticalRetraceSyncTime), and
+// takes as long as the CPU took between SWGRAPH_ClearStereo() and
+// SWGRAPH_SwapBuffers(). If that is longer than the sync time the frame
+// misses its retrace and is shown at the next one it can make. SWGRAPH_Time()
+// is the simulated time of the retrace the current frame is aimed at, so a
+// recording can be played back at the display rate.
+
+#ifndef SWGRAPH_H
+#define SWGRAPH_H
+
+#include <stdint.h>
+
+/******************************************************************************/
+
+#define SWGRAPH_EYES  2
+
+/******************************************************************************/
+
+bool SWGRAPH_Start( int width, int height, double pixelspercm, int eyes, double frequency, double synctime );
+void SWGRAPH_Stop( void );
+
+void SWGRAPH_ClearStereo( uint32_t color );
+void SWGRAPH_ViewCalib( int eye );
+void SWGRAPH_ClearMono( uint32_t color );
+
+void SWGRAPH_Circle( double x, double y, double radius, uint32_t color );
+void SWGRAPH_Ring( double x, double y, double radius, double width, uint32_t color );
+void SWGRAPH_Rectangle( double x, double y, double width, double height, uint32_t color );
+void SWGRAPH_Line( double x1, double y1, double x2, double y2, double width, uint32_t color );
+
+// Stroke text starting at (x,y), scale cm per font unit (capitals are 100 units high).
+void SWGRAPH_String( double x, double y, double scale, const char *text, double width, uint32_t color );
+
+// End of a frame, returning the simulated time (sec) it is shown.
+double SWGRAPH_SwapBuffers( void );
+
+// Simulated time (sec) of the retrace the current frame is aimed at.
+double SWGRAPH_Time( void );
+
+// CPU time (sec) taken to draw the last frame.
+double SWGRAPH_FrameTime( void );
+
+void SWGRAPH_Results( void );
+
+// JOURNAL_Hash() of an eye's buffer (to check a change draws the same frame).
+uint32_t SWGRAPH_Check( int eye );
+
+// Write an eye's buffer as a binary PPM image.
+bool SWGRAPH_Save( const char *file, int eye );
+
+/******************************************************************************/
+
+#endif
@@ -0,0 +1,458 @@
+/******************************************************************************/
+/*                                                                            */
+/* MODULE  : trialindex.cpp                                                   */
+/*                                                                            */
+/* PURPOSE : Random-access index of the trials in a data file.                */
+/*                                                                            */
+/* DATE    : 17/Oct/2026                                                      */
+/*                                                                            */
+/* CHANGES                                                                    */
+/*                                                                            */
+/* V1.0  HRS 17/Oct/2026 - Initial development.                               */
+/*                                                                            */
+/******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+
+#include <mutex>
+#include <string>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "journal.h"
+#include "trialindex.h"
+
+/******************************************************************************/
+
+static FILE        *TRIALINDEX_FP=NULL;
+static FILE        *TRIALINDEX_TableFP=NULL; // Trial table of the open index.
+static int          TRIALINDEX_Sequence=0;   // Entries in the open index.
+static std::mutex   TRIALINDEX_Mutex;
+
+/******************************************************************************/
+
+static uint32_t TRIALINDEX_Check( const TRIALINDEX_ENTRY &entry )
+{
+    return(JOURNAL_Hash(&entry,sizeof(entry)-sizeof(entry.Check)));
+}
+
+/******************************************************************************/
+
+// Entry in the index (by sequence) or the trial table (by trial).
+
+static long TRIALINDEX_Position( int number )
+{
+    return((long)sizeof(TRIALINDEX_HEADER) + ((long)(number-1) * (long)sizeof(TRIALINDEX_ENTRY)));
+}
+
+/******************************************************************************/
+
+static std::string TRIALINDEX_TableFile( const char *file )
+{
+    return(std::string(file) + TRIALINDEX_TABLE);
+}
+
+/******************************************************************************/
+
+static bool TRIALINDEX_Header( FILE *FP, const char *magic )
+{
+TRIALINDEX_HEADER header;
+
+    if( (fseek(FP,0,SEEK_SET) != 0) || (fread(&header,sizeof(header),1,FP) != 1) )
+    {
+        return(false);
+    }
+
+    return((memcmp(header.Magic,magic,sizeof(header.Magic)) == 0) &&
+           (header.Version == TRIALINDEX_VERSION) &&
+           (header.EntryBytes == (int32_t)sizeof(TRIALINDEX_ENTRY)));
+}
+
+/******************************************************************************/
+
+static bool TRIALINDEX_HeaderWrite( FILE *FP, const char *magic )
+{
+TRIALINDEX_HEADER header;
+
+    memset(&header,0,sizeof(header));
+    memcpy(header.Magic,magic,sizeof(header.Magic));
+    header.Version = TRIALINDEX_VERSION;
+    header.EntryBytes = (int32_t)sizeof(TRIALINDEX_ENTRY);
+
+    return((fseek(FP,0,SEEK_SET) == 0) && (fwrite(&header,sizeof(header),1,FP) == 1) && (fflush(FP) == 0));
+}
+
+/******************************************************************************/
+
+// Make sure what has been written is on the disk, not just in the operating system.
+
+static bool TRIALINDEX_Sync( FILE *FP )
+{
+    if( fflush(FP) != 0 )
+    {
+        return(false);
+    }
+
+#if defined(_WIN32)
+    return(_commit(_fileno(FP)) == 0);
+#else
+    return(fsync(fileno(FP)) == 0);
+#endif
+}
+
+/******************************************************************************/
+
+// Read an entry from an open index (false if it isn't valid).
+
+static bool TRIALINDEX_Entry( FILE *FP, int sequence, TRIALINDEX_ENTRY &entry )
+{
+    if( (sequence < 1) || (fseek(FP,TRIALINDEX_Position(sequence),SEEK_SET) != 0) || (fread(&entry,sizeof(entry),1,FP) != 1) )
+    {
+        return(false);
+    }
+
+    return((entry.Magic == TRIALINDEX_ENTRY_OK) && (entry.Sequence == sequence) && (entry.Check == TRIALINDEX_Check(entry)));
+}
+
+/******************************************************************************/
+
+// Read a trial's copy from a trial table (false if it isn't valid).
+
+static bool TRIALINDEX_TableEntry( FILE *FP, int trial, TRIALINDEX_ENTRY &entry )
+{
+    if( (trial < 1) || (fseek(FP,TRIALINDEX_Position(trial),SEEK_SET) != 0) || (fread(&entry,sizeof(entry),1,FP) != 1) )
+    {
+        return(false);
+    }
+
+    return((entry.Magic == TRIALINDEX_ENTRY_OK) && (entry.Trial == trial) && (entry.Check == TRIALINDEX_Check(entry)));
+}
+
+/******************************************************************************/
+
+static bool TRIALINDEX_TableWrite( FILE *FP, const TRIALINDEX_ENTRY &entry )
+{
+    return((fseek(FP,TRIALINDEX_Position(entry.Trial),SEEK_SET) == 0) && (fwrite(&entry,sizeof(entry),1,FP) == 1));
+}
+
+/******************************************************************************/
+
+// Entries in an open index, back from the end past any entry that wasn't
+// completely written.
+
+static int TRIALINDEX_Count( FILE *FP )
+{
+TRIALINDEX_ENTRY entry;
+long size;
+int sequence;
+
+    if( (fseek(FP,0,SEEK_END) != 0) || ((size=ftell(FP)) < 0) )
+    {
+        return(0);
+    }
+
+    sequence = (int)((size - (long)sizeof(TRIALINDEX_HEADER)) / (long)sizeof(TRIALINDEX_ENTRY));
+
+    for( ; ((sequence > 0) && !TRIALINDEX_Entry(FP,sequence,entry)); sequence-- );
+
+    return(sequence);
+}
+
+/******************************************************************************/
+
+bool TRIALINDEX_Open( const char *file, bool create )
+{
+TRIALINDEX_ENTRY entry;
+int sequence;
+bool ok;
+
+    TRIALINDEX_Close();
+
+    std::lock_guard<std::mutex> lock(TRIALINDEX_Mutex);
+
+    if( !create )
+    {
+        if( (TRIALINDEX_FP=fopen(file,"r+b")) == NULL )
+        {
+            return(false);
+        }
+
+        ok = TRIALINDEX_Header(TRIALINDEX_FP,TRIALINDEX_MAGIC);
+
+        // New entries go after the last complete one.
+        TRIALINDEX_Sequence = ok ? TRIALINDEX_Count(TRIALINDEX_FP) : 0;
+    }
+    else
+    {
+        if( (TRIALINDEX_FP=fopen(file,"w+b")) == NULL )
+        {
+            return(false);
+        }
+
+        ok = TRIALINDEX_HeaderWrite(TRIALINDEX_FP,TRIALINDEX_MAGIC);
+        TRIALINDEX_Sequence = 0;
+    }
+
+    // Trial table, with each trial's last entry in the index so far.
+    ok = ok && ((TRIALINDEX_TableFP=fopen(TRIALINDEX_TableFile(file).c_str(),"w+b")) != NULL);
+    ok = ok && TRIALINDEX_HeaderWrite(TRIALINDEX_TableFP,TRIALINDEX_TABLE_MAGIC);
+
+    for( sequence=1; (ok && (sequence <= TRIALINDEX_Sequence)); sequence++ )
+    {
+        ok = TRIALINDEX_Entry(TRIALINDEX_FP,sequence,entry) && TRIALINDEX_TableWrite(TRIALINDEX_TableFP,entry);
+    }
+
+    ok = ok && TRIALINDEX_Sync(TRIALINDEX_TableFP);
+
+    if( !ok )
+    {
+        if( TRIALINDEX_TableFP != NULL )
+        {
+            fclose(TRIALINDEX_TableFP);
+            TRIALINDEX_TableFP = NULL;
+        }
+
+        fclose(TRIALINDEX_FP);
+        TRIALINDEX_FP = NULL;
+    }
+
+    return(ok);
+}
+
+/******************************************************************************/
+
+void TRIALINDEX_Close( void )
+{
+std::lock_guard<std::mutex> lock(TRIALINDEX_Mutex);
+
+    if( TRIALINDEX_FP != NULL )
+    {
+        fclose(TRIALINDEX_FP);
+        TRIALINDEX_FP = NULL;
+    }
+
+    if( TRIALINDEX_TableFP != NULL )
+    {
+        fclose(TRIALINDEX_TableFP);
+        TRIALINDEX_TableFP = NULL;
+    }
+}
+
+/******************************************************************************/
+
+bool TRIALINDEX_Opened( void )
+{
+std::lock_guard<std::mutex> lock(TRIALINDEX_Mutex);
+
+    return(TRIALINDEX_FP != NULL);
+}
+
+/******************************************************************************/
+
+bool TRIALINDEX_Write( TRIALINDEX_ENTRY &entry )
+{
+std::lock_guard<std::mutex> lock(TRIALINDEX_Mutex);
+bool ok;
+
+    if( (TRIALINDEX_FP == NULL) || (entry.Trial < 1) )
+    {
+        return(false);
+    }
+
+    entry.Magic = TRIALINDEX_ENTRY_OK;
+    entry.Sequence = TRIALINDEX_Sequence + 1;
+    entry.Check = TRIALINDEX_Check(entry);
+
+    ok = (fseek(TRIALINDEX_FP,TRIALINDEX_Position(entry.Sequence),SEEK_SET) == 0);
+    ok = ok && (fwrite(&entry,sizeof(entry),1,TRIALINDEX_FP) == 1);
+    ok = ok && TRIALINDEX_Sync(TRIALINDEX_FP);
+
+    // An entry that failed is written over by the next one.
+    if( !ok )
+    {
+        return(false);
+    }
+
+    TRIALINDEX_Sequence = entry.Sequence;
+
+    // The trial's copy in the table only once the entry is on the disk.
+    ok = TRIALINDEX_TableWrite(TRIALINDEX_TableFP,entry) && TRIALINDEX_Sync(TRIALINDEX_TableFP);
+
+    return(ok);
+}
+
+/******************************************************************************/
+
+bool TRIALINDEX_WriteAll( const char *file, TRIALINDEX_ENTRY entry[], int entries )
+{
+FILE *FP,*TableFP;
+int i;
+bool ok;
+
+    if( (FP=fopen(file,"w+b")) == NULL )
+    {
+        return(false);
+    }
+
+    ok = ((TableFP=fopen(TRIALINDEX_TableFile(file).c_str(),"w+b")) != NULL);
+    ok = ok && TRIALINDEX_HeaderWrite(FP,TRIALINDEX_MAGIC) && TRIALINDEX_HeaderWrite(TableFP,TRIALINDEX_TABLE_MAGIC);
+
+    for( i=0; (ok && (i < entries)); i++ )
+    {
+        entry[i].Magic = TRIALINDEX_ENTRY_OK;
+        entry[i].Sequence = i+1;
+        entry[i].Check = TRIALINDEX_Check(entry[i]);
+
+        ok = (entry[i].Trial >= 1) && (fwrite(&entry[i],sizeof(entry[i]),1,FP) == 1) && TRIALINDEX_TableWrite(TableFP,entry[i]);
+    }
+
+    ok = ok && TRIALINDEX_Sync(FP) && TRIALINDEX_Sync(TableFP);
+
+    if( TableFP != NULL )
+    {
+        ok = (fclose(TableFP) == 0) && ok;
+    }
+
+    ok = (fclose(FP) == 0) && ok;
+
+    return(ok);
+}
+
+/******************************************************************************/
+
+bool TRIALINDEX_Read( const char *file, int trial, TRIALINDEX_ENTRY &entry )
+{
+TRIALINDEX_ENTRY item;
+FILE *FP;
+int sequence;
+bool ok=false;
+
+    // The trial's copy in the trial table.
+    if( (FP=fopen(TRIALINDEX_TableFile(file).c_str(),"rb")) != NULL )
+    {
+        ok = TRIALINDEX_Header(FP,TRIALINDEX_TABLE_MAGIC) && TRIALINDEX_TableEntry(FP,trial,entry);
+        fclose(FP);
+    }
+
+    if( ok || ((FP=fopen(file,"rb")) == NULL) )
+    {
+        return(ok);
+    }
+
+    // Otherwise back from the last entry, so a trial saved more than once gives its last save.
+    if( TRIALINDEX_Header(FP,TRIALINDEX_MAGIC) )
+    {
+        for( sequence=TRIALINDEX_Count(FP); ((sequence > 0) && !ok); sequence-- )
+        {
+            if( TRIALINDEX_Entry(FP,sequence,item) && (item.Trial == trial) )
+            {
+                entry = item;
+                ok = true;
+            }
+        }
+    }
+
+    fclose(FP);
+
+    return(ok);
+}
+
+/******************************************************************************/
+
+bool TRIALINDEX_ReadSequence( const char *file, int sequence, TRIALINDEX_ENTRY &entry )
+{
+FILE *FP;
+bool ok;
+
+    if( (FP=fopen(file,"rb")) == NULL )
+    {
+        return(false);
+    }
+
+    ok = TRIALINDEX_Header(FP,TRIALINDEX_MAGIC) && TRIALINDEX_Entry(FP,sequence,entry);
+    fclose(FP);
+
+    return(ok);
+}
+
+/******************************************************************************/
+
+int TRIALINDEX_Entries( const char *file )
+{
+FILE *FP;
+int entries=0;
+
+    if( (FP=fopen(file,"rb")) == NULL )
+    {
+        return(0);
+    }
+
+    if( TRIALINDEX_Header(FP,TRIALINDEX_MAGIC) )
+    {
+        entries = TRIALINDEX_Count(FP);
+    }
+
+    fclose(FP);
+
+    return(entries);
+}
+
+/******************************************************************************/
+
+int TRIALINDEX_Last( const char *file )
+{
+TRIALINDEX_ENTRY entry;
+FILE *FP;
+int sequence,trial=0;
+
+    if( (FP=fopen(file,"rb")) == NULL )
+    {
+        return(0);
+    }
+
+    if( TRIALINDEX_Header(FP,TRIALINDEX_MAGIC) && ((sequence=TRIALINDEX_Count(FP)) > 0) && TRIALINDEX_Entry(FP,sequence,entry) )
+    {
+        trial = entry.Trial;
+    }
+
+    fclose(FP);
+
+    return(trial);
+}
+
+/******************************************************************************/
+
+int64_t TRIALINDEX_FileSize( const char *file )
+{
+#if defined(_WIN32)
+struct _stat64 info;
+
+    fflush(NULL);
+
+    if( _stat64(file,&info) != 0 )
+    {
+        return(-1);
+    }
+#else
+struct stat info;
+
+    fflush(NULL);
+
+    if( stat(file,&info) != 0 )
+    {
+        return(-1);
+    }
+#endif
+
+    return((int64_t)info.st_size);
+}
+
+/******************************************************************************/
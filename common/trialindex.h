@@ -0,0 +1,105 @@
+/******************************************************************************/
+/*                                                                            */
+/* MODULE  : trialindex.h                                                     */
+/*                                                                            */
+/* PURPOSE : Random-access index of the trials in a data file.                */
+/*                                                                            */
+/* DATE    : 17/Oct/2026                                                      */
+/*                                                                            */
+/* CHANGES                                                                    */
+/*                                                                            */
+/* V1.0  HRS 17/Oct/2026 - Initial development.                               */
+/*                                                                            */
+/******************************************************************************/
+
+// The index is written next to the data file, one fixed-size entry each time
+// a trial is saved, in the order they are saved (entry Sequence is at
+// TRIALINDEX_HEADER + (Sequence-1) entries). A trial saved more than once
+// (e.g., a miss trial that is run again) has an entry for each save, so one
+// doesn't overwrite another. An entry gives where the trial is in the data
+// file (byte offset and size of what DATAFILE_TrialSave() wrote) and a few
+// values from TrialData, so a program can go straight to a trial without
+// scanning the data file.
+//
+// A trial table is written next to the index (file.trials) with a copy of
+// the last entry for each trial number (entry Trial is at TRIALINDEX_HEADER +
+// (Trial-1) entries), so TRIALINDEX_Read() is one seek as well. The table is
+// rebuilt from the index when an index is opened to add to it. If the table
+// is missing or a trial's copy isn't valid, TRIALINDEX_Read() searches the
+// index back from the last entry instead.
+//
+// TRIALINDEX_Write() is called after the trial has been saved to the data
+// file. It writes the entry, then its copy in the trial table, each flushed
+// to the disk (fsync) before returning, so neither has a trial that isn't in
+// the data file. Each entry has its own check, so one that was only partly
+// written when the program died is the same as one that was never written.
+// Trials that are not in the index (e.g., before a resumed session) read as
+// not found.
+
+#ifndef TRIALINDEX_H
+#define TRIALINDEX_H
+
+#include <stdint.h>
+
+/******************************************************************************/
+
+#define TRIALINDEX_MAGIC        "TRIALIDX"
+#define TRIALINDEX_TABLE_MAGIC  "TRIALTBL"
+#define TRIALINDEX_TABLE        ".trials"       // Trial table is file.trials.
+#define TRIALINDEX_VERSION      2
+#define TRIALINDEX_ENTRY_OK     0x59525445U     // "ETRY".
+
+struct TRIALINDEX_HEADER
+{
+    char    Magic[8];
+    int32_t Version;
+    int32_t EntryBytes;
+};
+
+struct TRIALINDEX_ENTRY
+{
+    uint32_t Magic;             // TRIALINDEX_ENTRY_OK once written.
+    int32_t  Trial;
+    int64_t  Offset;            // Trial in the data file.
+    int64_t  Bytes;
+    int32_t  Rows;              // FrameData rows.
+    int32_t  MissTrial;         // Miss trial (or repeated after one).
+    int32_t  Phase;             // TrialPhase.
+    int32_t  FieldType;
+    int32_t  Sequence;          // Save order (1, 2, ...), set by TRIALINDEX_Write().
+    uint32_t Check;             // JOURNAL_Hash() of the entry before Check.
+};
+
+/******************************************************************************/
+
+// Open the index to write entries (create starts a new, empty index). The
+// trial table is created, or rebuilt from the entries already in the index.
+bool TRIALINDEX_Open( const char *file, bool create );
+void TRIALINDEX_Close( void );
+bool TRIALINDEX_Opened( void );
+
+bool TRIALINDEX_Write( TRIALINDEX_ENTRY &entry );
+
+// Write a whole index and its trial table from entries in save order (e.g.,
+// for a data file that was saved without one), flushed to the disk once at
+// the end. It doesn't use the open index, so threads can each write one.
+bool TRIALINDEX_WriteAll( const char *file, TRIALINDEX_ENTRY entry[], int entries );
+
+// Last entry for a trial (false if the trial isn't in the index).
+bool TRIALINDEX_Read( const char *file, int trial, TRIALINDEX_ENTRY &entry );
+
+// Entry in save order (1...TRIALINDEX_Entries()).
+bool TRIALINDEX_ReadSequence( const char *file, int sequence, TRIALINDEX_ENTRY &entry );
+int TRIALINDEX_Entries( const char *file );
+
+// Trial of the last entry in the index (0 if there are none).
+int TRIALINDEX_Last( const char *file );
+
+// Size of a file in bytes (-1 if it doesn't exist), for the entry's Offset.
+// Output streams are flushed first, so data still buffered by stdio (e.g.,
+// the trial DATAFILE_TrialSave() has just written) is counted.
+int64_t TRIALINDEX_FileSize( const char *file );
+
+/******************************************************************************/
+
+#endif
@@ -0,0 +1,230 @@
+/******************************************************************************/
+/*                                                                            */
+/* MODULE  : trialwriter.cpp                                                  */
+/*                                                                            */
+/* PURPOSE : Background thread for saving trial data files.                   */
+/*                                                                            */
+/* DATE    : 17/Oct/2026                                                      */
+/*                                                                            */
+/* CHANGES                                                                    */
+/*                                                                            */
+/* V1.0  HRS 17/Oct/2026 - Initial development.                               */
+/*                                                                            */
+/******************************************************************************/
+
+#include <stdio.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "trialwriter.h"
+
+/******************************************************************************/
+
+struct TRIALWRITER_JOB
+{
+    TRIALWRITER_FUNCTION Function;
+    int Trial;
+};
+
+static TRIALWRITER_JOB  TRIALWRITER_Job;            // Waiting to be written.
+static bool             TRIALWRITER_Waiting=false;
+static bool             TRIALWRITER_Writing=false;
+static bool             TRIALWRITER_Running=false;
+static bool             TRIALWRITER_Exit=false;
+static bool             TRIALWRITER_OkFlag=true;
+static int              TRIALWRITER_Failed=0;
+static double           TRIALWRITER_TimeMax=0.0;
+static std::mutex       TRIALWRITER_Mutex;
+static std::condition_variable TRIALWRITER_Condition;
+static std::thread      TRIALWRITER_Thread;
+
+/******************************************************************************/
+
+static bool TRIALWRITER_Call( const TRIALWRITER_JOB &job )
+{
+std::chrono::steady_clock::time_point start;
+double seconds;
+bool ok;
+
+    start = std::chrono::steady_clock::now();
+    ok = (*job.Function)(job.Trial);
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if( !ok )
+    {
+        printf("TRIALWRITER: Cannot save Trial %d.\n",job.Trial);
+    }
+
+    std::lock_guard<std::mutex> lock(TRIALWRITER_Mutex);
+
+    if( seconds > TRIALWRITER_TimeMax )
+    {
+        TRIALWRITER_TimeMax = seconds;
+    }
+
+    if( !ok && TRIALWRITER_OkFlag )
+    {
+        TRIALWRITER_OkFlag = false;
+        TRIALWRITER_Failed = job.Trial;
+    }
+
+    return(ok);
+}
+
+/******************************************************************************/
+
+static void TRIALWRITER_ThreadFunction( void )
+{
+TRIALWRITER_JOB job;
+
+    for( ;; )
+    {
+        {
+            std::unique_lock<std::mutex> lock(TRIALWRITER_Mutex);
+
+            TRIALWRITER_Condition.wait(lock,[]{ return(TRIALWRITER_Waiting || TRIALWRITER_Exit); });
+
+            if( !TRIALWRITER_Waiting )
+            {
+                break;
+            }
+
+            job = TRIALWRITER_Job;
+            TRIALWRITER_Waiting = false;
+            TRIALWRITER_Writing = true;
+        }
+
+        TRIALWRITER_Call(job);
+
+        {
+            std::lock_guard<std::mutex> lock(TRIALWRITER_Mutex);
+            TRIALWRITER_Writing = false;
+        }
+
+        TRIALWRITER_Condition.notify_all();
+    }
+}
+
+/******************************************************************************/
+
+bool TRIALWRITER_Start( void )
+{
+    if( TRIALWRITER_Running )
+    {
+        return(true);
+    }
+
+    TRIALWRITER_Waiting = false;
+    TRIALWRITER_Writing = false;
+    TRIALWRITER_Exit = false;
+
+    TRIALWRITER_Thread = std::thread(TRIALWRITER_ThreadFunction);
+    TRIALWRITER_Running = true;
+
+    return(true);
+}
+
+/******************************************************************************/
+
+void TRIALWRITER_Stop( void )
+{
+    if( !TRIALWRITER_Running )
+    {
+        return;
+    }
+
+    // A waiting trial is written before the thread exits.
+    {
+        std::lock_guard<std::mutex> lock(TRIALWRITER_Mutex);
+        TRIALWRITER_Exit = true;
+    }
+
+    TRIALWRITER_Condition.notify_all();
+    TRIALWRITER_Thread.join();
+    TRIALWRITER_Running = false;
+}
+
+/******************************************************************************/
+
+bool TRIALWRITER_Submit( TRIALWRITER_FUNCTION function, int trial )
+{
+TRIALWRITER_JOB job;
+
+    job.Function = function;
+    job.Trial = trial;
+
+    // Not running, so just write it now.
+    if( !TRIALWRITER_Running )
+    {
+        return(TRIALWRITER_Call(job));
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(TRIALWRITER_Mutex);
+
+        // Wait for the writer to take the trial already waiting (if any).
+        TRIALWRITER_Condition.wait(lock,[]{ return(!TRIALWRITER_Waiting); });
+
+        TRIALWRITER_Job = job;
+        TRIALWRITER_Waiting = true;
+    }
+
+    TRIALWRITER_Condition.notify_all();
+
+    return(true);
+}
+
+/******************************************************************************/
+
+void TRIALWRITER_Flush( void )
+{
+    if( !TRIALWRITER_Running )
+    {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(TRIALWRITER_Mutex);
+
+    TRIALWRITER_Condition.wait(lock,[]{ return(!TRIALWRITER_Waiting && !TRIALWRITER_Writing); });
+}
+
+/******************************************************************************/
+
+bool TRIALWRITER_Busy( void )
+{
+std::lock_guard<std::mutex> lock(TRIALWRITER_Mutex);
+
+    return(TRIALWRITER_Waiting || TRIALWRITER_Writing);
+}
+
+/******************************************************************************/
+
+bool TRIALWRITER_Ok( void )
+{
+std::lock_guard<std::mutex> lock(TRIALWRITER_Mutex);
+
+    return(TRIALWRITER_OkFlag);
+}
+
+/******************************************************************************/
+
+int TRIALWRITER_FailedTrial( void )
+{
+std::lock_guard<std::mutex> lock(TRIALWRITER_Mutex);
+
+    return(TRIALWRITER_Failed);
+}
+
+/******************************************************************************/
+
+double TRIALWRITER_MaximumTime( void )
+{
+std::lock_guard<std::mutex> lock(TRIALWRITER_Mutex);
+
+    return(TRIALWRITER_TimeMax);
+}
+
+/******************************************************************************/
@@ -0,0 +1,55 @@
+/******************************************************************************/
+/*                                                                            */
+/* MODULE  : trialwriter.h                                                    */
+/*                                                                            */
+/* PURPOSE : Background thread for saving trial data files.                   */
+/*                                                                            */
+/* DATE    : 17/Oct/2026                                                      */
+/*                                                                            */
+/* CHANGES                                                                    */
+/*                                                                            */
+/* V1.0  HRS 17/Oct/2026 - Initial development.                               */
+/*                                                                            */
+/******************************************************************************/
+
+// TRIALWRITER_Submit() hands a function to save a trial to the writer thread
+// and returns straight away, so the state machine (and graphics) don't wait
+// for the disk.
+//
+// The function reads the trial from the program's tables (TrialData,
+// FrameColumns, the histograms, etc.), not from a copy: DATAFILE_TrialSave()
+// takes row Trial of the TrialData MATDAT, which is also the trial list, so
+// it can't be given a copy of the trial. The tables must not be changed
+// until the trial has been written, so call TRIALWRITER_Flush() before they
+// are used for the next trial (i.e., in TrialSetup()), at rest breaks, and
+// before the data file is closed. That means only one trial is ever waiting,
+// so there is no queue: Submit() waits if a trial is still waiting to be
+// written. Before TRIALWRITER_Start() or after TRIALWRITER_Stop() functions
+// are called immediately.
+
+#ifndef TRIALWRITER_H
+#define TRIALWRITER_H
+
+/******************************************************************************/
+
+// Save function for a trial (returns false on error).
+typedef bool (*TRIALWRITER_FUNCTION)( int trial );
+
+/******************************************************************************/
+
+bool TRIALWRITER_Start( void );
+void TRIALWRITER_Stop( void );
+bool TRIALWRITER_Submit( TRIALWRITER_FUNCTION function, int trial );
+void TRIALWRITER_Flush( void );
+bool TRIALWRITER_Busy( void );
+
+// False if any trial could not be written (and the first trial that failed).
+bool TRIALWRITER_Ok( void );
+int  TRIALWRITER_FailedTrial( void );
+
+// Longest time (sec) taken to write a trial.
+double TRIALWRITER_MaximumTime( void );
+
+/******************************************************************************/
+
+#endif
@@ -0,0 +1,332 @@
+/******************************************************************************/
+/*                                                                            */
+/* MODULE  : vec3.h                                                           */
+/*                                                                            */
+/* PURPOSE : Fixed-size 3-vector and 3x3 matrix for the robot forces function.*/
+/*                                                                            */
+/* DATE    : 17/Oct/2026                                                      */
+/*                                                                            */
+/* CHANGES                                                                    */
+/*                                                                            */
+/* V1.0  HRS 17/Oct/2026 - Initial development.                               */
+/*                                                                            */
+/******************************************************************************/
+
+// The dynamic "matrix" type allocates storage for every temporary it creates,
+// so expressions like R * (P - Q) hit the heap several times per tick. VEC3
+// and MAT3 live entirely on the stack and arithmetic is done with expression
+// templates, so a whole expression is evaluated in one pass when it is
+// assigned without any intermediate objects. Elements are indexed from 1, the
+// same as matrix (i.e., P(1) for P(1,1)).
+
+#ifndef VEC3_H
+#define VEC3_H
+
+#include <math.h>
+
+/******************************************************************************/
+
+class VEC3;
+class MAT3;
+
+// Expression operands are held by value, except VEC3 which is held by reference.
+template<class E> struct VEC3_OPERAND { typedef const E type; };
+template<> struct VEC3_OPERAND<VEC3> { typedef const VEC3 &type; };
+
+/******************************************************************************/
+
+template<class E> class VEC3_EXPR
+{
+public:
+    inline const E &Self( void ) const
+    {
+        return(static_cast<const E &>(*this));
+    }
+
+    inline double Element( int i ) const
+    {
+        return(Self().Element(i));
+    }
+};
+
+/******************************************************************************/
+
+template<class A,class B> class VEC3_ADD : public VEC3_EXPR< VEC3_ADD<A,B> >
+{
+typename VEC3_OPERAND<A>::type a;
+typename VEC3_OPERAND<B>::type b;
+
+public:
+    inline VEC3_ADD( const A &_a, const B &_b ) : a(_a), b(_b) { }
+
+    inline double Element( int i ) const
+    {
+        return(a.Element(i) + b.Element(i));
+    }
+};
+
+/******************************************************************************/
+
+template<class A,class B> class VEC3_SUB : public VEC3_EXPR< VEC3_SUB<A,B> >
+{
+typename VEC3_OPERAND<A>::type a;
+typename VEC3_OPERAND<B>::type b;
+
+public:
+    inline VEC3_SUB( const A &_a, const B &_b ) : a(_a), b(_b) { }
+
+    inline double Element( int i ) const
+    {
+        return(a.Element(i) - b.Element(i));
+    }
+};
+
+/******************************************************************************/
+
+template<class A> class VEC3_SCALE : public VEC3_EXPR< VEC3_SCALE<A> >
+{
+double s;
+typename VEC3_OPERAND<A>::type a;
+
+public:
+    inline VEC3_SCALE( double _s, const A &_a ) : s(_s), a(_a) { }
+
+    inline double Element( int i ) const
+    {
+        return(s * a.Element(i));
+    }
+};
+
+/******************************************************************************/
+
+template<class A> class VEC3_ROTATE : public VEC3_EXPR< VEC3_ROTATE<A> >
+{
+const MAT3 &m;
+typename VEC3_OPERAND<A>::type a;
+
+public:
+    inline VEC3_ROTATE( const MAT3 &_m, const A &_a ) : m(_m), a(_a) { }
+
+    inline double Element( int i ) const;
+};
+
+/******************************************************************************/
+
+class VEC3 : public VEC3_EXPR<VEC3>
+{
+public:
+    double v[3];
+
+    inline VEC3( void )
+    {
+        v[0] = v[1] = v[2] = 0.0;
+    }
+
+    inline VEC3( double x, double y, double z )
+    {
+        v[0] = x;
+        v[1] = y;
+        v[2] = z;
+    }
+
+    template<class E> inline VEC3( const VEC3_EXPR<E> &e )
+    {
+        v[0] = e.Element(0);
+        v[1] = e.Element(1);
+        v[2] = e.Element(2);
+    }
+
+    // Evaluate all elements before storing so that aliasing (V = R * V) is safe.
+    template<class E> inline VEC3 &operator=( const VEC3_EXPR<E> &e )
+    {
+    double x=e.Element(0),y=e.Element(1),z=e.Element(2);
+
+        v[0] = x;
+        v[1] = y;
+        v[2] = z;
+
+        return(*this);
+    }
+
+    template<class E> inline VEC3 &operator+=( const VEC3_EXPR<E> &e )
+    {
+    double x=e.Element(0),y=e.Element(1),z=e.Element(2);
+
+        v[0] += x;
+        v[1] += y;
+        v[2] += z;
+
+        return(*this);
+    }
+
+    template<class E> inline VEC3 &operator-=( const VEC3_EXPR<E> &e )
+    {
+    double x=e.Element(0),y=e.Element(1),z=e.Element(2);
+
+        v[0] -= x;
+        v[1] -= y;
+        v[2] -= z;
+
+        return(*this);
+    }
+
+    inline VEC3 &operator*=( double s )
+    {
+        v[0] *= s;
+        v[1] *= s;
+        v[2] *= s;
+
+        return(*this);
+    }
+
+    inline double Element( int i ) const
+    {
+        return(v[i]);
+    }
+
+    // One-based element access, same as matrix (i.e., P(1) for P(1,1)).
+    inline double &operator()( int i )
+    {
+        return(v[i-1]);
+    }
+
+    inline double operator()( int i ) const
+    {
+        return(v[i-1]);
+    }
+
+    inline void zeros( void )
+    {
+        v[0] = v[1] = v[2] = 0.0;
+    }
+
+    // Limit the length of the vector (same as matrix::clampnorm).
+    inline void clampnorm( double max )
+    {
+    double n=sqrt((v[0]*v[0]) + (v[1]*v[1]) + (v[2]*v[2]));
+
+        if( (n > max) && (n > 0.0) )
+        {
+            *this *= (max / n);
+        }
+    }
+};
+
+/******************************************************************************/
+
+class MAT3
+{
+public:
+    double m[3][3];
+
+    inline MAT3( void )
+    {
+        identity();
+    }
+
+    inline void identity( void )
+    {
+    int i,j;
+
+        for( i=0; (i < 3); i++ )
+        {
+            for( j=0; (j < 3); j++ )
+            {
+                m[i][j] = (i == j) ? 1.0 : 0.0;
+            }
+        }
+    }
+
+    // One-based element access, same as matrix.
+    inline double &operator()( int i, int j )
+    {
+        return(m[i-1][j-1]);
+    }
+
+    inline double operator()( int i, int j ) const
+    {
+        return(m[i-1][j-1]);
+    }
+};
+
+/******************************************************************************/
+
+template<class A> inline double VEC3_ROTATE<A>::Element( int i ) const
+{
+    return((m.m[i][0] * a.Element(0)) + (m.m[i][1] * a.Element(1)) + (m.m[i][2] * a.Element(2)));
+}
+
+/******************************************************************************/
+
+template<class A,class B> inline VEC3_ADD<A,B> operator+( const VEC3_EXPR<A> &a, const VEC3_EXPR<B> &b )
+{
+    return(VEC3_ADD<A,B>(a.Self(),b.Self()));
+}
+
+template<class A,class B> inline VEC3_SUB<A,B> operator-( const VEC3_EXPR<A> &a, const VEC3_EXPR<B> &b )
+{
+    return(VEC3_SUB<A,B>(a.Self(),b.Self()));
+}
+
+template<class A> inline VEC3_SCALE<A> operator*( double s, const VEC3_EXPR<A> &a )
+{
+    return(VEC3_SCALE<A>(s,a.Self()));
+}
+
+template<class A> inline VEC3_SCALE<A> operator*( const VEC3_EXPR<A> &a, double s )
+{
+    return(VEC3_SCALE<A>(s,a.Self()));
+}
+
+template<class A> inline VEC3_ROTATE<A> operator*( const MAT3 &m, const VEC3_EXPR<A> &a )
+{
+    return(VEC3_ROTATE<A>(m,a.Self()));
+}
+
+/******************************************************************************/
+
+template<class A,class B> inline double dot( const VEC3_EXPR<A> &a, const VEC3_EXPR<B> &b )
+{
+    return((a.Element(0) * b.Element(0)) + (a.Element(1) * b.Element(1)) + (a.Element(2) * b.Element(2)));
+}
+
+template<class A> inline double norm( const VEC3_EXPR<A> &a )
+{
+double x=a.Element(0),y=a.Element(1),z=a.Element(2);
+
+    return(sqrt((x*x) + (y*y) + (z*z)));
+}
+
+/******************************************************************************/
+
+// Rotation about the Z axis by an angle in radians (same as SPMX_romxZ).
+inline void MAT3_romxZ( double angle, MAT3 &R )
+{
+double c=cos(angle),s=sin(angle);
+
+    R.identity();
+
+    R.m[0][0] =  c;
+    R.m[0][1] = -s;
+    R.m[1][0] =  s;
+    R.m[1][1] =  c;
+}
+
+/******************************************************************************/
+
+// Copy between VEC3 and a (3,1) matrix (or any type with one-based (i,j) access).
+template<class M> inline VEC3 VEC3_get( M &m )
+{
+    return(VEC3(m(1,1),m(2,1),m(3,1)));
+}
+
+template<class M> inline void VEC3_put( M &m, const VEC3 &v )
+{
+    m(1,1) = v.v[0];
+    m(2,1) = v.v[1];
+    m(3,1) = v.v[2];
+}
+
+/******************************************************************************/
+
+#endif
@@ -20,6 +20,46 @@
 /*                                                                            */
 /* V1.5  JNI 29/Nov/2017 - Save miss trials (for fixation control).           */
 /*                                                                            */
+/* V1.6  HRS 17/Oct/2026 - Allocation-free VEC3/MAT3 in forces function.      */
+/*                                                                            */
+/* V1.7  HRS 17/Oct/2026 - Force-field compiled per trial (no per-tick trig). */
+/*                                                                            */
+/* V1.8  HRS 17/Oct/2026 - Force-field policy kernels selected per trial.     */
+/*                                                                            */
+/* V1.9  HRS 17/Oct/2026 - Robot state snapshot for the graphics thread.      */
+/*                                                                            */
+/* V1.10 HRS 17/Oct/2026 - Deferred logging (LOOPLOG) for robot loop messages.*/
+/*                                                                            */
+/* V1.11 HRS 17/Oct/2026 - Simulated robot (ROBOT_SIMULATE) for Linux.        */
+/*                                                                            */
+/* V1.12 HRS 17/Oct/2026 - Per-state loop timing histograms (LOOPHIST).       */
+/*                                                                            */
+/* V1.13 HRS 17/Oct/2026 - FrameData sized from worst-case trial duration.    */
+/*                                                                            */
+/* V1.14 HRS 17/Oct/2026 - Slow frame variables saved as streams (FRAMEREC).  */
+/*                                                                            */
+/* V1.15 HRS 17/Oct/2026 - Trials saved by a background thread (TRIALWRITER). */
+/*                                                                            */
+/* V1.16 HRS 17/Oct/2026 - Columnar session file (COLFILE).                   */
+/*                                                                            */
+/* V1.17 HRS 17/Oct/2026 - Compressed columns in session file (COLCODEC).     */
+/*                                                                            */
+/* V1.18 HRS 17/Oct/2026 - Session journal and /resume (JOURNAL).             */
+/*                                                                            */
+/* V1.19 HRS 17/Oct/2026 - Online force-compensation index for channel trials.*/
+/*                                                                            */
+/* V1.20 HRS 17/Oct/2026 - Random-access trial index next to the data file.   */
+/*                                                                            */
+/* V1.21 HRS 17/Oct/2026 - Configuration and trial list cache (CFGCACHE).     */
+/*                                                                            */
+/* V1.22 HRS 17/Oct/2026 - Idle function sleeps until its next deadline.      */
+/*                                                                            */
+/* V1.23 HRS 17/Oct/2026 - Cursor predicted to the time it is on the screen.  */
+/*                                                                            */
+/* V1.24 HRS 17/Oct/2026 - Cached geometry for circles, rings and text.       */
+/*                                                                            */
+/* V1.25 HRS 17/Oct/2026 - Stereo scene compiled once, drawn for each eye.    */
+/*                                                                            */
 /******************************************************************************/
 
 #define MODULE_NAME "ImagineFollowThroughEye"
@@ -27,6 +67,23 @@
 /******************************************************************************/
 
 #include <motor.h>
+#include <atomic>
+#include "../common/vec3.h"
+#include "../common/snapshot.h"
+#include "../common/looplog.h"
+#include "../common/loophist.h"
+#include "../common/framerec.h"
+#include "../common/trialwriter.h"
+#include "../common/colfile.h"
+#include "../common/journal.h"
+#include "../common/trialindex.h"
+#include "../common/cfgcache.h"
+#include "../common/idlesched.h"
+#include "../common/glcache.h"
+
+#ifdef ROBOT_SIMULATE
+#include "../common/robotsim.h"
+#endif
 
 /******************************************************************************/
 
@@ -157,13 +214,23 @@ int     CursorColor=RED;
 STRING  CursorColorText="RED";
 double  CursorRadius=0.5;
 
-matrix  ForceFieldForces(3,1);
+// The cursor can be drawn where the hand is expected to be when the frame is
+// on the screen (CursorPredicted), extrapolated from the loop-rate kinematics.
+BOOL    CursorPredictFlag=FALSE;
+double  CursorPredictTime=0.0;             // Vertical retrace (or drawing) to photons (sec).
+BOOL    CursorPredictAcceleration=FALSE;   // Include acceleration as well as velocity.
+double  CursorAccelerationTime=0.01;       // Time constant (sec) of acceleration filter.
+matrix  CursorPredicted(3,1);
+VEC3    CursorAcceleration;
+VEC3    CursorVelocityLast;
+
+VEC3    ForceFieldForces;
 BOOL    ForceFieldStarted=FALSE;
-matrix  ForceFieldPosition(3,1);
+VEC3    ForceFieldPosition;
 RAMPER  ForceFieldRamp;
 double  ForceFieldRampTime=0.1;
 
-matrix  WallForces(3,1);
+VEC3    WallForces;
 BOOL    WallStarted=FALSE;
 double  WallDistance;
 //matrix  WallPosition(3,1);
@@ -200,7 +267,7 @@ double  ViaRadius=0.5;
 TIMER_Interval  RobotForcesFunctionLatency("ForcesFunction");
 double          ForcesFunctionLatency;
 TIMER_Frequency RobotForcesFunctionFrequency("ForcesFunction");
-double          ForcesFunctionPeriod;
+double          ForcesFunctionPeriod;           // msec (TIMER_Frequency::Loop()).
 
 TIMER_Frequency GraphicsDisplayFrequency("DisplayFrequency");
 TIMER_Frequency GraphicsIdleFrequency("IdleFrequency");
@@ -211,6 +278,9 @@ TIMER_Interval  GraphicsClearMonoLatency("ClearMonoLatency");
 
 double  GraphicsVerticalRetraceSyncTime=0.01;   // Time (sec) before vertical retrace to draw graphics frame
 double  GraphicsVerticalRetraceCatchTime=0.05;  // Time (msec) to devote to catching vertical retrace
+double  GraphicsIdlePeriod=0.001;               // Longest sleep (sec) of idle function (0 for Sleep(0) loop)
+double  GraphicsIdleSpinTime=0.001;             // Time (sec) to spin before a vertical retrace deadline
+BOOL    GraphicsSceneListFlag=TRUE;             // Stereo scene compiled once and drawn for each eye
 TIMER   GraphicsTargetTimer("GraphicsTarget");
 
 int     GraphicsMode=GRAPHICS_DISPLAY_2D;
@@ -228,9 +298,21 @@ struct WAVELIST WaveList[] =
 
 TIMER_Interval WaveListPlayInterval("WaveListPlay");
 
-#define FRAMEDATA_ROWS 10000
+#define FRAMEDATA_ROWS   10000         // Minimum rows.
+#define FRAMEDATA_CHUNK  1000          // Rows are added in chunks of this size.
+#define FRAMEDATA_MARGIN 1.0           // Extra time (sec) on top of worst-case trial.
 MATDAT FrameData("FrameData");
+COLTABLE FrameColumns("FrameData");
+COLTABLE FrameShadow("FrameData");     // Copies of the frame variables, which FrameData samples.
+MATDAT FrameGraphics("FrameGraphics"); // GRAPHICS frame variables for each row.
 BOOL   FrameRecord=FALSE;
+int    FrameDataRows=0;
+int    FrameDataExtraChunks=0;
+BOOL   FrameDataTruncated=FALSE;       // FrameData filled and recording stopped early (TrialData).
+
+// Slowly-changing frame variables, each with its own sample rate and time.
+#define FRAMESTREAM_RATE 100.0         // Hz
+FRAMEREC FrameStreams("FrameStreams");
 
 TIMER  MovementDurationTimer("MovementDuration");
 TIMER  MovementDurationToViaTimer("MovementDuration");
@@ -298,6 +380,8 @@ PERMUTELIST PhaseFieldIndexPermute;
 PERMUTELIST TargetPermute; 
 
 MATDAT TrialData("TrialData");
+COLTABLE TrialColumns("TrialData");
+BOOL     ColumnCompress=TRUE;  // Compress columns in session file (COLCODEC).
 
 // Trial data variables.
 int    FieldIndex;
@@ -317,6 +401,40 @@ int    MissTrialsFixation=0;
 int    MissTrialsTotal=0;
 int    MissTrialsFixationTotal=0;
 double MissTrialsPercent=0.0;
+
+// Session journal (to resume an interrupted session with /resume).
+#define RECORD_SESSION  1       // Trial list.
+#define RECORD_TRIAL    2       // Trial written to data file.
+#define RECORD_RESUME   3       // Session resumed.
+#define RECORD_TIMES    64
+
+struct JOURNALTRIAL
+{
+    int    Trial;
+    int    MissTrialsTotal;
+    int    MissTrialsFixationTotal;
+    int    MissTrialFlag;               // Missed, so the same trial is run again.
+    int    MovementTimes;
+    double MovementTime[RECORD_TIMES];  // Added to ContextFullMovementTimeData.
+};
+
+STRING  JournalFile="";
+BOOL    JournalResumeFlag=FALSE;
+BOOL    JournalSessionFlag=FALSE;
+int     JournalResumeCount=0;
+int     JournalTrialLast=0;
+int     JournalTimeCount=0;
+double  JournalTime[RECORD_TIMES];
+JOURNALTRIAL JournalTrial;
+
+// Trial index (DataFile.index) to go straight to a trial in the data file.
+int     TrialIndexMissTotal=0;
+BOOL    TrialIndexMissTrial=FALSE;
+
+// Cache of the configuration and trial list (DataFile.cfgcache), which is used
+// instead of loading the configuration files again if they haven't changed.
+CFGCACHE ConfigCache;
+STRING  ConfigCacheFile="";
 double MovementReactionTime=0.0;
 double MovementDurationTime=0.0;
 double MovementDurationToViaTime=0.0;
@@ -327,7 +445,55 @@ matrix FinishPositionTemp(3,1);
 int    RobotFieldType;
 double RobotFieldConstants[FIELD_CONSTANTS];
 double RobotFieldAngle;
-matrix RobotFieldMatrix;
+
+// Force-compensation index of channel trials: regression (through zero) of the
+// channel force on the ideal force of the viscous field, both perpendicular to
+// the channel. The forces function adds to the sums during the movement, so
+// the index is ready at TrialStop() without going back over the frame data.
+double CompensationViscosity=0.0;   // Viscous field the channel force is compared with
+double CompensationAngle=0.0;       // (the last one used, or the first configured).
+double CompensationSum[3];          // Channel x channel, channel x ideal, ideal x ideal.
+int    CompensationCount=0;
+double CompensationIndex=0.0;
+double CompensationR2=0.0;
+
+// Wall (moved past via point) checks made by the forces function.
+#define WALL_CHECK_NONE     0
+#define WALL_CHECK_TOOFAR   1   // Moved too far?
+#define WALL_CHECK_BARRIER  2   // Moved too far, with wall barrier forces.
+#define WALL_CHECK_MAX      3
+
+// Force-field kernel (field type and wall check) called by the forces function.
+struct ROBOTFIELD;
+typedef void (*ROBOTFIELD_KERNEL)( const ROBOTFIELD *field, const VEC3 &X, const VEC3 &V, VEC3 &F );
+
+// Force-field as evaluated by the forces function. It is compiled for the trial
+// and when the force-field starts, so the rotation matrices are only calculated
+// when the field changes rather than on every tick. It is only compiled by the
+// forces function (the graphics thread asks for it with RobotFieldRequest() and
+// ForceFieldRequest()), into the object not in use, and handed over with a
+// release store so a tick never sees a part-built field.
+struct ROBOTFIELD
+{
+    int     Type;
+    ROBOTFIELD_KERNEL Kernel[2];    // Kernel before and after ForceFieldStart().
+    double  Constants[FIELD_CONSTANTS];
+    MAT3    Matrix;                 // Viscous field rotation (FieldAngle).
+    VEC3    Position;               // Force-field origin (ForceFieldPosition).
+    MAT3    R;                      // Rotation into home angle frame...
+    MAT3    _R;                     // ...and back again.
+    int     WallCheck;              // WALL_CHECK_...
+    double  WallDistance;
+    VEC3    ViaPosition;
+    VEC3    ChannelAxis;            // Perpendicular to the channel (row 1 of R).
+    VEC3    IdealAxis;              // Ideal viscous force along ChannelAxis (per unit velocity).
+};
+
+ROBOTFIELD  RobotFieldList[2];
+std::atomic<ROBOTFIELD *> RobotField(&RobotFieldList[0]);
+
+std::atomic<bool> RobotFieldCompileFlag(false);
+std::atomic<bool> ForceFieldStartFlag(false);
 
 TIMER   ExperimentTimer("Experiment");
 double  ExperimentTime;
@@ -368,17 +534,43 @@ TIMER_Frequency EyeTrackerFrameFrequency("EyeTrackerFrameFrequency");
 #define STATE_EYETRACKER  17 // Eye tracker calibration state. (2)
 #define STATE_MAX         18
 
-int   State=STATE_INITIALIZE;
+std::atomic<int> State(STATE_INITIALIZE);   // Set by both threads.
+int   StateFrame;                   // State saved to FrameData for the tick.
 int   StateLast;
 BOOL  StateFirstFlag=FALSE;
 int   StateGraphics=STATE_INITIALIZE;
 int   StateGraphicsLast;
 char *StateText[] = { "Initialize","Setup","Home","Start","Delay","Go","MoveWait","Moving0","Moving1","Feedback","Finish","Next","InterTrial","Exit","TimeOut","Error","Rest","EyeTracker" };
 BOOL  StateLoopTask[STATE_MAX] = { FALSE,FALSE,FALSE,FALSE,FALSE,FALSE,TRUE,TRUE,TRUE,FALSE,FALSE,FALSE,FALSE,FALSE,FALSE,FALSE,FALSE,FALSE };
+
+// Loop timing histograms for each state (current trial and since last rest break).
+LOOPHIST_STATES LoopHistTrial(STATE_MAX,StateText);
+LOOPHIST_STATES LoopHistSession(STATE_MAX,StateText);
 TIMER StateTimer("State");
 TIMER StateGraphicsTimer("StateGraphics");
 int   StateErrorResume;
 
+// Robot state published by the forces function once per tick. The graphics
+// thread takes a copy at the start of each GraphicsIdle() so that positions and
+// state are from the same tick. The RobotHome(), RobotNotMoving(), etc. checks
+// are given the copy of the thread that calls them (LoopRobot for the forces
+// function, GraphicsRobot for StateProcess()).
+struct ROBOTSNAPSHOT
+{
+    double TrialTime;
+    int    State;
+    VEC3   RobotPosition;
+    VEC3   RobotVelocity;
+    double RobotSpeed;
+    VEC3   CursorPosition;          // As drawn (CursorPredicted).
+    VEC3   RobotForces;
+    BOOL   ForceFieldStarted;
+};
+
+SNAPSHOT<ROBOTSNAPSHOT> RobotSnapshot;
+ROBOTSNAPSHOT GraphicsRobot;
+ROBOTSNAPSHOT LoopRobot;
+
 /******************************************************************************/
 
 void ProgramExit( void );
@@ -395,84 +587,162 @@ void WaveListPlay( char *name )
 
 /******************************************************************************/
 
+// Configuration variables are also added to the cache.
+
+template<class TYPE> void ConfigSet( char *name, TYPE &variable )
+{
+    CONFIG_set(name,variable);
+    ConfigCache.Add(variable);
+}
+
+/******************************************************************************/
+
+template<class TYPE> void ConfigSet( char *name, TYPE *variable, int count )
+{
+    CONFIG_set(name,variable,count);
+    ConfigCache.Add(variable,count);
+}
+
+/******************************************************************************/
+
+void ConfigSetBOOL( char *name, BOOL &variable )
+{
+    CONFIG_setBOOL(name,variable);
+    ConfigCache.Add(variable);
+}
+
+/******************************************************************************/
+
+void ConfigLabel( char *name, int &variable )
+{
+    CONFIG_label(name,variable);
+    ConfigCache.Add(variable);
+}
+
+/******************************************************************************/
+
+void ConfigLabel( char *name, int *variable, int count )
+{
+    CONFIG_label(name,variable,count);
+    ConfigCache.Add(variable,count);
+}
+
+/******************************************************************************/
+
 void ConfigSetup( void )
 {
 int i;
 
     // Reset configuration variable list.
     CONFIG_reset();
+    ConfigCache.Reset();
 
     // Set up variable list for configuration.
-    CONFIG_set(VAR(RobotName));
-    CONFIG_setBOOL(VAR(RobotFT));
-    CONFIG_set(VAR(ForceMax));
-    CONFIG_set("GraphicsSyncTime",GraphicsVerticalRetraceSyncTime);
-    CONFIG_set("GraphicsCatchTime",GraphicsVerticalRetraceCatchTime);
-    CONFIG_set(VAR(EyeTrackerConfig)); // Eye tracker configuration file. (3)
-    CONFIG_setBOOL(VAR(FixateRequiredFlag));
-    CONFIG_set(VAR(TextPosition));
-    CONFIG_set("CursorColor",CursorColorText);
-    CONFIG_set(VAR(CursorRadius));
-    CONFIG_set(VAR(TargetDistance));
-    CONFIG_set("TargetColor",TargetColorText);
-    CONFIG_set(VAR(TargetRadius));
-    CONFIG_set(VAR(TargetWidth));
-    CONFIG_set(VAR(ViaRadius));
-    CONFIG_set(VAR(ViaPosition));
-    CONFIG_set(VAR(WallDistance));
-    CONFIG_set(VAR(HomeRadius));
-    CONFIG_set(VAR(HomeWidth));
-    CONFIG_set(VAR(HomeTolerance));
-    CONFIG_set(VAR(HomeToleranceTime));
-    CONFIG_set(VAR(ViaTolerance));
-    CONFIG_set(VAR(ViaToleranceTime));
-    CONFIG_set(VAR(ViaTimeOutTime));
-    CONFIG_set(VAR(ViaSpeedThreshold));
-    CONFIG_set(VAR(FollowSpeedQuickTarget));
-    CONFIG_set(VAR(FollowSpeedSlowTarget));
-    CONFIG_set(VAR(FollowSpeedTolerance));
-    CONFIG_set(VAR(PostMoveDelayInit));
-
-    CONFIG_set("MovementType",MovementTypeString);
-    CONFIG_set(VAR(MovementReactionTimeOut));
-    CONFIG_set(VAR(MovementDurationTimeOut));
-    CONFIG_set(VAR(MovementDurationTooFast));
-    CONFIG_set(VAR(MovementDurationTooSlow)); 
-    CONFIG_set(VAR(MovementDurationTooFastToVia)); 
-    CONFIG_set(VAR(MovementDurationTooSlowToVia)); 
-    CONFIG_set(VAR(ErrorWait));
-    CONFIG_set(VAR(TrialDelay));
-    CONFIG_set(VAR(InterTrialDelay));
-    CONFIG_set(VAR(FeedbackTime));
-    CONFIG_set(VAR(NotMovingSpeed));
-    CONFIG_set(VAR(NotMovingTime));
-    CONFIG_set(VAR(ForceFieldRampTime));
-    CONFIG_set(VAR(TargetSpeedVia));
-    CONFIG_set(VAR(TargetSpeedTarget));
-    CONFIG_set(VAR(TargetSpeedTolerance));
-
-    CONFIG_setBOOL(VAR(RestBreakHere));
-    CONFIG_set(VAR(RestBreakTrials),RESTBREAK_MAX);
-    CONFIG_set(VAR(RestBreakSeconds));
-
-    CONFIG_set(VAR(Trials));	
+    ConfigSet(VAR(RobotName));
+    ConfigSetBOOL(VAR(RobotFT));
+
+#ifdef ROBOT_SIMULATE
+    // Simulated robot and subject (see common/robotsim.h).
+    ConfigSet("SimulateFrequency",ROBOTSIM_Parameters.Frequency);
+    ConfigSet("SimulatePriority",ROBOTSIM_Parameters.Priority);
+    ConfigSet("SimulateMass",ROBOTSIM_Parameters.Mass);
+    ConfigSet("SimulateDamping",ROBOTSIM_Parameters.Damping);
+    ConfigSet("SimulateSubjectStiffness",ROBOTSIM_Parameters.SubjectStiffness);
+    ConfigSet("SimulateSubjectDamping",ROBOTSIM_Parameters.SubjectDamping);
+    ConfigSet("SimulateSubjectNoise",ROBOTSIM_Parameters.SubjectNoise);
+    ConfigSet("SimulateSubjectMoveTime",ROBOTSIM_Parameters.SubjectMoveTime);
+    ConfigSet("SimulateSubjectReactionTime",ROBOTSIM_Parameters.SubjectReactionTime);
+    ConfigSet("SimulateSeed",ROBOTSIM_Parameters.Seed);
+#endif
+    ConfigSetBOOL(VAR(ColumnCompress));
+    ConfigSet(VAR(ForceMax));
+    ConfigSet("GraphicsSyncTime",GraphicsVerticalRetraceSyncTime);
+    ConfigSet("GraphicsCatchTime",GraphicsVerticalRetraceCatchTime);
+    ConfigSet(VAR(GraphicsIdlePeriod));
+    ConfigSet(VAR(GraphicsIdleSpinTime));
+    ConfigSetBOOL(VAR(GraphicsSceneListFlag));
+    ConfigSet(VAR(EyeTrackerConfig)); // Eye tracker configuration file. (3)
+    ConfigSetBOOL(VAR(FixateRequiredFlag));
+    ConfigSet(VAR(TextPosition));
+    ConfigSet("CursorColor",CursorColorText);
+    ConfigSet(VAR(CursorRadius));
+    ConfigSetBOOL(VAR(CursorPredictFlag));
+    ConfigSet(VAR(CursorPredictTime));
+    ConfigSetBOOL(VAR(CursorPredictAcceleration));
+    ConfigSet(VAR(CursorAccelerationTime));
+    ConfigSet(VAR(TargetDistance));
+    ConfigSet("TargetColor",TargetColorText);
+    ConfigSet(VAR(TargetRadius));
+    ConfigSet(VAR(TargetWidth));
+    ConfigSet(VAR(ViaRadius));
+    ConfigSet(VAR(ViaPosition));
+    ConfigSet(VAR(WallDistance));
+    ConfigSet(VAR(HomeRadius));
+    ConfigSet(VAR(HomeWidth));
+    ConfigSet(VAR(HomeTolerance));
+    ConfigSet(VAR(HomeToleranceTime));
+    ConfigSet(VAR(ViaTolerance));
+    ConfigSet(VAR(ViaToleranceTime));
+    ConfigSet(VAR(ViaTimeOutTime));
+    ConfigSet(VAR(ViaSpeedThreshold));
+    ConfigSet(VAR(FollowSpeedQuickTarget));
+    ConfigSet(VAR(FollowSpeedSlowTarget));
+    ConfigSet(VAR(FollowSpeedTolerance));
+    ConfigSet(VAR(PostMoveDelayInit));
+
+    ConfigSet("MovementType",MovementTypeString);
+    ConfigSet(VAR(MovementReactionTimeOut));
+    ConfigSet(VAR(MovementDurationTimeOut));
+    ConfigSet(VAR(MovementDurationTooFast));
+    ConfigSet(VAR(MovementDurationTooSlow)); 
+    ConfigSet(VAR(MovementDurationTooFastToVia)); 
+    ConfigSet(VAR(MovementDurationTooSlowToVia)); 
+    ConfigSet(VAR(ErrorWait));
+    ConfigSet(VAR(TrialDelay));
+    ConfigSet(VAR(InterTrialDelay));
+    ConfigSet(VAR(FeedbackTime));
+    ConfigSet(VAR(NotMovingSpeed));
+    ConfigSet(VAR(NotMovingTime));
+    ConfigSet(VAR(ForceFieldRampTime));
+    ConfigSet(VAR(TargetSpeedVia));
+    ConfigSet(VAR(TargetSpeedTarget));
+    ConfigSet(VAR(TargetSpeedTolerance));
+
+    ConfigSetBOOL(VAR(RestBreakHere));
+    ConfigSet(VAR(RestBreakTrials),RESTBREAK_MAX);
+    ConfigSet(VAR(RestBreakSeconds));
+
+    ConfigSet(VAR(Trials));	
 
     for( i=0; (i < FIELD_INDEX); i++ )
     {
-        CONFIG_label(STR_stringf("FieldType%d",i),FieldIndexType[i]);
-        CONFIG_set("FieldConstants",FieldIndexConstants[i],FIELD_CONSTANTS);
-        CONFIG_set("FieldAngle",FieldIndexAngle[i]);
-        CONFIG_set("FieldContextType",FieldIndexContextType[i]);
-        CONFIG_set("FieldContextConstants",FieldIndexContextConstants[i],FIELD_CONSTANTS);
-        CONFIG_set("HomePosition",FieldHomePosition[i]);
+        ConfigLabel(STR_stringf("FieldType%d",i),FieldIndexType[i]);
+        ConfigSet("FieldConstants",FieldIndexConstants[i],FIELD_CONSTANTS);
+        ConfigSet("FieldAngle",FieldIndexAngle[i]);
+        ConfigSet("FieldContextType",FieldIndexContextType[i]);
+        ConfigSet("FieldContextConstants",FieldIndexContextConstants[i],FIELD_CONSTANTS);
+        ConfigSet("HomePosition",FieldHomePosition[i]);
     }
 
     for( i=0; (i < PHASE_MAX); i++ )
     {
-        CONFIG_label(STR_stringf("PhaseTrials%d",i),PhaseTrialRange[i],2);
-        CONFIG_set("FieldIndex",PhaseFieldIndex[i],FIELD_INDEX);
-        CONFIG_setBOOL("FieldPermute",PhaseFieldPermute[i]);
+        ConfigLabel(STR_stringf("PhaseTrials%d",i),PhaseTrialRange[i],2);
+        ConfigSet("FieldIndex",PhaseFieldIndex[i],FIELD_INDEX);
+        ConfigSetBOOL("FieldPermute",PhaseFieldPermute[i]);
     }
+
+    // Worked out from the configuration (or when the trial list is made).
+    ConfigCache.Add(CursorColor);
+    ConfigCache.Add(TargetColor);
+    ConfigCache.Add(MovementType);
+    ConfigCache.Add(EyeTrackerFlag);
+    ConfigCache.Add(PhaseCount);
+    ConfigCache.Add(PhaseFieldIndexCount,PHASE_MAX);
+    ConfigCache.Add(RestBreakCount);
+    ConfigCache.Add(TotalTrials);
+    ConfigCache.Add(PhaseIndex);
+    ConfigCache.Add(FieldTrials,FIELD_MAX);
+    ConfigCache.Add(FieldIndexTrialCount,FIELD_INDEX);
 }
 
 /******************************************************************************/
@@ -616,7 +886,7 @@ void GraphicsDisplayText( char *string, float size, matrix &pos )
 {
 static matrix p;
 void *font=GLUT_STROKE_MONO_ROMAN;
-int i,w;
+int w;
 //float s=size*0.015;
 float s=size*0.01;
 
@@ -634,8 +904,7 @@ float s=size*0.01;
 
     GRAPHICS_ColorSet(WHITE);
 
-    for( i=0; (i < w); i++ )
-        glutStrokeCharacter(font,string[i]);
+    GLCACHE_String(font,string);
 
     glPopMatrix();
 }
@@ -676,8 +945,73 @@ void FrameProcess( void )
     // Load GRAPHICS-related frame data variables.
     GRAPHICS_FrameData();
 
-    // Save current variables for FrameData.
-    FrameData.RowSave();
+    // Save current variables (FrameData is filled from them by TrialWrite).
+    FrameGraphics.RowSave();
+    FrameColumns.RowSave();
+
+    // Save slowly-changing variables that are due.
+    FrameStreams.RowSave(TrialTime);
+}
+
+/******************************************************************************/
+
+// Worst-case duration (sec) of frame recording, from TrialStart() to
+// TrialStop(), given the timeouts and delays for the current trial.
+
+double FrameDataTrialDuration( void )
+{
+double movement,duration;
+
+    // Movement (or passive movement).
+    movement = MovementDurationTimeOut;
+
+    if( (PMoveMovementTime+PMoveHoldTime+PMoveRampTime) > movement )
+    {
+        movement = PMoveMovementTime+PMoveHoldTime+PMoveRampTime;
+    }
+
+    // Delay period, reaction time, movement and feedback.
+    duration = TrialDelay + MovementReactionTimeOut + movement + FeedbackTime;
+    duration += HomeToleranceTime + ViaToleranceTime;
+
+    return(duration + FRAMEDATA_MARGIN);
+}
+
+/******************************************************************************/
+
+// Make sure FrameData has enough rows for the worst-case duration of the next
+// trial. Rows are only ever added (in chunks) between trials, so no memory is
+// allocated while frame data is being recorded.
+
+void FrameDataSize( void )
+{
+int rows;
+
+    if( LoopTaskFrequency <= 0.0 )
+    {
+        return;
+    }
+
+    rows = (int)ceil(FrameDataTrialDuration() * LoopTaskFrequency);
+    rows = FRAMEDATA_CHUNK * (((rows + FRAMEDATA_CHUNK - 1) / FRAMEDATA_CHUNK) + FrameDataExtraChunks);
+
+    if( rows < FRAMEDATA_ROWS )
+    {
+        rows = FRAMEDATA_ROWS;
+    }
+
+    FrameStreams.SetDuration((double)rows/LoopTaskFrequency,LoopTaskFrequency);
+
+    if( rows <= FrameDataRows )
+    {
+        return;
+    }
+
+    FrameData.SetRows(rows);
+    FrameGraphics.SetRows(rows);
+    FrameColumns.SetRows(rows);
+    printf("FrameData: %d rows (%.1lf seconds at %.0lf Hz).\n",rows,(double)rows/LoopTaskFrequency,LoopTaskFrequency);
+    FrameDataRows = rows;
 }
 
 /******************************************************************************/
@@ -685,7 +1019,9 @@ void FrameProcess( void )
 void FrameStart( void )
 {
     // Start recording frame data.
-    FrameData.Reset();
+    FrameGraphics.Reset();
+    FrameColumns.Reset();
+    FrameStreams.Reset();
     FrameRecord = TRUE;
 }
 
@@ -699,6 +1035,29 @@ void FrameStop( void )
 
 /******************************************************************************/
 
+// Fill FrameData (for DATAFILE) from the rows recorded in FrameColumns, so
+// the forces function only saves each row once. A row is stored into the
+// copies of the frame variables and the GRAPHICS variables are loaded for it
+// from FrameGraphics. The GRAPHICS variables belong to the MOTOR library, so
+// this is done by TrialSave() on the graphics thread after FrameStop(), not
+// by the trial writer thread, which only reads FrameData.
+
+void FrameDataFill( void )
+{
+int row;
+
+    FrameData.Reset();
+
+    for( row=0; (row < FrameColumns.GetRow()); row++ )
+    {
+        FrameShadow.RowStore(FrameColumns,row);
+        FrameGraphics.RowLoad(row+1);
+        FrameData.RowSave();
+    }
+}
+
+/******************************************************************************/
+
 BOOL RestBreakNow( void )
 {
 BOOL flag=FALSE;
@@ -712,6 +1071,13 @@ BOOL flag=FALSE;
         RestBreakMinutesPerTrial = ExperimentTimer.ElapsedMinutes() / (double)Trial;
         RestBreakMinutesRemaining = RestBreakMinutesPerTrial * (double)(TotalTrials-Trial);
         printf("RestBreak=%d/%d, Time=%.0lf(sec), Trial=%d/%d (%.0lf%% done, %.1f minutes remaining)\n",RestBreakIndex,RestBreakCount,RestBreakSeconds,Trial,TotalTrials,RestBreakTrialsPercent,RestBreakMinutesRemaining);
+
+        // Make sure trials so far are on disk.
+        TRIALWRITER_Flush();
+
+        // Loop timing (usec) for each state since the last rest break.
+        LoopHistSession.Print(stdout);
+        LoopHistSession.Reset();
     }
 
     return(flag);
@@ -723,7 +1089,7 @@ void StateProcessLoopTask( void );
 
 /******************************************************************************/
 
-void RobotPMoveUpdate( matrix &F )
+void RobotPMoveUpdate( VEC3 &F )
 {
     PMovePosition(1,1) = RobotPosition(1,1);
     PMovePosition(2,1) = RobotPosition(2,1);
@@ -737,9 +1103,9 @@ void RobotPMoveUpdate( matrix &F )
 
     if( RobotPMove.Update(PMovePosition,PMoveVelocity,PMoveForces) )
     {
-        F(1,1) = PMoveForces(1,1);
-        F(2,1) = PMoveForces(2,1);
-        F(3,1) = 0.0;
+        F(1) = PMoveForces(1,1);
+        F(2) = PMoveForces(2,1);
+        F(3) = 0.0;
     }
 
     RobotPMove.CurrentState(PMoveState,PMoveStateTime,PMoveStateRampValue,PMoveStatePosition);
@@ -760,7 +1126,7 @@ BOOL ok;
     PMoveEndPosition(3,1) = 0.0;
 
 	ok = RobotPMove.Start(PMoveStartPosition,PMoveEndPosition);
-    printf("RobotPMove.Start(...) %s.\n",STR_OkFailed(ok));
+    LOOPLOG_printf("RobotPMove.Start(...) %s.\n",STR_OkFailed(ok));
 }
 
 /******************************************************************************/
@@ -799,9 +1165,188 @@ matrix SC(3,1),PT(3,1),VT(3,1);
 
 /******************************************************************************/
 
+// Force-field policies, one for each field type. Forces() sets the force-field
+// forces (F is zero on entry) for the current position and velocity.
+
+template<int TYPE> struct FIELD_POLICY
+{
+    static inline void Forces( const ROBOTFIELD *field, const VEC3 &X, const VEC3 &V, VEC3 &F )
+    {
+    }
+};
+
+template<> struct FIELD_POLICY<FIELD_VISCOUS>
+{
+    static inline void Forces( const ROBOTFIELD *field, const VEC3 &X, const VEC3 &V, VEC3 &F )
+    {
+        F = field->Constants[0] * (field->Matrix * V);
+    }
+};
+
+template<> struct FIELD_POLICY<FIELD_CHANNEL>
+{
+    static inline void Forces( const ROBOTFIELD *field, const VEC3 &X, const VEC3 &V, VEC3 &F )
+    {
+    VEC3 P,V1;
+
+        // Next rotate position along the channel between the home position and the via point.
+        P = field->R * (X - field->Position);
+        V1 = field->R * V;
+
+        // Calculate perpendicular (X) channel forces.
+        F(1) = (field->Constants[0] * P(1)) + (field->Constants[1] * V1(1));
+
+        // Rotate back to original.
+        F = field->_R * F;
+    }
+};
+
+template<> struct FIELD_POLICY<FIELD_PMOVE>
+{
+    static inline void Forces( const ROBOTFIELD *field, const VEC3 &X, const VEC3 &V, VEC3 &F )
+    {
+        RobotPMoveUpdate(F);
+    }
+};
+
+/******************************************************************************/
+
+// Wall policies (moved past the via point along the home angle).
+
+template<int CHECK> struct WALL_POLICY
+{
+    static inline void Check( const ROBOTFIELD *field, const VEC3 &X, const VEC3 &V )
+    {
+    }
+};
+
+template<> struct WALL_POLICY<WALL_CHECK_TOOFAR>
+{
+    static inline void Check( const ROBOTFIELD *field, const VEC3 &X, const VEC3 &V )
+    {
+    VEC3 P1;
+
+        P1 = field->R * (X - field->ViaPosition);
+
+        if( P1(2) >= field->WallDistance )
+        {
+            MovedTooFar = TRUE;
+        }
+    }
+};
+
+template<> struct WALL_POLICY<WALL_CHECK_BARRIER>
+{
+    static inline void Check( const ROBOTFIELD *field, const VEC3 &X, const VEC3 &V )
+    {
+    VEC3 P1,V1;
+
+        WallForces.zeros();
+
+        P1 = field->R * (X - field->ViaPosition);
+        V1 = field->R * V;
+
+        if( P1(2) >= field->WallDistance )
+        {
+            WallForces(2) = SpringConstant * (P1(2) - field->WallDistance) + DampingConstant * V1(2);
+            WallForces = field->_R * WallForces;  // Rotate back to the original
+            MovedTooFar = TRUE;
+        }
+    }
+};
+
+/******************************************************************************/
+
+template<int TYPE,int CHECK> void RobotFieldKernel( const ROBOTFIELD *field, const VEC3 &X, const VEC3 &V, VEC3 &F )
+{
+    FIELD_POLICY<TYPE>::Forces(field,X,V,F);
+    WALL_POLICY<CHECK>::Check(field,X,V);
+}
+
+// Kernel for each field type and wall check. A new field type needs a
+// FIELD_POLICY specialization and a row here.
+ROBOTFIELD_KERNEL RobotFieldKernelTable[FIELD_MAX][WALL_CHECK_MAX] =
+{
+    { RobotFieldKernel<FIELD_NONE,WALL_CHECK_NONE>,    RobotFieldKernel<FIELD_NONE,WALL_CHECK_TOOFAR>,    RobotFieldKernel<FIELD_NONE,WALL_CHECK_BARRIER>    },
+    { RobotFieldKernel<FIELD_VISCOUS,WALL_CHECK_NONE>, RobotFieldKernel<FIELD_VISCOUS,WALL_CHECK_TOOFAR>, RobotFieldKernel<FIELD_VISCOUS,WALL_CHECK_BARRIER> },
+    { RobotFieldKernel<FIELD_CHANNEL,WALL_CHECK_NONE>, RobotFieldKernel<FIELD_CHANNEL,WALL_CHECK_TOOFAR>, RobotFieldKernel<FIELD_CHANNEL,WALL_CHECK_BARRIER> },
+    { RobotFieldKernel<FIELD_PMOVE,WALL_CHECK_NONE>,   RobotFieldKernel<FIELD_PMOVE,WALL_CHECK_TOOFAR>,   RobotFieldKernel<FIELD_PMOVE,WALL_CHECK_BARRIER>   },
+};
+
+/******************************************************************************/
+
+// Forces function only.
+
+void RobotFieldCompile( void )
+{
+ROBOTFIELD *field;
+MAT3 M;
+int i;
+
+    // Build the field in the object not currently used by the forces function.
+    field = (RobotField.load(std::memory_order_relaxed) == &RobotFieldList[0]) ? &RobotFieldList[1] : &RobotFieldList[0];
+
+    field->Type = RobotFieldType;
+
+    for( i=0; (i < FIELD_CONSTANTS); i++ )
+    {
+        field->Constants[i] = RobotFieldConstants[i];
+    }
+
+    MAT3_romxZ(D2R(RobotFieldAngle),field->Matrix);
+
+    field->Position = ForceFieldPosition;
+
+    // Channel and wall are both aligned with the home angle.
+    MAT3_romxZ(D2R(HomeAngle),field->R);
+    MAT3_romxZ(D2R(-HomeAngle),field->_R);
+
+    // Force-compensation index compares the channel force with this viscous field.
+    MAT3_romxZ(D2R(CompensationAngle),M);
+
+    for( i=1; (i <= 3); i++ )
+    {
+        field->ChannelAxis(i) = field->R(1,i);
+        field->IdealAxis(i) = CompensationViscosity * ((field->R(1,1) * M(1,i)) + (field->R(1,2) * M(2,i)) + (field->R(1,3) * M(3,i)));
+    }
+
+    // Wall barrier forces are on if ContextConstants[3] is set (HRS: no longer in use).
+    field->WallCheck = WALL_CHECK_NONE;
+
+    if( FieldType != FIELD_PMOVE )
+    {
+        field->WallCheck = (ContextConstants[3] != 0.0) ? WALL_CHECK_BARRIER : WALL_CHECK_TOOFAR;
+    }
+
+    field->WallDistance = WallDistance;
+    field->ViaPosition = VEC3_get(ViaPosition);
+
+    // Select kernels for field type and wall check (no field until ForceFieldStart).
+    field->Kernel[FALSE] = RobotFieldKernelTable[FIELD_NONE][field->WallCheck];
+    field->Kernel[TRUE] = RobotFieldKernelTable[field->Type][field->WallCheck];
+
+    // Hand the new field to the forces function.
+    RobotField.store(field,std::memory_order_release);
+}
+
+/******************************************************************************/
+
+// Compile the force-field at the next tick (graphics thread, after the
+// variables it is compiled from have been set).
+
+void RobotFieldRequest( void )
+{
+    RobotFieldCompileFlag.store(true,std::memory_order_release);
+}
+
+/******************************************************************************/
+
+// Forces function only (it reads the robot position and compiles the field).
+
 void ForceFieldStart( void )
 {
-    ForceFieldPosition = RobotPosition;
+    ForceFieldPosition = VEC3_get(RobotPosition);
+    RobotFieldCompile();
     ForceFieldStarted = TRUE;
     ForceFieldRamp.Up();
 	
@@ -812,11 +1357,22 @@ void ForceFieldStart( void )
     }
 }
 
+/******************************************************************************/
+
+// Start the force-field at the next tick (graphics thread).
+
+void ForceFieldRequest( void )
+{
+    ForceFieldStartFlag.store(true,std::memory_order_release);
+}
 
 /******************************************************************************/
 
 void ForceFieldStop( void )
 {
+    // Cancel a start the forces function hasn't made yet.
+    ForceFieldStartFlag.store(false,std::memory_order_relaxed);
+
 	if( ForceFieldStarted )
 	{
 		ForceFieldRamp.Down();
@@ -842,14 +1398,67 @@ void WallStop( void )
 
 /******************************************************************************/
 
+// Cursor position when the frame being drawn is on the screen. The frame is
+// drawn GraphicsVerticalRetraceSyncTime before the retrace and is on the
+// screen CursorPredictTime after that. Acceleration is estimated from the
+// change in velocity each tick (dt, in seconds) and low-pass filtered.
+
+inline VEC3 CursorPredict( const VEC3 &X, const VEC3 &V, double dt )
+{
+double alpha,lead;
+VEC3 P;
+
+    // Not after a pause in the loop.
+    if( (dt > 0.0) && (dt < 0.1) )
+    {
+        alpha = dt / (CursorAccelerationTime + dt);
+        CursorAcceleration += alpha * (((1.0/dt) * (V - CursorVelocityLast)) - CursorAcceleration);
+    }
+
+    CursorVelocityLast = V;
+
+    if( !CursorPredictFlag )
+    {
+        return(X);
+    }
+
+    lead = GraphicsVerticalRetraceSyncTime + CursorPredictTime;
+    P = X + (lead * V);
+
+    if( CursorPredictAcceleration )
+    {
+        P += (0.5 * lead * lead) * CursorAcceleration;
+    }
+
+    return(P);
+}
+
+/******************************************************************************/
+
+// Add a tick to the force-compensation sums.
+
+inline void CompensationAdd( const ROBOTFIELD *field, const VEC3 &V, const VEC3 &F )
+{
+double channel,ideal;
+
+    channel = dot(field->ChannelAxis,F);
+    ideal = dot(field->IdealAxis,V);
+
+    CompensationSum[0] += channel * channel;
+    CompensationSum[1] += channel * ideal;
+    CompensationSum[2] += ideal * ideal;
+    CompensationCount++;
+}
+
+/******************************************************************************/
+
 void RobotForcesFunction( matrix &position, matrix &velocity, matrix &forces )
 {
-int i,j;
-static matrix P,V,R,_R;
-static matrix P1,V1,R1,_R1;
-static double HomeDistance, WallYPosition;
+static VEC3 X,V,F,P;
 static BOOL ok;
-BOOL BarrierOn=FALSE;
+ROBOTFIELD *field;
+ROBOTSNAPSHOT *snapshot;
+int state=State;
 
     // Monitor timing of Forces Function (values saved to FrameData).
     ForcesFunctionPeriod = RobotForcesFunctionFrequency.Loop();
@@ -857,16 +1466,22 @@ BOOL BarrierOn=FALSE;
 
     TrialTime = TrialTimer.ElapsedSeconds();
 
-    // Kinematic data passed from robot API.
-    RobotPosition = position;
-    RobotVelocity = velocity;
-    RobotSpeed = norm(RobotVelocity);
+    // Kinematic data passed from robot API (fixed-size types avoid heap allocation).
+    X = VEC3_get(position);
+    V = VEC3_get(velocity);
+    RobotSpeed = norm(V);
+
+    VEC3_put(RobotPosition,X);
+    VEC3_put(RobotVelocity,V);
+
+    LoopRobot.RobotPosition = X;
+    LoopRobot.RobotVelocity = V;
+    LoopRobot.RobotSpeed = RobotSpeed;
 
     RobotActiveFlag = ROBOT_Activated(RobotID);
 
     // Zero forces.
     ForceFieldForces.zeros();
-    RobotForces.zeros();
 
     // Read raw sensor values from Sensoray card.
     ROBOT_SensorRead(RobotID);
@@ -877,96 +1492,28 @@ BOOL BarrierOn=FALSE;
         ROBOT_Sensor_DAQFT(RobotID,HandleForces,HandleTorques);
     }
 
-    P = RobotPosition;
-    CursorPosition = RobotPosition;
-
-    // Process force-field type.
-    switch( ForceFieldStarted ? RobotFieldType : FIELD_NONE )
-    {
-        case FIELD_NONE :
-           break;
-
-        case FIELD_VISCOUS :   // Viscous force field.
-
-           ForceFieldForces = RobotFieldConstants[0] * RobotFieldMatrix * RobotVelocity;
-           break;
+    VEC3_put(CursorPosition,X);
 
-        case FIELD_CHANNEL :
-           // Next rotate position along the channel between the home position and the via point.
-
-           SPMX_romxZ(D2R(HomeAngle),R);
-           SPMX_romxZ(D2R(-HomeAngle),_R);
-
-           P = R * (RobotPosition - ForceFieldPosition);
-           V = R * RobotVelocity;
-
-           // Calculate perpendicular (X) channel forces.
-           ForceFieldForces(1,1) = (RobotFieldConstants[0] * P(1,1)) + (RobotFieldConstants[1] * V(1,1));
-
-           // Rotate back to original.
-           ForceFieldForces = _R * ForceFieldForces;
-           break;
-
-        case FIELD_PMOVE :
-           RobotPMoveUpdate(ForceFieldForces);
-           break;
+    // Cursor drawn where the hand is expected to be (saved with the true position).
+    P = CursorPredict(X,V,ForcesFunctionPeriod/1000.0);
+    VEC3_put(CursorPredicted,P);
 
+    // Force-field compiled or started when asked by the graphics thread.
+    if( RobotFieldCompileFlag.exchange(false,std::memory_order_acquire) )
+    {
+        RobotFieldCompile();
     }
 
-	if (FieldType != FIELD_PMOVE)
-	{
-       // HRS: Wall barrier no longer in use.
-	  // Process wall barrier
-		/*
-		BarrierOn = ContextConstants[3];
-		
-		SPMX_romxZ(D2R(HomeAngle),R1);
-		SPMX_romxZ(D2R(-HomeAngle),_R1);
-           	P1 = R1 * (RobotPosition - ViaPosition);
-	
-		if( P1(2,1) >= WallDistance )
-		{
-			MovedTooFar=TRUE;
-		}
-		
-	   */
-	
-	    BarrierOn = ContextConstants[3];
-		if (BarrierOn)
-		{	
-			WallForces.zeros();
-						
-			SPMX_romxZ(D2R(HomeAngle),R1);
-			SPMX_romxZ(D2R(-HomeAngle),_R1);
-            P1 = R1 * (RobotPosition - ViaPosition);
-			V1 = R1 * RobotVelocity;	
-			// HRS: Wall barrier no longer in use.
-            //HomeDistance 	= sqrt( pow(HomePosition(1,1),2) + pow(HomePosition(2,1),2) );
-			//WallYPosition   = WallDistance - HomeDistance;
-			
+    if( ForceFieldStartFlag.exchange(false,std::memory_order_acquire) )
+    {
+        ForceFieldStart();
+    }
 
-			if( P1(2,1) >= WallDistance )
-			{
-				WallForces(2,1) = SpringConstant * (P1(2,1) - WallDistance) + DampingConstant * V1(2,1);
-				WallForces = _R1 * WallForces;  // Rotate back to the original
-				MovedTooFar=TRUE;
-							
-			}
-		}
-		else
-		{
-			SPMX_romxZ(D2R(HomeAngle),R1);
-			SPMX_romxZ(D2R(-HomeAngle),_R1);
-           	P1 = R1 * (RobotPosition - ViaPosition);
-		
-			if( P1(2,1) >= WallDistance )
-			{
-				MovedTooFar=TRUE;
-			}
-		}
-	
-	}
+    // Force-field compiled for this trial.
+    field = RobotField.load(std::memory_order_acquire);
 
+    // Force-field forces and wall checks.
+    (*field->Kernel[ForceFieldStarted ? TRUE : FALSE])(field,X,V,ForceFieldForces);
 
     // Process Finite State Machine.
     StateProcessLoopTask();
@@ -974,7 +1521,20 @@ BOOL BarrierOn=FALSE;
     // Monitor timing of Forces Function (values saved to FrameData).
     ForcesFunctionLatency = RobotForcesFunctionLatency.After();
 
-	RobotForces = (ForceFieldRamp.RampCurrent() * ForceFieldForces) + WallForces;
+    // Timing histograms for loop task states (msec to usec).
+    if( StateLoopTask[state] )
+    {
+        LoopHistTrial.Add(state,ForcesFunctionLatency*1000.0,ForcesFunctionPeriod*1000.0);
+    }
+
+	F = (ForceFieldRamp.RampCurrent() * ForceFieldForces) + WallForces;
+	VEC3_put(RobotForces,F);
+
+    // Force-compensation sums (channel trials, during the movement, without the wall).
+    if( (field->Type == FIELD_CHANNEL) && ForceFieldStarted && (state >= STATE_MOVING0) && (state <= STATE_MOVING1) )
+    {
+        CompensationAdd(field,V,ForceFieldRamp.RampCurrent() * ForceFieldForces);
+    }
 	//RobotForces = (ForceFieldRamp.RampCurrent() * ForceFieldForces) + (WallRamp.RampCurrent() * WallForces); // HRS: Wall barrier no longer in use.
 
     // Get next frame of eye tracker data. (5)
@@ -993,11 +1553,24 @@ BOOL BarrierOn=FALSE;
     }
 
     // Save frame data.
+    StateFrame = State;
     FrameProcess();
 
+    // Publish robot state for the graphics thread (never blocks).
+    snapshot = &RobotSnapshot.Write();
+    snapshot->TrialTime = TrialTime;
+    snapshot->State = State;
+    snapshot->RobotPosition = X;
+    snapshot->RobotVelocity = V;
+    snapshot->RobotSpeed = RobotSpeed;
+    snapshot->CursorPosition = P;
+    snapshot->RobotForces = F;
+    snapshot->ForceFieldStarted = ForceFieldStarted;
+    RobotSnapshot.Publish();
+
     // Set forces to pass to robot API and clamp for safety.
-    forces = RobotForces;
-    forces.clampnorm(ForceMax);
+    F.clampnorm(ForceMax);
+    VEC3_put(forces,F);
 }
 
 /******************************************************************************/
@@ -1027,10 +1600,61 @@ void DeviceStop( void )
 
 /******************************************************************************/
 
+#ifdef ROBOT_SIMULATE
+void RobotSimulateSubject( void )
+{
+static int last=STATE_INITIALIZE;
+
+    // Called by the simulator each tick; the subject moves when the state changes.
+    if( State == last )
+    {
+        return;
+    }
+
+    last = State;
+
+    switch( State )
+    {
+        case STATE_SETUP :
+            // Passive trials move the arm, otherwise return to the start position.
+            if( FieldType == FIELD_PMOVE )
+            {
+                ROBOTSIM_SubjectRelax();
+                break;
+            }
+
+            ROBOTSIM_SubjectMove(StartPosition(1,1),StartPosition(2,1));
+            break;
+
+        case STATE_GO :
+            // Move through the via point after a reaction time.
+            if( FieldType == FIELD_PMOVE )
+            {
+                break;
+            }
+
+            ROBOTSIM_SubjectMove(ViaPosition(1,1),ViaPosition(2,1));
+            break;
+
+        case STATE_MOVING1 :
+            // Follow through to the target.
+            ROBOTSIM_SubjectMove(TargetPosition(1,1),TargetPosition(2,1),0.0,ROBOTSIM_Parameters.SubjectMoveTime);
+            break;
+    }
+}
+#endif
+
+/******************************************************************************/
+
 BOOL DeviceStart( void )
 {
 BOOL ok=TRUE;
 
+#ifdef ROBOT_SIMULATE
+    // Simulated subject follows the state machine.
+    ROBOTSIM_SubjectHook(RobotSimulateSubject);
+#endif
+
     // Open and start robot.
     if( (RobotID=ROBOT_Open(RobotName)) == ROBOT_INVALID )
     {
@@ -1132,22 +1756,22 @@ BOOL flag=FALSE;
 
 /******************************************************************************/
 
-double RobotDistance( matrix &home )
+double RobotDistance( const ROBOTSNAPSHOT &robot, matrix &home )
 {
 double distance;
 
-    distance = norm(RobotPosition-home);
+    distance = norm(robot.RobotPosition - VEC3_get(home));
 
     return(distance);
 }
 
 /******************************************************************************/
 
-BOOL RobotHome( matrix &home, double tolerance )
+BOOL RobotHome( const ROBOTSNAPSHOT &robot, matrix &home, double tolerance )
 {
 BOOL flag=FALSE;
 
-    if( RobotDistance(home) <= tolerance )
+    if( RobotDistance(robot,home) <= tolerance )
     {
         flag = TRUE;
     }
@@ -1157,29 +1781,29 @@ BOOL flag=FALSE;
 
 /******************************************************************************/
 
-BOOL RobotHome( void )
+BOOL RobotHome( const ROBOTSNAPSHOT &robot )
 {
 BOOL flag;
 
-    flag = RobotHome(StartPosition,HomeTolerance);
+    flag = RobotHome(robot,StartPosition,HomeTolerance);
 
     return(flag);
 }
 
 /******************************************************************************/
 
-BOOL MovementStarted( void )
+BOOL MovementStarted( const ROBOTSNAPSHOT &robot )
 {
 BOOL flag;
 
-    flag = !RobotHome(StartPosition,HomeTolerance);
+    flag = !RobotHome(robot,StartPosition,HomeTolerance);
 
     return(flag);
 }
 
 /******************************************************************************/
 
-BOOL MovementFinished( void )
+BOOL MovementFinished( const ROBOTSNAPSHOT &robot )
 {
 BOOL flag=FALSE;
 
@@ -1190,7 +1814,7 @@ BOOL flag=FALSE;
     }
 
 	// Is robot in the finish position?
-    if( !RobotHome(FinishPosition,HomeTolerance) )
+    if( !RobotHome(robot,FinishPosition,HomeTolerance) )
     {
 		MovementFinishedTimer.Reset();    
     }
@@ -1220,7 +1844,7 @@ BOOL flag=FALSE;
 
 /******************************************************************************/
 
-BOOL RobotNotMoving( void )
+BOOL RobotNotMoving( const ROBOTSNAPSHOT &robot )
 {
 BOOL flag;
 
@@ -1229,7 +1853,7 @@ BOOL flag;
         return(TRUE);
     }
 
-    if( RobotSpeed > NotMovingSpeed )
+    if( robot.RobotSpeed > NotMovingSpeed )
     {
         NotMovingTimer.Reset();
     }
@@ -1248,10 +1872,11 @@ void StateNext( int state )
         return;
     }
 
-    printf("STATE: %s[%d] > %s[%d] (%.0lf msec).\n",StateText[State],State,StateText[state],state,StateTimer.Elapsed());
+    StateLast = State;
+
+    LOOPLOG_printf("STATE: %s[%d] > %s[%d] (%.0lf msec).\n",StateText[StateLast],StateLast,StateText[state],state,StateTimer.Elapsed());
     StateTimer.Reset();
     StateFirstFlag = TRUE;
-    StateLast = State;
     State = state;
 }
 
@@ -1294,6 +1919,9 @@ void TrialSetup( void )
 {
 int i;
 
+    // Previous trial must be written before its data is changed.
+    TRIALWRITER_Flush();
+
     // Load trial variables from TrialData.
     TrialData.RowLoad(Trial);
     MissTrialFlag = FALSE;
@@ -1307,11 +1935,24 @@ int i;
     }
 
     RobotFieldAngle = FieldAngle;
-    SPMX_romxZ(D2R(RobotFieldAngle),RobotFieldMatrix);
+
+    // Channel trials are compared with the last viscous field.
+    if( RobotFieldType == FIELD_VISCOUS )
+    {
+        CompensationViscosity = RobotFieldConstants[0];
+        CompensationAngle = RobotFieldAngle;
+    }
+
+    // Compile force-field for the forces function.
+    RobotFieldRequest();
 
     TrialRunning = FALSE;
 	PassedVisibleDistance = FALSE;
 	MovedTooFar = FALSE;
+
+    // Make sure there is room for the frame data of this trial.
+    FrameDataSize();
+
 	StateGraphicsNext(State);
 
     printf("TrialSetup: Trial=%d FieldType=%d ContextType=%d\n",Trial,FieldType,ContextType);
@@ -1319,6 +1960,43 @@ int i;
 
 /******************************************************************************/
 
+void CompensationStart( void )
+{
+int i;
+
+    for( i=0; (i < 3); i++ )
+    {
+        CompensationSum[i] = 0.0;
+    }
+
+    CompensationCount = 0;
+    CompensationIndex = 0.0;
+    CompensationR2 = 0.0;
+}
+
+/******************************************************************************/
+
+void CompensationStop( void )
+{
+    // Slope and R-squared of channel force against ideal force (through zero).
+    if( CompensationSum[2] > 0.0 )
+    {
+        CompensationIndex = CompensationSum[1] / CompensationSum[2];
+    }
+
+    if( (CompensationSum[0] * CompensationSum[2]) > 0.0 )
+    {
+        CompensationR2 = (CompensationSum[1] * CompensationSum[1]) / (CompensationSum[0] * CompensationSum[2]);
+    }
+
+    if( CompensationCount > 0 )
+    {
+        printf("CompensationIndex=%.3lf R2=%.3lf (%d samples, viscous field %.2lf at %.1lf deg).\n",CompensationIndex,CompensationR2,CompensationCount,CompensationViscosity,CompensationAngle);
+    }
+}
+
+/******************************************************************************/
+
 void TrialStart( void )
 {
     printf("Starting Trial %d...\n",Trial);
@@ -1329,12 +2007,327 @@ void TrialStart( void )
     TrialTimer.Reset();
     TrialTime = TrialTimer.ElapsedSeconds();
     TrialRunning = TRUE;
+    LoopHistTrial.Reset();
+    FrameDataTruncated = FALSE;
+    CompensationStart();
     MovedTooFar = FALSE;
     // Start force field.
-    ForceFieldStart();
+    ForceFieldRequest();
+
+    // Start recording frame data for trial.
+    FrameStart();
+}
+
+/******************************************************************************/
+
+void ContextFullMovementTime( double time )
+{
+    ContextFullMovementTimeData.Data(time);
+
+    // Kept for the journal, so a resumed session has the same mean.
+    if( JournalTimeCount < RECORD_TIMES )
+    {
+        JournalTime[JournalTimeCount++] = time;
+    }
+}
+
+/******************************************************************************/
+
+// Hash of things that must be the same to resume a session from the journal.
+
+uint32_t JournalHash( void )
+{
+uint32_t hash=JOURNAL_HASH;
+int i,width;
+
+    // Contents as well as names, so an edited configuration isn't resumed.
+    for( i=0; (i < ConfigFileCount); i++ )
+    {
+        hash = JOURNAL_Hash(ConfigFileList[i],strlen(ConfigFileList[i]),hash);
+        CFGCACHE_FileHash(ConfigFileList[i],hash);
+    }
+
+    for( i=0; (i < TrialColumns.GetColumns()); i++ )
+    {
+        width = TrialColumns.GetColumnWidth(i);
+        hash = JOURNAL_Hash(TrialColumns.GetColumnName(i),strlen(TrialColumns.GetColumnName(i)),hash);
+        hash = JOURNAL_Hash(&width,sizeof(width),hash);
+    }
+
+    hash = JOURNAL_Hash(&Trials,sizeof(Trials),hash);
+
+    return(hash);
+}
+
+/******************************************************************************/
+
+// Start a new journal with the trial list (the random choices are all made
+// when the list is created, so the list itself is saved).
+
+BOOL JournalStart( void )
+{
+double *record;
+int width,values,row;
+BOOL ok;
+
+    width = TrialColumns.GetWidth();
+    values = 3 + (Trials * width);
+    record = new double[values];
+
+    record[0] = (double)JournalHash();
+    record[1] = (double)Trials;
+    record[2] = (double)width;
+
+    for( row=1; (row <= Trials); row++ )
+    {
+        TrialData.RowLoad(row);
+        TrialColumns.Sample(&record[3 + ((row-1) * width)]);
+    }
+
+    ok = JOURNAL_Open(JournalFile,true) && JOURNAL_Append(RECORD_SESSION,record,values * sizeof(double));
+    delete [] record;
+
+    return(ok);
+}
+
+/******************************************************************************/
+
+bool JournalRecord( int type, const void *data, int bytes )
+{
+const double *session=(const double *)data;
+const JOURNALTRIAL *trial=(const JOURNALTRIAL *)data;
+int width,row,i;
+
+    switch( type )
+    {
+        case RECORD_SESSION :
+            width = TrialColumns.GetWidth();
+
+            if( (bytes != (int)((3 + (Trials * width)) * sizeof(double))) || (session[0] != (double)JournalHash()) || (session[1] != (double)Trials) || (session[2] != (double)width) )
+            {
+                printf("JOURNAL: %s is not for this trial list.\n",JournalFile);
+                return(false);
+            }
+
+            // Replace the new trial list with the one from the session.
+            for( row=1; (row <= Trials); row++ )
+            {
+                TrialColumns.Store(&session[3 + ((row-1) * width)]);
+                TrialData.RowSave(row);
+            }
+
+            JournalSessionFlag = TRUE;
+            break;
+
+        case RECORD_TRIAL :
+            if( !JournalSessionFlag || (bytes != sizeof(JOURNALTRIAL)) || (trial->MovementTimes > RECORD_TIMES) )
+            {
+                printf("JOURNAL: %s Invalid trial record.\n",JournalFile);
+                return(false);
+            }
+
+            // A missed trial is saved but not completed, so resume at it.
+            JournalTrialLast = trial->MissTrialFlag ? (trial->Trial - 1) : trial->Trial;
+            MissTrialsTotal = trial->MissTrialsTotal;
+            TrialIndexMissTotal = trial->MissTrialsTotal;
+            MissTrialsFixationTotal = trial->MissTrialsFixationTotal;
+
+            for( i=0; (i < trial->MovementTimes); i++ )
+            {
+                ContextFullMovementTimeData.Data(trial->MovementTime[i]);
+            }
+            break;
+
+        case RECORD_RESUME :
+            JournalResumeCount++;
+            break;
+    }
+
+    return(true);
+}
+
+/******************************************************************************/
+
+// Report where the last trial in the journal is in a data file (from its index).
+
+void TrialIndexResume( char *data )
+{
+TRIALINDEX_ENTRY entry;
+STRING file;
+
+    snprintf(file,sizeof(file),"%s.index",data);
+
+    if( !TRIALINDEX_Read(file,JournalTrialLast,entry) )
+    {
+        printf("TRIALINDEX: %s does not have Trial %d (last is %d).\n",file,JournalTrialLast,TRIALINDEX_Last(file));
+        return;
+    }
+
+    printf("TRIALINDEX: %s Trial %d at byte %lld (%lld bytes, %d frames).\n",data,entry.Trial,(long long)entry.Offset,(long long)entry.Bytes,entry.Rows);
+}
+
+/******************************************************************************/
+
+// The interrupted session didn't reach COLFILE_Close(), so its session file
+// (.col) is written from the trials in the spool file (.col.tmp).
+
+void ColumnFileResume( char *data )
+{
+STRING file;
+
+    snprintf(file,sizeof(file),"%s.col",data);
+
+    if( !COLFILE_Recover(file) )
+    {
+        printf("COLFILE: No spool file for %s\n",file);
+    }
+}
+
+/******************************************************************************/
+
+// Restore the trial list and progress from the journal of an interrupted
+// session. The resumed session is saved to new files (DataFile with "R1",
+// "R2", etc.), so the files from the interrupted session are kept.
+
+BOOL JournalResume( void )
+{
+STRING file;
+
+    JournalSessionFlag = FALSE;
+    JournalResumeCount = 0;
+    JournalTrialLast = 0;
+
+    if( !JOURNAL_Read(JournalFile,JournalRecord) || !JournalSessionFlag )
+    {
+        printf("JOURNAL: Cannot resume from %s\n",JournalFile);
+        return(FALSE);
+    }
+
+    if( JournalTrialLast >= Trials )
+    {
+        printf("JOURNAL: All %d trials have been completed.\n",Trials);
+        return(FALSE);
+    }
+
+    // Skip rest breaks that have already been taken.
+    for( RestBreakIndex=0; ((RestBreakIndex < RestBreakCount) && (RestBreakTrials[RestBreakIndex] <= JournalTrialLast)); RestBreakIndex++ );
+
+    // Data file of the interrupted session should have the last trial.
+    if( JournalResumeCount == 0 )
+    {
+        snprintf(file,sizeof(file),"%s",DataFile);
+    }
+    else
+    {
+        snprintf(file,sizeof(file),"%sR%d",DataFile,JournalResumeCount);
+    }
+
+    TrialIndexResume(file);
+    ColumnFileResume(file);
+
+    JournalResumeCount++;
+    snprintf(file,sizeof(file),"%sR%d",DataFile,JournalResumeCount);
+    strcpy(DataFile,file);
+
+    if( !JOURNAL_Open(JournalFile,false) || !JOURNAL_Append(RECORD_RESUME,&JournalTrialLast,sizeof(JournalTrialLast)) )
+    {
+        printf("JOURNAL: Cannot open %s\n",JournalFile);
+        return(FALSE);
+    }
+
+    printf("JOURNAL: Resuming at Trial %d/%d (MissTrials=%d), data file %s\n",JournalTrialLast+1,Trials,MissTrialsTotal,DataFile);
+
+    return(TRUE);
+}
+
+/******************************************************************************/
+
+// Write a trial to the data file (and the files next to it). This is called by
+// the trial writer thread, so the state machine and graphics don't wait for
+// the disk. TrialData, FrameData, etc., are not changed until TrialSetup().
+
+bool TrialWrite( int trial )
+{
+TRIALINDEX_ENTRY entry;
+STRING file;
+int64_t offset;
+BOOL ok;
+
+    // Set-up the data file on the first trial (or first resumed trial).
+    if( !DATAFILE_Opened() )
+    {
+        // Open the file for trial data.
+        if( !DATAFILE_Open(DataFile,TrialData,FrameData) )
+        {
+            printf("DATAFILE: Cannot open file: %s\n",DataFile);
+            return(false);
+        }
+
+        // Index of the trials in the data file.
+        snprintf(file,sizeof(file),"%s.index",DataFile);
+        if( !TRIALINDEX_Open(file,true) )
+        {
+            printf("TRIALINDEX: Cannot open file: %s\n",file);
+        }
+    }
+
+    // Write the trial data to the file.
+    printf("Saving trial %d: %d frames of data collected in %.2lf seconds.\n",trial,FrameData.GetRow(),TrialDuration);
+    offset = TRIALINDEX_FileSize(DataFile);
+    ok = DATAFILE_TrialSave(trial);
+    printf("%s %s Trial=%d.\n",DataFile,STR_OkFailed(ok),trial);
+
+    // The trial is only indexed once it is in the data file.
+    if( ok && TRIALINDEX_Opened() )
+    {
+        entry.Trial = trial;
+        entry.Offset = offset;
+        entry.Bytes = TRIALINDEX_FileSize(DataFile) - offset;
+        entry.Rows = FrameData.GetRow();
+        entry.MissTrial = TrialIndexMissTrial;
+        entry.Phase = TrialPhase;
+        entry.FieldType = FieldType;
+
+        if( !TRIALINDEX_Write(entry) )
+        {
+            printf("TRIALINDEX: Cannot save Trial %d.\n",trial);
+        }
+    }
+
+    // Columnar copy of the trial for the session file (written by TrialExit).
+    snprintf(file,sizeof(file),"%s.col",DataFile);
+    COLFILE_Compress(ColumnCompress ? true : false);
+    if( !COLFILE_Opened() && !COLFILE_Open(file,TrialColumns,FrameColumns) )
+    {
+        printf("COLFILE: Cannot open file: %s\n",file);
+    }
+    else
+    if( !COLFILE_TrialSave(trial) )
+    {
+        printf("COLFILE: Cannot save Trial %d.\n",trial);
+    }
+
+    // Loop timing histograms for the trial are saved next to the data file.
+    snprintf(file,sizeof(file),"%s.hist",DataFile);
+    if( !LoopHistTrial.Save(file,trial) )
+    {
+        printf("LOOPHIST: Cannot save %s\n",file);
+    }
+
+    // Frame variables recorded at lower rates are saved next to the data file.
+    snprintf(file,sizeof(file),"%s.streams",DataFile);
+    if( !FrameStreams.Save(file,trial) )
+    {
+        printf("FRAMEREC: Cannot save %s\n",file);
+    }
+
+    // The trial is only complete in the journal once it has been written.
+    if( ok && JOURNAL_Opened() && !JOURNAL_Append(RECORD_TRIAL,&JournalTrial,sizeof(JournalTrial)) )
+    {
+        printf("JOURNAL: Cannot save Trial %d.\n",trial);
+    }
 
-    // Start recording frame data for trial.
-    FrameStart();
+    return(ok ? true : false);
 }
 
 /******************************************************************************/
@@ -1342,6 +2335,7 @@ void TrialStart( void )
 BOOL TrialSave( void )
 {
 BOOL ok=FALSE;
+int i;
 
     ExperimentTime = ExperimentTimer.ElapsedSeconds();
     MissTrials = MissTrialsTotal;
@@ -1350,22 +2344,39 @@ BOOL ok=FALSE;
 
     // Put values in the trial data
     TrialData.RowSave(Trial);
+    TrialColumns.Reset();
+    TrialColumns.RowSave();
 
-    // Set-up the data file on the first trial.
-    if( Trial == 1 )
+    // Stop if an earlier trial could not be written.
+    if( !TRIALWRITER_Ok() )
     {
-        // Open the file for trial data.
-        if( !DATAFILE_Open(DataFile,TrialData,FrameData) )
-        {
-            printf("DATAFILE: Cannot open file: %s\n",DataFile);
-            return(FALSE);
-        }
+        printf("TRIALWRITER: Trial %d was not saved.\n",TRIALWRITER_FailedTrial());
+        return(FALSE);
     }
 
-    // Write the trial data to the file.
-    printf("Saving trial %d: %d frames of data collected in %.2lf seconds.\n",Trial,FrameData.GetRow(),TrialDuration);
-    ok = DATAFILE_TrialSave(Trial);
-    printf("%s %s Trial=%d.\n",DataFile,STR_OkFailed(ok),Trial);
+    LoopHistSession.Merge(LoopHistTrial);
+
+    // Miss trial, or repeated after one (for the trial index).
+    TrialIndexMissTrial = (MissTrialsTotal > TrialIndexMissTotal) || MissTrialFlag;
+    TrialIndexMissTotal = MissTrialsTotal;
+
+    // Progress for the journal (appended when the trial has been written).
+    JournalTrial.Trial = Trial;
+    JournalTrial.MissTrialsTotal = MissTrialsTotal;
+    JournalTrial.MissTrialsFixationTotal = MissTrialsFixationTotal;
+    JournalTrial.MissTrialFlag = MissTrialFlag;
+    JournalTrial.MovementTimes = JournalTimeCount;
+    for( i=0; (i < JournalTimeCount); i++ )
+    {
+        JournalTrial.MovementTime[i] = JournalTime[i];
+    }
+    JournalTimeCount = 0;
+
+    // FrameData from the rows recorded by the forces function.
+    FrameDataFill();
+
+    // Files are written by a background thread, TrialSetup() waits for it.
+    ok = TRIALWRITER_Submit(TrialWrite,Trial);
 
     return(ok);
 }
@@ -1399,6 +2410,8 @@ BOOL ok;
     TrialDuration = TrialTimer.ElapsedSeconds();
     InterTrialDelayTimer.Reset();
 
+    CompensationStop();
+
     // Save the data for this trial (changed for saving miss trials).
     ok = TrialSave();
 
@@ -1431,6 +2444,18 @@ BOOL ok;
 
 void TrialExit( void )
 {
+    // Wait for the trial writer to finish.
+    TRIALWRITER_Stop();
+
+    // Write the columnar session file.
+    if( COLFILE_Opened() )
+    {
+        COLFILE_Close();
+    }
+
+    JOURNAL_Close();
+    TRIALINDEX_Close();
+
     // Close the data file if it has been opened.
     if( DATAFILE_Opened() )
     {
@@ -1505,8 +2530,7 @@ int background=-1;
 
 void ErrorFrameDataFull( void )
 {
-    MessageSet("Frame data full",LIGHTBLUE);
-    printf("Error: Frame data full\n");
+    LOOPLOG_printf("Warning: Frame data full (%d rows), trial kept.\n",FrameColumns.GetRow());
 }
 
 /******************************************************************************/
@@ -1514,7 +2538,7 @@ void ErrorFrameDataFull( void )
 void ErrorMessage( char *str )
 {
     MessageSet(str,LIGHTBLUE);
-    printf("Error: %s\n",str);
+    LOOPLOG_printf("Error: %s\n",str);
 }
 
 /******************************************************************************/
@@ -1522,7 +2546,7 @@ void ErrorMessage( char *str )
 void ErrorMoveWaitTimeOut( void )
 {
     MessageSet("Move After Beep",LIGHTBLUE);
-    printf("Error: MoveWaitTimeOut\n");
+    LOOPLOG_printf("Error: MoveWaitTimeOut\n");
 }
 
 /******************************************************************************/
@@ -1530,7 +2554,7 @@ void ErrorMoveWaitTimeOut( void )
 void ErrorFixateCross( void )
 {
     MessageSet("Fixate Cross");
-    printf("Error: FixateCross\n");
+    LOOPLOG_printf("Error: FixateCross\n");
 }
 
 /******************************************************************************/
@@ -1538,7 +2562,7 @@ void ErrorFixateCross( void )
 void ErrorMoveTooSlow( void )
 {
     MessageSet("Too Slow");
-    printf("Error: TooSlow\n");
+    LOOPLOG_printf("Error: TooSlow\n");
 }
 
 /******************************************************************************/
@@ -1587,7 +2611,7 @@ DualFeedback = ContextConstants[5];
 void ErrorMoveTimeOut( void )
 {
     MessageSet("Too Slow",LIGHTBLUE);
-    printf("Error: MoveTimeOut\n");
+    LOOPLOG_printf("Error: MoveTimeOut\n");
 }
 
 /******************************************************************************/
@@ -1595,7 +2619,7 @@ void ErrorMoveTimeOut( void )
 void ErrorMoveMissedVia( void )
 {
     MessageSet("Missed Via Target",LIGHTBLUE);
-    printf("Error: MissedVia\n");
+    LOOPLOG_printf("Error: MissedVia\n");
 }
 
 /******************************************************************************/
@@ -1603,7 +2627,7 @@ void ErrorMoveMissedVia( void )
 void ErrorMovePassedVia( void )
 {
     MessageSet("Passed Target",LIGHTBLUE);
-    printf("Error: Didn'tStopAtVia\n");
+    LOOPLOG_printf("Error: Didn'tStopAtVia\n");
 }
 
 /******************************************************************************/
@@ -1611,7 +2635,7 @@ void ErrorMovePassedVia( void )
 void ErrorMoveTooSoon( void )
 {
     MessageSet("Moved Too Soon",LIGHTBLUE);
-    printf("Error: MoveTooSoon\n");
+    LOOPLOG_printf("Error: MoveTooSoon\n");
 }
 
 /******************************************************************************/
@@ -1619,14 +2643,14 @@ void ErrorMoveTooSoon( void )
 void ErrorViaTimeout( void )
 {
     MessageSet("Via Target Timeout",LIGHTBLUE);
-    printf("Error: ViaTimeout\n");
+    LOOPLOG_printf("Error: ViaTimeout\n");
 }
 /******************************************************************************/
 
 void ErrorRobotInactive( void )
 {
     MessageSet("Handle switch",LIGHTBLUE);
-    printf("Error: RobotInactive\n");
+    LOOPLOG_printf("Error: RobotInactive\n");
 }
 
 /******************************************************************************/
@@ -1659,7 +2683,7 @@ void MissTrial( BOOL fixation )
     }
 
     MissTrialsPercent = 100.0 * ((double)MissTrialsTotal / (double)Trial);
-    printf("\nMiss Trials = %d/%d (%.0lf%%)\n\n",MissTrialsTotal,Trial,MissTrialsPercent);
+    LOOPLOG_printf("\nMiss Trials = %d/%d (%.0lf%%)\n\n",MissTrialsTotal,Trial,MissTrialsPercent);
 
     ErrorState(STATE_SETUP);
 }
@@ -1716,7 +2740,7 @@ BOOL PassingVia( void )
     BOOL flag=FALSE;
     
 	// Is robot passing through the via position?
-    if( !RobotHome(ViaPosition,ViaTolerance) )
+    if( !RobotHome(LoopRobot,ViaPosition,ViaTolerance) )
     {
         PassingViaTimer.Reset();		
     }
@@ -1790,7 +2814,7 @@ void StateProcessLoopTask( void )
     switch( State )
     {
         case STATE_MOVEWAIT :
-           if( MovementStarted() || (FieldType == FIELD_PMOVE) )
+           if( MovementStarted(LoopRobot) || (FieldType == FIELD_PMOVE) )
            {
                MovementDurationTimer.Reset();
                MovementDurationToViaTimer.Reset();
@@ -1847,12 +2871,12 @@ void StateProcessLoopTask( void )
             // Monitor the speed to extract max
             TrackSpeed();
             
-            if( MovementFinished()  )
+            if( MovementFinished(LoopRobot)  )
             {
 				MovementDurationTime = MovementDurationTimer.ElapsedSeconds();
 				if (!( (ContextType == TARGET_STOP_WARNING) || (ContextType == TARGET_STOP) ))
 				{   
-					ContextFullMovementTimeData.Data(MovementDurationTime); // store this for full movements only
+					ContextFullMovementTime(MovementDurationTime); // store this for full movements only
 				}
 				StateNext(STATE_FEEDBACK);
                 break;
@@ -1900,12 +2924,15 @@ double d;
             MissTrial();
         }
         else
-        if( FrameData.Full() )
+        if( FrameColumns.Full() && FrameRecord )
         {
-            // Abort current trial if frame data is full.
+            // Should not happen as FrameData is sized for the worst-case trial. Stop
+            // recording (the trial is kept, with FrameDataTruncated set in TrialData)
+            // and add a chunk before the next trial.
             ErrorFrameDataFull();
-            //TrialAbort(); // For saving miss trials (V1.5)
-            MissTrial();
+            FrameStop();
+            FrameDataTruncated = TRUE;
+            FrameDataExtraChunks++;
         }
     }
 
@@ -1943,7 +2970,7 @@ double d;
         case STATE_SETUP :
            // Setup details of next trial, but only when robot stationary and active.
            
-           if( !(RobotNotMoving() && RobotActive()) )
+           if( !(RobotNotMoving(GraphicsRobot) && RobotActive()) )
            {
                break;
            }
@@ -1977,7 +3004,7 @@ double d;
                break;
            }
 
-	   if( RobotNotMoving() && RobotHome() && RobotActive() && FixateFlag )
+	   if( RobotNotMoving(GraphicsRobot) && RobotHome(GraphicsRobot) && RobotActive() && FixateFlag )
            {
                StateNext(STATE_START);
                break;
@@ -2006,7 +3033,7 @@ double d;
                break;
            }
 
-           if( MovementStarted() )
+           if( MovementStarted(GraphicsRobot) )
            {
                ErrorMoveTooSoon();
                //TrialAbort(); // For saving miss trials (V1.5)
@@ -2192,6 +3219,7 @@ void GraphicsResults( void )
     GraphicsClearStereoLatency.Results();
     GraphicsClearMonoLatency.Results();
     GraphicsIdleFrequency.Results();
+    IDLESCHED_Results();
 
     if( GraphicsVerticalRetraceSyncTime != 0.0 )
     {
@@ -2208,6 +3236,8 @@ void Results( void )
     // Print results for various timers and things.
     RobotForcesFunctionLatency.Results();
     RobotForcesFunctionFrequency.Results();
+    LoopHistSession.Print(stdout);
+    printf("TRIALWRITER: Maximum time to save a trial %.3lf seconds.\n",TRIALWRITER_MaximumTime());
     GraphicsResults();
     WaveListPlayInterval.Results();
 	ContextFullMovementTimeData.Results();
@@ -2222,8 +3252,11 @@ void ProgramExit( void )
 
     // Stop, close and other final stuff.
     DeviceStop();
+    LOOPLOG_Stop();
+    GLCACHE_Free();
     GRAPHICS_Stop();
     Results();
+    IDLESCHED_Stop();
     WAVELIST_Close(WaveList);
 
     printf("ExperimentTime = %.0lf minutes.\n",ExperimentTimer.ElapsedMinutes());
@@ -2248,13 +3281,22 @@ static matrix vector(3,1);
 
 /******************************************************************************/
 
+void GraphicsCircle( matrix *posn, double radius, int color )
+{
+    // Same as GRAPHICS_Circle(), but drawn from the geometry cache.
+    GRAPHICS_ColorSet(color);
+    GLCACHE_Disc((*posn)(1,1),(*posn)(2,1),(*posn)(3,1),radius);
+}
+
+/******************************************************************************/
+
 void GraphicsDisplayCursor( void )
 {
 static matrix posn(3,1);
 
-    posn = CursorPosition;
+    VEC3_put(posn,GraphicsRobot.CursorPosition);
     posn(3,1) = 1.0;
-    GRAPHICS_Circle(&posn,CursorRadius,CursorColor);
+    GraphicsCircle(&posn,CursorRadius,CursorColor);
 
 }
 /******************************************************************************/
@@ -2285,7 +3327,8 @@ int attr;
 	BarrierOn	  = ContextConstants[3];
 
 	SPMX_romxZ(D2R(HomeAngle),R);
-  	P = R * CursorPosition;
+	VEC3_put(posn,GraphicsRobot.CursorPosition);
+  	P = R * posn;
 
 	H = ViaPosition;
 	H(3,1) = 0.0;
@@ -2326,12 +3369,12 @@ int attr;
 	// Always display the target
 	if( ContextType == TARGET_STATIC_ON )
     {
-		GRAPHICS_Circle(&posn,TargetRadius,attr);
+		GraphicsCircle(&posn,TargetRadius,attr);
 	}
     // Display the secondary target as only a visual cue
     if( ContextType == TARGET_STATIC_OFF )
     {
-	GRAPHICS_Circle(&posn,TargetRadius,TargetColor);
+	GraphicsCircle(&posn,TargetRadius,TargetColor);
     }
 	// Display the target once the cursor has moved far enough
 	if( ContextType == TARGET_APPEAR )
@@ -2339,7 +3382,7 @@ int attr;
 		if ( ( P(2,1) >= VisibleDistance ) || ( PassedVisibleDistance ) )
 		{
 			PassedVisibleDistance = TRUE;
-			GRAPHICS_Circle(&posn,TargetRadius,attr);
+			GraphicsCircle(&posn,TargetRadius,attr);
 		}
 	}
 	
@@ -2347,7 +3390,7 @@ int attr;
 	if(( ContextType == TARGET_STOP ) || ( ContextType == TARGET_STOP_WARNING ))
 	{
 		attr = YELLOW;
-		GRAPHICS_Circle(&posn,TargetRadius,attr);
+		GraphicsCircle(&posn,TargetRadius,attr);
 	}
 
 }
@@ -2366,71 +3409,52 @@ void GraphicsDisplayTeaPot( void )
 
 /******************************************************************************/
 
-void GraphicsDisplay( void )
+void GraphicsDisplayScene( void )
 {
 int attr;
 static matrix posn;
 
-    // Mark time before we start drawing the graphics scene.
-    GraphicsDisplayLatency.Before();
-
-    // Clear "stereo" graphics buffers.
-    GraphicsClearStereoLatency.Before();
-    GRAPHICS_ClearStereo();
-    GraphicsClearStereoLatency.After();
+    // Display text.
+    GraphicsDisplayText();
 
-    // Loop for each eye (stereo 3D).
-    GRAPHICS_EyeLoop(eye)
+    // Display rotating teapot during rest period.
+    if( StateGraphics == STATE_REST )
     {
-        // Set view for each eye (stereo 3D).
-        GRAPHICS_ViewCalib(eye);
-
-        // Clear "mono" graphics buffers.
-        GraphicsClearMonoLatency.Before();
-        GRAPHICS_ClearMono();
-        GraphicsClearMonoLatency.After();
-
-        // Display text.
-        GraphicsDisplayText();
-
-        // Display rotating teapot during rest period.
-        if( StateGraphics == STATE_REST )
-        {
-            GraphicsDisplayTeaPot();
-            continue;
-        }
+        GraphicsDisplayTeaPot();
+        return;
+    }
 
-        // Display eye tracker graphics if we're in the eye tracker state. (12)
-        if( StateGraphics == STATE_EYETRACKER )
-        {
-            EYET_GraphicsDisplay();
-            continue;
-        }
+    // Display eye tracker graphics if we're in the eye tracker state. (12)
+    if( StateGraphics == STATE_EYETRACKER )
+    {
+        EYET_GraphicsDisplay();
+        return;
+    }
 
-        // Display home position at start of trial.
-        if( (StateGraphics >= STATE_SETUP) && (StateGraphics <= STATE_INTERTRIAL) && (FieldType != FIELD_PMOVE) )
-        {
-            attr = RobotHome() ? HomeColor : NotHomeColor;
+    // Display home position at start of trial.
+    if( (StateGraphics >= STATE_SETUP) && (StateGraphics <= STATE_INTERTRIAL) && (FieldType != FIELD_PMOVE) )
+    {
+        attr = RobotHome(GraphicsRobot,StartPosition,HomeTolerance) ? HomeColor : NotHomeColor;
 
-            posn = StartPosition;
-            posn(3,1) = 0.0;
+        posn = StartPosition;
+        posn(3,1) = 0.0;
 
-            GRAPHICS_Circle(&posn,HomeRadius,attr);
-        }
+        GraphicsCircle(&posn,HomeRadius,attr);
+    }
 
 	if ( (FieldType == FIELD_PMOVE) && (StateGraphics > STATE_SETUP) )
 	{
-	    attr = RobotHome() ? HomeColor : NotHomeColor;	    
+	    attr = RobotHome(GraphicsRobot,StartPosition,HomeTolerance) ? HomeColor : NotHomeColor;	    
 	    posn = FinishPosition;
 	    posn(3,1) = 0.0;
-     	    GRAPHICS_Circle(&posn,HomeRadius,attr);
+     	    GraphicsCircle(&posn,HomeRadius,attr);
 	}
 
-        // Display target spheres when trial running.
-        // Should the target go off when the movement finishes?
-        if( ( StateGraphics >= STATE_START ) && ( StateGraphics <= STATE_INTERTRIAL ) )
-        {
-            
+    // Display target spheres when trial running.
+    // Should the target go off when the movement finishes?
+    if( ( StateGraphics >= STATE_START ) && ( StateGraphics <= STATE_INTERTRIAL ) )
+    {
+        
 			if ( FieldType != FIELD_PMOVE )
 			{
 				// Display target for movement.
@@ -2445,33 +3469,79 @@ static matrix posn;
 				        attr = ImagineViaColor;
 				}
 				
-			    GRAPHICS_Circle(&posn,ViaRadius,attr);
+			    GraphicsCircle(&posn,ViaRadius,attr);
 			}
 
 
-        }
+    }
 
-        if( (StateGraphics >= STATE_HOME) && (StateGraphics <= STATE_FEEDBACK) && (FieldType != FIELD_PMOVE) && FixateRequiredFlag )
-        {
-            FixateCrossPosition(3,1) = 2.0;
-            GRAPHICS_FixationCross(FixateCrossPosition,FixateCrossSize,FixateCrossWidth,FixateFlag ? WHITE : BLACK);
-        }
+    if( (StateGraphics >= STATE_HOME) && (StateGraphics <= STATE_FEEDBACK) && (FieldType != FIELD_PMOVE) && FixateRequiredFlag )
+    {
+        FixateCrossPosition(3,1) = 2.0;
+        GRAPHICS_FixationCross(FixateCrossPosition,FixateCrossSize,FixateCrossWidth,FixateFlag ? WHITE : BLACK);
+    }
 
-        // Display finish position.
-        if( (MovementType == MOVETYPE_OUTANDBACK) && ((StateGraphics > STATE_MOVING1) && (StateGraphics <= STATE_INTERTRIAL)) )
-        {
-            posn = FinishPosition;
-            posn(3,1) = 0.0;
+    // Display finish position.
+    if( (MovementType == MOVETYPE_OUTANDBACK) && ((StateGraphics > STATE_MOVING1) && (StateGraphics <= STATE_INTERTRIAL)) )
+    {
+        posn = FinishPosition;
+        posn(3,1) = 0.0;
 
-            attr = RobotHome() ? HomeColor : NotHomeColor;
+        attr = RobotHome(GraphicsRobot,StartPosition,HomeTolerance) ? HomeColor : NotHomeColor;
 
-            GRAPHICS_Circle(&posn,HomeRadius,attr);
-        }
+        GraphicsCircle(&posn,HomeRadius,attr);
+    }
+
+    // Display robot position cursor.
+    if( StateGraphics != STATE_ERROR )
+    {
+        GraphicsDisplayCursor();
+    }
+}
+
+/******************************************************************************/
+
+void GraphicsDisplay( void )
+{
+BOOL scene;
+
+    // Mark time before we start drawing the graphics scene.
+    GraphicsDisplayLatency.Before();
+
+    // Clear "stereo" graphics buffers.
+    GraphicsClearStereoLatency.Before();
+    GRAPHICS_ClearStereo();
+    GraphicsClearStereoLatency.After();
 
-        // Display robot position cursor.
-        if( StateGraphics != STATE_ERROR )
+    // In stereo, the scene is the same for each eye except for the view, so
+    // compile it once and draw the list for each eye.
+    scene = GraphicsSceneListFlag && (GraphicsMode != GRAPHICS_DISPLAY_2D) && (StateGraphics != STATE_EYETRACKER) && GLCACHE_SceneStart();
+
+    if( scene )
+    {
+        GraphicsDisplayScene();
+        GLCACHE_SceneEnd();
+    }
+
+    // Loop for each eye (stereo 3D).
+    GRAPHICS_EyeLoop(eye)
+    {
+        // Set view for each eye (stereo 3D).
+        GRAPHICS_ViewCalib(eye);
+
+        // Clear "mono" graphics buffers.
+        GraphicsClearMonoLatency.Before();
+        GRAPHICS_ClearMono();
+        GraphicsClearMonoLatency.After();
+
+        // Display the scene.
+        if( scene )
+        {
+            GLCACHE_SceneCall();
+        }
+        else
         {
-            GraphicsDisplayCursor();
+            GraphicsDisplayScene();
         }
     }
 
@@ -2536,12 +3606,69 @@ static matrix posn;
 
 /******************************************************************************/
 
+// Sleep until the idle function's next deadline: the state machine is
+// processed at least every GraphicsIdlePeriod and, with vertical retrace
+// timing, a frame is drawn GraphicsVerticalRetraceSyncTime before the next
+// retrace. Around the retrace itself it doesn't sleep (as before), so that
+// GRAPHICS_VerticalRetraceCatch() still catches it.
+
+void GraphicsIdleWait( void )
+{
+double period,retrace,draw,wait;
+
+    if( GraphicsIdlePeriod == 0.0 )
+    {
+        Sleep(0);
+        return;
+    }
+
+    if( GraphicsVerticalRetraceSyncTime == 0.0 )
+    {
+        IDLESCHED_Wait(GraphicsIdlePeriod,false);
+        return;
+    }
+
+    // Time (sec) until the next vertical retrace.
+    period = GRAPHICS_VerticalRetracePeriod;
+    retrace = GRAPHICS_VerticalRetraceOnsetTimeUntilNext() / 1000.0;
+
+    if( (retrace <= GraphicsIdleSpinTime) || (retrace >= (period - GraphicsIdleSpinTime)) )
+    {
+        Sleep(0);
+        return;
+    }
+
+    // Next draw point (in the next cycle if this one has passed).
+    draw = retrace - GraphicsVerticalRetraceSyncTime;
+
+    if( draw <= 0.0 )
+    {
+        draw += period;
+    }
+
+    wait = (draw < (retrace - GraphicsIdleSpinTime)) ? draw : (retrace - GraphicsIdleSpinTime);
+
+    if( wait < GraphicsIdlePeriod )
+    {
+        IDLESCHED_Wait(wait,true);
+    }
+    else
+    {
+        IDLESCHED_Wait(GraphicsIdlePeriod,false);
+    }
+}
+
+/******************************************************************************/
+
 void GraphicsIdle( void )
 {
 BOOL draw=FALSE;
 
     GraphicsIdleFrequency.Loop();
 
+    // Robot position and state published by the forces function.
+    GraphicsRobot = RobotSnapshot.Read();
+
     // Process Finite State Machine.
     StateProcess();
 
@@ -2569,7 +3696,7 @@ BOOL draw=FALSE;
     // Draw graphics frame only if draw flag set.
     if( draw )
     {
-        StateGraphicsNext(State); // Safe to set graphics state at this point.
+        StateGraphicsNext(GraphicsRobot.State); // Safe to set graphics state at this point.
 
         if( TargetTestFlag )
         {
@@ -2581,7 +3708,8 @@ BOOL draw=FALSE;
         }
     }
 
-    Sleep(0);
+    // Sleep until there is something to do.
+    GraphicsIdleWait();
 }
 
 /******************************************************************************/
@@ -2657,6 +3785,12 @@ void GraphicsMainLoop( void )
     GraphicsDisplayFrequency.Reset();
     GraphicsIdleFrequency.Reset();
 
+    // High-resolution sleeps for the idle function.
+    if( !IDLESCHED_Start(GraphicsIdleSpinTime) )
+    {
+        printf("IDLESCHED: Cannot start timer (idle function will not sleep).\n");
+    }
+
     // Give control to GLUT's main loop.
     glutMainLoop();
 }
@@ -2666,7 +3800,7 @@ void GraphicsMainLoop( void )
 void Usage( void )
 {
     printf("----------------------------------\n");
-    printf("%s /C:Config(1)[,...Config(n)] /M:MetaConfig /D:DataFile\n",MODULE_NAME);
+    printf("%s /C:Config(1)[,...Config(n)] /M:MetaConfig /D:DataFile [/resume]\n",MODULE_NAME);
     printf("----------------------------------\n");
 
     exit(0);
@@ -2674,8 +3808,47 @@ void Usage( void )
 
 /******************************************************************************/
 
+// Variables are added to the MATDAT (for the DATAFILE) and the matching
+// COLTABLE (for the columnar session file) with the same name.
+
+template<class T> void TrialVariable( const char *name, T &variable )
+{
+    TrialData.AddVariable(name,variable);
+    TrialColumns.AddVariable(name,variable);
+}
+
+template<class T> void TrialVariable( const char *name, T *variable, int count )
+{
+    TrialData.AddVariable(name,variable,count);
+    TrialColumns.AddVariable(name,variable,count);
+}
+
+// FrameColumns samples the variable and FrameData a copy (see FrameDataFill).
+
+template<class T> void FrameVariable( const char *name, T &variable )
+{
+T *copy=new T(variable);
+
+    FrameColumns.AddVariable(name,variable);
+    FrameShadow.AddVariable(name,*copy);
+    FrameData.AddVariable(name,*copy);
+}
+
+template<class T> void FrameVariable( const char *name, T *variable, int count )
+{
+T *copy=new T[count];
+
+    FrameColumns.AddVariable(name,variable,count);
+    FrameShadow.AddVariable(name,copy,count);
+    FrameData.AddVariable(name,copy,count);
+}
+
+/******************************************************************************/
+
 BOOL Initialize( void )
 {
+int i;
+
     // Load the first (and possibly the only) configuration file.
     if( !ConfigLoad(ConfigFileList[0]) )
     {
@@ -2691,88 +3864,111 @@ BOOL Initialize( void )
 
 	ContextFullMovementTimeData.Data(PostMoveDelayInit);
 
+    // Until a viscous field is used, channel trials are compared with the first one configured.
+    for( i=0; ((i < FIELD_INDEX) && (CompensationViscosity == 0.0)); i++ )
+    {
+        if( FieldIndexType[i] == FIELD_VISCOUS )
+        {
+            CompensationViscosity = FieldIndexConstants[i][0];
+            CompensationAngle = FieldIndexAngle[i];
+        }
+    }
+
     // Add each variable to the TrialData matrix.
-    TrialData.AddVariable(VAR(ExperimentTime));
-    TrialData.AddVariable(VAR(ConfigIndex));
-    TrialData.AddVariable(VAR(PhaseIndex));
-    TrialData.AddVariable(VAR(TrialPhase));
-    TrialData.AddVariable(VAR(MovementType));
-    TrialData.AddVariable(VAR(MovementDirection));
-    TrialData.AddVariable(VAR(FieldIndex));
-    TrialData.AddVariable(VAR(FieldType));
-    TrialData.AddVariable(VAR(FieldConstants),FIELD_CONSTANTS);
-    TrialData.AddVariable(VAR(FieldAngle));
-    TrialData.AddVariable(VAR(ContextType));
-    TrialData.AddVariable(VAR(ContextConstants),FIELD_CONSTANTS);
-    TrialData.AddVariable("Trial",TrialNumber); // For saving miss trials.
-    TrialData.AddVariable(VAR(MissTrialFlag));  // For saving miss trials.
-    TrialData.AddVariable(VAR(TrialDelay));
-    TrialData.AddVariable(VAR(InterTrialDelay));
-    TrialData.AddVariable(VAR(TargetIndex));
-    TrialData.AddVariable(VAR(TargetAngle));
-    TrialData.AddVariable(VAR(TargetPosition));
-    TrialData.AddVariable(VAR(TargetDistance));
-    TrialData.AddVariable(VAR(ViaPosition));
-    TrialData.AddVariable(VAR(FixateCrossPosition));
-    TrialData.AddVariable(VAR(HomeAngle));
+    TrialVariable(VAR(ExperimentTime));
+    TrialVariable(VAR(ConfigIndex));
+    TrialVariable(VAR(PhaseIndex));
+    TrialVariable(VAR(TrialPhase));
+    TrialVariable(VAR(MovementType));
+    TrialVariable(VAR(MovementDirection));
+    TrialVariable(VAR(FieldIndex));
+    TrialVariable(VAR(FieldType));
+    TrialVariable(VAR(FieldConstants),FIELD_CONSTANTS);
+    TrialVariable(VAR(FieldAngle));
+    TrialVariable(VAR(ContextType));
+    TrialVariable(VAR(ContextConstants),FIELD_CONSTANTS);
+    TrialVariable("Trial",TrialNumber); // For saving miss trials.
+    TrialVariable(VAR(MissTrialFlag));  // For saving miss trials.
+    TrialVariable(VAR(TrialDelay));
+    TrialVariable(VAR(InterTrialDelay));
+    TrialVariable(VAR(TargetIndex));
+    TrialVariable(VAR(TargetAngle));
+    TrialVariable(VAR(TargetPosition));
+    TrialVariable(VAR(TargetDistance));
+    TrialVariable(VAR(ViaPosition));
+    TrialVariable(VAR(FixateCrossPosition));
+    TrialVariable(VAR(HomeAngle));
     //TrialData.AddVariable(VAR(WallPosition)); 
-    TrialData.AddVariable(VAR(WallDistance)); 
-    TrialData.AddVariable(VAR(HomePosition));
-    TrialData.AddVariable(VAR(StartPosition));
-    TrialData.AddVariable(VAR(FinishPosition));
-    TrialData.AddVariable(VAR(MissTrials));
-    TrialData.AddVariable(VAR(MissTrialsFixation));
-    TrialData.AddVariable(VAR(TrialDuration));
-    TrialData.AddVariable(VAR(MovementReactionTime));
-    TrialData.AddVariable(VAR(MovementDurationTime));
-    TrialData.AddVariable(VAR(MovementDurationToViaTime));
-    TrialData.AddVariable(VAR(MovementDurationTooFast));
-    TrialData.AddVariable(VAR(MovementDurationTooSlow));
-    TrialData.AddVariable(VAR(MovementDurationTooSlowToVia));
-    TrialData.AddVariable(VAR(PMoveStartPosition));
-    TrialData.AddVariable(VAR(PMoveEndPosition));
-    TrialData.AddVariable(VAR(ViaToleranceTime));
-    TrialData.AddVariable(VAR(ViaTimeOutTime));
-    TrialData.AddVariable(VAR(ViaSpeedThreshold));
-    TrialData.AddVariable(VAR(FollowSpeedQuickTarget));
-    TrialData.AddVariable(VAR(FollowSpeedSlowTarget));
-    TrialData.AddVariable(VAR(FollowSpeedTolerance));
-    TrialData.AddVariable(VAR(FollowSpeedTarget));
-    TrialData.AddVariable(VAR(PostMoveDelayInit));
-    TrialData.AddVariable(VAR(PostMoveDelayTime));
+    TrialVariable(VAR(WallDistance)); 
+    TrialVariable(VAR(HomePosition));
+    TrialVariable(VAR(StartPosition));
+    TrialVariable(VAR(FinishPosition));
+    TrialVariable(VAR(MissTrials));
+    TrialVariable(VAR(MissTrialsFixation));
+    TrialVariable(VAR(TrialDuration));
+    TrialVariable(VAR(MovementReactionTime));
+    TrialVariable(VAR(MovementDurationTime));
+    TrialVariable(VAR(MovementDurationToViaTime));
+    TrialVariable(VAR(MovementDurationTooFast));
+    TrialVariable(VAR(MovementDurationTooSlow));
+    TrialVariable(VAR(MovementDurationTooSlowToVia));
+    TrialVariable(VAR(PMoveStartPosition));
+    TrialVariable(VAR(PMoveEndPosition));
+    TrialVariable(VAR(ViaToleranceTime));
+    TrialVariable(VAR(ViaTimeOutTime));
+    TrialVariable(VAR(ViaSpeedThreshold));
+    TrialVariable(VAR(FollowSpeedQuickTarget));
+    TrialVariable(VAR(FollowSpeedSlowTarget));
+    TrialVariable(VAR(FollowSpeedTolerance));
+    TrialVariable(VAR(FollowSpeedTarget));
+    TrialVariable(VAR(PostMoveDelayInit));
+    TrialVariable(VAR(PostMoveDelayTime));
+    TrialVariable(VAR(CompensationIndex));
+    TrialVariable(VAR(CompensationR2));
+    TrialVariable(VAR(FrameDataTruncated));
 	
     // Add each variable to the FrameData matrix.
-    FrameData.AddVariable(VAR(TrialTime));         
-    FrameData.AddVariable(VAR(State));
-    FrameData.AddVariable(VAR(StateGraphics));
-    FrameData.AddVariable(VAR(ForcesFunctionLatency));
-    FrameData.AddVariable(VAR(ForcesFunctionPeriod));
-    FrameData.AddVariable(VAR(RobotPosition));
-    FrameData.AddVariable(VAR(RobotVelocity));     
-    FrameData.AddVariable(VAR(RobotForces));       
-    FrameData.AddVariable(VAR(RobotActiveFlag));
-    FrameData.AddVariable(VAR(HandleForces));
-    FrameData.AddVariable(VAR(HandleTorques));
-    FrameData.AddVariable(VAR(CursorPosition));
-    FrameData.AddVariable(VAR(PMoveState));
-    FrameData.AddVariable(VAR(PMoveStateTime));
-    FrameData.AddVariable(VAR(PMoveStateRampValue));
-    FrameData.AddVariable(VAR(PMoveStatePosition));
+    FrameVariable(VAR(TrialTime));         
+    FrameVariable("State",StateFrame);
+    FrameVariable(VAR(ForcesFunctionLatency));
+    FrameVariable(VAR(ForcesFunctionPeriod));
+    FrameVariable(VAR(RobotPosition));
+    FrameVariable(VAR(RobotVelocity));     
+    FrameVariable(VAR(RobotForces));       
+    FrameVariable(VAR(HandleForces));
+    FrameVariable(VAR(CursorPosition));
+    FrameVariable(VAR(CursorPredicted));
 
     // Eye tracker frame data variables if required. (15)
     if( EyeTrackerFlag )
     {
-        FrameData.AddVariable(VAR(EyeTrackerFrameCount));
-        FrameData.AddVariable(VAR(EyeTrackerTimeStamp));
-        FrameData.AddVariable(VAR(EyeTrackerEyeXY),2);
-        FrameData.AddVariable(VAR(EyeTrackerPupilSize));
+        FrameVariable(VAR(EyeTrackerFrameCount));
+        FrameVariable(VAR(EyeTrackerTimeStamp));
+        FrameVariable(VAR(EyeTrackerEyeXY),2);
+        FrameVariable(VAR(EyeTrackerPupilSize));
     }
 
+    // Slowly-changing variables have their own sample rate (and time column).
+    FrameStreams.AddVariable(VAR(StateGraphics),FRAMEREC_CHANGE);
+    FrameStreams.AddVariable(VAR(RobotActiveFlag),FRAMEREC_CHANGE);
+    FrameStreams.AddVariable(VAR(HandleTorques),FRAMESTREAM_RATE);
+    FrameStreams.AddVariable(VAR(PMoveState),FRAMEREC_CHANGE);
+    FrameStreams.AddVariable(VAR(PMoveStateTime),FRAMESTREAM_RATE);
+    FrameStreams.AddVariable(VAR(PMoveStateRampValue),FRAMESTREAM_RATE);
+    FrameStreams.AddVariable(VAR(PMoveStatePosition),FRAMESTREAM_RATE);
+
     // Add GRAPHICS variables to FrameData matrix.
     GRAPHICS_FrameData(&FrameData);
+    GRAPHICS_FrameData(&FrameGraphics);
 
-    // Set rows of FrameData to maximum.
+    // Set rows of FrameData to minimum (resized for each trial in TrialSetup).
     FrameData.SetRows(FRAMEDATA_ROWS);
+    FrameGraphics.SetRows(FRAMEDATA_ROWS);
+    FrameColumns.SetRows(FRAMEDATA_ROWS);
+    FrameDataRows = FRAMEDATA_ROWS;
+
+    // One row of TrialColumns for each trial.
+    TrialColumns.SetRows(1);
 
     return(TRUE);
 }
@@ -2968,7 +4164,7 @@ static double Dot, Det;
 
 /******************************************************************************/
 
-BOOL TrialList( void )
+BOOL TrialListMake( void )
 {
 int i;
 BOOL ok=TRUE;
@@ -3090,6 +4286,115 @@ BOOL ok=TRUE;
         return(FALSE);
     }
 
+    return(TRUE);
+}
+
+/******************************************************************************/
+
+// Key for the cache (the program, data file and configuration files).
+
+BOOL ConfigCacheKey( uint32_t &key )
+{
+static const char build[]=MODULE_NAME " " __DATE__ " " __TIME__;
+int i,width;
+
+    width = TrialColumns.GetWidth();
+
+    key = JOURNAL_Hash(build,strlen(build));
+    key = JOURNAL_Hash(DataFile,strlen(DataFile),key);
+    key = JOURNAL_Hash(&width,sizeof(width),key);
+
+    for( i=0; (i < ConfigFileCount); i++ )
+    {
+        key = JOURNAL_Hash(ConfigFileList[i],strlen(ConfigFileList[i]),key);
+
+        if( !CFGCACHE_FileHash(ConfigFileList[i],key) )
+        {
+            return(FALSE);
+        }
+    }
+
+    return(TRUE);
+}
+
+/******************************************************************************/
+
+// Configuration and trial list from the cache, if it was saved with the same
+// configuration files (each row of TrialData as in the journal).
+
+BOOL ConfigCacheLoad( void )
+{
+std::vector<double> list;
+uint32_t key;
+int width,rows,row;
+
+    if( !ConfigCacheKey(key) || !ConfigCache.Load(ConfigCacheFile,key,list) )
+    {
+        return(FALSE);
+    }
+
+    width = TrialColumns.GetWidth();
+    rows = (int)list[0];
+
+    TrialData.SetRows(rows);
+
+    for( row=1; (row <= rows); row++ )
+    {
+        TrialColumns.Store(&list[1 + ((row-1) * width)]);
+        TrialData.RowSave(row);
+    }
+
+    return(TRUE);
+}
+
+/******************************************************************************/
+
+void ConfigCacheSave( void )
+{
+std::vector<double> list;
+uint32_t key;
+int width,rows,row;
+
+    width = TrialColumns.GetWidth();
+    rows = TrialData.GetRows();
+
+    list.resize(1 + (rows * width));
+    list[0] = (double)rows;
+
+    for( row=1; (row <= rows); row++ )
+    {
+        TrialData.RowLoad(row);
+        TrialColumns.Sample(&list[1 + ((row-1) * width)]);
+    }
+
+    if( !ConfigCacheKey(key) || !ConfigCache.Save(ConfigCacheFile,key,list) )
+    {
+        printf("CFGCACHE: Cannot write %s.\n",ConfigCacheFile);
+    }
+}
+
+/******************************************************************************/
+
+BOOL TrialList( void )
+{
+int i;
+BOOL ok=TRUE;
+
+    // Configuration files not changed since the cache was saved?
+    if( ConfigCacheLoad() )
+    {
+        printf("CFGCACHE: %s Trials=%d (configuration not changed).\n",ConfigCacheFile,TrialData.GetRows());
+    }
+    else
+    {
+        if( !TrialListMake() )
+        {
+            return(FALSE);
+        }
+
+        ConfigCacheSave();
+    }
+
     printf("RestBreakCount = %d\n",RestBreakCount);
     for( i=0; (i < RestBreakCount); i++ )
     {
@@ -3099,12 +4404,26 @@ BOOL ok=TRUE;
     // Total number of trails.
     Trials = TotalTrials;
 
+    // Restore an interrupted session from the journal, or start a new journal.
+    if( JournalResumeFlag )
+    {
+        if( !JournalResume() )
+        {
+            return(FALSE);
+        }
+    }
+    else
+    if( !JournalStart() )
+    {
+        printf("JOURNAL: Cannot create %s (session cannot be resumed).\n",JournalFile);
+    }
+
     // Save trial list to file.
     ok = DATAFILE_Save(TrialListFile,TrialData);
     printf("%s %s Trials=%d.\n",TrialListFile,STR_OkFailed(ok),TrialData.GetRows());
 
-    // Reset trial number, etc.
-    Trial = 1;
+    // Reset trial number (next trial if resuming), etc.
+    Trial = JournalTrialLast + 1;
     TrialSetup();
     ExperimentTimer.Reset();
     StateNext(STATE_INITIALIZE);
@@ -3116,12 +4435,18 @@ BOOL ok=TRUE;
 
 void main( int argc, char *argv[] )
 {
+    // Resume an interrupted session (not a MOTOR.LIB parameter).
+    JournalResumeFlag = JOURNAL_Parameter(argc,argv,"/resume");
+
     // Initialize MOTOR.LIB, command-line parameters, configuration files, etc.
     if( !MOTOR_Parameters(argc,argv,DataName,DataFile,TrialListFile,ConfigFileCount,ConfigFileList) )
     {
         exit(0);
     }
 
+    snprintf(JournalFile,sizeof(JournalFile),"%s.journal",DataFile);
+    snprintf(ConfigCacheFile,sizeof(ConfigCacheFile),"%s.cfgcache",DataFile);
+
     // Initialize variables, etc.
     if( !Initialize() )
     {
@@ -3135,6 +4460,12 @@ void main( int argc, char *argv[] )
         ProgramExit();
     }
 
+    // Messages from the robot loop are written by a background thread.
+    LOOPLOG_Start();
+
+    // Trial data files are written by a background thread.
+    TRIALWRITER_Start();
+
     // Start the robot.
     if( DeviceStart() )
     {
@@ -0,0 +1,827 @@
+/******************************************************************************/
+/*                                                                            */
+/* MODULE  : datconvert.cpp                                                   */
+/*                                                                            */
+/* PURPOSE : Index and convert archived DATAFILE (.dat) files to COLFILE.     */
+/*                                                                            */
+/* DATE    : 17/Oct/2026                                                      */
+/*                                                                            */
+/* CHANGES                                                                    */
+/*                                                                            */
+/* V1.0  HRS 17/Oct/2026 - Initial development.                               */
+/*                                                                            */
+/******************************************************************************/
+
+// datconvert [/T:Threads] [/F] [/R] [/I] File.dat|File.col.tmp|Directory ...
+//
+//   /T:n   Threads (default is the number of cores).
+//   /F     Convert files that have already been converted.
+//   /R     Raw columns (no COLCODEC compression).
+//   /I     Only write the index.
+//
+// Directories are searched (with sub-directories) for .dat files. For each
+// name.dat it writes name.dat.index, the trial index the experiment writes
+// as it saves trials (TRIALINDEX, read with common/trialindex.h), and
+// name.col (COLFILE, read with COLFILE_READER). The index entries have the
+// byte offset and size of each trial's block in the .dat, its FrameData rows
+// and, when they are in TrialData, TrialPhase, FieldType and whether
+// MissTrials went up. name.col is written as a .part file and renamed when
+// complete, so an interrupted run can be started again and only converts the
+// files that were not finished (a name.col that opens is skipped). The index
+// is written again each time.
+//
+// A name.col.tmp is the spool file of a session that stopped before its
+// name.col was written. name.col is written from the trials in it (with
+// COLFILE_Recover()) before any .dat files are converted. Directories are
+// searched for these as well.
+//
+// Files are converted in parallel. With fewer files than threads, the trials
+// of each file are also read and encoded in parallel (and appended in order).
+//
+// DATAFILE is written by MOTOR.LIB, which is not in this repository, so the
+// layout below is the one this program assumes. It is only used by
+// DATFILE_Header() and DATFILE_Index(). A file that doesn't fit it is
+// reported and skipped (never partly converted).
+//
+//   Header (text lines):
+//     TrialData <variables>
+//     <name> <rows> <columns>        One line for each variable.
+//     FrameData <variables>
+//     <name> <rows> <columns>
+//   Trial block (native doubles), one per trial:
+//     Trial, Rows
+//     TrialData[Width]               Width is the sum of rows*columns.
+//     FrameData[Rows][Width]
+
+#if !defined(_WIN32)
+#define _FILE_OFFSET_BITS 64
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+#include "../common/colfile.h"
+#include "../common/trialindex.h"
+
+/******************************************************************************/
+
+#define DATFILE_TABLES     2       // TrialData and FrameData.
+#define DATFILE_LINE       256
+#define DATFILE_ROWS       10000000
+
+struct DATFILE_VARIABLE
+{
+    char Name[COLFILE_NAME];
+    int Width;
+};
+
+struct DATFILE_TABLE
+{
+    char Name[COLFILE_NAME];
+    std::vector<DATFILE_VARIABLE> Variable;
+    int Width;
+};
+
+struct DATFILE_TRIAL
+{
+    int Trial;
+    int64_t Offset;
+    int64_t Bytes;
+    int Rows;
+    int Phase;                  // From TrialData (0 if it isn't there).
+    int FieldType;
+    int MissTrials;
+};
+
+struct DATFILE
+{
+    std::string File;
+    DATFILE_TABLE Table[DATFILE_TABLES];
+    std::vector<DATFILE_TRIAL> Trial;
+    int RowsMax;
+};
+
+/******************************************************************************/
+
+int         Threads=0;
+bool        ForceFlag=false;
+bool        RawFlag=false;
+bool        IndexOnlyFlag=false;
+
+std::vector<std::string> FileList;
+std::vector<std::string> SpoolList;
+std::atomic<int> FileNext(0);
+std::atomic<int> FilesConverted(0);
+std::atomic<int> FilesSkipped(0);
+std::atomic<int> FilesFailed(0);
+std::mutex  PrintMutex;
+
+/******************************************************************************/
+
+void Usage( void )
+{
+    printf("----------------------------------\n");
+    printf("datconvert [/T:Threads] [/F] [/R] [/I] File.dat|File.col.tmp|Directory ...\n");
+    printf("----------------------------------\n");
+
+    exit(0);
+}
+
+/******************************************************************************/
+
+static int DATFILE_Seek( FILE *FP, int64_t offset )
+{
+#if defined(_WIN32)
+    return(_fseeki64(FP,offset,SEEK_SET));
+#else
+    return(fseeko(FP,(off_t)offset,SEEK_SET));
+#endif
+}
+
+/******************************************************************************/
+
+static int64_t DATFILE_Tell( FILE *FP )
+{
+#if defined(_WIN32)
+    return(_ftelli64(FP));
+#else
+    return((int64_t)ftello(FP));
+#endif
+}
+
+/******************************************************************************/
+
+static int64_t DATFILE_Size( FILE *FP )
+{
+int64_t position,size;
+
+    position = DATFILE_Tell(FP);
+    fseek(FP,0,SEEK_END);
+    size = DATFILE_Tell(FP);
+    DATFILE_Seek(FP,position);
+
+    return(size);
+}
+
+/******************************************************************************/
+
+// Name from the header, truncated to COLFILE_NAME-1 characters.
+
+static void DATFILE_Name( char *name, const char *text )
+{
+size_t length;
+
+    if( (length=strlen(text)) > (COLFILE_NAME-1) )
+    {
+        length = COLFILE_NAME-1;
+    }
+
+    memcpy(name,text,length);
+    name[length] = 0;
+}
+
+/******************************************************************************/
+
+// Text header of variable names and sizes for each MATDAT.
+
+bool DATFILE_Header( FILE *FP, DATFILE &dat )
+{
+char line[DATFILE_LINE];
+char name[DATFILE_LINE];
+DATFILE_VARIABLE variable;
+int t,i,variables,rows,columns;
+
+    for( t=0; (t < DATFILE_TABLES); t++ )
+    {
+        if( (fgets(line,sizeof(line),FP) == NULL) || (sscanf(line,"%255s %d",name,&variables) != 2) || (variables < 1) || (variables > COLFILE_VARIABLES) )
+        {
+            return(false);
+        }
+
+        DATFILE_Name(dat.Table[t].Name,name);
+        dat.Table[t].Variable.clear();
+        dat.Table[t].Width = 0;
+
+        for( i=0; (i < variables); i++ )
+        {
+            if( (fgets(line,sizeof(line),FP) == NULL) || (sscanf(line,"%255s %d %d",name,&rows,&columns) != 3) || (rows < 1) || (columns < 1) || ((rows * columns) > 1000) )
+            {
+                return(false);
+            }
+
+            DATFILE_Name(variable.Name,name);
+            variable.Width = rows * columns;
+
+            dat.Table[t].Variable.push_back(variable);
+            dat.Table[t].Width += variable.Width;
+        }
+    }
+
+    return((strcmp(dat.Table[0].Name,"TrialData") == 0) && (strcmp(dat.Table[1].Name,"FrameData") == 0));
+}
+
+/******************************************************************************/
+
+// Position of a TrialData variable in the trial's block (-1 if it isn't there).
+
+static int DATFILE_TrialVariable( const DATFILE &dat, const char *name )
+{
+size_t i;
+int offset;
+
+    for( offset=2,i=0; (i < dat.Table[0].Variable.size()); i++ )
+    {
+        if( strcmp(dat.Table[0].Variable[i].Name,name) == 0 )
+        {
+            return(offset);
+        }
+
+        offset += dat.Table[0].Variable[i].Width;
+    }
+
+    return(-1);
+}
+
+/******************************************************************************/
+
+static int DATFILE_TrialValue( const std::vector<double> &block, int offset )
+{
+    return((offset < 0) ? 0 : (int)block[offset]);
+}
+
+/******************************************************************************/
+
+// Byte offset and size of each trial's block (only the block headers and
+// TrialData are read).
+
+bool DATFILE_Index( FILE *FP, DATFILE &dat )
+{
+DATFILE_TRIAL trial;
+std::vector<double> block(2 + dat.Table[0].Width);
+int64_t offset,size;
+int phase,field,misses;
+
+    size = DATFILE_Size(FP);
+    offset = DATFILE_Tell(FP);
+
+    dat.Trial.clear();
+    dat.RowsMax = 0;
+
+    phase = DATFILE_TrialVariable(dat,"TrialPhase");
+    field = DATFILE_TrialVariable(dat,"FieldType");
+    misses = DATFILE_TrialVariable(dat,"MissTrials");
+
+    while( offset < size )
+    {
+        if( (DATFILE_Seek(FP,offset) != 0) || (fread(block.data(),sizeof(double),block.size(),FP) != block.size()) )
+        {
+            return(false);
+        }
+
+        if( (block[0] < 1.0) || (block[1] < 0.0) || (block[1] > DATFILE_ROWS) || (block[0] != (int)block[0]) || (block[1] != (int)block[1]) )
+        {
+            return(false);
+        }
+
+        trial.Trial = (int)block[0];
+        trial.Rows = (int)block[1];
+        trial.Offset = offset;
+        trial.Bytes = (2 + dat.Table[0].Width + ((int64_t)trial.Rows * dat.Table[1].Width)) * (int64_t)sizeof(double);
+        trial.Phase = DATFILE_TrialValue(block,phase);
+        trial.FieldType = DATFILE_TrialValue(block,field);
+        trial.MissTrials = DATFILE_TrialValue(block,misses);
+
+        // Trials are in order and the block must be complete. A trial number
+        // is repeated when a trial is saved more than once (e.g., a miss
+        // trial and then the trial run again), so each block is indexed.
+        if( (!dat.Trial.empty() && (trial.Trial < dat.Trial.back().Trial)) || ((offset + trial.Bytes) > size) )
+        {
+            return(false);
+        }
+
+        if( trial.Rows > dat.RowsMax )
+        {
+            dat.RowsMax = trial.Rows;
+        }
+
+        dat.Trial.push_back(trial);
+        offset += trial.Bytes;
+    }
+
+    return(!dat.Trial.empty());
+}
+
+/******************************************************************************/
+
+// Trial index as the experiment writes it (TRIALINDEX_Write()).
+
+bool IndexWrite( const DATFILE &dat, const std::string &file )
+{
+std::vector<TRIALINDEX_ENTRY> entry(dat.Trial.size());
+size_t i;
+int misses=0;
+
+    for( i=0; (i < dat.Trial.size()); i++ )
+    {
+        memset(&entry[i],0,sizeof(entry[i]));
+        entry[i].Trial = dat.Trial[i].Trial;
+        entry[i].Offset = dat.Trial[i].Offset;
+        entry[i].Bytes = dat.Trial[i].Bytes;
+        entry[i].Rows = dat.Trial[i].Rows;
+        entry[i].MissTrial = (dat.Trial[i].MissTrials > misses);
+        entry[i].Phase = dat.Trial[i].Phase;
+        entry[i].FieldType = dat.Trial[i].FieldType;
+
+        misses = dat.Trial[i].MissTrials;
+    }
+
+    return(TRIALINDEX_WriteAll(file.c_str(),entry.data(),(int)entry.size()));
+}
+
+/******************************************************************************/
+
+// COLTABLEs for a DATFILE, with each variable pointing into a row buffer.
+
+class DATFILE_COLUMNS
+{
+public:
+    COLTABLE *Table[DATFILE_TABLES];
+    std::vector<double> Row[DATFILE_TABLES];
+    std::vector<double> Block;
+
+    DATFILE_COLUMNS( const DATFILE &dat )
+    {
+    size_t i;
+    int t,offset;
+
+        for( t=0; (t < DATFILE_TABLES); t++ )
+        {
+            Table[t] = new COLTABLE(dat.Table[t].Name);
+            Row[t].resize(dat.Table[t].Width);
+
+            for( offset=0,i=0; (i < dat.Table[t].Variable.size()); i++ )
+            {
+                Table[t]->AddVariable(dat.Table[t].Variable[i].Name,&Row[t][offset],dat.Table[t].Variable[i].Width);
+                offset += dat.Table[t].Variable[i].Width;
+            }
+        }
+
+        Table[0]->SetRows(1);
+        Table[1]->SetRows((dat.RowsMax > 0) ? dat.RowsMax : 1);
+    }
+
+   ~DATFILE_COLUMNS( void )
+    {
+    int t;
+
+        for( t=0; (t < DATFILE_TABLES); t++ )
+        {
+            delete Table[t];
+        }
+    }
+
+    // Read a trial's block and copy its rows into the tables.
+    bool Load( FILE *FP, const DATFILE &dat, int index )
+    {
+    const DATFILE_TRIAL &trial=dat.Trial[index];
+    const double *data;
+    int row,t;
+
+        Block.resize((size_t)(trial.Bytes / sizeof(double)));
+
+        if( (DATFILE_Seek(FP,trial.Offset) != 0) || (fread(Block.data(),sizeof(double),Block.size(),FP) != Block.size()) )
+        {
+            return(false);
+        }
+
+        for( t=0; (t < DATFILE_TABLES); t++ )
+        {
+            Table[t]->Reset();
+        }
+
+        data = &Block[2];
+        memcpy(Row[0].data(),data,Row[0].size() * sizeof(double));
+        Table[0]->RowSave();
+        data += Row[0].size();
+
+        for( row=0; (row < trial.Rows); row++ )
+        {
+            memcpy(Row[1].data(),data,Row[1].size() * sizeof(double));
+            Table[1]->RowSave();
+            data += Row[1].size();
+        }
+
+        return(true);
+    }
+};
+
+/******************************************************************************/
+
+// Trials are read and encoded by several threads and appended in order.
+
+struct CONVERT
+{
+    const DATFILE *Dat;
+    COLFILE_WRITER *Writer;
+    std::atomic<int> Next;
+    int Appended;
+    bool Ok;
+    std::mutex Mutex;
+    std::condition_variable Condition;
+};
+
+void ConvertThread( CONVERT *convert )
+{
+DATFILE_COLUMNS columns(*convert->Dat);
+COLFILE_TRIAL encoded;
+FILE *FP;
+bool ok;
+int index;
+
+    FP = fopen(convert->Dat->File.c_str(),"rb");
+
+    while( (index=convert->Next++) < (int)convert->Dat->Trial.size() )
+    {
+        ok = (FP != NULL) && columns.Load(FP,*convert->Dat,index);
+
+        if( ok )
+        {
+            COLFILE_WRITER::TrialEncode(columns.Table,DATFILE_TABLES,!RawFlag,encoded);
+        }
+
+        std::unique_lock<std::mutex> lock(convert->Mutex);
+
+        convert->Condition.wait(lock,[&]{ return(convert->Appended == index); });
+
+        if( !ok || !convert->Ok || !convert->Writer->TrialAppend(convert->Dat->Trial[index].Trial,encoded) )
+        {
+            convert->Ok = false;
+        }
+
+        convert->Appended++;
+        convert->Condition.notify_all();
+    }
+
+    if( FP != NULL )
+    {
+        fclose(FP);
+    }
+}
+
+/******************************************************************************/
+
+bool ConvertFile( const DATFILE &dat, const std::string &file, int threads )
+{
+DATFILE_COLUMNS columns(dat);
+COLFILE_WRITER writer;
+std::vector<std::thread> thread;
+std::string part=file + ".part";
+CONVERT convert;
+int i;
+
+    writer.Compress(!RawFlag);
+
+    if( !writer.Open(part.c_str(),columns.Table,DATFILE_TABLES) )
+    {
+        return(false);
+    }
+
+    convert.Dat = &dat;
+    convert.Writer = &writer;
+    convert.Next = 0;
+    convert.Appended = 0;
+    convert.Ok = true;
+
+    for( i=0; (i < threads); i++ )
+    {
+        thread.push_back(std::thread(ConvertThread,&convert));
+    }
+
+    for( i=0; (i < threads); i++ )
+    {
+        thread[i].join();
+    }
+
+    if( !writer.Close(false) || !convert.Ok )
+    {
+        remove(part.c_str());
+        return(false);
+    }
+
+    remove(file.c_str());
+
+    return(rename(part.c_str(),file.c_str()) == 0);
+}
+
+/******************************************************************************/
+
+void Print( const char *text, const std::string &file )
+{
+std::lock_guard<std::mutex> lock(PrintMutex);
+
+    printf("%s %s\n",text,file.c_str());
+}
+
+/******************************************************************************/
+
+// Convert files from the list until there are none left.
+
+void FileThread( int threads )
+{
+COLFILE_READER reader;
+std::string base,index,column;
+DATFILE dat;
+FILE *FP;
+size_t i;
+bool ok;
+
+    while( (i=(size_t)FileNext++) < FileList.size() )
+    {
+        dat.File = FileList[i];
+        base = dat.File.substr(0,dat.File.size()-4);
+        index = dat.File + ".index";
+        column = base + ".col";
+
+        if( !ForceFlag && !IndexOnlyFlag && reader.Open(column.c_str()) )
+        {
+            reader.Close();
+            FilesSkipped++;
+            Print("Done",dat.File);
+            continue;
+        }
+
+        ok = ((FP=fopen(dat.File.c_str(),"rb")) != NULL);
+        ok = ok && DATFILE_Header(FP,dat) && DATFILE_Index(FP,dat);
+
+        if( FP != NULL )
+        {
+            fclose(FP);
+        }
+
+        if( !ok )
+        {
+            FilesFailed++;
+            Print("Unknown layout",dat.File);
+            continue;
+        }
+
+        ok = IndexWrite(dat,index);
+        ok = ok && (IndexOnlyFlag || ConvertFile(dat,column,threads));
+
+        if( ok )
+        {
+            FilesConverted++;
+            Print("Ok",dat.File);
+        }
+        else
+        {
+            FilesFailed++;
+            Print("Failed",dat.File);
+        }
+    }
+}
+
+/******************************************************************************/
+
+bool FileIsDat( const std::string &file )
+{
+    return((file.size() > 4) && ((file.compare(file.size()-4,4,".dat") == 0) || (file.compare(file.size()-4,4,".DAT") == 0)));
+}
+
+/******************************************************************************/
+
+bool FileIsSpool( const std::string &file )
+{
+    return((file.size() > 8) && (file.compare(file.size()-8,8,".col.tmp") == 0));
+}
+
+/******************************************************************************/
+
+// Add .dat files in a directory (and its sub-directories) to the list.
+
+void FileSearch( const std::string &path )
+{
+std::string file;
+#if defined(_WIN32)
+WIN32_FIND_DATAA find;
+HANDLE handle;
+
+    if( (handle=FindFirstFileA((path + "\\*").c_str(),&find)) == INVALID_HANDLE_VALUE )
+    {
+        return;
+    }
+
+    do
+    {
+        if( (strcmp(find.cFileName,".") == 0) || (strcmp(find.cFileName,"..") == 0) )
+        {
+            continue;
+        }
+
+        file = path + "\\" + find.cFileName;
+
+        if( find.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY )
+        {
+            FileSearch(file);
+        }
+        else
+        if( FileIsDat(file) )
+        {
+            FileList.push_back(file);
+        }
+        else
+        if( FileIsSpool(file) )
+        {
+            SpoolList.push_back(file);
+        }
+    }
+    while( FindNextFileA(handle,&find) );
+
+    FindClose(handle);
+#else
+struct dirent *entry;
+struct stat info;
+DIR *dir;
+
+    if( (dir=opendir(path.c_str())) == NULL )
+    {
+        return;
+    }
+
+    while( (entry=readdir(dir)) != NULL )
+    {
+        if( (strcmp(entry->d_name,".") == 0) || (strcmp(entry->d_name,"..") == 0) )
+        {
+            continue;
+        }
+
+        file = path + "/" + entry->d_name;
+
+        if( stat(file.c_str(),&info) != 0 )
+        {
+            continue;
+        }
+
+        if( S_ISDIR(info.st_mode) )
+        {
+            FileSearch(file);
+        }
+        else
+        if( FileIsDat(file) )
+        {
+            FileList.push_back(file);
+        }
+        else
+        if( FileIsSpool(file) )
+        {
+            SpoolList.push_back(file);
+        }
+    }
+
+    closedir(dir);
+#endif
+}
+
+/******************************************************************************/
+
+bool FileDirectory( const char *path )
+{
+#if defined(_WIN32)
+DWORD attributes=GetFileAttributesA(path);
+
+    return((attributes != INVALID_FILE_ATTRIBUTES) && (attributes & FILE_ATTRIBUTE_DIRECTORY));
+#else
+struct stat info;
+
+    return((stat(path,&info) == 0) && S_ISDIR(info.st_mode));
+#endif
+}
+
+/******************************************************************************/
+
+int main( int argc, char *argv[] )
+{
+std::vector<std::thread> thread;
+int i,files,threads;
+
+    for( i=1; (i < argc); i++ )
+    {
+        // Options are "/X" or "/X:..." (so an absolute path isn't an option).
+        if( ((argv[i][0] == '/') || (argv[i][0] == '-')) && (argv[i][1] != 0) && ((argv[i][2] == 0) || (argv[i][2] == ':')) )
+        {
+            switch( argv[i][1] )
+            {
+                case 'T' :
+                case 't' :
+                    Threads = (argv[i][2] == ':') ? atoi(&argv[i][3]) : 0;
+                    break;
+
+                case 'F' :
+                case 'f' :
+                    ForceFlag = true;
+                    break;
+
+                case 'R' :
+                case 'r' :
+                    RawFlag = true;
+                    break;
+
+                case 'I' :
+                case 'i' :
+                    IndexOnlyFlag = true;
+                    break;
+
+                default :
+                    Usage();
+                    break;
+            }
+        }
+        else
+        if( FileDirectory(argv[i]) )
+        {
+            FileSearch(argv[i]);
+        }
+        else
+        if( FileIsSpool(argv[i]) )
+        {
+            SpoolList.push_back(argv[i]);
+        }
+        else
+        {
+            FileList.push_back(argv[i]);
+        }
+    }
+
+    if( FileList.empty() && SpoolList.empty() )
+    {
+        Usage();
+    }
+
+    // Session files of interrupted sessions, from their spool files.
+    for( i=0; (i < (int)SpoolList.size()); i++ )
+    {
+        if( COLFILE_Recover(SpoolList[i].substr(0,SpoolList[i].size()-4).c_str()) )
+        {
+            FilesConverted++;
+            Print("Recovered",SpoolList[i]);
+        }
+        else
+        {
+            FilesFailed++;
+            Print("Failed",SpoolList[i]);
+        }
+    }
+
+    if( FileList.empty() )
+    {
+        printf("Converted=%d Skipped=%d Failed=%d\n",(int)FilesConverted,(int)FilesSkipped,(int)FilesFailed);
+        return((FilesFailed == 0) ? 0 : 1);
+    }
+
+    if( Threads < 1 )
+    {
+        Threads = (int)std::thread::hardware_concurrency();
+    }
+
+    if( Threads < 1 )
+    {
+        Threads = 1;
+    }
+
+    // Threads are shared between files, and the trials of each file.
+    files = ((int)FileList.size() < Threads) ? (int)FileList.size() : Threads;
+    threads = Threads / files;
+
+    printf("Files=%d Threads=%d (%d files x %d trials)\n",(int)FileList.size(),Threads,files,threads);
+
+    for( i=0; (i < files); i++ )
+    {
+        thread.push_back(std::thread(FileThread,threads));
+    }
+
+    for( i=0; (i < files); i++ )
+    {
+        thread[i].join();
+    }
+
+    printf("Converted=%d Skipped=%d Failed=%d\n",(int)FilesConverted,(int)FilesSkipped,(int)FilesFailed);
+
+    return((FilesFailed == 0) ? 0 : 1);
+}
+
+/******************************************************************************/
@@ -0,0 +1,467 @@
+/******************************************************************************/
+/*                                                                            */
+/* MODULE  : drawbench.cpp                                                    */
+/*                                                                            */
+/* PURPOSE : Benchmark of drawing the DualPlanning scene from a session file. */
+/*                                                                            */
+/* DATE    : 17/Oct/2026                                                      */
+/*                                                                            */
+/* CHANGES                                                                    */
+/*                                                                            */
+/* V1.0  HRS 17/Oct/2026 - Initial development.                               */
+/*                                                                            */
+/******************************************************************************/
+
+// drawbench [/W:Width] [/H:Height] [/P:PixelsPerCm] [/E:Eyes] [/F:Frequency] [/Y:SyncTime] [/T:Text] [/I:Image.ppm] [/L] File.col
+//
+//   /W:n   Width of the screen in pixels (default 1920).
+//   /H:n   Height of the screen in pixels (default 1080).
+//   /P:s   Pixels per cm (default 40.0).
+//   /E:n   Eyes, 1 (mono, default) or 2 (stereo).
+//   /F:f   Vertical retrace frequency (default 60.0 Hz).
+//   /Y:s   Sync time (sec) before the retrace to draw a frame, as
+//          GraphicsVerticalRetraceSyncTime (default 0.01).
+//   /T:s   Text drawn in every frame (messages aren't saved in the session).
+//   /I:f   Write the last frame as a PPM image.
+//   /L     List the draw time of each frame.
+//
+// Plays back a session file written by DualPlanningClean (COLFILE) at the
+// display rate and draws each frame with SCENE_Draw(), the same scene code
+// as the experiment (DualPlanningScene.cpp), using the SWGRAPH software
+// rasterizer, so the cost of drawing (and whether a frame would miss its
+// retrace) can be measured without the lab display. Each trial is played
+// from its first FrameData row, with the robot, cursor and state taken from
+// the last row at or before the simulated retrace time. The positions,
+// field, context and movement order types come from TrialData (sessions
+// without them are drawn as TARGET_STATIC_GO). The via point is a circle
+// and the rest break teapot isn't drawn. Sizes are those of FT-Basic.cfg,
+// with the default colours.
+//
+// g++ -O2 -std=c++11 -pthread -o drawbench drawbench.cpp ../combinedDecayExperiment/DualPlanningScene.cpp ../common/swgraph.cpp ../common/journal.cpp ../common/colfile.cpp ../common/colcodec.cpp
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <chrono>
+
+#include "../common/colfile.h"
+#include "../common/swgraph.h"
+#include "../combinedDecayExperiment/DualPlanningScene.h"
+
+/******************************************************************************/
+
+#define CURSOR_RADIUS       0.5  // FT-Basic.cfg
+#define START_RADIUS        1.25
+#define START_TOLERANCE     1.25
+#define TARGET_RADIUS       1.25
+#define TARGET_OUTLINE      0.1
+#define VIA_RADIUS          1.25
+#define SECOND_DISTANCE     12.0
+
+#define COLOR_BACKGROUND    0xADD8E6  // LIGHTBLUE
+#define COLOR_START         0xFFFFFF  // WHITE
+#define COLOR_NOTSTART      0x808080  // GREY
+#define COLOR_VIA           0x808080  // GREY
+#define COLOR_TARGET        0xFFFF00  // YELLOW
+#define COLOR_CURSOR        0xFF0000  // RED
+#define COLOR_TEXT          0xFFFFFF  // WHITE
+
+#define TEXT_WIDTH          2.0       // Pixels (glLineWidth() in SCENE_String()).
+
+/******************************************************************************/
+
+int         Width=1920;
+int         Height=1080;
+double      PixelsPerCm=40.0;
+int         Eyes=1;
+double      Frequency=60.0;
+double      SyncTime=0.01;
+char       *Text=NULL;
+char       *Image=NULL;
+bool        ListFlag=false;
+char       *File=NULL;
+
+COLFILE_READER Reader;
+SCENE       Scene;
+
+/******************************************************************************/
+
+void Usage( void )
+{
+    printf("----------------------------------\n");
+    printf("drawbench [/W:Width] [/H:Height] [/P:PixelsPerCm] [/E:Eyes] [/F:Frequency] [/Y:SyncTime] [/T:Text] [/I:Image.ppm] [/L] File.col\n");
+    printf("----------------------------------\n");
+
+    exit(0);
+}
+
+/******************************************************************************/
+
+// Variables used (FrameData then TrialData).
+
+#define TRIALTIME               0
+#define STATE                   1
+#define CURSORPOSITION          2
+#define ROBOTPOSITION           3
+#define STARTPOSITION           4
+#define VIAPOSITION             5
+#define TARGETPOSITION          6
+#define FINISHPOSITION          7
+#define FIELDTYPE               8
+#define CONTEXTTYPE             9
+#define MOVEMENTORDERTYPE      10
+#define SYMMETRYAXISANGLE      11
+#define TARGETANGLE            12
+#define MOVEMENTSECONDDISTANCE 13
+#define TARGETRESOLVEDISTANCE  14
+#define VARIABLES              15
+
+#define FRAMEVARIABLES          4       // The first TrialData variable.
+
+const char *VariableName[VARIABLES] =
+{
+    "TrialTime","State","CursorPosition","RobotPosition",
+    "StartPosition","ViaPosition","TargetPosition","FinishPosition",
+    "FieldType","ContextType","MovementOrderType","SymmetryAxisAngle","TargetAngle","MovementSecondDistance","TargetResolveDistance"
+};
+
+// The others have defaults (for sessions from before they were saved).
+const bool VariableRequired[VARIABLES] =
+{
+    true,true,true,false,
+    true,true,true,false,
+    false,false,false,false,false,false,false
+};
+
+int         Variable[VARIABLES];
+
+/******************************************************************************/
+
+bool VariablesFind( void )
+{
+int table[2],i;
+
+    table[0] = Reader.TableFind("FrameData");
+    table[1] = Reader.TableFind("TrialData");
+
+    if( (table[0] < 0) || (table[1] < 0) )
+    {
+        printf("%s: TrialData and FrameData tables not found.\n",File);
+        return(false);
+    }
+
+    for( i=0; (i < VARIABLES); i++ )
+    {
+        Variable[i] = Reader.VariableFind(table[(i < FRAMEVARIABLES) ? 0 : 1],VariableName[i]);
+
+        // Sessions from before CursorPosition was saved.
+        if( (Variable[i] < 0) && (i == CURSORPOSITION) )
+        {
+            Variable[i] = Reader.VariableFind(table[0],"RobotPosition");
+        }
+
+        if( (Variable[i] < 0) && VariableRequired[i] )
+        {
+            printf("%s: %s not found.\n",File,VariableName[i]);
+            return(false);
+        }
+
+        if( (Variable[i] >= 0) && (Reader.Column(Variable[i]).Data == NULL) )
+        {
+            printf("%s: %s cannot be decoded.\n",File,VariableName[i]);
+            return(false);
+        }
+    }
+
+    // The cursor is the robot position without its own column.
+    if( Variable[ROBOTPOSITION] < 0 )
+    {
+        Variable[ROBOTPOSITION] = Variable[CURSORPOSITION];
+    }
+
+    return(true);
+}
+
+/******************************************************************************/
+
+double TrialValue( const COLFILE_SPAN *span, int variable, double value )
+{
+    return((span[variable].Rows > 0) ? span[variable](0) : value);
+}
+
+/******************************************************************************/
+
+VEC3 RowPosition( const COLFILE_SPAN &span, int64_t row )
+{
+    return(VEC3(span(row,0),span(row,1),span(row,2)));
+}
+
+/******************************************************************************/
+
+// Sizes and colours, as ConfigLoad() with FT-Basic.cfg.
+
+void SceneStart( void )
+{
+    Scene.ViaType = VIA_CIRCLE;
+
+    Scene.TextPosition = VEC3(0.0,0.0,0.0);
+
+    Scene.StartRadius = START_RADIUS;
+    Scene.StartTolerance = START_TOLERANCE;
+    Scene.ViaRadius = VIA_RADIUS;
+    Scene.ViaWidth = 0.0;
+    Scene.ViaHeight = 0.0;
+    Scene.TargetRadius = TARGET_RADIUS;
+    Scene.TargetOutlineWidth = TARGET_OUTLINE;
+    Scene.CursorRadius = CURSOR_RADIUS;
+
+    Scene.StartColor = COLOR_START;
+    Scene.NotStartColor = COLOR_NOTSTART;
+    Scene.ViaColor = COLOR_VIA;
+    Scene.TargetColor = COLOR_TARGET;
+    Scene.CursorColor = COLOR_CURSOR;
+    Scene.TextColor = COLOR_TEXT;
+
+    Scene.Text = Text;
+
+    Scene.TeapotSize = 0.0;
+    Scene.TeapotAngle = 0.0;
+}
+
+/******************************************************************************/
+
+// The trial's TrialData, as TrialSetup().
+
+void SceneTrial( const COLFILE_SPAN *span )
+{
+    Scene.FieldType = (int)TrialValue(span,FIELDTYPE,FIELD_NONE);
+    Scene.ContextType = (int)TrialValue(span,CONTEXTTYPE,TARGET_STATIC_GO);
+    Scene.MovementOrderType = (int)TrialValue(span,MOVEMENTORDERTYPE,ORDER_FOLLOW_THROUGH);
+
+    Scene.StartPosition = RowPosition(span[STARTPOSITION],0);
+    Scene.ViaPosition = RowPosition(span[VIAPOSITION],0);
+    Scene.TargetPosition = RowPosition(span[TARGETPOSITION],0);
+    Scene.FinishPosition = (span[FINISHPOSITION].Rows > 0) ? RowPosition(span[FINISHPOSITION],0) : Scene.StartPosition;
+
+    Scene.SymmetryAxisAngle = TrialValue(span,SYMMETRYAXISANGLE,0.0);
+    Scene.TargetAngle = TrialValue(span,TARGETANGLE,0.0);
+    Scene.MovementSecondDistance = TrialValue(span,MOVEMENTSECONDDISTANCE,SECOND_DISTANCE);
+    Scene.TargetResolveDistance = TrialValue(span,TARGETRESOLVEDISTANCE,0.0);
+
+    Scene.TargetResolveFlag = false;
+}
+
+/******************************************************************************/
+
+// SCENE_Draw() drawing functions, as DualPlanningClean.cpp but with SWGRAPH.
+
+void SCENE_Circle( const VEC3 &posn, double radius, int color )
+{
+    SWGRAPH_Circle(posn(1),posn(2),radius,(uint32_t)color);
+}
+
+/******************************************************************************/
+
+void SCENE_Ring( const VEC3 &posn, double radius, double width, int color )
+{
+    SWGRAPH_Ring(posn(1),posn(2),radius,width,(uint32_t)color);
+}
+
+/******************************************************************************/
+
+void SCENE_Rectangle( const VEC3 &posn, double width, double height, int color )
+{
+    SWGRAPH_Rectangle(posn(1),posn(2),width,height,(uint32_t)color);
+}
+
+/******************************************************************************/
+
+void SCENE_String( const VEC3 &posn, double scale, const char *text, int color )
+{
+    SWGRAPH_String(posn(1),posn(2),scale,text,TEXT_WIDTH,(uint32_t)color);
+}
+
+/******************************************************************************/
+
+void SCENE_Teapot( double, double, int )
+{
+    // The rest break isn't in the session file.
+}
+
+/******************************************************************************/
+
+// One frame of the scene, as GraphicsDisplay().
+
+void DrawFrame( const COLFILE_SPAN *span, int64_t row )
+{
+int eye;
+
+    Scene.State = (int)span[STATE](row);
+    Scene.RobotPosition = RowPosition(span[ROBOTPOSITION],row);
+    Scene.CursorPosition = RowPosition(span[CURSORPOSITION],row);
+
+    SWGRAPH_ClearStereo(COLOR_BACKGROUND);
+
+    for( eye=0; (eye < Eyes); eye++ )
+    {
+        SWGRAPH_ViewCalib(eye);
+        SWGRAPH_ClearMono(COLOR_BACKGROUND);
+
+        SCENE_Draw(Scene);
+    }
+}
+
+/******************************************************************************/
+
+int main( int argc, char *argv[] )
+{
+std::chrono::steady_clock::time_point start;
+COLFILE_SPAN span[VARIABLES];
+int trials,t,i,frames;
+int64_t row,rows;
+double begin,time,shown,seconds;
+
+    for( t=1; (t < argc); t++ )
+    {
+        // Options are "/X" or "/X:..." (so an absolute path isn't an option).
+        if( ((argv[t][0] == '/') || (argv[t][0] == '-')) && (argv[t][1] != 0) && ((argv[t][2] == 0) || (argv[t][2] == ':')) )
+        {
+            switch( argv[t][1] )
+            {
+                case 'W' :
+                case 'w' :
+                    Width = (argv[t][2] == ':') ? atoi(&argv[t][3]) : Width;
+                    break;
+
+                case 'H' :
+                case 'h' :
+                    Height = (argv[t][2] == ':') ? atoi(&argv[t][3]) : Height;
+                    break;
+
+                case 'P' :
+                case 'p' :
+                    PixelsPerCm = (argv[t][2] == ':') ? atof(&argv[t][3]) : PixelsPerCm;
+                    break;
+
+                case 'E' :
+                case 'e' :
+                    Eyes = (argv[t][2] == ':') ? atoi(&argv[t][3]) : Eyes;
+                    break;
+
+                case 'F' :
+                case 'f' :
+                    Frequency = (argv[t][2] == ':') ? atof(&argv[t][3]) : Frequency;
+                    break;
+
+                case 'Y' :
+                case 'y' :
+                    SyncTime = (argv[t][2] == ':') ? atof(&argv[t][3]) : SyncTime;
+                    break;
+
+                case 'T' :
+                case 't' :
+                    Text = (argv[t][2] == ':') ? &argv[t][3] : NULL;
+                    break;
+
+                case 'I' :
+                case 'i' :
+                    Image = (argv[t][2] == ':') ? &argv[t][3] : NULL;
+                    break;
+
+                case 'L' :
+                case 'l' :
+                    ListFlag = true;
+                    break;
+
+                default :
+                    Usage();
+                    break;
+            }
+        }
+        else
+        {
+            File = argv[t];
+        }
+    }
+
+    if( File == NULL )
+    {
+        Usage();
+    }
+
+    if( !Reader.Open(File) )
+    {
+        printf("%s: Cannot open.\n",File);
+        return(1);
+    }
+
+    if( !VariablesFind() )
+    {
+        return(1);
+    }
+
+    if( !SWGRAPH_Start(Width,Height,PixelsPerCm,Eyes,Frequency,SyncTime) )
+    {
+        printf("Cannot start SWGRAPH (%dx%d Eyes=%d).\n",Width,Height,Eyes);
+        return(1);
+    }
+
+    if( ListFlag )
+    {
+        printf("Trial Frame TrialTime State Draw(msec) Shown(sec)\n");
+    }
+
+    SceneStart();
+
+    trials = Reader.Trials();
+    frames = 0;
+    start = std::chrono::steady_clock::now();
+
+    for( t=0; (t < trials); t++ )
+    {
+        for( i=0; (i < VARIABLES); i++ )
+        {
+            span[i] = (Variable[i] >= 0) ? Reader.Column(Variable[i],t) : COLFILE_SPAN();
+        }
+
+        SceneTrial(span);
+
+        if( (rows=span[TRIALTIME].Rows) == 0 )
+        {
+            continue;
+        }
+
+        // Play the trial from its first row at the display rate.
+        begin = SWGRAPH_Time() - span[TRIALTIME](0);
+
+        for( row=0; ((time=SWGRAPH_Time() - begin) <= span[TRIALTIME](rows-1)); frames++ )
+        {
+            for( ; ((row+1) < rows) && (span[TRIALTIME](row+1) <= time); row++ );
+
+            DrawFrame(span,row);
+            shown = SWGRAPH_SwapBuffers();
+
+            if( ListFlag )
+            {
+                printf("%d %d %.4lf %d %.3lf %.4lf\n",Reader.Trial(t),frames,time,(int)span[STATE](row),1000.0 * SWGRAPH_FrameTime(),shown);
+            }
+        }
+    }
+
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    SWGRAPH_Results();
+
+    printf("%s: Trials=%d Frames=%d Time=%.3lf(sec) Check=%08X\n",File,trials,frames,seconds,SWGRAPH_Check(0));
+
+    if( (Image != NULL) && !SWGRAPH_Save(Image,0) )
+    {
+        printf("%s: Cannot write.\n",Image);
+    }
+
+    SWGRAPH_Stop();
+
+    return(0);
+}
+
+/******************************************************************************/
@@ -0,0 +1,315 @@
+/******************************************************************************/
+/*                                                                            */
+/* MODULE  : kinmetrics.cpp                                                   */
+/*                                                                            */
+/* PURPOSE : Per-trial kinematic metrics for a DualPlanning session file.     */
+/*                                                                            */
+/* DATE    : 17/Oct/2026                                                      */
+/*                                                                            */
+/* CHANGES                                                                    */
+/*                                                                            */
+/* V1.0  HRS 17/Oct/2026 - Initial development.                               */
+/*                                                                            */
+/******************************************************************************/
+
+// kinmetrics [/T:Threads] [/V:ViaNotMovingSpeed] [/O:OnsetFraction] [/R:Repeats] [/Q] File.col
+//
+//   /T:n   Threads (default is the number of cores).
+//   /V:s   ViaNotMovingSpeed of the session (default 5.0, it isn't in TrialData).
+//   /O:f   Onset at this fraction of peak speed (default 0.1).
+//   /R:n   Calculate the metrics n times and report the best time.
+//   /Q     Only print the times (not the metrics).
+//
+// Reads a session file written by DualPlanningClean (COLFILE) and prints one
+// line of KINEMETRIC_RESULT for each trial. The channel, via-point and state
+// settings come from each trial's TrialData, with the state, field, order and
+// channel numbers from combinedDecayExperiment/DualPlanningScene.h.
+// FIELD_SAMEASLAST keeps the field of the trial before, as the robot forces
+// function does. Only the columns used
+// are decoded, with the trial blocks of compressed columns shared between
+// the threads (COLFILE_READER::Load()).
+//
+// A session of 800 trials x 4000 rows takes about 12 ms with raw columns on
+// one core. Compressed columns (ColumnCompress) are decoded first, which takes
+// 2 to 3 seconds for that session on one core, so compressed sessions don't
+// process in under a second unless the decoding is shared between cores.
+//
+// g++ -O2 -std=c++11 -pthread -o kinmetrics kinmetrics.cpp ../common/kinemetric.cpp ../common/colfile.cpp ../common/colcodec.cpp
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "../common/colfile.h"
+#include "../common/kinemetric.h"
+#include "../combinedDecayExperiment/DualPlanningScene.h"
+
+/******************************************************************************/
+
+int         Threads=0;
+double      ViaNotMovingSpeed=5.0;
+double      OnsetFraction=0.1;
+int         Repeats=1;
+bool        QuietFlag=false;
+char       *File=NULL;
+
+COLFILE_READER Reader;
+
+/******************************************************************************/
+
+void Usage( void )
+{
+    printf("----------------------------------\n");
+    printf("kinmetrics [/T:Threads] [/V:ViaNotMovingSpeed] [/O:OnsetFraction] [/R:Repeats] [/Q] File.col\n");
+    printf("----------------------------------\n");
+
+    exit(0);
+}
+
+/******************************************************************************/
+
+// Variables used (only these columns are decoded, by all the threads).
+
+#define TRIALTIME            0
+#define STATE                1
+#define ROBOTPOSITION        2
+#define ROBOTVELOCITY        3
+#define ROBOTFORCES          4
+#define FIELDTYPE            5
+#define CHANNELORDERTYPE     6
+#define SYMMETRYAXISANGLE    7
+#define TARGETANGLE          8
+#define MOVEMENTORDERTYPE    9
+#define FINISHPOSITION      10
+#define VIATOLERANCETIME    11
+#define VARIABLES           12
+
+const char *VariableName[VARIABLES] =
+{
+    "TrialTime","State","RobotPosition","RobotVelocity","RobotForces",
+    "FieldType","ChannelOrderType","SymmetryAxisAngle","TargetAngle",
+    "MovementOrderType","FinishPosition","ViaToleranceTime"
+};
+
+int         Variable[VARIABLES];
+
+/******************************************************************************/
+
+bool VariablesFind( void )
+{
+int table[2],i;
+
+    table[0] = Reader.TableFind("FrameData");
+    table[1] = Reader.TableFind("TrialData");
+
+    if( (table[0] < 0) || (table[1] < 0) )
+    {
+        printf("%s: TrialData and FrameData tables not found.\n",File);
+        return(false);
+    }
+
+    for( i=0; (i < VARIABLES); i++ )
+    {
+        if( (Variable[i]=Reader.VariableFind(table[(i < FIELDTYPE) ? 0 : 1],VariableName[i])) < 0 )
+        {
+            printf("%s: %s not found.\n",File,VariableName[i]);
+            return(false);
+        }
+    }
+
+    // Trial blocks of the compressed columns are decoded in parallel.
+    Reader.Load(Variable,VARIABLES,Threads);
+
+    for( i=0; (i < VARIABLES); i++ )
+    {
+        if( Reader.Column(Variable[i]).Data == NULL )
+        {
+            printf("%s: %s cannot be decoded.\n",File,VariableName[i]);
+            return(false);
+        }
+    }
+
+    return(true);
+}
+
+/******************************************************************************/
+
+double Seconds( std::chrono::steady_clock::time_point start )
+{
+    return(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+}
+
+/******************************************************************************/
+
+int main( int argc, char *argv[] )
+{
+std::chrono::steady_clock::time_point start;
+std::vector<KINEMETRIC_TRIAL> trial;
+std::vector<KINEMETRIC_RESULT> result;
+COLFILE_SPAN span[VARIABLES];
+int trials,t,i,r,field;
+double load,seconds;
+int64_t rows;
+
+    for( t=1; (t < argc); t++ )
+    {
+        // Options are "/X" or "/X:..." (so an absolute path isn't an option).
+        if( ((argv[t][0] == '/') || (argv[t][0] == '-')) && (argv[t][1] != 0) && ((argv[t][2] == 0) || (argv[t][2] == ':')) )
+        {
+            switch( argv[t][1] )
+            {
+                case 'T' :
+                case 't' :
+                    Threads = (argv[t][2] == ':') ? atoi(&argv[t][3]) : 0;
+                    break;
+
+                case 'V' :
+                case 'v' :
+                    ViaNotMovingSpeed = (argv[t][2] == ':') ? atof(&argv[t][3]) : ViaNotMovingSpeed;
+                    break;
+
+                case 'O' :
+                case 'o' :
+                    OnsetFraction = (argv[t][2] == ':') ? atof(&argv[t][3]) : OnsetFraction;
+                    break;
+
+                case 'R' :
+                case 'r' :
+                    Repeats = (argv[t][2] == ':') ? atoi(&argv[t][3]) : 1;
+                    break;
+
+                case 'Q' :
+                case 'q' :
+                    QuietFlag = true;
+                    break;
+
+                default :
+                    Usage();
+                    break;
+            }
+        }
+        else
+        {
+            File = argv[t];
+        }
+    }
+
+    if( File == NULL )
+    {
+        Usage();
+    }
+
+    if( Threads < 1 )
+    {
+        Threads = (int)std::thread::hardware_concurrency();
+    }
+
+    // Open the file and decode the columns.
+    start = std::chrono::steady_clock::now();
+
+    if( !Reader.Open(File) )
+    {
+        printf("%s: Cannot open.\n",File);
+        return(1);
+    }
+
+    if( !VariablesFind() )
+    {
+        return(1);
+    }
+
+    load = Seconds(start);
+
+    // Set up each trial from its TrialData row and FrameData rows.
+    trials = Reader.Trials();
+    trial.resize(trials);
+    result.resize(trials);
+    field = 0;
+    rows = 0;
+
+    for( t=0; (t < trials); t++ )
+    {
+        for( i=0; (i < VARIABLES); i++ )
+        {
+            span[i] = Reader.Column(Variable[i],t);
+        }
+
+        KINEMETRIC_Defaults(trial[t]);
+
+        trial[t].Rows = (int)span[TRIALTIME].Rows;
+        trial[t].Time = span[TRIALTIME].Data;
+        trial[t].State = span[STATE].Data;
+        trial[t].Position = span[ROBOTPOSITION].Data;
+        trial[t].Velocity = span[ROBOTVELOCITY].Data;
+        trial[t].Forces = span[ROBOTFORCES].Data;
+        rows += trial[t].Rows;
+
+        // TrialData has one row per trial.
+        if( (int)span[FIELDTYPE](0) != FIELD_SAMEASLAST )
+        {
+            field = (int)span[FIELDTYPE](0);
+        }
+
+        if( field == FIELD_CHANNEL )
+        {
+            trial[t].Channel = ((int)span[CHANNELORDERTYPE](0) == CHANNEL_SECOND) ? KINEMETRIC_CHANNEL_SECOND : KINEMETRIC_CHANNEL_FIRST;
+        }
+
+        trial[t].SymmetryAxisAngle = span[SYMMETRYAXISANGLE](0);
+        trial[t].TargetAngle = span[TARGETANGLE](0);
+        trial[t].SingleMovement = ((int)span[MOVEMENTORDERTYPE](0) == ORDER_SINGLE_MOVEMENT);
+        trial[t].FinishPosition[0] = span[FINISHPOSITION](0,0);
+        trial[t].FinishPosition[1] = span[FINISHPOSITION](0,1);
+
+        // ForceFieldStop() is called leaving the movement with the channel (or the trial).
+        trial[t].ChannelStopStates = KINEMETRIC_STATE(STATE_POSTMOVEDELAY) | KINEMETRIC_STATE(STATE_FINISH) | KINEMETRIC_STATE(STATE_TIMEOUT) | KINEMETRIC_STATE(STATE_ERROR);
+
+        if( trial[t].Channel == KINEMETRIC_CHANNEL_FIRST )
+        {
+            trial[t].ChannelStopStates |= KINEMETRIC_STATE(STATE_VIAPOINT);
+        }
+
+        trial[t].ViaState = STATE_VIAPOINT;
+        trial[t].ViaNotMovingSpeed = ViaNotMovingSpeed;
+        trial[t].ViaToleranceTime = span[VIATOLERANCETIME](0);
+        trial[t].OnsetFraction = OnsetFraction;
+    }
+
+    // Best time of the repeats.
+    seconds = 1.0E9;
+
+    for( r=0; (r < Repeats); r++ )
+    {
+        start = std::chrono::steady_clock::now();
+        KINEMETRIC_Batch(trial.data(),result.data(),trials,Threads);
+
+        if( Seconds(start) < seconds )
+        {
+            seconds = Seconds(start);
+        }
+    }
+
+    if( !QuietFlag )
+    {
+        printf("Trial PeakSpeed PeakSpeedTime OnsetTime ChannelAngle PerpendicularError LateralForcePeak LateralForceMean ViaDwell ViaStillTime\n");
+
+        for( t=0; (t < trials); t++ )
+        {
+            printf("%d %.3lf %.4lf %.4lf %.2lf %.4lf %.3lf %.3lf %.4lf %.4lf\n",
+                   Reader.Trial(t),result[t].PeakSpeed,result[t].PeakSpeedTime,result[t].OnsetTime,
+                   result[t].ChannelAngle,result[t].PerpendicularError,result[t].LateralForcePeak,
+                   result[t].LateralForceMean,result[t].ViaDwell,result[t].ViaStillTime);
+        }
+    }
+
+    printf("%s: Trials=%d Rows=%lld Threads=%d Load=%.3lf(sec) Metrics=%.4lf(sec) (%.1lf ns/row)\n",
+           File,trials,(long long)rows,Threads,load,seconds,1.0E9 * seconds / (double)((rows > 0) ? rows : 1));
+
+    return(0);
+}
+
+/******************************************************************************/
@@ -0,0 +1,292 @@
+/******************************************************************************/
+/*                                                                            */
+/* MODULE  : rowbench.cpp                                                     */
+/*                                                                            */
+/* PURPOSE : Microbenchmark of saving FrameData rows (COLTABLE::RowSave).     */
+/*                                                                            */
+/* DATE    : 17/Oct/2026                                                      */
+/*                                                                            */
+/* CHANGES                                                                    */
+/*                                                                            */
+/* V1.0  HRS 17/Oct/2026 - Initial development.                               */
+/*                                                                            */
+/******************************************************************************/
+
+// Times saving 10000 rows of the FrameData variables of the experiments
+// (TrialTime, State, ForcesFunctionLatency, ForcesFunctionPeriod and five 3x1
+// matrices) with a compiled COLTABLE, and with a copy of each element in turn
+// through a list of addresses into a row-major matrix (as MATDAT::RowSave()).
+// MATRIX stands in for the MOTOR matrix (heap storage, 1-based elements).
+//
+// g++ -O2 -std=c++11 -pthread -o rowbench rowbench.cpp ../common/colfile.cpp ../common/colcodec.cpp
+// rowbench [rows] [repeats]
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <chrono>
+#include <vector>
+
+#include "../common/colfile.h"
+
+/******************************************************************************/
+
+class MATRIX
+{
+private:
+    double *Data;
+    int Rows;
+    int Columns;
+
+public:
+    MATRIX( int rows, int columns )
+    {
+        Rows = rows;
+        Columns = columns;
+        Data = new double[rows * columns]();
+    }
+
+   ~MATRIX( void )
+    {
+        delete [] Data;
+    }
+
+    double &operator()( int row, int column )
+    {
+        if( (row < 1) || (row > Rows) || (column < 1) || (column > Columns) )
+        {
+            abort();
+        }
+
+        return(Data[((row-1) * Columns) + (column-1)]);
+    }
+
+    int rows( void ) const
+    {
+        return(Rows);
+    }
+};
+
+/******************************************************************************/
+
+// Element-by-element copy through registered addresses (as MATDAT).
+
+#define ELEMENT_DOUBLE 0
+#define ELEMENT_INT    1
+#define ELEMENT_MATRIX 2
+
+struct ELEMENT
+{
+    int Type;
+    void *Variable;
+    int Index;
+};
+
+class ROWLIST
+{
+private:
+    std::vector<ELEMENT> Element;
+    MATRIX *Data;
+    int Row;
+
+public:
+    ROWLIST( void )
+    {
+        Data = NULL;
+        Row = 0;
+    }
+
+   ~ROWLIST( void )
+    {
+        delete Data;
+    }
+
+    void Add( int type, void *variable, int count )
+    {
+    ELEMENT element;
+    int i;
+
+        for( i=0; (i < count); i++ )
+        {
+            element.Type = type;
+            element.Variable = variable;
+            element.Index = i;
+            Element.push_back(element);
+        }
+    }
+
+    void SetRows( int rows )
+    {
+        delete Data;
+        Data = new MATRIX(rows,(int)Element.size());
+        Row = 0;
+    }
+
+    void Reset( void )
+    {
+        Row = 0;
+    }
+
+    void RowSave( void )
+    {
+    size_t i;
+    double value;
+
+        Row++;
+
+        for( i=0; (i < Element.size()); i++ )
+        {
+            switch( Element[i].Type )
+            {
+                case ELEMENT_DOUBLE :
+                    value = ((double *)Element[i].Variable)[Element[i].Index];
+                    break;
+
+                case ELEMENT_INT :
+                    value = (double)((int *)Element[i].Variable)[Element[i].Index];
+                    break;
+
+                default :
+                    value = (*(MATRIX *)Element[i].Variable)(Element[i].Index+1,1);
+                    break;
+            }
+
+            (*Data)(Row,(int)i+1) = value;
+        }
+    }
+};
+
+/******************************************************************************/
+
+double  TrialTime=0.0;
+int     State=0;
+double  ForcesFunctionLatency=0.0;
+double  ForcesFunctionPeriod=0.0;
+MATRIX  RobotPosition(3,1);
+MATRIX  RobotVelocity(3,1);
+MATRIX  RobotForces(3,1);
+MATRIX  HandleForces(3,1);
+MATRIX  CursorPosition(3,1);
+
+/******************************************************************************/
+
+// Change the variables between rows, as the robot loop does.
+
+void Update( int row )
+{
+int i;
+
+    TrialTime = row * 0.001;
+    State = row / 1000;
+    ForcesFunctionLatency = 1.0E-5 * (row % 7);
+    ForcesFunctionPeriod = 0.001;
+
+    for( i=1; (i <= 3); i++ )
+    {
+        RobotPosition(i,1) = TrialTime * i;
+        RobotVelocity(i,1) = i;
+        RobotForces(i,1) = -TrialTime;
+        HandleForces(i,1) = TrialTime;
+        CursorPosition(i,1) = RobotPosition(i,1);
+    }
+}
+
+/******************************************************************************/
+
+double Minimum( double seconds, std::chrono::steady_clock::time_point start )
+{
+double elapsed;
+
+    elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    return((elapsed < seconds) ? elapsed : seconds);
+}
+
+/******************************************************************************/
+
+int main( int argc, char *argv[] )
+{
+std::chrono::steady_clock::time_point start;
+COLTABLE columns("FrameData");
+ROWLIST list;
+double seconds[3]={ 1.0E9,1.0E9,1.0E9 };
+int rows=10000,repeats=100;
+int r,row;
+
+    if( argc > 1 )
+    {
+        rows = atoi(argv[1]);
+    }
+
+    if( argc > 2 )
+    {
+        repeats = atoi(argv[2]);
+    }
+
+    columns.AddVariable("TrialTime",TrialTime);
+    columns.AddVariable("State",State);
+    columns.AddVariable("ForcesFunctionLatency",ForcesFunctionLatency);
+    columns.AddVariable("ForcesFunctionPeriod",ForcesFunctionPeriod);
+    columns.AddVariable("RobotPosition",RobotPosition);
+    columns.AddVariable("RobotVelocity",RobotVelocity);
+    columns.AddVariable("RobotForces",RobotForces);
+    columns.AddVariable("HandleForces",HandleForces);
+    columns.AddVariable("CursorPosition",CursorPosition);
+    columns.SetRows(rows);
+
+    list.Add(ELEMENT_DOUBLE,&TrialTime,1);
+    list.Add(ELEMENT_INT,&State,1);
+    list.Add(ELEMENT_DOUBLE,&ForcesFunctionLatency,1);
+    list.Add(ELEMENT_DOUBLE,&ForcesFunctionPeriod,1);
+    list.Add(ELEMENT_MATRIX,&RobotPosition,3);
+    list.Add(ELEMENT_MATRIX,&RobotVelocity,3);
+    list.Add(ELEMENT_MATRIX,&RobotForces,3);
+    list.Add(ELEMENT_MATRIX,&HandleForces,3);
+    list.Add(ELEMENT_MATRIX,&CursorPosition,3);
+    list.SetRows(rows);
+
+    // Alternate them so they see the same cache and clock conditions.
+    for( r=0; (r < repeats); r++ )
+    {
+        start = std::chrono::steady_clock::now();
+        for( row=0; (row < rows); row++ )
+        {
+            Update(row);
+        }
+        seconds[2] = Minimum(seconds[2],start);
+
+        list.Reset();
+        start = std::chrono::steady_clock::now();
+        for( row=0; (row < rows); row++ )
+        {
+            Update(row);
+            list.RowSave();
+        }
+        seconds[0] = Minimum(seconds[0],start);
+
+        columns.Reset();
+        start = std::chrono::steady_clock::now();
+        for( row=0; (row < rows); row++ )
+        {
+            Update(row);
+            columns.RowSave();
+        }
+        seconds[1] = Minimum(seconds[1],start);
+    }
+
+    // Check the columns have the right values.
+    if( (columns.GetRow() != rows) || (columns.GetColumnData(4)[((rows-1) * 3) + 2] != ((rows-1) * 0.001 * 3)) )
+    {
+        printf("COLTABLE: Wrong values.\n");
+        return(1);
+    }
+
+    // Best of the repeats, less the time for Update() alone.
+    printf("Rows=%d Repeats=%d\n",rows,repeats);
+    printf("Element list (MATDAT) %6.1lf ns/row\n",1.0E9 * (seconds[0] - seconds[2]) / (double)rows);
+    printf("COLTABLE compiled     %6.1lf ns/row\n",1.0E9 * (seconds[1] - seconds[2]) / (double)rows);
+
+    return(0);
+}
+
+/******************************************************************************/